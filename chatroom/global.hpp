@@ -22,14 +22,49 @@ extern QString CHATROOM_API_BASE_URL;
 
 enum class ReqID : std::uint16_t
 {
-  ID_GET_VERIFY_CODE = 1001,      // 获取验证码
-  ID_REGISTER = 1002,             // 注册
-  ID_RESET_PASSWORD = 1003,       // 重置密码
-  ID_LOGIN = 1004,                // 登录
-  ID_LOGIN_CHAT = 1005,           // 逻辑登录
-  ID_LOGIN_CHAT_RESPONSE = 1006,  // 登录回包
-  ID_EXIT_LOGIN = 1007,           // 退出登录
-  ID_EXIT_LOGIN_RESPONSE = 1008,  // 退出登录回包
+  ID_GET_VERIFY_CODE = 1001,        // 获取验证码
+  ID_REGISTER = 1002,               // 注册
+  ID_RESET_PASSWORD = 1003,         // 重置密码
+  ID_LOGIN = 1004,                  // 登录
+  ID_LOGIN_CHAT = 1005,             // 逻辑登录
+  ID_LOGIN_CHAT_RESPONSE = 1006,    // 登录回包
+  ID_EXIT_LOGIN = 1007,             // 退出登录
+  ID_EXIT_LOGIN_RESPONSE = 1008,    // 退出登录回包
+  ID_HEARTBEAT = 1009,              // 心跳，空消息体
+  ID_HEARTBEAT_RESPONSE = 1010,     // 心跳回包
+  ID_LOAD_HISTORY = 1011,           // 拉取历史消息
+  ID_LOAD_HISTORY_RESPONSE = 1012,  // 拉取历史消息回包
+  ID_RESUME = 1013,                 // 断线重连后以恢复令牌挂回会话
+  ID_RESUME_RESPONSE = 1014,        // 恢复回包
+  ID_CHAT_SEND = 1015,              // 发送聊天消息
+  ID_CHAT_SEND_RESPONSE = 1016,     // 发送聊天消息回包
+  ID_CHAT_PUSH = 1017,              // 服务端推送的新消息
+};
+
+// 与 ChatServer 协商的消息体编码，登录请求与登录回包始终为 JSON
+enum class WireProtocol : std::uint8_t
+{
+  JSON = 1,      // JSON 文本
+  PROTOBUF = 2,  // proto/chat_message.proto
+};
+
+// 与 ChatServer 协商的消息体压缩算法，客户端只实现 zstd
+enum class Compression : std::uint8_t
+{
+  NONE = 0,  // 不压缩
+  LZ4 = 1,   // LZ4 frame
+  ZSTD = 2,  // zstd
+};
+
+// 一条聊天消息，与 proto/chat_message.proto 中的 ChatMsg 对应，seq 为会话内从 1 开始的序号
+struct ChatMsgData
+{
+  QString conversation_id;
+  quint64 seq = 0;
+  QString sender_uuid;
+  quint32 msg_type = 0;
+  QString content;
+  quint64 created_at = 0;  // 服务端分配的毫秒时间戳
 };
 
 enum class Module : std::uint8_t
@@ -311,11 +311,10 @@ void LoginDialog::slot_tcp_conn_finish(bool success)
     QJsonObject obj;
     obj["uuid"] = UserInfo::GetInstance().GetUUID();
     obj["token"] = _server_info.GetToken();
+    obj["protocol"] = static_cast<int>(WireProtocol::PROTOBUF);
+    obj["compression"] = static_cast<int>(Compression::ZSTD);
 
-    QJsonDocument doc{obj};
-    QString jsonStr = doc.toJson(QJsonDocument::Compact);
-
-    TcpManager::GetInstance().sig_send_data(ReqID::ID_LOGIN_CHAT, jsonStr);
+    TcpManager::GetInstance().sig_send_data(ReqID::ID_LOGIN_CHAT, obj);
   }
   else
   {
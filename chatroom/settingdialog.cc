@@ -1,6 +1,5 @@
 #include "settingdialog.hpp"
 
-#include <QJsonDocument>
 #include <QJsonObject>
 #include <QKeyEvent>
 #include <QShortcut>
@@ -31,8 +30,5 @@ void SettingDialog::on_exit_button_clicked()
   QJsonObject obj;
   obj["uuid"] = UserInfo::GetInstance().GetUUID();
 
-  QJsonDocument doc{obj};
-  QString jsonStr = doc.toJson(QJsonDocument::Compact);
-
-  TcpManager::GetInstance().sig_send_data(ReqID::ID_EXIT_LOGIN, jsonStr);
+  TcpManager::GetInstance().sig_send_data(ReqID::ID_EXIT_LOGIN, obj);
 }
@@ -1,26 +1,93 @@
 #include "tcpmanager.hpp"
 
+#include <chat_message.pb.h>
+#include <zstd.h>
+
 #include <QAbstractSocket>
 #include <QDebug>
+#include <QJsonArray>
 #include <QJsonDocument>
 #include <QJsonObject>
+#include <QRandomGenerator>
+#include <QTimer>
 #include <QtEndian>
+#include <algorithm>
+#include <array>
+#include <utility>
 
 #include "global.hpp"
 #include "userinfo.hpp"
 
+namespace
+{
+
+// 与 ChatServer 的帧格式保持一致
+constexpr qsizetype MSG_HEAD_LEN = 4;                       // id 2 字节 + 长度 2 字节
+constexpr qsizetype MSG_EXT_LEN_LEN = 4;                    // 大帧消息体长度字段
+constexpr quint16 MSG_EXT_LEN_MARKER = 0xFFFF;              // 长度字段取该值表示大帧
+constexpr qsizetype RECV_BUFFER_SIZE = 8192;                // 服务端普通帧消息体上限
+constexpr quint32 MAX_LARGE_FRAME_SIZE = 16 * 1024 * 1024;  // 大帧消息体上限 16MB
+constexpr quint16 MSG_COMPRESSED_FLAG = 0x8000;             // 消息 id 最高位表示消息体已压缩
+constexpr qsizetype MSG_RAW_LEN_LEN = 4;                    // 压缩消息体前的原始长度字段
+constexpr qsizetype COMPRESS_MIN_SIZE = 512;                // 消息体达到该长度才尝试压缩
+constexpr int COMPRESS_ZSTD_LEVEL = 3;                      // 与服务端一致的压缩级别
+constexpr int RESUME_MAX_ATTEMPTS = 5;                      // 重连次数上限，用尽后交给界面重新登录
+constexpr int RESUME_BASE_DELAY_MS = 500;                   // 第一次重连前的等待，之后每次翻倍
+constexpr int RESUME_JITTER_MS = 1000;                      // 每次等待附加的随机抖动上限
+constexpr qsizetype RESUME_MAX_CURSORS = 64;                // 与服务端一致，多出的游标会被忽略
+constexpr int HEARTBEAT_INTERVAL_MS = 30 * 1000;            // 与服务端 HEARTBEAT_INTERVAL_S 一致
+
+// JSON 中的 seq 与时间戳为数字，解析后是 double，毫秒时间戳与会话内序号都远小于 2^53
+quint64 json_uint64(const QJsonValue& value)
+{
+  return static_cast<quint64>(value.toDouble());
+}
+
+ChatMsgData from_proto(const KBchulan::ChatRoom::ChatMessage::ChatMsg& msg)
+{
+  return ChatMsgData{.conversation_id = QString::fromStdString(msg.conversation_id()),
+                     .seq = msg.seq(),
+                     .sender_uuid = QString::fromStdString(msg.sender_uuid()),
+                     .msg_type = msg.msg_type(),
+                     .content = QString::fromStdString(msg.content()),
+                     .created_at = msg.created_at()};
+}
+
+ChatMsgData from_json(const QJsonObject& obj)
+{
+  return ChatMsgData{.conversation_id = obj["conversation_id"].toString(),
+                     .seq = json_uint64(obj["seq"]),
+                     .sender_uuid = obj["sender_uuid"].toString(),
+                     .msg_type = static_cast<quint32>(obj["msg_type"].toInt()),
+                     .content = obj["content"].toString(),
+                     .created_at = json_uint64(obj["created_at"])};
+}
+
+}  // namespace
+
 TcpManager& TcpManager::GetInstance()
 {
   static TcpManager instance;
   return instance;
 }
 
-TcpManager::TcpManager() : _host(""), _port(0), _recv_pending(false), _message_id(0), _message_len(0)
+TcpManager::TcpManager()
+    : _host(""), _port(0), _recv_pending(false), _ext_len_pending(false), _message_id(0), _message_len(0),
+      _body_received(0), _protocol(WireProtocol::JSON), _compression(Compression::NONE), _closing(false),
+      _resuming(false), _resume_attempts(0)
 {
+  _heartbeat_timer.setInterval(HEARTBEAT_INTERVAL_MS);
+  connect(&_heartbeat_timer, &QTimer::timeout, this, &TcpManager::send_heartbeat);
+
   connect(&_socket, &QTcpSocket::connected, this,
           [this]() -> void
           {
             qDebug() << "Connected to server!";
+            if (_resuming)
+            {
+              send_resume();
+              return;
+            }
             emit sig_conn_finish(true);
           });
 
@@ -32,51 +99,123 @@ TcpManager::TcpManager() : _host(""), _port(0), _recv_pending(false), _message_i
             if (err == QTcpSocket::ConnectionRefusedError || err == QTcpSocket::HostNotFoundError ||
                 err == QTcpSocket::SocketTimeoutError)
             {
+              if (_resuming)
+              {
+                schedule_resume();
+                return;
+              }
               emit sig_conn_finish(false);
             }
           });
 
-  connect(&_socket, &QTcpSocket::disconnected, this, []() { qDebug() << "Disconnected from server."; });
+  connect(&_socket, &QTcpSocket::disconnected, this,
+          [this]()
+          {
+            qDebug() << "Disconnected from server.";
+            _heartbeat_timer.stop();
+            _protocol = WireProtocol::JSON;
+            _compression = Compression::NONE;
+
+            // 丢弃未收完的帧，重连后从新的消息头开始解析
+            _recv_pending = false;
+            _ext_len_pending = false;
+            _body.clear();
+            _body_received = 0;
+
+            // 登录之后的意外断线以恢复令牌重连，不再经过 GateWay
+            if (!std::exchange(_closing, false) && !_resume_token.isEmpty())
+            {
+              schedule_resume();
+            }
+          });
 
   connect(&_socket, &QTcpSocket::readyRead, this,
           [this]() -> void
           {
-            // 读取所有数据
-            _buffer.append(_socket.readAll());
-
             while (true)
             {
               // 1. 解析头部
               if (!_recv_pending)
               {
-                if (_buffer.size() < static_cast<qsizetype>(2 * sizeof(quint16)))
+                if (_socket.bytesAvailable() < MSG_HEAD_LEN)
                 {
                   return;
                 }
 
-                _message_id = qFromBigEndian<quint16>(_buffer.constData());
-                _message_len = qFromBigEndian<quint16>(_buffer.constData() + 2);
-                _buffer.remove(0, 4);
+                std::array<char, MSG_HEAD_LEN> head{};
+                _socket.read(head.data(), MSG_HEAD_LEN);
+                _message_id = qFromBigEndian<quint16>(head.data());
+                _message_len = qFromBigEndian<quint16>(head.data() + 2);
 
-                qDebug() << "Message ID:" << _message_id << ", Length:" << _message_len;
+                _recv_pending = true;
+                _ext_len_pending = (_message_len == MSG_EXT_LEN_MARKER);
+                if (!_ext_len_pending)
+                {
+                  _body.resize(static_cast<qsizetype>(_message_len));
+                  _body_received = 0;
+                }
               }
 
-              // 2. 检查消息体是否完整
-              if (_buffer.size() < _message_len)
+              // 2. 大帧在消息头之后还有 4 字节的消息体长度
+              if (_ext_len_pending)
+              {
+                if (_socket.bytesAvailable() < MSG_EXT_LEN_LEN)
+                {
+                  return;
+                }
+
+                std::array<char, MSG_EXT_LEN_LEN> ext_len{};
+                _socket.read(ext_len.data(), MSG_EXT_LEN_LEN);
+                _message_len = qFromBigEndian<quint32>(ext_len.data());
+                _ext_len_pending = false;
+
+                if (_message_len > MAX_LARGE_FRAME_SIZE)
+                {
+                  qDebug() << "Large frame too long:" << _message_len;
+                  _socket.abort();
+                  return;
+                }
+                _body.resize(static_cast<qsizetype>(_message_len));
+                _body_received = 0;
+              }
+
+              // 3. 消息体直接读入目标缓冲区，大帧跨多次 readyRead 逐段读完，不在中间缓冲区里累积
+              auto bytes = _socket.read(_body.data() + _body_received, _body.size() - _body_received);
+              if (bytes < 0)
+              {
+                return;
+              }
+              _body_received += bytes;
+              if (_body_received < _body.size())
               {
-                _recv_pending = true;
                 return;
               }
 
-              // 3. 直接提取消息体
               _recv_pending = false;
-              QByteArray body = _buffer.left(_message_len);
-              _buffer.remove(0, _message_len);
+              qDebug() << "Message ID:" << _message_id << ", Length:" << _message_len;
 
-              qDebug() << "Receive body:" << body;
+              QByteArray body = std::exchange(_body, QByteArray{});
+              if ((_message_id & MSG_COMPRESSED_FLAG) != 0)
+              {
+                _message_id = static_cast<quint16>(_message_id & ~MSG_COMPRESSED_FLAG);
+                body = decompress_body(body);
+                if (body.isEmpty())
+                {
+                  qDebug() << "Invalid compressed frame, id:" << _message_id;
+                  _socket.abort();
+                  return;
+                }
+              }
 
+              // 未注册的消息 id 跳过这一帧，不能调用空的回调
               auto reqID = static_cast<ReqID>(_message_id);
-              _handlers[reqID](reqID, _message_len, body);
+              auto handler = _handlers.constFind(reqID);
+              if (handler == _handlers.cend())
+              {
+                qDebug() << "No handler for message id:" << _message_id << ", len:" << body.size();
+                continue;
+              }
+              handler.value()(reqID, static_cast<int>(body.size()), body);
             }
           });
 
@@ -93,14 +232,88 @@ TcpManager::~TcpManager()
 
 void TcpManager::Disconnect()
 {
+  _resuming = false;
   if (_socket.state() == QAbstractSocket::UnconnectedState)
   {
     return;
   }
 
+  _closing = true;
   _socket.disconnectFromHost();
 }
 
+void TcpManager::schedule_resume()
+{
+  if (_resume_attempts >= RESUME_MAX_ATTEMPTS)
+  {
+    qDebug() << "Resume gave up after" << _resume_attempts << "attempts";
+    _resuming = false;
+    _resume_attempts = 0;
+    _resume_token.clear();
+    _last_seq.clear();
+    emit sig_resume_failed(static_cast<int>(ErrorCode::NETWORK_ERROR));
+    return;
+  }
+
+  _resuming = true;
+  auto delay = (RESUME_BASE_DELAY_MS << _resume_attempts) + QRandomGenerator::global()->bounded(RESUME_JITTER_MS);
+  ++_resume_attempts;
+  QTimer::singleShot(delay, this,
+                     [this]()
+                     {
+                       if (_resuming && _socket.state() == QAbstractSocket::UnconnectedState)
+                       {
+                         _socket.connectToHost(_host, _port);
+                       }
+                     });
+}
+
+// 携带各会话已收到的最大 seq，服务端在恢复回包的 missed 中补发断线期间错过的消息
+void TcpManager::send_resume()
+{
+  QJsonArray cursors;
+  for (auto iter = _last_seq.cbegin(); iter != _last_seq.cend() && cursors.size() < RESUME_MAX_CURSORS; ++iter)
+  {
+    QJsonObject cursor;
+    cursor["conversation_id"] = iter.key();
+    cursor["last_seq"] = static_cast<double>(iter.value());
+    cursors.append(cursor);
+  }
+
+  QJsonObject obj;
+  obj["token"] = _resume_token;
+  obj["protocol"] = static_cast<int>(WireProtocol::PROTOBUF);
+  obj["compression"] = static_cast<int>(Compression::ZSTD);
+  obj["cursors"] = cursors;
+  SlotSendData(ReqID::ID_RESUME, obj);
+}
+
+void TcpManager::update_cursor(const QString& conversation_id, quint64 seq)
+{
+  if (conversation_id.isEmpty() || seq == 0)
+  {
+    return;
+  }
+
+  auto& last_seq = _last_seq[conversation_id];
+  last_seq = std::max(last_seq, seq);
+}
+
+void TcpManager::send_heartbeat()
+{
+  if (_socket.state() != QAbstractSocket::ConnectedState)
+  {
+    return;
+  }
+
+  // 空消息体只有 4 字节消息头，不经过编码与压缩
+  auto rid = static_cast<quint16>(ReqID::ID_HEARTBEAT);
+  std::array<char, MSG_HEAD_LEN> head{};
+  qToBigEndian<quint16>(rid, head.data());
+  qToBigEndian<quint16>(0, head.data() + 2);
+  _socket.write(head.data(), MSG_HEAD_LEN);
+}
+
 void TcpManager::init_handlers()
 {
   _handlers.insert(ReqID::ID_LOGIN_CHAT_RESPONSE,
@@ -136,13 +349,29 @@ void TcpManager::init_handlers()
                        UserInfo::GetInstance().SetAvatar(data["avatar"].toString());
                        UserInfo::GetInstance().SetEmail(data["email"].toString());
                      }
+
+                     // 旧服务端不返回 protocol，继续使用 JSON
+                     if (jsonObj["protocol"].toInt() == static_cast<int>(WireProtocol::PROTOBUF))
+                     {
+                       _protocol = WireProtocol::PROTOBUF;
+                     }
+                     if (jsonObj["compression"].toInt() == static_cast<int>(Compression::ZSTD))
+                     {
+                       _compression = Compression::ZSTD;
+                     }
+
+                     // 旧服务端不签发令牌，断线后不自动恢复
+                     _resume_token = jsonObj["resume_token"].toString();
+                     _last_seq.clear();
+                     _resume_attempts = 0;
+                     _heartbeat_timer.start();
                      emit sig_switch_chat_dialog();
                    });
 
-  _handlers.insert(ReqID::ID_EXIT_LOGIN_RESPONSE,
+  _handlers.insert(ReqID::ID_RESUME_RESPONSE,
                    [this](ReqID rid, int len, const QByteArray& data) -> void
                    {
-                     // 解析数据
+                     // 恢复回包属于握手，总是 JSON
                      QJsonDocument jsonDoc = QJsonDocument::fromJson(data);
 
                      if (jsonDoc.isNull())
@@ -153,10 +382,85 @@ void TcpManager::init_handlers()
                      }
 
                      QJsonObject jsonObj = jsonDoc.object();
-
-                     // 解析响应数据并存下
                      auto code = jsonObj["code"].toInt();
-                     auto message = jsonObj["message"].toString();
+                     _resuming = false;
+                     _resume_attempts = 0;
+
+                     // 令牌过期或已在别处退出登录，需要重新走完整登录
+                     if (code != 0)
+                     {
+                       qDebug() << "resume failed, msg is: " << jsonObj["message"].toString() << '\n';
+                       _resume_token.clear();
+                       _last_seq.clear();
+                       emit sig_resume_failed(code);
+                       return;
+                     }
+
+                     _resume_token = jsonObj["resume_token"].toString();
+                     if (jsonObj["protocol"].toInt() == static_cast<int>(WireProtocol::PROTOBUF))
+                     {
+                       _protocol = WireProtocol::PROTOBUF;
+                     }
+                     if (jsonObj["compression"].toInt() == static_cast<int>(Compression::ZSTD))
+                     {
+                       _compression = Compression::ZSTD;
+                     }
+                     _heartbeat_timer.start();
+                     qDebug() << "Session resumed";
+
+                     // 补发的消息按 seq 降序，与历史消息回包相同；has_more 时由界面继续以 ID_LOAD_HISTORY 拉取
+                     const QJsonArray missed = jsonObj["missed"].toArray();
+                     for (const auto& item : missed)
+                     {
+                       const QJsonObject conversation = item.toObject();
+                       auto conversation_id = conversation["conversation_id"].toString();
+                       const QJsonArray array = conversation["messages"].toArray();
+                       QVector<ChatMsgData> messages;
+                       messages.reserve(array.size());
+                       for (const auto& msg : array)
+                       {
+                         messages.push_back(from_json(msg.toObject()));
+                         update_cursor(conversation_id, messages.back().seq);
+                       }
+                       emit sig_history_loaded(code, conversation_id, messages, conversation["has_more"].toBool());
+                     }
+                   });
+
+  _handlers.insert(ReqID::ID_EXIT_LOGIN_RESPONSE,
+                   [this](ReqID rid, int len, const QByteArray& data) -> void
+                   {
+                     int code = 0;
+                     QString message;
+
+                     if (_protocol == WireProtocol::PROTOBUF)
+                     {
+                       KBchulan::ChatRoom::ChatMessage::ExitLoginResponse response;
+                       if (!response.ParseFromArray(data.constData(), static_cast<int>(data.size())))
+                       {
+                         qDebug() << "Receive from id: " << static_cast<int>(rid) << ", len: " << len
+                                  << ", data: " << data.toHex() << '\n';
+                         return;
+                       }
+
+                       code = response.code();
+                       message = QString::fromStdString(response.message());
+                     }
+                     else
+                     {
+                       // 解析数据
+                       QJsonDocument jsonDoc = QJsonDocument::fromJson(data);
+
+                       if (jsonDoc.isNull())
+                       {
+                         qDebug() << "Receive from id: " << static_cast<int>(rid) << ", len: " << len
+                                  << ", data: " << data << '\n';
+                         return;
+                       }
+
+                       QJsonObject jsonObj = jsonDoc.object();
+                       code = jsonObj["code"].toInt();
+                       message = jsonObj["message"].toString();
+                     }
 
                      if (code != 0)
                      {
@@ -165,8 +469,260 @@ void TcpManager::init_handlers()
                        return;
                      }
 
+                     _resume_token.clear();
+                     _last_seq.clear();
+                     _heartbeat_timer.stop();
                      emit sig_exit_login_success();
                    });
+
+  // 回包只用于让服务端看到连接仍在收发，客户端无需处理
+  _handlers.insert(ReqID::ID_HEARTBEAT_RESPONSE, [](ReqID, int, const QByteArray&) -> void {});
+
+  _handlers.insert(ReqID::ID_CHAT_PUSH,
+                   [this](ReqID rid, int len, const QByteArray& data) -> void
+                   {
+                     ChatMsgData msg;
+
+                     if (_protocol == WireProtocol::PROTOBUF)
+                     {
+                       KBchulan::ChatRoom::ChatMessage::ChatMsg push;
+                       if (!push.ParseFromArray(data.constData(), static_cast<int>(data.size())))
+                       {
+                         qDebug() << "Receive from id: " << static_cast<int>(rid) << ", len: " << len
+                                  << ", data: " << data.toHex() << '\n';
+                         return;
+                       }
+                       msg = from_proto(push);
+                     }
+                     else
+                     {
+                       QJsonDocument jsonDoc = QJsonDocument::fromJson(data);
+
+                       if (jsonDoc.isNull())
+                       {
+                         qDebug() << "Receive from id: " << static_cast<int>(rid) << ", len: " << len
+                                  << ", data: " << data << '\n';
+                         return;
+                       }
+                       msg = from_json(jsonDoc.object());
+                     }
+
+                     update_cursor(msg.conversation_id, msg.seq);
+                     emit sig_chat_push(msg);
+                   });
+
+  _handlers.insert(ReqID::ID_CHAT_SEND_RESPONSE,
+                   [this](ReqID rid, int len, const QByteArray& data) -> void
+                   {
+                     int code = 0;
+                     QString message;
+                     QString client_msg_id;
+                     QString conversation_id;
+                     quint64 seq = 0;
+                     quint64 created_at = 0;
+
+                     if (_protocol == WireProtocol::PROTOBUF)
+                     {
+                       KBchulan::ChatRoom::ChatMessage::ChatSendResponse response;
+                       if (!response.ParseFromArray(data.constData(), static_cast<int>(data.size())))
+                       {
+                         qDebug() << "Receive from id: " << static_cast<int>(rid) << ", len: " << len
+                                  << ", data: " << data.toHex() << '\n';
+                         return;
+                       }
+
+                       code = response.code();
+                       message = QString::fromStdString(response.message());
+                       client_msg_id = QString::fromStdString(response.client_msg_id());
+                       conversation_id = QString::fromStdString(response.conversation_id());
+                       seq = response.seq();
+                       created_at = response.created_at();
+                     }
+                     else
+                     {
+                       QJsonDocument jsonDoc = QJsonDocument::fromJson(data);
+
+                       if (jsonDoc.isNull())
+                       {
+                         qDebug() << "Receive from id: " << static_cast<int>(rid) << ", len: " << len
+                                  << ", data: " << data << '\n';
+                         return;
+                       }
+
+                       QJsonObject jsonObj = jsonDoc.object();
+                       code = jsonObj["code"].toInt();
+                       message = jsonObj["message"].toString();
+                       client_msg_id = jsonObj["client_msg_id"].toString();
+                       conversation_id = jsonObj["conversation_id"].toString();
+                       seq = json_uint64(jsonObj["seq"]);
+                       created_at = json_uint64(jsonObj["created_at"]);
+                     }
+
+                     // 失败时 seq 与 created_at 为 0，界面按 client_msg_id 把本地消息标记为发送失败
+                     if (code != 0)
+                     {
+                       qDebug() << "chat send failed, msg is: " << message << '\n';
+                     }
+                     else
+                     {
+                       update_cursor(conversation_id, seq);
+                     }
+                     emit sig_chat_send_response(code, client_msg_id, conversation_id, seq, created_at);
+                   });
+
+  _handlers.insert(ReqID::ID_LOAD_HISTORY_RESPONSE,
+                   [this](ReqID rid, int len, const QByteArray& data) -> void
+                   {
+                     int code = 0;
+                     QString message;
+                     QString conversation_id;
+                     QVector<ChatMsgData> messages;
+                     bool has_more = false;
+
+                     if (_protocol == WireProtocol::PROTOBUF)
+                     {
+                       KBchulan::ChatRoom::ChatMessage::LoadHistoryResponse response;
+                       if (!response.ParseFromArray(data.constData(), static_cast<int>(data.size())))
+                       {
+                         qDebug() << "Receive from id: " << static_cast<int>(rid) << ", len: " << len
+                                  << ", data: " << data.toHex() << '\n';
+                         return;
+                       }
+
+                       code = response.code();
+                       message = QString::fromStdString(response.message());
+                       conversation_id = QString::fromStdString(response.conversation_id());
+                       messages.reserve(response.messages_size());
+                       for (const auto& msg : response.messages())
+                       {
+                         messages.push_back(from_proto(msg));
+                       }
+                       has_more = response.has_more();
+                     }
+                     else
+                     {
+                       QJsonDocument jsonDoc = QJsonDocument::fromJson(data);
+
+                       if (jsonDoc.isNull())
+                       {
+                         qDebug() << "Receive from id: " << static_cast<int>(rid) << ", len: " << len
+                                  << ", data: " << data << '\n';
+                         return;
+                       }
+
+                       QJsonObject jsonObj = jsonDoc.object();
+                       code = jsonObj["code"].toInt();
+                       message = jsonObj["message"].toString();
+                       conversation_id = jsonObj["conversation_id"].toString();
+                       const QJsonArray array = jsonObj["messages"].toArray();
+                       messages.reserve(array.size());
+                       for (const auto& item : array)
+                       {
+                         messages.push_back(from_json(item.toObject()));
+                       }
+                       has_more = jsonObj["has_more"].toBool();
+                     }
+
+                     if (code != 0)
+                     {
+                       qDebug() << "load history failed, msg is: " << message << '\n';
+                     }
+                     for (const auto& msg : messages)
+                     {
+                       update_cursor(conversation_id, msg.seq);
+                     }
+                     emit sig_history_loaded(code, conversation_id, messages, has_more);
+                   });
+}
+
+QByteArray TcpManager::encode_body(ReqID reqId, const QJsonObject& data) const
+{
+  if (_protocol == WireProtocol::JSON || reqId == ReqID::ID_LOGIN_CHAT || reqId == ReqID::ID_RESUME)
+  {
+    return QJsonDocument{data}.toJson(QJsonDocument::Compact);
+  }
+
+  std::string bytes;
+  switch (reqId)
+  {
+    case ReqID::ID_EXIT_LOGIN:
+    {
+      KBchulan::ChatRoom::ChatMessage::ExitLoginRequest request;
+      request.set_uuid(data["uuid"].toString().toStdString());
+      bytes = request.SerializeAsString();
+      break;
+    }
+    case ReqID::ID_CHAT_SEND:
+    {
+      KBchulan::ChatRoom::ChatMessage::ChatSendRequest request;
+      request.set_conversation_id(data["conversation_id"].toString().toStdString());
+      request.set_msg_type(static_cast<std::uint32_t>(data["msg_type"].toInt()));
+      request.set_content(data["content"].toString().toStdString());
+      request.set_client_msg_id(data["client_msg_id"].toString().toStdString());
+      bytes = request.SerializeAsString();
+      break;
+    }
+    case ReqID::ID_LOAD_HISTORY:
+    {
+      KBchulan::ChatRoom::ChatMessage::LoadHistoryRequest request;
+      request.set_conversation_id(data["conversation_id"].toString().toStdString());
+      request.set_before_seq(json_uint64(data["before_seq"]));
+      request.set_limit(static_cast<std::uint32_t>(data["limit"].toInt()));
+      bytes = request.SerializeAsString();
+      break;
+    }
+    default:
+      // 服务端会按 protobuf 解析，退回 JSON 只会得到解析错误
+      qDebug() << "No protobuf body for request id: " << static_cast<int>(reqId);
+      return {};
+  }
+  return {bytes.data(), static_cast<qsizetype>(bytes.size())};
+}
+
+QByteArray TcpManager::compress_body(const QByteArray& body) const
+{
+  if (_compression != Compression::ZSTD || body.size() < COMPRESS_MIN_SIZE)
+  {
+    return {};
+  }
+
+  QByteArray packed(MSG_RAW_LEN_LEN + static_cast<qsizetype>(ZSTD_compressBound(static_cast<size_t>(body.size()))),
+                    Qt::Uninitialized);
+  auto size = ZSTD_compress(packed.data() + MSG_RAW_LEN_LEN, static_cast<size_t>(packed.size() - MSG_RAW_LEN_LEN),
+                            body.constData(), static_cast<size_t>(body.size()), COMPRESS_ZSTD_LEVEL);
+
+  // 压缩失败或没有变小时发送原文
+  if (ZSTD_isError(size) != 0U || MSG_RAW_LEN_LEN + static_cast<qsizetype>(size) >= body.size())
+  {
+    return {};
+  }
+
+  qToBigEndian<quint32>(static_cast<quint32>(body.size()), packed.data());
+  packed.resize(MSG_RAW_LEN_LEN + static_cast<qsizetype>(size));
+  return packed;
+}
+
+QByteArray TcpManager::decompress_body(const QByteArray& body) const
+{
+  if (_compression != Compression::ZSTD || body.size() <= MSG_RAW_LEN_LEN)
+  {
+    return {};
+  }
+
+  auto raw_len = qFromBigEndian<quint32>(body.constData());
+  if (raw_len == 0 || raw_len > MAX_LARGE_FRAME_SIZE)
+  {
+    return {};
+  }
+
+  QByteArray raw(static_cast<qsizetype>(raw_len), Qt::Uninitialized);
+  auto size = ZSTD_decompress(raw.data(), raw_len, body.constData() + MSG_RAW_LEN_LEN,
+                              static_cast<size_t>(body.size() - MSG_RAW_LEN_LEN));
+  if (ZSTD_isError(size) != 0U || size != raw_len)
+  {
+    return {};
+  }
+  return raw;
 }
 
 void TcpManager::SlotTcpConnect(const ServerInfo& sif)
@@ -176,21 +732,47 @@ void TcpManager::SlotTcpConnect(const ServerInfo& sif)
   _socket.connectToHost(_host, _port);
 }
 
-void TcpManager::SlotSendData(ReqID reqId, const QString& data)
+void TcpManager::SlotSendData(ReqID reqId, const QJsonObject& data)
 {
   auto rid = static_cast<quint16>(reqId);
-  QByteArray body = data.toUtf8();
-  auto len = static_cast<quint16>(body.size());
+  QByteArray body = encode_body(reqId, data);
+  if (body.isEmpty())
+  {
+    return;
+  }
+
+  // 协商了压缩且压缩后更小时置位压缩标记
+  if (QByteArray packed = compress_body(body); !packed.isEmpty())
+  {
+    rid = static_cast<quint16>(rid | MSG_COMPRESSED_FLAG);
+    body = std::move(packed);
+  }
+
+  // 超过服务端普通帧上限的消息体使用大帧，长度字段写标记值，其后跟 4 字节长度
+  bool large = body.size() > RECV_BUFFER_SIZE;
+  auto len = large ? MSG_EXT_LEN_MARKER : static_cast<quint16>(body.size());
 
   QByteArray packet;
-  packet.reserve(4 + body.size());
+  packet.reserve(MSG_HEAD_LEN + MSG_EXT_LEN_LEN + body.size());
 
   // 写入大端序数据
   packet.append(static_cast<char>(rid >> 8));
   packet.append(static_cast<char>(rid & 0xFF));
   packet.append(static_cast<char>(len >> 8));
   packet.append(static_cast<char>(len & 0xFF));
+  if (large)
+  {
+    std::array<char, MSG_EXT_LEN_LEN> ext_len{};
+    qToBigEndian<quint32>(static_cast<quint32>(body.size()), ext_len.data());
+    packet.append(ext_len.data(), MSG_EXT_LEN_LEN);
+  }
   packet.append(body);
 
   _socket.write(packet);
+
+  // 刚发送过数据，空闲计时从现在重新开始
+  if (_heartbeat_timer.isActive())
+  {
+    _heartbeat_timer.start();
+  }
 }
@@ -12,10 +12,13 @@
 #define TCPMANAGER_HPP
 
 #include <QByteArray>
+#include <QJsonObject>
 #include <QMap>
 #include <QObject>
 #include <QString>
 #include <QTcpSocket>
+#include <QTimer>
+#include <QVector>
 #include <cstdint>
 #include <functional>
 
@@ -38,30 +41,74 @@ private:
 
   void init_handlers();
 
+  // 按当前编码序列化消息体，逻辑登录与恢复请求属于握手，总是 JSON
+  [[nodiscard]] QByteArray encode_body(ReqID reqId, const QJsonObject& data) const;
+
+  // 压缩帧的消息体为 4 字节原始长度加 zstd frame，失败时返回空
+  [[nodiscard]] QByteArray compress_body(const QByteArray& body) const;
+  [[nodiscard]] QByteArray decompress_body(const QByteArray& body) const;
+
+  // 意外断线后按指数退避加随机抖动重连，避免同一时刻断线的客户端一起涌向服务器
+  void schedule_resume();
+  void send_resume();
+
+  // 记录会话中收到的最大 seq，恢复请求据此携带游标
+  void update_cursor(const QString& conversation_id, quint64 seq);
+
+  // 登录后空闲时定期发送空消息体的心跳，服务端连续 90s 收不到任何帧会关闭连接
+  void send_heartbeat();
+
   QTcpSocket _socket;
   QString _host;
   std::uint16_t _port;
 
   bool _recv_pending;
+  bool _ext_len_pending;
 
-  // TLV 格式
+  // TLV 格式，大帧的长度为 32 位
   quint16 _message_id;
-  quint16 _message_len;
-  QByteArray _buffer;
+  quint32 _message_len;
+
+  // 正在接收的消息体，按长度一次分配，数据到达后直接读入
+  QByteArray _body;
+  qsizetype _body_received;
+
+  // 登录回包确认后切换，断开连接后恢复为 JSON
+  WireProtocol _protocol;
+  Compression _compression;
+
+  // 登录回包中的恢复令牌，恢复成功后换成新令牌，退出登录或恢复被拒绝后清空
+  QString _resume_token;
+  bool _closing;         // 主动断开，不触发恢复
+  bool _resuming;        // 重连中，连接建立后发送恢复请求而不是通知登录界面
+  int _resume_attempts;  // 本次断线已重连的次数
+
+  // 各会话已收到的最大 seq，来自推送、发送回包、历史消息与恢复补发的消息，与恢复令牌一起清空
+  QMap<QString, quint64> _last_seq;
+
+  // 登录或恢复成功后启动，断开连接时停止；每次发送数据都会重新计时
+  QTimer _heartbeat_timer;
 
   QMap<ReqID, std::function<void(ReqID rid, int len, const QByteArray& data)>> _handlers;
 
 public slots:
   void SlotTcpConnect(const ServerInfo&);
-  void SlotSendData(ReqID reqId, const QString& data);
+  void SlotSendData(ReqID reqId, const QJsonObject& data);
 
 signals:
   void sig_conn_finish(bool success);
-  void sig_send_data(ReqID reqId, QString data);
+  void sig_send_data(ReqID reqId, QJsonObject data);
   void sig_switch_chat_dialog();
   void sig_login_failed(int);
   void sig_exit_login_success();
   void sig_exit_login_failed(int);
+  void sig_resume_failed(int);
+
+  // 收到的聊天消息、发送回包与历史消息，按当前协商的编码解码后分发
+  void sig_chat_push(ChatMsgData msg);
+  void sig_chat_send_response(int code, QString client_msg_id, QString conversation_id, quint64 seq,
+                              quint64 created_at);
+  void sig_history_loaded(int code, QString conversation_id, QVector<ChatMsgData> messages, bool has_more);
 };
 
 #endif  // TCPMANAGER_HPP
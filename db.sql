@@ -28,4 +28,17 @@ CREATE TABLE IF NOT EXISTS `users` (
   `updated_at` DATETIME NOT NULL DEFAULT CURRENT_TIMESTAMP ON UPDATE CURRENT_TIMESTAMP COMMENT '信息更新时间, 如修改密码等',
 
   PRIMARY KEY (`id`)
-) ENGINE=InnoDB DEFAULT CHARSET=utf8mb4 COLLATE=utf8mb4_unicode_ci;
\ No newline at end of file
+) ENGINE=InnoDB DEFAULT CHARSET=utf8mb4 COLLATE=utf8mb4_unicode_ci;
+
+-- 聊天消息表，(conversation_id, seq) 为聚簇主键，同一会话的消息按序号连续存放，历史消息按键集分页顺序读取
+CREATE TABLE IF NOT EXISTS `messages` (
+  `conversation_id` VARCHAR(80) NOT NULL COMMENT '会话id, 单聊为双方uuid拼接, 群聊为群id',
+  `seq` BIGINT UNSIGNED NOT NULL COMMENT '会话内单调递增的消息序号',
+  `sender_uuid` CHAR(36) NOT NULL COMMENT '发送方uuid',
+  `msg_type` TINYINT UNSIGNED NOT NULL COMMENT '1=text, 2=image, 3=file, 消息类型',
+  `content` MEDIUMTEXT NOT NULL COMMENT '消息内容',
+  `created_at` BIGINT UNSIGNED NOT NULL COMMENT '服务端接收时的毫秒时间戳',
+
+  PRIMARY KEY (`conversation_id`, `seq`),
+  INDEX `idx_sender_created_at` (`sender_uuid`, `created_at`)
+) ENGINE=InnoDB DEFAULT CHARSET=utf8mb4 COLLATE=utf8mb4_unicode_ci;
@@ -0,0 +1,276 @@
+/******************************************************************************
+ *
+ * @file       bench_compression.cc
+ * @brief      消息体压缩基准测试
+ *
+ * @author     KBchulan
+ * @date       2026/10/18
+ * @history    单条消息、联系人列表、历史同步三类消息体在各压缩方式下每 MB 的 CPU 耗时与节省的字节
+ ******************************************************************************/
+
+#include <benchmark/benchmark.h>
+#include <zdict.h>
+
+#include <array>
+#include <core/msg-node/frame-compressor.hpp>
+#include <core/msg-node/msg-node.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <global/Global.hpp>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace
+{
+
+constexpr std::size_t DICT_SAMPLE_COUNT = 4000;      // 训练字典使用的样本数
+constexpr std::size_t DICT_CAPACITY = 16 * 1024;     // 字典大小上限 16KB
+constexpr std::size_t CONTACT_COUNT = 24;            // 联系人列表样本的条目数，约 3.6KB
+constexpr std::size_t HISTORY_MESSAGE_COUNT = 1000;  // 历史同步样本的消息条数，约 130KB，解压结果跨多个分块
+constexpr double BYTES_PER_MB = 1024.0 * 1024.0;
+
+constexpr std::array<const char*, 16> WORDS = {"好的",   "明天见",      "收到",          "哈哈哈",
+                                               "在吗",   "稍等一下",    "晚上一起吃饭吗", "文件我发你邮箱了",
+                                               "ok",     "sounds good", "see you later", "on my way",
+                                               "thanks", "lol",         "meeting at 3pm", "伙伴们早上好"};
+
+// 与线上单聊消息结构一致的 JSON，内容由随机短语拼成
+std::string chat_message(std::mt19937& rng, std::uint64_t msg_id)
+{
+  std::uniform_int_distribution<std::size_t> word(0, WORDS.size() - 1);
+  std::uniform_int_distribution<std::uint32_t> uid(100000, 999999);
+  std::uniform_int_distribution<std::size_t> length(1, 4);
+
+  std::string content;
+  for (auto i = length(rng); i > 0; --i)
+  {
+    content += WORDS[word(rng)];
+    content += ' ';
+  }
+
+  return R"({"msg_id":)" + std::to_string(msg_id) + R"(,"from_uid":)" + std::to_string(uid(rng)) + R"(,"to_uid":)" +
+         std::to_string(uid(rng)) + R"(,"type":"text","content":")" + content + R"(","timestamp":)" +
+         std::to_string(1760745600000ULL + msg_id * 1375) + "}";
+}
+
+std::string contact(std::mt19937& rng)
+{
+  std::uniform_int_distribution<std::uint32_t> uid(100000, 999999);
+  std::uniform_int_distribution<int> online(0, 1);
+  auto id = std::to_string(uid(rng));
+
+  return R"({"uid":)" + id + R"(,"nickname":"user_)" + id +
+         R"(","avatar":"https://static.chatroom.example/avatar/)" + id + R"(.png","email":"user_)" + id +
+         R"(@example.com","online":)" + (online(rng) != 0 ? "true" : "false") + "}";
+}
+
+std::string json_array(const std::vector<std::string>& items)
+{
+  std::string body = R"({"code":0,"message":"ok","data":[)";
+  for (std::size_t i = 0; i < items.size(); ++i)
+  {
+    body += (i == 0 ? "" : ",") + items[i];
+  }
+  return body + "]}";
+}
+
+// 参数 0 为单条消息，1 为联系人列表，2 为历史同步，与字典训练样本使用不同的随机种子
+std::string payload(std::int64_t kind)
+{
+  std::mt19937 rng(42);
+  std::vector<std::string> items;
+
+  switch (kind)
+  {
+    case 0:
+      return chat_message(rng, 1);
+    case 1:
+      for (std::size_t i = 0; i < CONTACT_COUNT; ++i)
+      {
+        items.push_back(contact(rng));
+      }
+      return json_array(items);
+    default:
+      for (std::size_t i = 0; i < HISTORY_MESSAGE_COUNT; ++i)
+      {
+        items.push_back(chat_message(rng, i));
+      }
+      return json_array(items);
+  }
+}
+
+// 用单条消息与联系人条目训练字典并加载，进程内只做一次
+void ensure_dictionary()
+{
+  static bool loaded = []
+  {
+    std::mt19937 rng(7);
+    std::string samples;
+    std::vector<std::size_t> sizes;
+    for (std::size_t i = 0; i < DICT_SAMPLE_COUNT; ++i)
+    {
+      auto sample = (i % 2 == 0) ? chat_message(rng, i) : contact(rng);
+      samples += sample;
+      sizes.push_back(sample.size());
+    }
+
+    std::vector<char> dict(DICT_CAPACITY);
+    auto size = ZDICT_trainFromBuffer(dict.data(), dict.size(), samples.data(), sizes.data(),
+                                      static_cast<unsigned>(sizes.size()));
+    if (ZDICT_isError(size) != 0U)
+    {
+      return false;
+    }
+
+    auto path = std::filesystem::temp_directory_path() / "bench_compression.zdict";
+    std::ofstream(path, std::ios::binary).write(dict.data(), static_cast<std::streamsize>(size));
+    return core::FrameCompressor::GetInstance().LoadDictionary(path.string());
+  }();
+  benchmark::DoNotOptimize(loaded);
+}
+
+// 参数 0 为不压缩，1 为 LZ4，2 为 zstd，3 为 zstd 加字典
+core::CompressionMode compression_mode(std::int64_t mode)
+{
+  switch (mode)
+  {
+    case 1:
+      return {.algorithm = utils::Compression::LZ4, .use_dict = false};
+    case 2:
+      return {.algorithm = utils::Compression::ZSTD, .use_dict = false};
+    case 3:
+      ensure_dictionary();
+      return {.algorithm = utils::Compression::ZSTD, .use_dict = true};
+    default:
+      return {};
+  }
+}
+
+// 帧在线上的消息体字节数，不含消息头
+std::size_t wire_body_size(const core::SendNode& node)
+{
+  if (node.IsChunked())
+  {
+    std::size_t size = 0;
+    for (auto chunk : node.GetChunks())
+    {
+      size += chunk.size();
+    }
+    return size;
+  }
+  return node.GetData().size() - global::server::MSG_HEAD_TOTAL_LEN;
+}
+
+// 按接收端的方式把发送帧还原为 RecvNode，大帧分块存放
+std::shared_ptr<core::RecvNode> to_recv_node(const core::SendNode& node)
+{
+  auto msg_id = static_cast<short>(static_cast<std::uint16_t>(node.GetMsgId()) &
+                                   static_cast<std::uint16_t>(~global::server::MSG_COMPRESSED_FLAG));
+  if (!node.IsChunked())
+  {
+    return core::RecvNode::Create(msg_id, node.GetData().subspan(global::server::MSG_HEAD_TOTAL_LEN));
+  }
+
+  auto recv_node = core::RecvNode::CreateChunked(msg_id, wire_body_size(node));
+  auto src = node.GetChunks();
+  auto dst = recv_node->GetChunks();
+  for (std::size_t i = 0; i < src.size(); ++i)
+  {
+    std::memcpy(dst[i].data(), src[i].data(), src[i].size());
+  }
+  return recv_node;
+}
+
+std::string flatten(const std::shared_ptr<core::RecvNode>& node)
+{
+  if (!node)
+  {
+    return {};
+  }
+  if (!node->IsChunked())
+  {
+    return {node->GetData().data(), node->GetData().size()};
+  }
+
+  std::string body;
+  for (auto chunk : node->GetChunks())
+  {
+    body.append(chunk.data(), chunk.size());
+  }
+  return body;
+}
+
+void report(benchmark::State& state, std::size_t raw_bytes, std::size_t wire_bytes)
+{
+  auto megabytes = static_cast<double>(raw_bytes) / BYTES_PER_MB;
+  state.counters["raw_bytes"] = static_cast<double>(raw_bytes);
+  state.counters["wire_bytes"] = static_cast<double>(wire_bytes);
+  state.counters["saved_pct"] = 100.0 * (1.0 - static_cast<double>(wire_bytes) / static_cast<double>(raw_bytes));
+  state.counters["cpu_s_per_MB"] =
+      benchmark::Counter(megabytes, benchmark::Counter::kIsIterationInvariantRate | benchmark::Counter::kInvert);
+  state.SetBytesProcessed(static_cast<std::int64_t>(state.iterations() * raw_bytes));
+}
+
+}  // namespace
+
+// 测试1: 发送端组帧，包含压缩与拷入 SendNode，参数为 {消息体类型, 压缩方式}
+static void BM_Compression_Send(benchmark::State& state)
+{
+  auto body = payload(state.range(0));
+  auto mode = compression_mode(state.range(1));
+  auto& compressor = core::FrameCompressor::GetInstance();
+
+  std::size_t wire_bytes = 0;
+  for (auto _ : state)
+  {
+    auto node = compressor.MakeSendNode(1, body, mode);
+    wire_bytes = wire_body_size(*node);
+    benchmark::DoNotOptimize(node);
+  }
+
+  report(state, body.size(), wire_bytes);
+}
+BENCHMARK(BM_Compression_Send)->ArgsProduct({{0, 1, 2}, {0, 1, 2, 3}});
+
+// 测试2: 接收端把压缩帧解压为新的 RecvNode，未压缩的帧不计入
+static void BM_Compression_Recv(benchmark::State& state)
+{
+  auto body = payload(state.range(0));
+  auto mode = compression_mode(state.range(1));
+  auto& compressor = core::FrameCompressor::GetInstance();
+
+  auto send_node = compressor.MakeSendNode(1, body, mode);
+  if ((static_cast<std::uint16_t>(send_node->GetMsgId()) & global::server::MSG_COMPRESSED_FLAG) == 0)
+  {
+    state.SkipWithError("body below compression threshold");
+    return;
+  }
+  auto recv_node = to_recv_node(*send_node);
+  if (flatten(compressor.Decompress(*recv_node, mode)) != body)
+  {
+    state.SkipWithError("decompressed body mismatch");
+    return;
+  }
+
+  std::size_t failed = 0;
+  for (auto _ : state)
+  {
+    auto node = compressor.Decompress(*recv_node, mode);
+    if (!node || node->GetBodySize() != body.size())
+    {
+      ++failed;
+    }
+    benchmark::DoNotOptimize(node);
+  }
+
+  report(state, body.size(), wire_body_size(*send_node));
+  state.counters["failed"] = static_cast<double>(failed);
+}
+BENCHMARK(BM_Compression_Recv)->ArgsProduct({{0, 1, 2}, {1, 2, 3}});
+
+BENCHMARK_MAIN();
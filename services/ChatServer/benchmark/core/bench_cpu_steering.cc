@@ -0,0 +1,242 @@
+/******************************************************************************
+ *
+ * @file       bench_cpu_steering.cc
+ * @brief      io 线程绑核与 reuseport 按收包 CPU 分发基准测试
+ *
+ * @author     KBchulan
+ * @date       2026/10/18
+ * @history    回环压测一组 SO_REUSEPORT 回显 acceptor，对比不绑核的哈希分发与绑核加 CBPF 分发的请求往返延迟，
+ *             并统计读完成时 io 线程所在核与连接收包核一致的比例
+ ******************************************************************************/
+
+#include <benchmark/benchmark.h>
+#include <sched.h>
+#include <sys/socket.h>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <boost/asio/awaitable.hpp>
+#include <boost/asio/buffer.hpp>
+#include <boost/asio/co_spawn.hpp>
+#include <boost/asio/detached.hpp>
+#include <boost/asio/executor_work_guard.hpp>
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/asio/read.hpp>
+#include <boost/asio/use_awaitable.hpp>
+#include <boost/asio/write.hpp>
+#include <chrono>
+#include <core/io/cpu_affinity.hpp>
+#include <cstdint>
+#include <global/Global.hpp>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace
+{
+
+constexpr std::size_t REQUEST_SIZE = 64;   // 一条聊天消息帧的典型长度
+constexpr std::size_t CLIENT_THREADS = 4;  // 压测线程数
+constexpr std::size_t CONNECTIONS = 64;    // 连接总数，平均分给压测线程
+constexpr std::size_t ROUNDS = 50;         // 每次迭代每条连接的请求数
+
+// 统计读完成时所在核与连接收包核是否一致
+struct Locality
+{
+  std::atomic<std::uint64_t> _same_cpu{0};
+  std::atomic<std::uint64_t> _reads{0};
+};
+
+boost::asio::awaitable<void> echo(boost::asio::ip::tcp::socket socket, Locality& locality)
+{
+  std::array<char, REQUEST_SIZE> buffer{};
+  try
+  {
+    for (;;)
+    {
+      co_await boost::asio::async_read(socket, boost::asio::buffer(buffer), boost::asio::use_awaitable);
+
+      int incoming = -1;
+      socklen_t len = sizeof(incoming);
+      getsockopt(socket.native_handle(), SOL_SOCKET, SO_INCOMING_CPU, &incoming, &len);
+      if (incoming == sched_getcpu())
+      {
+        locality._same_cpu.fetch_add(1, std::memory_order_relaxed);
+      }
+      locality._reads.fetch_add(1, std::memory_order_relaxed);
+
+      co_await boost::asio::async_write(socket, boost::asio::buffer(buffer), boost::asio::use_awaitable);
+    }
+  }
+  catch (const boost::system::system_error&)
+  {
+    // 客户端断开
+  }
+}
+
+boost::asio::awaitable<void> accept_loop(boost::asio::ip::tcp::acceptor& acceptor, Locality& locality)
+{
+  for (;;)
+  {
+    auto socket = co_await acceptor.async_accept(boost::asio::use_awaitable);
+    socket.set_option(boost::asio::ip::tcp::no_delay(true));
+    boost::asio::co_spawn(acceptor.get_executor(), echo(std::move(socket), locality), boost::asio::detached);
+  }
+}
+
+// 与 Server 相同的结构：每个 io 线程一个 io_context 与一个 reuseport acceptor，steered 时按 IO 池的方式绑核并挂载程序
+struct EchoGroup
+{
+  std::vector<std::unique_ptr<boost::asio::io_context>> _io_contexts;
+  std::vector<std::unique_ptr<boost::asio::ip::tcp::acceptor>> _acceptors;
+  std::vector<std::jthread> _threads;
+  Locality _locality;
+  unsigned short _port = 0;
+  bool _attached = false;
+
+  EchoGroup(std::size_t count, bool steered)
+  {
+    auto available = core::CpuAffinity::AvailableCpus();
+    std::vector<int> cpus(count, -1);
+    for (std::size_t i = 0; steered && !available.empty() && i < count; ++i)
+    {
+      cpus[i] = available[i % available.size()];
+    }
+
+    for (std::size_t i = 0; i < count; ++i)
+    {
+      auto& ioc = *_io_contexts.emplace_back(std::make_unique<boost::asio::io_context>());
+      auto& acceptor = *_acceptors.emplace_back(std::make_unique<boost::asio::ip::tcp::acceptor>(ioc));
+
+      acceptor.open(boost::asio::ip::tcp::v4());
+      int reuse_port = 1;
+      setsockopt(acceptor.native_handle(), SOL_SOCKET, SO_REUSEPORT, &reuse_port, sizeof(reuse_port));
+      if (cpus[i] >= 0)
+      {
+        core::CpuAffinity::SetIncomingCpu(acceptor.native_handle(), cpus[i]);
+      }
+
+      // 第一个 acceptor 取临时端口，其余绑定到同一端口组成 reuseport 组
+      acceptor.bind({boost::asio::ip::make_address("127.0.0.1"), _port});
+      acceptor.listen(boost::asio::socket_base::max_listen_connections);
+      _port = acceptor.local_endpoint().port();
+
+      boost::asio::co_spawn(ioc, accept_loop(acceptor, _locality), boost::asio::detached);
+    }
+
+    if (steered && std::ranges::find(cpus, -1) == cpus.end())
+    {
+      _attached = core::CpuAffinity::AttachReuseportSteering(_acceptors.front()->native_handle(), cpus);
+    }
+
+    for (std::size_t i = 0; i < count; ++i)
+    {
+      _threads.emplace_back(
+          [ioc = _io_contexts[i].get(), cpu = cpus[i]]()
+          {
+            if (cpu >= 0)
+            {
+              core::CpuAffinity::PinCurrentThread(cpu);
+            }
+            auto guard = boost::asio::make_work_guard(*ioc);
+            ioc->run();
+          });
+    }
+  }
+
+  ~EchoGroup()
+  {
+    for (auto& ioc : _io_contexts)
+    {
+      ioc->stop();
+    }
+    _threads.clear();
+  }
+
+  EchoGroup(const EchoGroup&) = delete;
+  EchoGroup& operator=(const EchoGroup&) = delete;
+  EchoGroup(EchoGroup&&) = delete;
+  EchoGroup& operator=(EchoGroup&&) = delete;
+};
+
+double percentile(std::vector<double>& samples, double ratio)
+{
+  auto idx = static_cast<std::size_t>(ratio * static_cast<double>(samples.size() - 1));
+  std::ranges::nth_element(samples, samples.begin() + static_cast<std::ptrdiff_t>(idx));
+  return samples[idx];
+}
+
+// 每个压测线程依次在自己的连接上发请求并等回显，记录每次往返的延迟
+void run_load(benchmark::State& state, bool steered)
+{
+  EchoGroup group(static_cast<std::size_t>(global::server::IO_CONTEXT_POOL_SIZE), steered);
+
+  boost::asio::io_context client_ioc;
+  std::vector<boost::asio::ip::tcp::socket> clients;
+  clients.reserve(CONNECTIONS);
+  for (std::size_t i = 0; i < CONNECTIONS; ++i)
+  {
+    clients.emplace_back(client_ioc).connect({boost::asio::ip::make_address("127.0.0.1"), group._port});
+    clients.back().set_option(boost::asio::ip::tcp::no_delay(true));
+  }
+
+  std::vector<std::vector<double>> latencies(CLIENT_THREADS);
+  for (auto ___ : state)
+  {
+    std::vector<std::jthread> workers;
+    for (std::size_t t = 0; t < CLIENT_THREADS; ++t)
+    {
+      workers.emplace_back(
+          [&clients, &samples = latencies[t], t]()
+          {
+            std::array<char, REQUEST_SIZE> request{};
+            std::array<char, REQUEST_SIZE> response{};
+            for (std::size_t round = 0; round < ROUNDS; ++round)
+            {
+              for (std::size_t i = t; i < CONNECTIONS; i += CLIENT_THREADS)
+              {
+                auto start = std::chrono::steady_clock::now();
+                boost::asio::write(clients[i], boost::asio::buffer(request));
+                boost::asio::read(clients[i], boost::asio::buffer(response));
+                samples.push_back(
+                    std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count());
+              }
+            }
+          });
+    }
+  }
+
+  std::vector<double> all;
+  for (auto& samples : latencies)
+  {
+    all.insert(all.end(), samples.begin(), samples.end());
+  }
+
+  const auto reads = static_cast<double>(group._locality._reads.load());
+  state.counters["p50_us"] = percentile(all, 0.50);
+  state.counters["p99_us"] = percentile(all, 0.99);
+  state.counters["p999_us"] = percentile(all, 0.999);
+  state.counters["same_cpu_ratio"] = static_cast<double>(group._locality._same_cpu.load()) / reads;
+  state.counters["cbpf_attached"] = group._attached ? 1 : 0;
+  state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(CONNECTIONS * ROUNDS));
+}
+
+}  // namespace
+
+// 测试1: io 线程不绑核，连接按四元组哈希分到各个 acceptor，与改造前的部署一致
+static void BM_Loopback_Hashed(benchmark::State& state)
+{
+  run_load(state, false);
+}
+BENCHMARK(BM_Loopback_Hashed)->UseRealTime()->Unit(benchmark::kMillisecond);
+
+// 测试2: io 线程按 NUMA 顺序绑核，CBPF 程序把连接交给绑定在收包核上的 acceptor
+static void BM_Loopback_Steered(benchmark::State& state)
+{
+  run_load(state, true);
+}
+BENCHMARK(BM_Loopback_Steered)->UseRealTime()->Unit(benchmark::kMillisecond);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,166 @@
+/******************************************************************************
+ *
+ * @file       bench_fanout.cc
+ * @brief      群聊消息扇出基准测试
+ *
+ * @author     KBchulan
+ * @date       2026/10/18
+ * @history    一条消息扇出到上万个回环会话，对比逐会话组帧发送与共享帧按 io_context 合并投递
+ *             2026/10/18 Publish 改为按编码回调序列化消息体，回环会话都是 JSON，只序列化一次
+ ******************************************************************************/
+
+#include <benchmark/benchmark.h>
+#include <sys/resource.h>
+
+#include <boost/asio/buffer.hpp>
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/asio/read.hpp>
+#include <chrono>
+#include <core/io/io.hpp>
+#include <core/manager/fan_out.hpp>
+#include <core/session/session.hpp>
+#include <global/Global.hpp>
+#include <memory>
+#include <string>
+#include <thread>
+#include <utils/common/code.hpp>
+#include <vector>
+
+namespace
+{
+
+constexpr std::size_t BODY_SIZE = 512;  // 带图片链接的群消息 JSON 长度
+constexpr short MSG_ID = 1;
+
+// 尽量放开文件描述符上限，回环连接每个会话占用两个 fd
+std::size_t clamp_sessions(std::size_t count)
+{
+  rlimit limit{};
+  getrlimit(RLIMIT_NOFILE, &limit);
+  limit.rlim_cur = limit.rlim_max;
+  setrlimit(RLIMIT_NOFILE, &limit);
+  getrlimit(RLIMIT_NOFILE, &limit);
+
+  const auto max_files = static_cast<std::size_t>(limit.rlim_cur);
+  return count * 2 + 64 > max_files ? (max_files - 64) / 2 : count;
+}
+
+// 在 IO 池上建立 count 个真实 Session，客户端 socket 以阻塞模式留在测试线程
+struct LoopbackSessions
+{
+  boost::asio::io_context _client_ioc;
+  std::vector<boost::asio::ip::tcp::socket> _clients;
+  std::vector<core::Session::Ptr> _sessions;
+
+  explicit LoopbackSessions(std::size_t count)
+  {
+    auto& io_pool = core::IO::GetInstance();
+    boost::asio::ip::tcp::acceptor acceptor(
+        _client_ioc, boost::asio::ip::tcp::endpoint(boost::asio::ip::make_address("127.0.0.1"), 0));
+    acceptor.listen(boost::asio::socket_base::max_listen_connections);
+    auto endpoint = acceptor.local_endpoint();
+
+    _clients.reserve(count);
+    _sessions.reserve(count);
+    for (std::size_t i = 0; i < count; ++i)
+    {
+      _clients.emplace_back(_client_ioc);
+      _clients.back().connect(endpoint);
+
+      // 与 Server 一样，会话的 executor 即接入时所在的 io_context
+      auto socket = acceptor.accept(io_pool.GetIOContextAt(i % io_pool.GetPoolSize()));
+      auto session = core::Session::Create(std::move(socket), std::weak_ptr<core::Server>{},
+                                           i % io_pool.GetPoolSize());
+      session->Start();
+      _sessions.emplace_back(std::move(session));
+    }
+  }
+
+  // 每个客户端读出一帧，全部读完即本次扇出送达
+  void drain(std::vector<char>& sink)
+  {
+    for (auto& client : _clients)
+    {
+      boost::asio::read(client, boost::asio::buffer(sink));
+    }
+  }
+
+  ~LoopbackSessions()
+  {
+    for (auto& client : _clients)
+    {
+      boost::system::error_code errc;
+      client.close(errc);
+    }
+    _sessions.clear();
+    std::this_thread::sleep_for(std::chrono::milliseconds(500));
+  }
+
+  LoopbackSessions(const LoopbackSessions&) = delete;
+  LoopbackSessions& operator=(const LoopbackSessions&) = delete;
+  LoopbackSessions(LoopbackSessions&&) = delete;
+  LoopbackSessions& operator=(LoopbackSessions&&) = delete;
+};
+
+// caller_us 为调用方线程上扇出本身的耗时，即逻辑线程被占用的时间；迭代时间还包含全部客户端读出的时间
+template <typename Publish>
+void run_fanout(benchmark::State& state, Publish&& publish)
+{
+  const auto count = clamp_sessions(static_cast<std::size_t>(state.range(0)));
+  LoopbackSessions loopback(count);
+
+  std::string body(BODY_SIZE, 'x');
+  std::vector<char> sink(global::server::MSG_HEAD_TOTAL_LEN + BODY_SIZE);
+  double caller_us = 0;
+
+  for (auto ___ : state)
+  {
+    auto start = std::chrono::steady_clock::now();
+    publish(loopback._sessions, body);
+    caller_us += std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+
+    loopback.drain(sink);
+  }
+
+  state.counters["sessions"] = static_cast<double>(count);
+  state.counters["caller_us"] = caller_us / static_cast<double>(state.iterations());
+  state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(count));
+}
+
+}  // namespace
+
+// 测试1: 逐个会话调用 Send(msg_id, body)，每个会话各自组帧拷贝一次，并各自跨线程启动写协程
+static void BM_FanOut_PerSession(benchmark::State& state)
+{
+  run_fanout(state,
+             [](const std::vector<core::Session::Ptr>& sessions, const std::string& body)
+             {
+               for (const auto& session : sessions)
+               {
+                 session->Send(MSG_ID, body);
+               }
+             });
+}
+BENCHMARK(BM_FanOut_PerSession)->Arg(1000)->Arg(10000)->UseRealTime()->Unit(benchmark::kMillisecond);
+
+// 测试2: FanOut::Publish 只组帧一次，全部会话共享同一个 SendNode，每个 io_context 只 post 一次
+static void BM_FanOut_Shared(benchmark::State& state)
+{
+  auto before = core::FanOut::GetStats();
+
+  run_fanout(state,
+             [](const std::vector<core::Session::Ptr>& sessions, const std::string& body)
+             {
+               core::FanOut::GetInstance().Publish(
+                   MSG_ID, [&body](utils::WireProtocol) { return body; }, sessions);
+             });
+
+  auto after = core::FanOut::GetStats();
+  const auto publishes = static_cast<double>(after.publishes - before.publishes);
+  state.counters["frames_per_publish"] = static_cast<double>(after.frames_encoded - before.frames_encoded) / publishes;
+  state.counters["posts_per_publish"] = static_cast<double>(after.posts - before.posts) / publishes;
+}
+BENCHMARK(BM_FanOut_Shared)->Arg(1000)->Arg(10000)->UseRealTime()->Unit(benchmark::kMillisecond);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,153 @@
+/******************************************************************************
+ *
+ * @file       bench_io_backend.cc
+ * @brief      io 后端回环基准测试
+ *
+ * @author     KBchulan
+ * @date       2026/10/18
+ * @history    多个客户端线程在回环连接上流水线发送心跳，由真实 Session 在 io 线程上回包，
+ *             统计每秒请求数与每条消息消耗的进程 CPU 时间；分别以 epoll 与 ENABLE_IO_URING 构建后对比
+ ******************************************************************************/
+
+#include <benchmark/benchmark.h>
+#include <sys/resource.h>
+
+#include <array>
+#include <boost/asio/buffer.hpp>
+#include <boost/asio/detail/socket_ops.hpp>
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/asio/read.hpp>
+#include <boost/asio/write.hpp>
+#include <chrono>
+#include <core/io/io.hpp>
+#include <core/session/session.hpp>
+#include <cstdint>
+#include <cstring>
+#include <global/Global.hpp>
+#include <memory>
+#include <thread>
+#include <utils/common/code.hpp>
+#include <vector>
+
+namespace
+{
+
+constexpr std::size_t BODY_SIZE = 64;      // 一条短聊天消息的长度
+constexpr std::size_t CLIENT_THREADS = 4;  // 压测线程数
+constexpr std::size_t CONNECTIONS = 256;   // 连接总数，平均分给压测线程
+constexpr std::size_t FRAME_SIZE = global::server::MSG_HEAD_TOTAL_LEN + BODY_SIZE;
+
+// 用户态与内核态 CPU 时间之和，包含压测线程
+double process_cpu_us()
+{
+  rusage usage{};
+  getrusage(RUSAGE_SELF, &usage);
+  auto to_us = [](const timeval& tv) { return static_cast<double>(tv.tv_sec) * 1e6 + static_cast<double>(tv.tv_usec); };
+  return to_us(usage.ru_utime) + to_us(usage.ru_stime);
+}
+
+// 客户端侧的心跳帧，Session 在 io 线程上直接回显，不经过逻辑线程
+std::vector<char> make_heartbeats(std::size_t count)
+{
+  using namespace global::server;
+
+  std::vector<char> frames(FRAME_SIZE * count, 'x');
+  auto net_id = boost::asio::detail::socket_ops::host_to_network_short(static_cast<std::uint16_t>(utils::ID_HEARTBEAT));
+  auto net_len = boost::asio::detail::socket_ops::host_to_network_short(static_cast<std::uint16_t>(BODY_SIZE));
+  for (std::size_t i = 0; i < count; ++i)
+  {
+    std::memcpy(frames.data() + i * FRAME_SIZE, &net_id, MSG_TYPE_LENGTH);
+    std::memcpy(frames.data() + i * FRAME_SIZE + MSG_TYPE_LENGTH, &net_len, MSG_LEN_LENGTH);
+  }
+  return frames;
+}
+
+// 在 IO 池上建立 count 个真实 Session，与 Server 一样分散到各个 io_context
+struct LoopbackSessions
+{
+  boost::asio::io_context _client_ioc;
+  std::vector<boost::asio::ip::tcp::socket> _clients;
+  std::vector<core::Session::Ptr> _sessions;
+
+  explicit LoopbackSessions(std::size_t count)
+  {
+    auto& io_pool = core::IO::GetInstance();
+    boost::asio::ip::tcp::acceptor acceptor(
+        _client_ioc, boost::asio::ip::tcp::endpoint(boost::asio::ip::make_address("127.0.0.1"), 0));
+    acceptor.listen(boost::asio::socket_base::max_listen_connections);
+
+    _clients.reserve(count);
+    _sessions.reserve(count);
+    for (std::size_t i = 0; i < count; ++i)
+    {
+      _clients.emplace_back(_client_ioc).connect(acceptor.local_endpoint());
+      _clients.back().set_option(boost::asio::ip::tcp::no_delay(true));
+
+      auto socket = acceptor.accept(io_pool.GetIOContextAt(i % io_pool.GetPoolSize()));
+      socket.set_option(boost::asio::ip::tcp::no_delay(true));
+      auto session = core::Session::Create(std::move(socket), std::weak_ptr<core::Server>{},
+                                           i % io_pool.GetPoolSize());
+      session->Start();
+      _sessions.emplace_back(std::move(session));
+    }
+  }
+
+  ~LoopbackSessions()
+  {
+    for (auto& client : _clients)
+    {
+      boost::system::error_code errc;
+      client.close(errc);
+    }
+    _sessions.clear();
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+  }
+
+  LoopbackSessions(const LoopbackSessions&) = delete;
+  LoopbackSessions& operator=(const LoopbackSessions&) = delete;
+  LoopbackSessions(LoopbackSessions&&) = delete;
+  LoopbackSessions& operator=(LoopbackSessions&&) = delete;
+};
+
+}  // namespace
+
+// 每次迭代每个压测线程在自己的每条连接上一次写出 pipeline 个心跳，再逐条读回全部回包
+// pipeline 为 1 时每个请求一次往返，读写都是小包，系统调用开销占比最高
+static void BM_IoBackend_Heartbeat(benchmark::State& state)
+{
+  const auto pipeline = static_cast<std::size_t>(state.range(0));
+  LoopbackSessions loopback(CONNECTIONS);
+  auto requests = make_heartbeats(pipeline);
+
+  auto cpu_before = process_cpu_us();
+  for (auto ___ : state)
+  {
+    std::vector<std::jthread> workers;
+    for (std::size_t t = 0; t < CLIENT_THREADS; ++t)
+    {
+      workers.emplace_back(
+          [&loopback, &requests, t]()
+          {
+            std::vector<char> responses(requests.size());
+            for (std::size_t i = t; i < CONNECTIONS; i += CLIENT_THREADS)
+            {
+              boost::asio::write(loopback._clients[i], boost::asio::buffer(requests));
+            }
+            for (std::size_t i = t; i < CONNECTIONS; i += CLIENT_THREADS)
+            {
+              boost::asio::read(loopback._clients[i], boost::asio::buffer(responses));
+            }
+          });
+    }
+  }
+  auto cpu_us = process_cpu_us() - cpu_before;
+
+  const auto messages = static_cast<double>(state.iterations() * CONNECTIONS * pipeline);
+  state.counters["cpu_us_per_msg"] = cpu_us / messages;
+  state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(CONNECTIONS * pipeline));
+  state.SetLabel(core::IO::GetBackendName());
+}
+BENCHMARK(BM_IoBackend_Heartbeat)->Arg(1)->Arg(16)->UseRealTime()->Unit(benchmark::kMillisecond);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,167 @@
+/******************************************************************************
+ *
+ * @file       bench_large_frame.cc
+ * @brief      大帧收发基准测试
+ *
+ * @author     KBchulan
+ * @date       2026/10/18
+ * @history    1MB 消息体经真实 Session 在回环连接上的上行与下行吞吐
+ ******************************************************************************/
+
+#include <benchmark/benchmark.h>
+
+#include <atomic>
+#include <boost/asio/buffer.hpp>
+#include <boost/asio/detail/socket_ops.hpp>
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/asio/read.hpp>
+#include <boost/asio/write.hpp>
+#include <core/io/io.hpp>
+#include <core/logic/logic.hpp>
+#include <core/msg-node/msg-node.hpp>
+#include <core/session/session.hpp>
+#include <cstdint>
+#include <cstring>
+#include <global/Global.hpp>
+#include <memory>
+#include <span>
+#include <vector>
+
+namespace
+{
+
+constexpr short CHUNKED_MSG_ID = 30001;   // 注册分块处理函数的测试 id
+constexpr short FLAT_MSG_ID = 30002;      // 只注册普通处理函数的测试 id，大帧拼接后交付
+constexpr short DOWNLOAD_MSG_ID = 30003;  // 下行测试 id
+
+std::atomic<std::uint64_t> g_received_bytes{0};
+
+void on_received(std::size_t bytes)
+{
+  g_received_bytes.fetch_add(bytes, std::memory_order_release);
+  g_received_bytes.notify_one();
+}
+
+void wait_received(std::uint64_t target)
+{
+  for (auto got = g_received_bytes.load(std::memory_order_acquire); got < target;
+       got = g_received_bytes.load(std::memory_order_acquire))
+  {
+    g_received_bytes.wait(got, std::memory_order_acquire);
+  }
+}
+
+void register_handlers()
+{
+  static const bool registered = []
+  {
+    auto& logic = core::Logic::GetInstance();
+    logic.RegisterChunkedHandler(CHUNKED_MSG_ID,
+                                 [](const std::shared_ptr<core::Session>&, std::span<const std::span<char>> chunks)
+                                 {
+                                   std::size_t bytes = 0;
+                                   for (auto chunk : chunks)
+                                   {
+                                     bytes += chunk.size();
+                                   }
+                                   on_received(bytes);
+                                 });
+    logic.RegisterHandler(FLAT_MSG_ID, [](const std::shared_ptr<core::Session>&, std::span<const char> body)
+                          { on_received(body.size()); });
+    return true;
+  }();
+  benchmark::DoNotOptimize(registered);
+}
+
+// 在 IO 池上建立一个真实 Session，客户端 socket 以阻塞模式留在测试线程
+struct LoopbackSession
+{
+  boost::asio::io_context _client_ioc;
+  boost::asio::ip::tcp::socket _client{_client_ioc};
+  core::Session::Ptr _session;
+
+  LoopbackSession()
+  {
+    boost::asio::ip::tcp::acceptor acceptor(
+        _client_ioc, boost::asio::ip::tcp::endpoint(boost::asio::ip::make_address("127.0.0.1"), 0));
+    _client.connect(acceptor.local_endpoint());
+
+    auto socket = acceptor.accept(core::IO::GetInstance().GetIOContext());
+    _session = core::Session::Create(std::move(socket), std::weak_ptr<core::Server>{});
+    _session->Start();
+  }
+
+  ~LoopbackSession()
+  {
+    boost::system::error_code errc;
+    _client.close(errc);
+  }
+
+  LoopbackSession(const LoopbackSession&) = delete;
+  LoopbackSession& operator=(const LoopbackSession&) = delete;
+  LoopbackSession(LoopbackSession&&) = delete;
+  LoopbackSession& operator=(LoopbackSession&&) = delete;
+};
+
+// 客户端侧的大帧：2 字节 id + 长度标记 + 4 字节长度 + 消息体
+std::vector<char> make_large_frame(short msg_id, std::size_t body_len)
+{
+  using namespace global::server;
+
+  std::vector<char> frame(MSG_HEAD_TOTAL_LEN + MSG_EXT_LEN_LENGTH + body_len, 'x');
+  auto net_id = boost::asio::detail::socket_ops::host_to_network_short(static_cast<std::uint16_t>(msg_id));
+  auto net_marker = boost::asio::detail::socket_ops::host_to_network_short(MSG_EXT_LEN_MARKER);
+  auto net_len = boost::asio::detail::socket_ops::host_to_network_long(static_cast<std::uint32_t>(body_len));
+  std::memcpy(frame.data(), &net_id, MSG_TYPE_LENGTH);
+  std::memcpy(frame.data() + MSG_TYPE_LENGTH, &net_marker, MSG_LEN_LENGTH);
+  std::memcpy(frame.data() + MSG_HEAD_TOTAL_LEN, &net_len, MSG_EXT_LEN_LENGTH);
+  return frame;
+}
+
+}  // namespace
+
+// 测试1: 客户端上行 1MB 大帧，Session 分散读入分块后交给 Logic
+// 参数 0 为分块处理函数，1 为普通处理函数（拼接成连续内存后交付）
+static void BM_LargeFrame_Upload(benchmark::State& state)
+{
+  constexpr std::size_t BODY_LEN = 1 << 20;
+
+  register_handlers();
+  LoopbackSession loopback;
+  auto frame = make_large_frame(state.range(0) == 0 ? CHUNKED_MSG_ID : FLAT_MSG_ID, BODY_LEN);
+
+  for (auto ___ : state)
+  {
+    auto target = g_received_bytes.load(std::memory_order_acquire) + BODY_LEN;
+    boost::asio::write(loopback._client, boost::asio::buffer(frame));
+    wait_received(target);
+  }
+
+  state.SetItemsProcessed(state.iterations());
+  state.SetBytesProcessed(state.iterations() * static_cast<std::int64_t>(BODY_LEN));
+}
+BENCHMARK(BM_LargeFrame_Upload)->Arg(0)->Arg(1)->UseRealTime()->Unit(benchmark::kMicrosecond);
+
+// 测试2: 服务端下行 1MB 大帧，SendNode 分块后由写协程以一组 iovec 写出
+static void BM_LargeFrame_Download(benchmark::State& state)
+{
+  using namespace global::server;
+  constexpr std::size_t BODY_LEN = 1 << 20;
+
+  LoopbackSession loopback;
+  std::vector<char> body(BODY_LEN, 'x');
+  std::vector<char> sink(MSG_HEAD_TOTAL_LEN + MSG_EXT_LEN_LENGTH + BODY_LEN);
+
+  for (auto ___ : state)
+  {
+    loopback._session->Send(core::SendNode::Create(DOWNLOAD_MSG_ID, body));
+    boost::asio::read(loopback._client, boost::asio::buffer(sink));
+  }
+
+  state.SetItemsProcessed(state.iterations());
+  state.SetBytesProcessed(state.iterations() * static_cast<std::int64_t>(BODY_LEN));
+}
+BENCHMARK(BM_LargeFrame_Download)->UseRealTime()->Unit(benchmark::kMicrosecond);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,190 @@
+/******************************************************************************
+ *
+ * @file       bench_logic.cc
+ * @brief      Logic 分发器基准测试
+ *
+ * @author     KBchulan
+ * @date       2026/10/18
+ * @history    模拟 8 个 io 线程并发调用 PostToLogic，统计吞吐、队列积压及会话内顺序
+ ******************************************************************************/
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <atomic>
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/ip/tcp.hpp>
+#include <chrono>
+#include <core/logic/logic.hpp>
+#include <core/msg-node/msg-node.hpp>
+#include <core/session/session.hpp>
+#include <cstdint>
+#include <cstring>
+#include <global/Global.hpp>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace
+{
+
+constexpr short BENCH_MSG_ID = 30000;              // 不与业务消息冲突的测试 id
+constexpr std::size_t IO_THREADS = 8;              // 模拟的 io 线程数
+constexpr std::size_t SESSIONS_PER_THREAD = 128;   // 每个 io 线程持有的会话数
+constexpr std::size_t POSTS_PER_THREAD = 16384;    // 每轮每个 io 线程投递的消息数
+
+// 全局在途消息上限，取单个 worker 队列容量的一半，检查与投递之间的竞争也不会触发丢弃
+constexpr std::uint64_t IN_FLIGHT_LIMIT = global::server::LOGIC_QUEUE_CAPACITY / 2;
+
+struct BenchState
+{
+  std::atomic<std::uint64_t> posted{0};
+  std::atomic<std::uint64_t> handled{0};
+  std::atomic<std::uint64_t> order_violations{0};
+  std::atomic<std::int64_t> handler_work_ns{0};
+
+  // 以会话地址为键记录最后一个序号，同一会话只会落在同一个 worker 上，因此无需加锁
+  std::unordered_map<const core::Session*, std::uint32_t> last_seq;
+};
+
+BenchState g_state;
+
+// 模拟 handler 中的业务耗时
+void spin_for(std::int64_t nanos)
+{
+  if (nanos <= 0)
+  {
+    return;
+  }
+
+  auto deadline = std::chrono::steady_clock::now() + std::chrono::nanoseconds(nanos);
+  while (std::chrono::steady_clock::now() < deadline)
+  {
+  }
+}
+
+void register_bench_handler()
+{
+  static std::once_flag flag;
+  std::call_once(flag,
+                 []
+                 {
+                   core::Logic::GetInstance().RegisterHandler(
+                       BENCH_MSG_ID,
+                       [](const std::shared_ptr<core::Session>& session, std::span<const char> data)
+                       {
+                         std::uint32_t seq = 0;
+                         std::memcpy(&seq, data.data(), sizeof(seq));
+
+                         auto& last = g_state.last_seq.at(session.get());
+                         if (seq != last + 1)
+                         {
+                           g_state.order_violations.fetch_add(1, std::memory_order_relaxed);
+                         }
+                         last = seq;
+
+                         spin_for(g_state.handler_work_ns.load(std::memory_order_relaxed));
+                         g_state.handled.fetch_add(1, std::memory_order_release);
+                       });
+                 });
+}
+
+std::shared_ptr<core::RecvNode> make_msg(std::uint32_t seq)
+{
+  auto msg = core::RecvNode::Create(BENCH_MSG_ID, static_cast<short>(sizeof(seq)));
+  std::memcpy(msg->GetBuffer().data(), &seq, sizeof(seq));
+  return msg;
+}
+
+}  // namespace
+
+// 测试1: 8 个线程并发投递，参数为 handler 模拟耗时（纳秒）
+static void BM_Logic_PostFromIoThreads(benchmark::State& state)
+{
+  register_bench_handler();
+  auto& logic = core::Logic::GetInstance();
+  g_state.handler_work_ns.store(state.range(0), std::memory_order_relaxed);
+
+  // 会话不启动读写协程，只作为分发键和 handler 入参
+  boost::asio::io_context io_context;
+  std::vector<std::vector<core::Session::Ptr>> sessions(IO_THREADS);
+  for (auto& group : sessions)
+  {
+    group.reserve(SESSIONS_PER_THREAD);
+    for (std::size_t i = 0; i < SESSIONS_PER_THREAD; ++i)
+    {
+      auto& session = group.emplace_back(core::Session::Create(boost::asio::ip::tcp::socket(io_context), {}));
+      g_state.last_seq[session.get()] = 0;
+    }
+  }
+
+  std::uint64_t total = 0;
+  std::size_t max_depth = 0;
+  std::vector<std::uint32_t> next_seq(IO_THREADS * SESSIONS_PER_THREAD, 0);
+
+  for (auto _ : state)
+  {
+    std::uint64_t target = g_state.handled.load(std::memory_order_relaxed) + (IO_THREADS * POSTS_PER_THREAD);
+
+    std::vector<std::jthread> io_threads;
+    io_threads.reserve(IO_THREADS);
+    for (std::size_t t = 0; t < IO_THREADS; ++t)
+    {
+      io_threads.emplace_back(
+          [&logic, &group = sessions[t], &next_seq, t]
+          {
+            for (std::size_t i = 0; i < POSTS_PER_THREAD; ++i)
+            {
+              std::size_t idx = i % SESSIONS_PER_THREAD;
+              auto seq = ++next_seq[(t * SESSIONS_PER_THREAD) + idx];
+
+              while (g_state.posted.load(std::memory_order_relaxed) -
+                         g_state.handled.load(std::memory_order_acquire) >=
+                     IN_FLIGHT_LIMIT)
+              {
+                std::this_thread::yield();
+              }
+              g_state.posted.fetch_add(1, std::memory_order_relaxed);
+              auto msg = make_msg(seq);
+              while (!logic.PostToLogic(group[idx], msg))
+              {
+                std::this_thread::yield();
+              }
+            }
+          });
+    }
+
+    // 投递的同时采样各个 worker 的积压
+    while (g_state.handled.load(std::memory_order_acquire) < target)
+    {
+      for (std::size_t w = 0; w < logic.GetWorkerCount(); ++w)
+      {
+        max_depth = std::max(max_depth, logic.GetQueueDepth(w));
+      }
+      std::this_thread::yield();
+    }
+
+    io_threads.clear();
+    total += IO_THREADS * POSTS_PER_THREAD;
+  }
+
+  state.SetItemsProcessed(static_cast<std::int64_t>(total));
+  state.counters["workers"] = static_cast<double>(logic.GetWorkerCount());
+  state.counters["max_queue_depth"] = static_cast<double>(max_depth);
+  state.counters["order_violations"] =
+      static_cast<double>(g_state.order_violations.load(std::memory_order_relaxed));
+
+  for (auto& group : sessions)
+  {
+    for (auto& session : group)
+    {
+      g_state.last_seq.erase(session.get());
+    }
+  }
+}
+BENCHMARK(BM_Logic_PostFromIoThreads)->Arg(0)->Arg(1000)->Arg(20000)->UseRealTime()->Unit(benchmark::kMillisecond);
+
+BENCHMARK_MAIN();
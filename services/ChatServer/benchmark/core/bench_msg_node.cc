@@ -0,0 +1,203 @@
+/******************************************************************************
+ *
+ * @file       bench_msg_node.cc
+ * @brief      消息节点分配基准测试
+ *
+ * @author     KBchulan
+ * @date       2026/10/18
+ * @history    对比 make_shared 加 vector 的逐节点两次堆分配与 BufferPool 的单次池化分配，
+ *             统计每个节点的堆分配次数与吞吐，包括 io 线程分配、逻辑线程释放的跨线程场景
+ ******************************************************************************/
+
+#include <benchmark/benchmark.h>
+
+#include <atomic>
+#include <core/msg-node/buffer-pool.hpp>
+#include <core/msg-node/msg-node.hpp>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <global/Global.hpp>
+#include <global/SuperQueue.hpp>
+#include <memory>
+#include <new>
+#include <span>
+#include <thread>
+#include <vector>
+
+namespace
+{
+
+// 当前线程调用全局 operator new 的次数，平凡类型，不需要初始化
+thread_local std::uint64_t t_heap_allocs = 0;
+
+}  // namespace
+
+// 替换全局分配函数以统计堆分配次数，池中向系统申请的块同样计入
+void* operator new(std::size_t size)
+{
+  ++t_heap_allocs;
+  if (void* block = std::malloc(size == 0 ? 1 : size))
+  {
+    return block;
+  }
+  throw std::bad_alloc();
+}
+
+void operator delete(void* block) noexcept
+{
+  std::free(block);
+}
+
+void operator delete(void* block, std::size_t /*size*/) noexcept
+{
+  std::free(block);
+}
+
+namespace
+{
+
+constexpr short MSG_ID = 1;
+constexpr std::size_t CROSS_THREAD_QUEUE = 4096;  // 跨线程场景中在途的节点数上限
+
+// 改造前的发送节点：make_shared 分配控制块与节点，消息头与消息体再由 vector 分配一次
+class LegacySendNode
+{
+public:
+  LegacySendNode(short msg_id, std::span<const char> body)
+      : _msg_id(msg_id), _data(global::server::MSG_HEAD_TOTAL_LEN + body.size())
+  {
+    auto len = static_cast<std::uint16_t>(body.size());
+    std::memcpy(_data.data(), &_msg_id, sizeof(_msg_id));
+    std::memcpy(_data.data() + global::server::MSG_TYPE_LENGTH, &len, sizeof(len));
+    std::memcpy(_data.data() + global::server::MSG_HEAD_TOTAL_LEN, body.data(), body.size());
+  }
+
+  virtual ~LegacySendNode() = default;
+
+  [[nodiscard]] std::span<const char> GetData() const noexcept
+  {
+    return _data;
+  }
+
+  LegacySendNode(const LegacySendNode&) = delete;
+  LegacySendNode& operator=(const LegacySendNode&) = delete;
+  LegacySendNode(LegacySendNode&&) = delete;
+  LegacySendNode& operator=(LegacySendNode&&) = delete;
+
+private:
+  short _msg_id;
+  std::vector<char> _data;
+};
+
+std::shared_ptr<LegacySendNode> make_legacy(std::span<const char> body)
+{
+  return std::make_shared<LegacySendNode>(MSG_ID, body);
+}
+
+std::shared_ptr<core::SendNode> make_pooled(std::span<const char> body)
+{
+  return core::SendNode::Create(MSG_ID, body);
+}
+
+// 同一线程分配后立即释放，对应逻辑线程组帧后由写协程发出即释放的短生命周期
+template <typename Make>
+void run_same_thread(benchmark::State& state, Make&& make)
+{
+  std::vector<char> body(static_cast<std::size_t>(state.range(0)), 'x');
+
+  // 预热一轮，池化版本的线程缓存在此填充
+  benchmark::DoNotOptimize(make(body));
+
+  auto allocs_before = t_heap_allocs;
+  for (auto ___ : state)
+  {
+    auto node = make(body);
+    benchmark::DoNotOptimize(node->GetData().data());
+  }
+
+  state.counters["heap_allocs_per_node"] =
+      static_cast<double>(t_heap_allocs - allocs_before) / static_cast<double>(state.iterations());
+  state.SetItemsProcessed(state.iterations());
+  state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+
+// 测试线程分配，另一线程释放，对应 RecvNode 在 io 线程分配、在逻辑线程释放
+template <typename Make>
+void run_cross_thread(benchmark::State& state, Make&& make)
+{
+  using Node = decltype(make(std::span<const char>{}));
+
+  std::vector<char> body(static_cast<std::size_t>(state.range(0)), 'x');
+  auto queue = std::make_unique<global::SuperQueue<Node, CROSS_THREAD_QUEUE>>();
+  std::atomic<bool> running{true};
+
+  std::jthread consumer(
+      [&queue, &running]
+      {
+        Node node;
+        while (running.load(std::memory_order_acquire) || !queue->empty())
+        {
+          if (!queue->pop(node))
+          {
+            std::this_thread::yield();
+            continue;
+          }
+          node.reset();
+        }
+      });
+
+  auto allocs_before = t_heap_allocs;
+  for (auto ___ : state)
+  {
+    auto node = make(body);
+    while (!queue->emplace(std::move(node)))
+    {
+      std::this_thread::yield();
+    }
+  }
+  running.store(false, std::memory_order_release);
+  consumer.join();
+
+  state.counters["heap_allocs_per_node"] =
+      static_cast<double>(t_heap_allocs - allocs_before) / static_cast<double>(state.iterations());
+  state.SetItemsProcessed(state.iterations());
+  state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+
+}  // namespace
+
+// 测试1: 改造前的节点，每个节点两次堆分配
+static void BM_MsgNode_Legacy(benchmark::State& state)
+{
+  run_same_thread(state, make_legacy);
+}
+BENCHMARK(BM_MsgNode_Legacy)->Arg(64)->Arg(512)->Arg(4096)->Arg(8192);
+
+// 测试2: 节点、控制块与缓冲区一次分配，且由线程缓存复用，稳定后不再访问堆
+static void BM_MsgNode_Pooled(benchmark::State& state)
+{
+  run_same_thread(state, make_pooled);
+}
+BENCHMARK(BM_MsgNode_Pooled)->Arg(64)->Arg(512)->Arg(4096)->Arg(8192);
+
+// 测试3: 跨线程释放的改造前节点
+static void BM_MsgNode_CrossThread_Legacy(benchmark::State& state)
+{
+  run_cross_thread(state, make_legacy);
+}
+BENCHMARK(BM_MsgNode_CrossThread_Legacy)->Arg(64)->Arg(4096)->UseRealTime();
+
+// 测试4: 跨线程释放的池化节点，释放方线程缓存溢出的块经全局空闲队列回到分配方
+static void BM_MsgNode_CrossThread_Pooled(benchmark::State& state)
+{
+  auto before = core::BufferPool::GetInstance().GetStats();
+
+  run_cross_thread(state, make_pooled);
+
+  auto after = core::BufferPool::GetInstance().GetStats();
+  state.counters["system_allocs"] = static_cast<double>(after.system_allocs - before.system_allocs);
+}
+BENCHMARK(BM_MsgNode_CrossThread_Pooled)->Arg(64)->Arg(4096)->UseRealTime();
+
+BENCHMARK_MAIN();
@@ -0,0 +1,134 @@
+/******************************************************************************
+ *
+ * @file       bench_profile_cache.cc
+ * @brief      用户资料近端缓存基准测试
+ *
+ * @author     KBchulan
+ * @date       2026/10/18
+ * @history    多个线程同时查询本地资料时，单锁 LRU 与按 uuid 分片的 ProfileCache 的吞吐；
+ *             命中时不访问 Redis 与数据库，作为对比的回源耗时需在有 MariaDB 的环境中另行测量
+ ******************************************************************************/
+
+#include <benchmark/benchmark.h>
+
+#include <core/model/user_do.hpp>
+#include <core/repository/profile_cache.hpp>
+#include <cstddef>
+#include <list>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace
+{
+
+constexpr std::size_t PROFILES = 16384;  // 预先放入的资料条数，小于缓存容量，查询全部命中
+
+core::UserDO make_user(const std::string& uuid)
+{
+  return core::UserDO{.id = 0,
+                      .uuid = uuid,
+                      .nickname = "nickname-" + uuid,
+                      .avatar = "https://cdn.example.com/avatar/" + uuid + ".png",
+                      .email = uuid + "@example.com",
+                      .password_hash = {},
+                      .last_login = {},
+                      .created_at = {},
+                      .updated_at = {}};
+}
+
+const std::vector<std::string>& uuids()
+{
+  static const auto values = []
+  {
+    std::vector<std::string> result;
+    result.reserve(PROFILES);
+    for (std::size_t i = 0; i < PROFILES; ++i)
+    {
+      result.push_back("0f5a3c1e-7d2b-4e8f-9a6c-" + std::to_string(100000000000 + i));
+    }
+    return result;
+  }();
+  return values;
+}
+
+// 不分片的 LRU：一把锁保护整张表，命中时同样移到队首
+class SingleLockLru
+{
+public:
+  void Put(const std::string& uuid, const core::UserDO& user)
+  {
+    std::lock_guard lock{_mutex};
+    _lru.push_front({uuid, user});
+    _index[uuid] = _lru.begin();
+  }
+
+  std::optional<core::UserDO> Peek(const std::string& uuid)
+  {
+    std::lock_guard lock{_mutex};
+    auto it = _index.find(uuid);
+    if (it == _index.end())
+    {
+      return std::nullopt;
+    }
+    _lru.splice(_lru.begin(), _lru, it->second);
+    return it->second->second;
+  }
+
+private:
+  std::mutex _mutex;
+  std::list<std::pair<std::string, core::UserDO>> _lru;
+  std::unordered_map<std::string, std::list<std::pair<std::string, core::UserDO>>::iterator> _index;
+};
+
+template <typename Cache>
+void run_peek(benchmark::State& state, Cache& cache)
+{
+  const auto& keys = uuids();
+  auto idx = static_cast<std::size_t>(state.thread_index()) * 7919;
+  for (auto ___ : state)
+  {
+    auto user = cache.Peek(keys[idx % keys.size()]);
+    benchmark::DoNotOptimize(user);
+    idx += 31;
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+}  // namespace
+
+static void BM_SingleLockLru_Peek(benchmark::State& state)
+{
+  static SingleLockLru cache;
+  static std::once_flag filled;
+  std::call_once(filled,
+                 []
+                 {
+                   for (const auto& uuid : uuids())
+                   {
+                     cache.Put(uuid, make_user(uuid));
+                   }
+                 });
+  run_peek(state, cache);
+}
+BENCHMARK(BM_SingleLockLru_Peek)->ThreadRange(1, 8)->UseRealTime();
+
+static void BM_ProfileCache_Peek(benchmark::State& state)
+{
+  auto& cache = core::ProfileCache::GetInstance();
+  static std::once_flag filled;
+  std::call_once(filled,
+                 [&cache]
+                 {
+                   for (const auto& uuid : uuids())
+                   {
+                     cache.Put(uuid, make_user(uuid));
+                   }
+                 });
+  run_peek(state, cache);
+}
+BENCHMARK(BM_ProfileCache_Peek)->ThreadRange(1, 8)->UseRealTime();
+
+BENCHMARK_MAIN();
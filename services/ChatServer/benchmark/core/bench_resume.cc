@@ -0,0 +1,142 @@
+/******************************************************************************
+ *
+ * @file       bench_resume.cc
+ * @brief      断线恢复握手基准测试
+ *
+ * @author     KBchulan
+ * @date       2026/10/18
+ * @history    恢复令牌的签发与校验，以及恢复请求解析、校验与带补发消息的响应编码在本地的 CPU 耗时；
+ *             完整登录中 GateWay 的 Argon2 与各次 RPC、SQL 往返需在完整部署中另行测量
+ *             2026/10/18 使用固定的测试密钥环，新增轮换前令牌的校验
+ ******************************************************************************/
+
+#include <benchmark/benchmark.h>
+
+#include <core/session/resume_token.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utils/codec/message_codec.hpp>
+
+namespace
+{
+
+constexpr const char* UUID = "0f5a3c1e-7d2b-4e8f-9a6c-100000000042";
+constexpr std::uint64_t MISSED_PER_CONVERSATION = 10;  // 每个会话补发的消息数
+
+// 与部署时环境变量的格式相同，轮换后旧密钥排在新密钥之后只用于校验
+constexpr const char* KEYS = "k2:bench-resume-key-0123456789abcdef,k1:bench-resume-key-fedcba9876543210";
+constexpr const char* KEYS_BEFORE_ROTATION = "k1:bench-resume-key-fedcba9876543210";
+
+std::string make_request(std::size_t conversations)
+{
+  utils::ResumeRequest request;
+  request.set_token(core::ResumeToken::Issue(UUID));
+  request.set_protocol(static_cast<std::uint32_t>(utils::WireProtocol::PROTOBUF));
+  for (std::size_t i = 0; i < conversations; ++i)
+  {
+    auto* cursor = request.add_cursors();
+    cursor->set_conversation_id("conversation-" + std::to_string(i));
+    cursor->set_last_seq(1000);
+  }
+  return utils::MessageCodec::Encode(utils::WireProtocol::JSON, request);
+}
+
+}  // namespace
+
+static void BM_ResumeToken_Issue(benchmark::State& state)
+{
+  core::ResumeToken::LoadKeys(KEYS);
+  for (auto ___ : state)
+  {
+    auto token = core::ResumeToken::Issue(UUID);
+    benchmark::DoNotOptimize(token);
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_ResumeToken_Issue);
+
+static void BM_ResumeToken_Verify(benchmark::State& state)
+{
+  core::ResumeToken::LoadKeys(KEYS);
+  auto token = core::ResumeToken::Issue(UUID);
+  for (auto ___ : state)
+  {
+    auto claims = core::ResumeToken::Verify(token);
+    benchmark::DoNotOptimize(claims);
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_ResumeToken_Verify);
+
+// 轮换前签发的令牌按密钥 id 找到旧密钥校验，与当前密钥签发的令牌耗时相同
+static void BM_ResumeToken_VerifyRotated(benchmark::State& state)
+{
+  core::ResumeToken::LoadKeys(KEYS_BEFORE_ROTATION);
+  auto token = core::ResumeToken::Issue(UUID);
+  core::ResumeToken::LoadKeys(KEYS);
+  for (auto ___ : state)
+  {
+    auto claims = core::ResumeToken::Verify(token);
+    benchmark::DoNotOptimize(claims);
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_ResumeToken_VerifyRotated);
+
+// 篡改签名的令牌同样要计算一次 HMAC，重连风暴中的伪造请求不比合法请求更贵
+static void BM_ResumeToken_VerifyForged(benchmark::State& state)
+{
+  core::ResumeToken::LoadKeys(KEYS);
+  auto token = core::ResumeToken::Issue(UUID);
+  token.back() = token.back() == '0' ? '1' : '0';
+  for (auto ___ : state)
+  {
+    auto claims = core::ResumeToken::Verify(token);
+    benchmark::DoNotOptimize(claims);
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_ResumeToken_VerifyForged);
+
+// 逻辑线程与回到逻辑线程后的全部本地工作：解析请求、校验令牌、签发新令牌并编码带补发消息的响应
+static void BM_ResumeHandshake(benchmark::State& state)
+{
+  core::ResumeToken::LoadKeys(KEYS);
+  auto conversations = static_cast<std::size_t>(state.range(0));
+  auto body = make_request(conversations);
+
+  for (auto ___ : state)
+  {
+    utils::ResumeRequest request;
+    if (!utils::MessageCodec::Decode(utils::WireProtocol::JSON, body, request))
+    {
+      state.SkipWithError("Failed to parse resume request");
+      break;
+    }
+    auto claims = core::ResumeToken::Verify(request.token());
+
+    utils::ResumeResponse response;
+    response.set_code(0);
+    response.set_resume_token(core::ResumeToken::Issue(claims->uuid));
+    for (const auto& cursor : request.cursors())
+    {
+      auto* missed = response.add_missed();
+      missed->set_conversation_id(cursor.conversation_id());
+      for (std::uint64_t seq = cursor.last_seq() + MISSED_PER_CONVERSATION; seq > cursor.last_seq(); --seq)
+      {
+        auto* msg = missed->add_messages();
+        msg->set_conversation_id(cursor.conversation_id());
+        msg->set_seq(seq);
+        msg->set_sender_uuid(UUID);
+        msg->set_content("message missed while the connection was down");
+      }
+    }
+    auto encoded = utils::MessageCodec::Encode(utils::WireProtocol::JSON, response);
+    benchmark::DoNotOptimize(encoded);
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_ResumeHandshake)->Arg(0)->Arg(4)->Arg(16);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,452 @@
+/******************************************************************************
+ *
+ * @file       bench_session.cc
+ * @brief      Session 常驻内存基准测试
+ *
+ * @author     KBchulan
+ * @date       2026/10/17
+ * @history    对比旧版定长发送队列与按需分配队列，并统计回环连接的 RSS
+ *             回环连接下小帧突发的逐帧写与合并写吞吐对比
+ *             万级在线会话下 Send 到 socket 可读的延迟
+ *             客户端停止读取时排队内存的上限，以及积压下控制帧的优先发送
+ ******************************************************************************/
+
+#include <benchmark/benchmark.h>
+#include <sys/resource.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <array>
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/buffer.hpp>
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/asio/read.hpp>
+#include <boost/asio/write.hpp>
+#include <chrono>
+#include <cstring>
+#include <core/io/io.hpp>
+#include <core/msg-node/msg-node.hpp>
+#include <core/session/session.hpp>
+#include <fstream>
+#include <global/Global.hpp>
+#include <global/MpscQueue.hpp>
+#include <global/SuperQueue.hpp>
+#include <limits>
+#include <memory>
+#include <thread>
+#include <utils/common/code.hpp>
+#include <vector>
+
+namespace
+{
+
+constexpr double SESSIONS_PER_REPORT = 100000.0;
+constexpr double BYTES_PER_MB = 1024.0 * 1024.0;
+
+// 读取当前进程的常驻内存
+std::size_t current_rss_bytes()
+{
+  std::ifstream statm("/proc/self/statm");
+  std::size_t pages = 0;
+  std::size_t resident = 0;
+  statm >> pages >> resident;
+  return resident * static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+}
+
+void report_rss(benchmark::State& state, std::size_t before, std::size_t after, std::size_t count)
+{
+  const auto delta = static_cast<double>(after > before ? after - before : 0);
+  state.counters["bytes_per_session"] = delta / static_cast<double>(count);
+  state.counters["rss_per_100k_MB"] = delta / static_cast<double>(count) * SESSIONS_PER_REPORT / BYTES_PER_MB;
+}
+
+// 旧版 Session 中常驻的收发结构: 1024 槽位的 SuperQueue + 8KB 接收缓冲区
+struct LegacySessionBuffers
+{
+  global::SuperQueue<std::shared_ptr<core::SendNode>, 1024> _send_queue;
+  std::array<char, global::server::RECV_BUFFER_SIZE> _recv_buffer{};
+};
+
+// 新版 Session 中常驻的收发结构: 按需分配的 MpscQueue + 消息头
+struct CompactSessionBuffers
+{
+  global::MpscQueue<std::shared_ptr<core::SendNode>> _send_queue;
+  std::array<char, global::server::MSG_HEAD_TOTAL_LEN> _recv_head{};
+};
+
+// 尽量放开文件描述符上限，回环连接每个会话占用两个 fd
+std::size_t raise_nofile_limit()
+{
+  rlimit limit{};
+  getrlimit(RLIMIT_NOFILE, &limit);
+  limit.rlim_cur = limit.rlim_max;
+  setrlimit(RLIMIT_NOFILE, &limit);
+  getrlimit(RLIMIT_NOFILE, &limit);
+  return static_cast<std::size_t>(limit.rlim_cur);
+}
+
+constexpr std::size_t SMALL_FRAME_BODY = 32;
+
+// 建立一对阻塞模式的回环 socket
+struct LoopbackPair
+{
+  boost::asio::io_context _ioc;
+  boost::asio::ip::tcp::socket _client{_ioc};
+  boost::asio::ip::tcp::socket _server{_ioc};
+
+  LoopbackPair()
+  {
+    boost::asio::ip::tcp::acceptor acceptor(
+        _ioc, boost::asio::ip::tcp::endpoint(boost::asio::ip::make_address("127.0.0.1"), 0));
+    _client.connect(acceptor.local_endpoint());
+    acceptor.accept(_server);
+    _client.set_option(boost::asio::ip::tcp::no_delay(true));
+    _server.set_option(boost::asio::ip::tcp::no_delay(true));
+  }
+};
+
+// 回环连接数受 fd 上限约束，每个会话占用两个 fd
+std::size_t clamp_sessions(std::size_t count)
+{
+  const auto limit = raise_nofile_limit();
+  return count * 2 + 64 > limit ? (limit - 64) / 2 : count;
+}
+
+// 在 IO 池上建立 count 个真实 Session，客户端 socket 以阻塞模式留在测试线程
+struct LoopbackSessions
+{
+  boost::asio::io_context _client_ioc;
+  std::vector<boost::asio::ip::tcp::socket> _clients;
+  std::vector<core::Session::Ptr> _sessions;
+
+  explicit LoopbackSessions(std::size_t count)
+  {
+    auto& io_pool = core::IO::GetInstance();
+    boost::asio::ip::tcp::acceptor acceptor(
+        _client_ioc, boost::asio::ip::tcp::endpoint(boost::asio::ip::make_address("127.0.0.1"), 0));
+    acceptor.listen(boost::asio::socket_base::max_listen_connections);
+    auto endpoint = acceptor.local_endpoint();
+
+    _clients.reserve(count);
+    _sessions.reserve(count);
+    for (std::size_t i = 0; i < count; ++i)
+    {
+      _clients.emplace_back(_client_ioc);
+      _clients.back().connect(endpoint);
+      _clients.back().set_option(boost::asio::ip::tcp::no_delay(true));
+
+      auto socket = acceptor.accept(io_pool.GetIOContext());
+      socket.set_option(boost::asio::ip::tcp::no_delay(true));
+      auto session = core::Session::Create(std::move(socket), std::weak_ptr<core::Server>{});
+      session->Start();
+      _sessions.emplace_back(std::move(session));
+    }
+  }
+
+  // 由客户端关闭连接，Session 在自己的 io 线程上感知 EOF 后退出
+  ~LoopbackSessions()
+  {
+    for (auto& client : _clients)
+    {
+      boost::system::error_code errc;
+      client.close(errc);
+    }
+    _sessions.clear();
+    std::this_thread::sleep_for(std::chrono::milliseconds(500));
+  }
+
+  LoopbackSessions(const LoopbackSessions&) = delete;
+  LoopbackSessions& operator=(const LoopbackSessions&) = delete;
+  LoopbackSessions(LoopbackSessions&&) = delete;
+  LoopbackSessions& operator=(LoopbackSessions&&) = delete;
+};
+
+std::vector<std::shared_ptr<core::SendNode>> make_burst(std::size_t frames)
+{
+  std::array<char, SMALL_FRAME_BODY> body{};
+  body.fill('x');
+
+  std::vector<std::shared_ptr<core::SendNode>> burst;
+  burst.reserve(frames);
+  for (std::size_t i = 0; i < frames; ++i)
+  {
+    burst.emplace_back(core::SendNode::Create(1, body));
+  }
+  return burst;
+}
+
+}  // namespace
+
+// 测试1: 旧版定长结构的常驻内存，与测试2使用相同的会话数
+// 前一项释放的堆内存会被后一项复用，对比时每项以 --benchmark_filter 单独运行一个进程
+static void BM_SessionBuffers_Legacy(benchmark::State& state)
+{
+  const auto count = static_cast<std::size_t>(state.range(0));
+
+  for (auto ___ : state)
+  {
+    std::vector<std::unique_ptr<LegacySessionBuffers>> buffers;
+    buffers.reserve(count);
+
+    auto before = current_rss_bytes();
+    for (std::size_t i = 0; i < count; ++i)
+    {
+      buffers.emplace_back(std::make_unique<LegacySessionBuffers>());
+    }
+    auto after = current_rss_bytes();
+
+    report_rss(state, before, after, count);
+    benchmark::DoNotOptimize(buffers.data());
+  }
+}
+BENCHMARK(BM_SessionBuffers_Legacy)->Arg(1000)->Arg(10000)->Iterations(1)->Unit(benchmark::kMillisecond);
+
+// 测试2: 新版按需分配结构的常驻内存
+static void BM_SessionBuffers_Compact(benchmark::State& state)
+{
+  const auto count = static_cast<std::size_t>(state.range(0));
+
+  for (auto ___ : state)
+  {
+    std::vector<std::unique_ptr<CompactSessionBuffers>> buffers;
+    buffers.reserve(count);
+
+    auto before = current_rss_bytes();
+    for (std::size_t i = 0; i < count; ++i)
+    {
+      buffers.emplace_back(std::make_unique<CompactSessionBuffers>());
+    }
+    auto after = current_rss_bytes();
+
+    report_rss(state, before, after, count);
+    benchmark::DoNotOptimize(buffers.data());
+  }
+}
+BENCHMARK(BM_SessionBuffers_Compact)->Arg(1000)->Arg(10000)->Iterations(1)->Unit(benchmark::kMillisecond);
+
+// 测试3: 真实 Session 通过回环连接建立后的空闲常驻内存
+static void BM_Session_LoopbackIdle(benchmark::State& state)
+{
+  const auto count = clamp_sessions(static_cast<std::size_t>(state.range(0)));
+
+  for (auto ___ : state)
+  {
+    auto before = current_rss_bytes();
+    LoopbackSessions loopback(count);
+
+    // 等待读协程全部挂起
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    auto after = current_rss_bytes();
+
+    report_rss(state, before, after, count);
+    state.counters["sessions"] = static_cast<double>(count);
+  }
+}
+BENCHMARK(BM_Session_LoopbackIdle)->Arg(1000)->Arg(5000)->Iterations(1)->Unit(benchmark::kMillisecond);
+
+// 测试4: 回环连接上逐帧 write，对应合并前的 write_loop
+static void BM_Loopback_PerFrameWrite(benchmark::State& state)
+{
+  const auto frames = static_cast<std::size_t>(state.range(0));
+  LoopbackPair pair;
+  auto burst = make_burst(frames);
+  const auto frame_size = burst.front()->GetData().size();
+  std::vector<char> sink(frames * frame_size);
+
+  for (auto ___ : state)
+  {
+    for (const auto& node : burst)
+    {
+      auto data = node->GetData();
+      boost::asio::write(pair._server, boost::asio::buffer(data.data(), data.size()));
+    }
+    boost::asio::read(pair._client, boost::asio::buffer(sink));
+  }
+
+  state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(frames));
+  state.SetBytesProcessed(state.iterations() * static_cast<std::int64_t>(sink.size()));
+}
+BENCHMARK(BM_Loopback_PerFrameWrite)->Arg(16)->Arg(64)->Arg(256);
+
+// 测试5: 回环连接上按批次合并为 writev，对应合并后的 write_loop
+static void BM_Loopback_GatherWrite(benchmark::State& state)
+{
+  using namespace global::server;
+
+  const auto frames = static_cast<std::size_t>(state.range(0));
+  LoopbackPair pair;
+  auto burst = make_burst(frames);
+  const auto frame_size = burst.front()->GetData().size();
+  std::vector<char> sink(frames * frame_size);
+  std::vector<boost::asio::const_buffer> buffers;
+  buffers.reserve(WRITE_BATCH_MAX_FRAMES);
+
+  for (auto ___ : state)
+  {
+    for (const auto& node : burst)
+    {
+      auto data = node->GetData();
+      buffers.emplace_back(data.data(), data.size());
+      if (buffers.size() == WRITE_BATCH_MAX_FRAMES)
+      {
+        boost::asio::write(pair._server, buffers);
+        buffers.clear();
+      }
+    }
+    if (!buffers.empty())
+    {
+      boost::asio::write(pair._server, buffers);
+      buffers.clear();
+    }
+    boost::asio::read(pair._client, boost::asio::buffer(sink));
+  }
+
+  state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(frames));
+  state.SetBytesProcessed(state.iterations() * static_cast<std::int64_t>(sink.size()));
+}
+BENCHMARK(BM_Loopback_GatherWrite)->Arg(16)->Arg(64)->Arg(256);
+
+// 测试6: 真实 Session 突发发送小帧，统计每次系统调用平均合并的帧数
+static void BM_Session_BurstSend(benchmark::State& state)
+{
+  const auto frames = static_cast<std::size_t>(state.range(0));
+  LoopbackSessions loopback(1);
+  auto& session = loopback._sessions.front();
+  auto& client = loopback._clients.front();
+
+  auto burst = make_burst(frames);
+  std::vector<char> sink(frames * burst.front()->GetData().size());
+  auto before = core::Session::GetWriteStats();
+
+  for (auto ___ : state)
+  {
+    for (const auto& node : burst)
+    {
+      session->Send(node);
+    }
+    boost::asio::read(client, boost::asio::buffer(sink));
+  }
+
+  auto after = core::Session::GetWriteStats();
+  const auto writes = static_cast<double>(after.writes - before.writes);
+  state.counters["frames_per_write"] = writes > 0 ? static_cast<double>(after.frames - before.frames) / writes : 0.0;
+  state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(frames));
+  state.SetBytesProcessed(state.iterations() * static_cast<std::int64_t>(sink.size()));
+}
+BENCHMARK(BM_Session_BurstSend)->Arg(16)->Arg(64)->Arg(256)->UseRealTime();
+
+// 测试7: 大量在线会话下单帧 Send 到客户端 socket 可读的延迟，轮询所有会话以覆盖空闲到忙碌的唤醒路径
+static void BM_Session_SendLatency(benchmark::State& state)
+{
+  const auto count = clamp_sessions(static_cast<std::size_t>(state.range(0)));
+  LoopbackSessions loopback(count);
+
+  auto node = make_burst(1).front();
+  std::vector<char> sink(node->GetData().size());
+  std::vector<double> samples;
+  samples.reserve(1 << 16);
+  std::size_t idx = 0;
+
+  for (auto ___ : state)
+  {
+    auto& session = loopback._sessions[idx % count];
+    auto& client = loopback._clients[idx % count];
+    ++idx;
+
+    auto start = std::chrono::steady_clock::now();
+    session->Send(node);
+    boost::asio::read(client, boost::asio::buffer(sink));
+    samples.push_back(std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count());
+  }
+
+  std::ranges::sort(samples);
+  state.counters["sessions"] = static_cast<double>(count);
+  state.counters["p50_us"] = samples[samples.size() / 2];
+  state.counters["p99_us"] = samples[samples.size() * 99 / 100];
+}
+BENCHMARK(BM_Session_SendLatency)->Arg(1000)->Arg(10000)->UseRealTime();
+
+// 测试8: 客户端停止读取后持续发送 1KB 普通帧，参数 0 为不设水位（改造前的无界队列），1 为默认水位加 DROP_OLDEST
+static void BM_Session_SlowConsumer(benchmark::State& state)
+{
+  constexpr std::size_t BODY_LEN = 1024;
+
+  LoopbackSessions loopback(1);
+  auto& session = loopback._sessions.front();
+  if (state.range(0) == 0)
+  {
+    constexpr auto UNBOUNDED = std::numeric_limits<std::size_t>::max();
+    session->SetSendLimits(
+        {.high_bytes = UNBOUNDED, .low_bytes = UNBOUNDED, .high_frames = UNBOUNDED, .low_frames = UNBOUNDED});
+  }
+
+  std::vector<char> body(BODY_LEN, 'x');
+  auto before = core::Session::GetBackpressureStats();
+  std::size_t peak = 0;
+
+  for (auto ___ : state)
+  {
+    session->Send(core::SendNode::Create(1, body));
+    peak = std::max(peak, session->GetQueuedBytes());
+  }
+
+  auto after = core::Session::GetBackpressureStats();
+  state.counters["peak_queued_MB"] = static_cast<double>(peak) / BYTES_PER_MB;
+  state.counters["frames_dropped"] = static_cast<double>(after.frames_dropped - before.frames_dropped);
+  state.counters["stall_events"] = static_cast<double>(after.stall_events - before.stall_events);
+}
+BENCHMARK(BM_Session_SlowConsumer)->Arg(0)->Arg(1)->Iterations(100000)->UseRealTime();
+
+// 测试9: 客户端暂停读取时积压 2000 个普通帧，再发送一帧心跳回包，恢复读取后统计它之前到达的帧数
+// 参数 0 时探测帧使用普通消息 id，与改造前单队列的顺序一致；1 时为控制帧，走优先通道
+static void BM_Session_ControlBehindBacklog(benchmark::State& state)
+{
+  constexpr std::size_t BACKLOG = 2000;
+  constexpr std::size_t BODY_LEN = 1024;
+  constexpr short BULK_PROBE_ID = 2;
+
+  LoopbackSessions loopback(1);
+  auto& session = loopback._sessions.front();
+  auto& client = loopback._clients.front();
+
+  auto probe_id = state.range(0) == 0 ? BULK_PROBE_ID : utils::ID_HEARTBEAT_RESPONSE;
+  std::vector<char> body(BODY_LEN, 'x');
+  std::array<char, global::server::MSG_HEAD_TOTAL_LEN> head{};
+  std::vector<char> sink(BODY_LEN);
+  double frames_ahead = 0;
+
+  for (auto ___ : state)
+  {
+    for (std::size_t i = 0; i < BACKLOG; ++i)
+    {
+      session->Send(core::SendNode::Create(1, body));
+    }
+    session->Send(core::SendNode::Create(probe_id, std::span<const char>(body.data(), 1)));
+
+    // 逐帧读取，直到读到探测帧，再读完剩余的积压
+    std::size_t received = 0;
+    std::size_t position = 0;
+    while (received < BACKLOG + 1)
+    {
+      boost::asio::read(client, boost::asio::buffer(head));
+      std::uint16_t net_id = 0;
+      std::uint16_t net_len = 0;
+      std::memcpy(&net_id, head.data(), sizeof(net_id));
+      std::memcpy(&net_len, head.data() + sizeof(net_id), sizeof(net_len));
+      boost::asio::read(client,
+                        boost::asio::buffer(sink.data(), boost::asio::detail::socket_ops::network_to_host_short(net_len)));
+
+      ++received;
+      if (static_cast<short>(boost::asio::detail::socket_ops::network_to_host_short(net_id)) == probe_id)
+      {
+        position = received - 1;
+      }
+    }
+    frames_ahead += static_cast<double>(position);
+  }
+
+  state.counters["frames_ahead"] = frames_ahead / static_cast<double>(state.iterations());
+}
+BENCHMARK(BM_Session_ControlBehindBacklog)->Arg(0)->Arg(1)->UseRealTime();
+
+BENCHMARK_MAIN();
@@ -0,0 +1,122 @@
+/******************************************************************************
+ *
+ * @file       bench_session_registry.cc
+ * @brief      在线会话表基准测试
+ *
+ * @author     KBchulan
+ * @date       2026/10/18
+ * @history    多个 io 线程同时接入与断开会话时，单锁会话表与按 io_context 分片的会话表的吞吐
+ ******************************************************************************/
+
+#include <benchmark/benchmark.h>
+
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/ip/tcp.hpp>
+#include <core/server/session_registry.hpp>
+#include <core/session/session.hpp>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace
+{
+
+constexpr std::size_t MAX_THREADS = 16;              // 模拟的 io 线程数上限
+constexpr std::size_t SESSIONS_PER_THREAD = 4096;    // 每个线程轮流接入、断开的会话数
+constexpr std::size_t ONLINE_PER_THREAD = 2048;      // 每个线程保持在线的会话数，接入一个的同时断开最早的一个
+
+// 改造前 Server 中的会话表：一把锁保护整张表
+class LegacyRegistry
+{
+public:
+  void Add(const std::shared_ptr<core::Session>& session)
+  {
+    std::lock_guard lock{_mutex};
+    _sessions[session->GetUuid()] = session;
+  }
+
+  void Remove(const core::Session& session)
+  {
+    std::lock_guard lock{_mutex};
+    _sessions.erase(session.GetUuid());
+  }
+
+private:
+  std::mutex _mutex;
+  std::unordered_map<std::string, std::shared_ptr<core::Session>> _sessions;
+};
+
+// 每个模拟 io 线程预先创建好的会话，下标即分片，进程内只创建一次且不析构
+const std::vector<std::vector<std::shared_ptr<core::Session>>>& session_pool()
+{
+  static auto* pool = []
+  {
+    auto* io_context = new boost::asio::io_context();
+    auto* sessions = new std::vector<std::vector<std::shared_ptr<core::Session>>>(MAX_THREADS);
+    for (std::size_t thread = 0; thread < MAX_THREADS; ++thread)
+    {
+      auto& group = (*sessions)[thread];
+      group.reserve(SESSIONS_PER_THREAD);
+      for (std::size_t i = 0; i < SESSIONS_PER_THREAD; ++i)
+      {
+        group.emplace_back(
+            core::Session::Create(boost::asio::ip::tcp::socket(*io_context), std::weak_ptr<core::Server>{}, thread));
+      }
+    }
+    return sessions;
+  }();
+  return *pool;
+}
+
+// 每次迭代为一次接入加一次断开，与重连风暴中的会话表操作一致，churn_per_sec 为全部线程合计，目标为 5 万次每秒
+template <typename Registry>
+void churn(benchmark::State& state, Registry& registry)
+{
+  const auto& sessions = session_pool()[static_cast<std::size_t>(state.thread_index()) % MAX_THREADS];
+
+  for (std::size_t i = 0; i < ONLINE_PER_THREAD; ++i)
+  {
+    registry.Add(sessions[i]);
+  }
+
+  std::size_t next = ONLINE_PER_THREAD;
+  for (auto _ : state)
+  {
+    registry.Add(sessions[next % SESSIONS_PER_THREAD]);
+    registry.Remove(*sessions[(next - ONLINE_PER_THREAD) % SESSIONS_PER_THREAD]);
+    ++next;
+  }
+
+  for (std::size_t i = next - ONLINE_PER_THREAD; i < next; ++i)
+  {
+    registry.Remove(*sessions[i % SESSIONS_PER_THREAD]);
+  }
+
+  state.counters["churn_per_sec"] =
+      benchmark::Counter(static_cast<double>(state.iterations()), benchmark::Counter::kIsRate);
+}
+
+}  // namespace
+
+// 测试1: 单锁会话表，所有 io 线程竞争同一把锁
+static void BM_SessionRegistry_Legacy(benchmark::State& state)
+{
+  static LegacyRegistry registry;
+  session_pool();
+  churn(state, registry);
+}
+BENCHMARK(BM_SessionRegistry_Legacy)->ThreadRange(1, 16)->UseRealTime();
+
+// 测试2: 按 io_context 分片，每个线程只操作自己的分片
+static void BM_SessionRegistry_Sharded(benchmark::State& state)
+{
+  static core::SessionRegistry registry(MAX_THREADS);
+  session_pool();
+  churn(state, registry);
+}
+BENCHMARK(BM_SessionRegistry_Sharded)->ThreadRange(1, 16)->UseRealTime();
+
+BENCHMARK_MAIN();
@@ -0,0 +1,142 @@
+/******************************************************************************
+ *
+ * @file       bench_timing_wheel.cc
+ * @brief      会话空闲检测基准测试
+ *
+ * @author     KBchulan
+ * @date       2026/10/18
+ * @history    10 万个会话按心跳间隔刷新时，单个时间轮与每个会话一个 steady_timer 的内存与 CPU 开销
+ ******************************************************************************/
+
+#include <benchmark/benchmark.h>
+#include <malloc.h>
+
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/steady_timer.hpp>
+#include <chrono>
+#include <core/timer/timing-wheel.hpp>
+#include <cstddef>
+#include <global/Global.hpp>
+#include <memory>
+#include <vector>
+
+namespace
+{
+
+using namespace global::server;
+
+constexpr auto TICK = std::chrono::milliseconds(IDLE_WHEEL_TICK_MS);
+constexpr auto IDLE_TIMEOUT = std::chrono::seconds(SESSION_IDLE_TIMEOUT_S);
+constexpr std::size_t HEARTBEAT_TICKS = HEARTBEAT_INTERVAL_S * 1000 / IDLE_WHEEL_TICK_MS;
+
+class IdleNode final : public core::TimingWheel::Node
+{
+public:
+  std::size_t expired = 0;
+
+protected:
+  void OnExpire() override
+  {
+    ++expired;
+  }
+};
+
+std::size_t heap_in_use()
+{
+  return mallinfo2().uordblks;
+}
+
+// 每次迭代模拟 1 秒：1/30 的会话收到心跳，再走一个刻度，因此每次迭代的耗时除以 1 秒即为占用的 CPU 比例
+void report(benchmark::State& state, std::size_t sessions, std::size_t heap_bytes)
+{
+  state.counters["bytes_per_session"] = static_cast<double>(heap_bytes) / static_cast<double>(sessions);
+  state.counters["heap_MB"] = static_cast<double>(heap_bytes) / (1024.0 * 1024.0);
+}
+
+}  // namespace
+
+// 测试1: 单个时间轮，刷新只改写到期刻度，每个刻度只处理一个槽位
+static void BM_IdleWheel(benchmark::State& state)
+{
+  auto sessions = static_cast<std::size_t>(state.range(0));
+  boost::asio::io_context io_context;
+
+  auto heap_before = heap_in_use();
+  auto wheel = std::make_shared<core::TimingWheel>(io_context, TICK, IDLE_WHEEL_SLOTS);
+  auto nodes = std::make_unique<IdleNode[]>(sessions);
+  for (std::size_t i = 0; i < sessions; ++i)
+  {
+    wheel->Add(nodes[i], IDLE_TIMEOUT);
+  }
+  auto heap_bytes = heap_in_use() - heap_before;
+
+  auto heartbeat = [&](std::size_t second)
+  {
+    for (std::size_t i = second % HEARTBEAT_TICKS; i < sessions; i += HEARTBEAT_TICKS)
+    {
+      wheel->Touch(nodes[i]);
+    }
+    return wheel->Advance();
+  };
+
+  // 同时加入的会话挂在同一个槽位上，先走过一个超时周期，让到期刻度按心跳时刻分散开
+  std::size_t second = 0;
+  for (; second < 2 * static_cast<std::size_t>(SESSION_IDLE_TIMEOUT_S); ++second)
+  {
+    heartbeat(second);
+  }
+
+  for (auto _ : state)
+  {
+    benchmark::DoNotOptimize(heartbeat(second++));
+  }
+
+  if (wheel->Size() != sessions)
+  {
+    state.SkipWithError("sessions expired while heartbeating");
+  }
+
+  for (std::size_t i = 0; i < sessions; ++i)
+  {
+    wheel->Remove(nodes[i]);
+  }
+  report(state, sessions, heap_bytes);
+}
+BENCHMARK(BM_IdleWheel)->Arg(10000)->Arg(100000)->Unit(benchmark::kMicrosecond);
+
+// 测试2: 每个会话一个 steady_timer，心跳时重新设置到期时间，旧的等待以 operation_aborted 完成后再次等待
+static void BM_IdlePerSessionTimer(benchmark::State& state)
+{
+  auto sessions = static_cast<std::size_t>(state.range(0));
+  boost::asio::io_context io_context;
+
+  auto heap_before = heap_in_use();
+  std::vector<boost::asio::steady_timer> timers;
+  timers.reserve(sessions);
+  for (std::size_t i = 0; i < sessions; ++i)
+  {
+    auto& timer = timers.emplace_back(io_context, IDLE_TIMEOUT);
+    timer.async_wait([](const boost::system::error_code&) {});
+  }
+  auto heap_bytes = heap_in_use() - heap_before;
+
+  std::size_t second = 0;
+  for (auto _ : state)
+  {
+    for (std::size_t i = second % HEARTBEAT_TICKS; i < sessions; i += HEARTBEAT_TICKS)
+    {
+      timers[i].expires_after(IDLE_TIMEOUT);
+      timers[i].async_wait([](const boost::system::error_code&) {});
+    }
+    io_context.poll();
+    io_context.restart();
+    ++second;
+  }
+
+  timers.clear();
+  io_context.poll();
+  report(state, sessions, heap_bytes);
+}
+BENCHMARK(BM_IdlePerSessionTimer)->Arg(10000)->Arg(100000)->Unit(benchmark::kMicrosecond);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,164 @@
+/******************************************************************************
+ *
+ * @file       bench_chat_relay.cc
+ * @brief      跨服消息转发基准测试
+ *
+ * @author     KBchulan
+ * @date       2026/10/18
+ * @history    两个进程经回环地址上的双向流转发消息，对比不同合并上限下的每秒帧数与空闲时的往返延迟
+ ******************************************************************************/
+
+#include <benchmark/benchmark.h>
+#include <grpcpp/security/server_credentials.h>
+#include <grpcpp/server.h>
+#include <grpcpp/server_builder.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <csignal>
+#include <cstdint>
+#include <global/Global.hpp>
+#include <string>
+#include <thread>
+#include <utils/grpc/client/chat_server_client.hpp>
+#include <utils/grpc/service/chat_service.hpp>
+
+namespace
+{
+
+constexpr std::size_t FRAMES_PER_ROUND = 20000;      // 每轮转发的帧数
+constexpr std::size_t BODY_SIZE = 160;               // 与单条聊天消息的 JSON 长度相当
+constexpr auto ACK_TIMEOUT = std::chrono::seconds(10);  // 等待确认的上限，超过视为流已断开
+
+std::string g_peer;
+
+// 子进程：对端 ChatServer 的转发接收端，处理函数只确认不投递
+[[noreturn]] void run_peer(int port_fd)
+{
+  utils::ChatServiceImpl service([](const utils::RelayFrame& /*frame*/) { return true; });
+
+  int port = 0;
+  grpc::ServerBuilder builder;
+  builder.AddListeningPort("127.0.0.1:0", grpc::InsecureServerCredentials(), &port);
+  builder.SetMaxReceiveMessageSize(global::server::RPC_MAX_SEND_RECV_SIZE);
+  builder.RegisterService(&service);
+  auto server = builder.BuildAndStart();
+
+  (void)write(port_fd, &port, sizeof(port));
+  close(port_fd);
+
+  // 由父进程结束
+  server->Wait();
+  _exit(0);
+}
+
+bool wait_acked(std::uint64_t target)
+{
+  auto deadline = std::chrono::steady_clock::now() + ACK_TIMEOUT;
+  while (utils::ChatServerClient::GetInstance().GetStats().frames_acked < target)
+  {
+    if (std::chrono::steady_clock::now() > deadline)
+    {
+      return false;
+    }
+    std::this_thread::yield();
+  }
+  return true;
+}
+
+}  // namespace
+
+// 测试1: 一轮转发 2 万帧直到全部确认，参数为单次写入合并的帧数上限，1 即每条消息单独写入一次
+static void BM_Relay_Throughput(benchmark::State& state)
+{
+  auto& client = utils::ChatServerClient::GetInstance();
+  client.Init({g_peer}, static_cast<std::size_t>(state.range(0)));
+  std::string body(BODY_SIZE, 'x');
+  auto base = client.GetStats();
+
+  for (auto _ : state)
+  {
+    auto target = client.GetStats().frames_acked + FRAMES_PER_ROUND;
+    for (std::size_t i = 0; i < FRAMES_PER_ROUND; ++i)
+    {
+      client.Relay(g_peer, "uid", 1, utils::WireProtocol::JSON, body);
+    }
+
+    if (!wait_acked(target))
+    {
+      state.SkipWithError("relay stream stalled");
+      return;
+    }
+  }
+
+  auto stats = client.GetStats();
+  auto batches = stats.batches_sent - base.batches_sent;
+  state.counters["frames_per_sec"] = benchmark::Counter(
+      static_cast<double>(state.iterations() * FRAMES_PER_ROUND), benchmark::Counter::kIsRate);
+  state.counters["frames_per_batch"] =
+      batches == 0 ? 0.0 : static_cast<double>(stats.frames_sent - base.frames_sent) / static_cast<double>(batches);
+  state.counters["dropped"] = static_cast<double>(stats.frames_dropped - base.frames_dropped);
+}
+BENCHMARK(BM_Relay_Throughput)
+    ->Arg(1)
+    ->Arg(16)
+    ->Arg(global::server::RELAY_BATCH_MAX_FRAMES)
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
+
+// 测试2: 流空闲时单帧从入队到收到确认的往返时间，合并不应引入额外等待
+static void BM_Relay_IdleLatency(benchmark::State& state)
+{
+  auto& client = utils::ChatServerClient::GetInstance();
+  client.Init({g_peer});
+  std::string body(BODY_SIZE, 'x');
+
+  for (auto _ : state)
+  {
+    auto target = client.GetStats().frames_acked + 1;
+    client.Relay(g_peer, "uid", 1, utils::WireProtocol::JSON, body);
+
+    if (!wait_acked(target))
+    {
+      state.SkipWithError("relay stream stalled");
+      return;
+    }
+  }
+}
+BENCHMARK(BM_Relay_IdleLatency)->UseRealTime()->Unit(benchmark::kMicrosecond);
+
+// gRPC 初始化之后不能安全地 fork，先启动对端进程，再在本进程中建立转发流
+int main(int argc, char** argv)
+{
+  int fds[2] = {-1, -1};
+  if (pipe(fds) != 0)
+  {
+    return 1;
+  }
+
+  pid_t child = fork();
+  if (child == 0)
+  {
+    close(fds[0]);
+    run_peer(fds[1]);
+  }
+
+  close(fds[1]);
+  int port = 0;
+  if (child < 0 || read(fds[0], &port, sizeof(port)) != static_cast<ssize_t>(sizeof(port)) || port == 0)
+  {
+    return 1;
+  }
+  close(fds[0]);
+  g_peer = "127.0.0.1:" + std::to_string(port);
+
+  benchmark::Initialize(&argc, argv);
+  benchmark::RunSpecifiedBenchmarks();
+  benchmark::Shutdown();
+
+  utils::ChatServerClient::GetInstance().Shutdown();
+  kill(child, SIGTERM);
+  waitpid(child, nullptr, 0);
+  return 0;
+}
@@ -0,0 +1,104 @@
+/******************************************************************************
+ *
+ * @file       bench_codec.cc
+ * @brief      消息体编解码基准测试
+ *
+ * @author     KBchulan
+ * @date       2026/10/18
+ * @history    同一消息在 JSON 与 protobuf 编码下的编解码耗时与线上字节数
+ ******************************************************************************/
+
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <string>
+#include <utils/codec/message_codec.hpp>
+
+namespace
+{
+
+// 与线上登录响应大小相当的样本，头像为 url
+template <typename Message>
+Message sample();
+
+template <>
+utils::LoginChatResponse sample<utils::LoginChatResponse>()
+{
+  utils::LoginChatResponse msg;
+  msg.set_code(utils::SUCCESS);
+  msg.set_message("Login successful");
+  msg.set_protocol(static_cast<std::uint32_t>(utils::WireProtocol::PROTOBUF));
+  msg.mutable_data()->set_nickname("KBchulan");
+  msg.mutable_data()->set_avatar("https://static.chatroom.example/avatar/6f1c0d2e-8a4b-4c3e-9d7f-2b1a0e5c4d3f.png");
+  msg.mutable_data()->set_email("kbchulan@example.com");
+  return msg;
+}
+
+template <>
+utils::ExitLoginRequest sample<utils::ExitLoginRequest>()
+{
+  utils::ExitLoginRequest msg;
+  msg.set_uuid("6f1c0d2e-8a4b-4c3e-9d7f-2b1a0e5c4d3f");
+  return msg;
+}
+
+template <>
+utils::ExitLoginResponse sample<utils::ExitLoginResponse>()
+{
+  utils::ExitLoginResponse msg;
+  msg.set_code(utils::SUCCESS);
+  msg.set_message("Exit login successful");
+  return msg;
+}
+
+}  // namespace
+
+// 测试1: 编码耗时，参数为 WireProtocol 取值，1 为 JSON，2 为 protobuf
+template <typename Message>
+static void BM_Codec_Encode(benchmark::State& state)
+{
+  auto protocol = static_cast<utils::WireProtocol>(state.range(0));
+  auto msg = sample<Message>();
+
+  std::size_t bytes = 0;
+  for (auto _ : state)
+  {
+    auto body = utils::MessageCodec::Encode(protocol, msg);
+    bytes = body.size();
+    benchmark::DoNotOptimize(body);
+  }
+
+  state.counters["wire_bytes"] = static_cast<double>(bytes);
+  state.SetBytesProcessed(static_cast<std::int64_t>(state.iterations() * bytes));
+}
+BENCHMARK_TEMPLATE(BM_Codec_Encode, utils::LoginChatResponse)->Arg(1)->Arg(2);
+BENCHMARK_TEMPLATE(BM_Codec_Encode, utils::ExitLoginRequest)->Arg(1)->Arg(2);
+BENCHMARK_TEMPLATE(BM_Codec_Encode, utils::ExitLoginResponse)->Arg(1)->Arg(2);
+
+// 测试2: 解码耗时，输入为同一编码下预先编码好的消息体
+template <typename Message>
+static void BM_Codec_Decode(benchmark::State& state)
+{
+  auto protocol = static_cast<utils::WireProtocol>(state.range(0));
+  auto body = utils::MessageCodec::Encode(protocol, sample<Message>());
+
+  std::size_t failed = 0;
+  for (auto _ : state)
+  {
+    Message msg;
+    if (!utils::MessageCodec::Decode(protocol, body, msg))
+    {
+      ++failed;
+    }
+    benchmark::DoNotOptimize(msg);
+  }
+
+  state.counters["wire_bytes"] = static_cast<double>(body.size());
+  state.counters["failed"] = static_cast<double>(failed);
+  state.SetBytesProcessed(static_cast<std::int64_t>(state.iterations() * body.size()));
+}
+BENCHMARK_TEMPLATE(BM_Codec_Decode, utils::LoginChatResponse)->Arg(1)->Arg(2);
+BENCHMARK_TEMPLATE(BM_Codec_Decode, utils::ExitLoginRequest)->Arg(1)->Arg(2);
+BENCHMARK_TEMPLATE(BM_Codec_Decode, utils::ExitLoginResponse)->Arg(1)->Arg(2);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,217 @@
+/******************************************************************************
+ *
+ * @file       bench_redis_client.cc
+ * @brief      Redis 客户端基准测试
+ *
+ * @author     KBchulan
+ * @date       2026/10/18
+ * @history    本地桩 Redis 下 RedisPool 与 AsyncRedisClient 在高并发调用时的每秒命令数
+ ******************************************************************************/
+
+#include <benchmark/benchmark.h>
+#include <hiredis/hiredis.h>
+
+#include <array>
+#include <atomic>
+#include <boost/asio/co_spawn.hpp>
+#include <boost/asio/detached.hpp>
+#include <boost/asio/executor_work_guard.hpp>
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/asio/steady_timer.hpp>
+#include <boost/asio/use_awaitable.hpp>
+#include <boost/asio/write.hpp>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+#include <utils/pool/redis/async_redis_client.hpp>
+#include <utils/pool/redis/redis_pool.hpp>
+#include <vector>
+
+namespace
+{
+
+constexpr auto STUB_RTT = std::chrono::microseconds(200);  // 桩服务每批命令的处理延迟，模拟跨机房往返
+constexpr std::size_t IO_THREADS = 4;                       // 运行异步客户端的 io 线程数
+constexpr std::size_t OPS_PER_CALLER = 64;                  // 每个调用方每轮执行的命令数
+
+// 本地桩 Redis，解析 RESP 请求后对每条命令回复 +PONG，一次读到的命令批量回复
+boost::asio::awaitable<void> serve(boost::asio::ip::tcp::socket socket)
+{
+  std::unique_ptr<redisReader, void (*)(redisReader*)> reader(redisReaderCreate(), redisReaderFree);
+  std::array<char, 16384> buffer{};
+  boost::asio::steady_timer timer(socket.get_executor());
+
+  try
+  {
+    while (true)
+    {
+      auto bytes = co_await socket.async_read_some(boost::asio::buffer(buffer), boost::asio::use_awaitable);
+      redisReaderFeed(reader.get(), buffer.data(), bytes);
+
+      std::string replies;
+      void* request = nullptr;
+      while (redisReaderGetReply(reader.get(), &request) == REDIS_OK && request != nullptr)
+      {
+        replies += "+PONG\r\n";
+        freeReplyObject(request);
+      }
+
+      timer.expires_after(STUB_RTT);
+      co_await timer.async_wait(boost::asio::use_awaitable);
+      co_await boost::asio::async_write(socket, boost::asio::buffer(replies), boost::asio::use_awaitable);
+    }
+  }
+  catch (const boost::system::system_error&)
+  {
+  }
+}
+
+boost::asio::awaitable<void> listen(boost::asio::ip::tcp::acceptor& acceptor)
+{
+  while (true)
+  {
+    auto socket = co_await acceptor.async_accept(boost::asio::use_awaitable);
+    boost::asio::co_spawn(acceptor.get_executor(), serve(std::move(socket)), boost::asio::detached);
+  }
+}
+
+// 客户端使用的 io 线程池，与 core::IO 的结构一致
+struct ClientIO
+{
+  std::vector<std::unique_ptr<boost::asio::io_context>> contexts;
+  std::vector<boost::asio::executor_work_guard<boost::asio::io_context::executor_type>> guards;
+  std::vector<std::jthread> threads;
+
+  ClientIO()
+  {
+    for (std::size_t i = 0; i < IO_THREADS; ++i)
+    {
+      auto& ioc = *contexts.emplace_back(std::make_unique<boost::asio::io_context>());
+      guards.push_back(boost::asio::make_work_guard(ioc));
+      threads.emplace_back([&ioc] { ioc.run(); });
+    }
+  }
+};
+
+// 进程内只启动一次桩服务，并初始化两种客户端；对象都不析构，避免与单例的析构顺序冲突
+ClientIO& ensure_stub_server()
+{
+  static auto* client_io = []
+  {
+    auto* server_ioc = new boost::asio::io_context();
+    auto* acceptor = new boost::asio::ip::tcp::acceptor(
+        *server_ioc, boost::asio::ip::tcp::endpoint(boost::asio::ip::make_address("127.0.0.1"), 0));
+    boost::asio::co_spawn(*server_ioc, listen(*acceptor), boost::asio::detached);
+    std::thread([server_ioc] { server_ioc->run(); }).detach();
+
+    utils::RedisConfig config{.host = "127.0.0.1",
+                              .port = acceptor->local_endpoint().port(),
+                              .password = "",
+                              .db_index = 0,
+                              .pool_size = global::server::REDIS_MAX_POOL_SIZE,
+                              .timeout = std::chrono::seconds(1)};
+    utils::RedisPool::GetInstance().Init(config);
+
+    auto* io = new ClientIO();
+    std::vector<boost::asio::any_io_executor> executors;
+    for (auto& ioc : io->contexts)
+    {
+      executors.emplace_back(ioc->get_executor());
+    }
+    config.pool_size = global::server::REDIS_ASYNC_CONNECTIONS;
+    utils::AsyncRedisClient::GetInstance().Init(config, executors);
+
+    // 等待后台协程完成建连
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    return io;
+  }();
+  return *client_io;
+}
+
+void wait_until_zero(std::atomic<std::size_t>& pending)
+{
+  for (auto left = pending.load(std::memory_order_acquire); left != 0; left = pending.load(std::memory_order_acquire))
+  {
+    pending.wait(left, std::memory_order_acquire);
+  }
+}
+
+}  // namespace
+
+// 测试1: N 个线程通过 RedisPool 同步调用，超过连接数的线程在连接池上等待
+static void BM_Redis_PoolSync(benchmark::State& state)
+{
+  ensure_stub_server();
+  auto callers = static_cast<std::size_t>(state.range(0));
+
+  std::atomic<std::size_t> failed{0};
+  for (auto _ : state)
+  {
+    std::vector<std::jthread> threads;
+    threads.reserve(callers);
+    for (std::size_t i = 0; i < callers; ++i)
+    {
+      threads.emplace_back(
+          [&failed]
+          {
+            for (std::size_t op = 0; op < OPS_PER_CALLER; ++op)
+            {
+              auto conn = utils::RedisPool::GetInstance().GetConnection();
+              if (!conn.Ping().IsValid())
+              {
+                failed.fetch_add(1, std::memory_order_relaxed);
+              }
+            }
+          });
+    }
+  }
+
+  auto commands = state.iterations() * callers * OPS_PER_CALLER;
+  state.counters["cmds_per_sec"] = benchmark::Counter(static_cast<double>(commands), benchmark::Counter::kIsRate);
+  state.counters["failed"] = static_cast<double>(failed.load(std::memory_order_relaxed));
+}
+BENCHMARK(BM_Redis_PoolSync)->Arg(16)->Arg(64)->UseRealTime()->Unit(benchmark::kMillisecond);
+
+// 测试2: N 个协程分布在 io 线程上通过 AsyncRedisClient 调用，命令在少量连接上流水线复用
+static void BM_Redis_AsyncClient(benchmark::State& state)
+{
+  auto& io = ensure_stub_server();
+  auto callers = static_cast<std::size_t>(state.range(0));
+
+  std::atomic<std::size_t> failed{0};
+  for (auto _ : state)
+  {
+    std::atomic<std::size_t> pending{callers};
+    for (std::size_t i = 0; i < callers; ++i)
+    {
+      boost::asio::co_spawn(
+          *io.contexts[i % io.contexts.size()],
+          [&pending, &failed]() -> boost::asio::awaitable<void>
+          {
+            for (std::size_t op = 0; op < OPS_PER_CALLER; ++op)
+            {
+              auto reply = co_await utils::AsyncRedisClient::GetInstance().Ping();
+              if (!reply.IsValid())
+              {
+                failed.fetch_add(1, std::memory_order_relaxed);
+              }
+            }
+            if (pending.fetch_sub(1, std::memory_order_acq_rel) == 1)
+            {
+              pending.notify_one();
+            }
+          },
+          boost::asio::detached);
+    }
+    wait_until_zero(pending);
+  }
+
+  auto commands = state.iterations() * callers * OPS_PER_CALLER;
+  state.counters["cmds_per_sec"] = benchmark::Counter(static_cast<double>(commands), benchmark::Counter::kIsRate);
+  state.counters["failed"] = static_cast<double>(failed.load(std::memory_order_relaxed));
+}
+BENCHMARK(BM_Redis_AsyncClient)->Arg(16)->Arg(64)->Arg(512)->UseRealTime()->Unit(benchmark::kMillisecond);
+
+BENCHMARK_MAIN();
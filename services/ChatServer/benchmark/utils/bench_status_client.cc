@@ -0,0 +1,120 @@
+/******************************************************************************
+ *
+ * @file       bench_status_client.cc
+ * @brief      StatusServer 登录校验客户端基准测试
+ *
+ * @author     KBchulan
+ * @date       2026/10/18
+ * @history    本地桩 StatusServer 下同步与异步 VerifyLoginInfo 的每秒登录数
+ ******************************************************************************/
+
+#include <benchmark/benchmark.h>
+#include <grpcpp/security/server_credentials.h>
+#include <grpcpp/server.h>
+#include <grpcpp/server_builder.h>
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+#include <utils/grpc/client/status_server_client.hpp>
+
+namespace
+{
+
+constexpr auto STUB_RTT = std::chrono::milliseconds(1);  // 桩服务模拟的校验耗时
+constexpr std::size_t CLIENT_CHANNELS = 8;               // 客户端 channel 数量，与线上配置一致
+
+// 本地桩 StatusServer，固定延迟后返回成功
+class StubStatusService final : public utils::StatusService::Service
+{
+public:
+  grpc::Status LoginVerify(grpc::ServerContext* /*context*/, const utils::LoginVerifyRequest* /*request*/,
+                           utils::LoginVerifyResponse* response) override
+  {
+    std::this_thread::sleep_for(STUB_RTT);
+    response->set_code(0);
+    response->set_message("ok");
+    return grpc::Status::OK;
+  }
+};
+
+// 进程内只启动一次桩服务，并把客户端指向它
+void ensure_stub_server()
+{
+  static StubStatusService service;
+  static std::unique_ptr<grpc::Server> server = []
+  {
+    int port = 0;
+    grpc::ServerBuilder builder;
+    builder.AddListeningPort("127.0.0.1:0", grpc::InsecureServerCredentials(), &port);
+    builder.RegisterService(&service);
+    auto built = builder.BuildAndStart();
+
+    utils::StatusServerClinet::GetInstance().Init("127.0.0.1:" + std::to_string(port), CLIENT_CHANNELS);
+    return built;
+  }();
+  (void)server;
+}
+
+}  // namespace
+
+// 测试1: 同步校验，等价于原先在唯一逻辑线程上串行调用
+static void BM_VerifyLogin_Sync(benchmark::State& state)
+{
+  ensure_stub_server();
+  auto& client = utils::StatusServerClinet::GetInstance();
+
+  for (auto _ : state)
+  {
+    auto res = client.VerifyLoginInfo("uuid", "token");
+    benchmark::DoNotOptimize(res);
+  }
+
+  state.counters["logins_per_sec"] = benchmark::Counter(static_cast<double>(state.iterations()),
+                                                        benchmark::Counter::kIsRate);
+}
+BENCHMARK(BM_VerifyLogin_Sync)->UseRealTime()->Unit(benchmark::kMillisecond);
+
+// 测试2: 异步校验，一次发出 N 个登录请求，全部完成为一轮
+static void BM_VerifyLogin_Async(benchmark::State& state)
+{
+  ensure_stub_server();
+  auto& client = utils::StatusServerClinet::GetInstance();
+  auto logins = static_cast<std::size_t>(state.range(0));
+
+  std::atomic<std::size_t> failed{0};
+  for (auto _ : state)
+  {
+    std::atomic<std::size_t> pending{logins};
+    for (std::size_t i = 0; i < logins; ++i)
+    {
+      client.AsyncVerifyLoginInfo("uuid", "token",
+                                  [&pending, &failed](utils::LoginVerifyResult res)
+                                  {
+                                    if (!res)
+                                    {
+                                      failed.fetch_add(1, std::memory_order_relaxed);
+                                    }
+                                    if (pending.fetch_sub(1, std::memory_order_acq_rel) == 1)
+                                    {
+                                      pending.notify_one();
+                                    }
+                                  });
+    }
+
+    for (auto left = pending.load(std::memory_order_acquire); left != 0;
+         left = pending.load(std::memory_order_acquire))
+    {
+      pending.wait(left, std::memory_order_acquire);
+    }
+  }
+
+  state.counters["logins_per_sec"] = benchmark::Counter(static_cast<double>(state.iterations() * logins),
+                                                        benchmark::Counter::kIsRate);
+  state.counters["failed"] = static_cast<double>(failed.load(std::memory_order_relaxed));
+}
+BENCHMARK(BM_VerifyLogin_Async)->Arg(64)->Arg(512)->UseRealTime()->Unit(benchmark::kMillisecond);
+
+BENCHMARK_MAIN();
@@ -73,39 +73,119 @@ constexpr std::chrono::microseconds FLUSH_POLL_INTERVAL{100};
 namespace server
 {
 
-constexpr unsigned short DEFAULT_SERVER_PORT = 10004;  // 默认服务器端口
-constexpr std::int8_t IO_CONTEXT_POOL_SIZE = 8;        // io_context 池子大小
-constexpr std::int8_t MSG_TYPE_LENGTH = 2;             // 消息类型长度
-constexpr std::int8_t MSG_LEN_LENGTH = 2;              // 消息长度字段长度
-constexpr std::int8_t MSG_HEAD_TOTAL_LEN = 4;          // 消息头总长度
-constexpr std::size_t RECV_BUFFER_SIZE = 8192;         // 接收缓冲区大小
-constexpr std::size_t SEND_QUEUE_CAPACITY = 1024;      // 发送队列容量 2^10
-constexpr std::size_t SEND_EXPIRE_TIME_S = 60 * 5;     // 单条发送过期时间 300s
-constexpr std::size_t LOGIC_QUEUE_CAPACITY = 4096;     // 逻辑队列容量 2^12
+constexpr unsigned short DEFAULT_SERVER_PORT = 10004;           // 默认服务器端口
+constexpr std::int8_t IO_CONTEXT_POOL_SIZE = 8;                 // io_context 池子大小
+constexpr std::int8_t MSG_TYPE_LENGTH = 2;                      // 消息类型长度
+constexpr std::int8_t MSG_LEN_LENGTH = 2;                       // 消息长度字段长度
+constexpr std::int8_t MSG_HEAD_TOTAL_LEN = 4;                   // 消息头总长度
+constexpr std::size_t RECV_BUFFER_SIZE = 8192;                  // 普通帧消息体最大长度，超过时使用大帧
+constexpr std::uint16_t MSG_EXT_LEN_MARKER = 0xFFFF;            // 长度字段取该值表示大帧，其后跟随 4 字节长度
+constexpr std::int8_t MSG_EXT_LEN_LENGTH = 4;                   // 大帧消息体长度字段长度
+constexpr std::size_t MAX_LARGE_FRAME_SIZE = 16 * 1024 * 1024;  // 大帧消息体最大长度 16MB
+constexpr std::size_t LARGE_FRAME_CHUNK_SIZE = 65536;           // 大帧消息体按 64KB 分块存放，不做整块分配
+constexpr std::size_t CHUNK_POOL_CAPACITY = 1024;               // 空闲分块最多缓存 1024 个，即 64MB
+constexpr std::uint16_t MSG_COMPRESSED_FLAG = 0x8000;           // 消息 id 最高位表示消息体已压缩，算法由登录时协商
+constexpr std::int8_t MSG_RAW_LEN_LENGTH = 4;                   // 压缩消息体前 4 字节为解压后的长度
+constexpr std::size_t COMPRESS_MIN_SIZE = 512;                  // 消息体达到该长度才尝试压缩
+constexpr std::size_t COMPRESS_DICT_MIN_SIZE = 64;              // 使用字典时的压缩阈值，小消息也能受益
+constexpr int COMPRESS_ZSTD_LEVEL = 3;                          // zstd 压缩级别，兼顾速度与压缩率
+constexpr const char* COMPRESS_DICT_PATH = "chat.zdict";        // zstd 字典文件路径，不存在时不启用字典
+constexpr std::size_t WRITE_BATCH_MAX_FRAMES = 64;              // 单次 writev 最多合并的帧数，与 asio 单次 iovec 上限一致
+constexpr std::size_t WRITE_BATCH_MAX_BYTES = 65536;            // 单次 writev 最多合并的字节数 64KB
+constexpr std::int8_t LOGIC_WORKER_COUNT = 8;                   // 逻辑线程数量，按会话哈希分片
+constexpr std::size_t LOGIC_QUEUE_CAPACITY = 4096;              // 单个逻辑线程的队列容量 2^12
+constexpr std::int64_t LOGIC_QUEUE_RETRY_MS = 1;                // 逻辑线程队列满时 io 线程暂停读取，按该间隔重试投递
+constexpr std::size_t LOGIN_PARKED_MAX = 256;                   // 登录完成之前同一会话暂存的消息上限，超过时丢弃
+constexpr std::size_t SESSION_SHARD_RESERVE = 4096;             // 会话表每个分片预留的桶数，分片数与 io_context 数一致
+constexpr std::size_t USER_INDEX_SHARD_COUNT = 64;              // 在线用户索引的分片数，按用户 id 哈希，查找只锁一个分片
+constexpr std::int64_t IDLE_WHEEL_TICK_MS = 1000;               // 空闲检测时间轮的刻度，每个 io_context 一个时间轮
+constexpr std::size_t IDLE_WHEEL_SLOTS = 128;                   // 时间轮槽数，覆盖超时时长后每个会话每个周期只处理一次
+constexpr std::int64_t HEARTBEAT_INTERVAL_S = 30;               // 客户端空闲时发送心跳的间隔
+constexpr std::int64_t SESSION_IDLE_TIMEOUT_S = 90;             // 连续该时长未收到任何帧时断开，容忍丢失两次心跳
+
+constexpr bool IO_PIN_CPUS = false;             // io 线程按 NUMA 节点顺序各绑一个核，独占机器部署时开启
+constexpr bool REUSEPORT_CPU_STEERING = false;  // 绑核时按收包 CPU 选择 acceptor，需网卡 RSS 或 RPS 把连接分散到各核
+
+constexpr std::size_t BUFFER_POOL_THREAD_CACHE_BYTES = 256 * 1024;  // 消息节点内存池每个线程每个尺寸档位缓存的字节数上限
+constexpr std::size_t BUFFER_POOL_DEPOT_CAPACITY = 4096;            // 每个尺寸档位在线程之间流转的空闲块上限，与逻辑线程队列容量一致
+
+constexpr std::size_t RECV_SLAB_SLOTS = 2048;  // io_uring 下每个 io_context 注册的会话接收槽数，只有读取中的会话占用，用尽时该帧退回普通读取
+constexpr std::size_t RECV_SLOT_SIZE = 512;    // 接收槽大小，消息头与常见的小消息体一次读入
+
+constexpr std::size_t SEND_HIGH_WATERMARK_BYTES = 4 * 1024 * 1024;  // 会话排队待发送的字节数高水位，超过时按慢消费者策略处理
+constexpr std::size_t SEND_LOW_WATERMARK_BYTES = 1024 * 1024;       // 丢弃或转存到低水位为止，写出后回落到其下时解除拥塞
+constexpr std::size_t SEND_HIGH_WATERMARK_FRAMES = 4096;            // 会话排队待发送的帧数高水位
+constexpr std::size_t SEND_LOW_WATERMARK_FRAMES = 1024;             // 帧数低水位
 
 constexpr std::int32_t RPC_MAX_SEND_RECV_SIZE = 4 * 1024 * 1024;  // RPC 最大发送和接收消息大小 4MB
 
 constexpr const char* STATUS_RPC_SERVER_HOST = "127.0.0.1";  // 状态 RPC 服务器地址
 constexpr std::uint16_t STATUS_RPC_SERVER_PORT = 10003;      // 状态 RPC 服务器端口
 constexpr std::size_t STATUS_RPC_CONNECTION_POOL_SIZE = 8;   // 状态 RPC 连接池大小
-
-constexpr const char* DB_HOST = "127.0.0.1";  // 数据库主机地址
-constexpr std::uint16_t DB_PORT = 3306;       // 数据库端口
-constexpr const char* DB_USER = "root";       // 数据库用户名
-constexpr const char* DB_PASSWORD = "whx";    // 数据库密码
-constexpr const char* DB_NAME = "chatroom";   // 数据库名称
-constexpr std::size_t DB_MAX_POOL_SIZE = 16;  // 数据库最大连接池大小
-
-constexpr const char* REDIS_HOST = "127.0.0.1";  // Redis 主机地址
-constexpr std::uint16_t REDIS_PORT = 6379;       // Redis 端口
-constexpr const char* REDIS_PASSWORD = "whx";    // Redis 密码
-constexpr std::size_t REDIS_DB_INDEX = 0;        // Redis 数据库索引
-constexpr std::size_t REDIS_MAX_POOL_SIZE = 16;  // Redis 最大连接池大小
-constexpr std::size_t REDIS_TIMEOUT = 3;         // Redis 连接超时时间
+constexpr std::int64_t STATUS_RPC_TIMEOUT_MS = 5000;         // 异步登录校验的超时，到期后按失败处理并结束登录
+
+constexpr unsigned short CHAT_RPC_PORT_OFFSET = 1000;       // 跨服转发 RPC 端口为 TCP 端口加该偏移
+constexpr std::size_t RELAY_BATCH_MAX_FRAMES = 256;         // 转发流单次写入最多合并的帧数
+constexpr std::size_t RELAY_BATCH_MAX_BYTES = 1024 * 1024;  // 单次写入最多合并的字节数 1MB，单帧超过时拒绝转发
+constexpr std::size_t RELAY_MAX_PENDING_FRAMES = 65536;     // 单个对端排队未发送的帧数上限，超过时拒绝转发
+constexpr std::int64_t RELAY_RECONNECT_MS = 1000;           // 转发流断开后的重连间隔
+
+constexpr const char* HOT_RESTART_SOCKET_PREFIX = "/tmp/chatserver-";  // 热重启交接的 Unix socket 路径，后接 TCP 端口与 .sock
+constexpr std::uint32_t HOT_RESTART_VERSION = 1;                       // 交接协议版本，新旧进程不一致时不交接
+constexpr std::int64_t HOT_RESTART_DRAIN_MS = 3000;                    // 等待全部会话停在帧边界的时长，超时的会话照常断开
+constexpr std::int64_t HOT_RESTART_WRITE_DRAIN_MS = 1000;              // 单个会话等待在途写出完成的时长
+constexpr std::size_t HOT_RESTART_CHUNK_SIZE = 64 * 1024;              // 交接时每条消息携带的会话数据上限
+
+constexpr const char* DB_HOST = "127.0.0.1";       // 数据库主机地址
+constexpr std::uint16_t DB_PORT = 3306;            // 数据库端口
+constexpr const char* DB_USER = "root";            // 数据库用户名
+constexpr const char* DB_PASSWORD = "whx";         // 数据库密码
+constexpr const char* DB_NAME = "chatroom";        // 数据库名称
+constexpr std::size_t DB_MAX_POOL_SIZE = 16;       // 数据库最大连接池大小
+constexpr std::size_t DB_ASYNC_POOL_SIZE = 128;    // 协程连接池大小，需小于 MariaDB 的 max_connections
+constexpr std::int64_t DB_ASYNC_IDLE_PING_S = 30;  // 协程连接空闲超过该时间后，取出时先探活
+
+constexpr std::size_t PERSIST_BATCH_MAX_ROWS = 256;           // 消息落库单条 INSERT 最多合并的行数，攒够即写出
+constexpr std::size_t PERSIST_BATCH_MAX_BYTES = 1024 * 1024;  // 单条 INSERT 的消息内容合计上限，需小于 max_allowed_packet
+constexpr std::int64_t PERSIST_FLUSH_INTERVAL_MS = 20;        // 未攒够一批时最多等待该时长写出
+constexpr std::size_t PERSIST_MAX_PENDING = 65536;            // 排队与写入中的消息上限，超过时拒绝入队
+constexpr std::int64_t PERSIST_RETRY_BACKOFF_MS = 100;        // 写入失败后的重试间隔，逐次翻倍
+constexpr std::int64_t PERSIST_RETRY_BACKOFF_MAX_MS = 5000;   // 重试间隔上限
+constexpr std::size_t PERSIST_SHUTDOWN_RETRIES = 3;           // 停止时写入失败的重试次数，之后丢弃并记录日志
+
+constexpr std::int64_t LOGIN_FLUSH_INTERVAL_MS = 5000;  // 登录时间在内存中合并，按该间隔写入数据库，崩溃时最多丢失一个间隔
+constexpr std::size_t LOGIN_BATCH_MAX_ROWS = 500;       // 单条 UPDATE ... CASE 最多更新的用户数
+
+constexpr const char* REDIS_HOST = "127.0.0.1";          // Redis 主机地址
+constexpr std::uint16_t REDIS_PORT = 6379;               // Redis 端口
+constexpr const char* REDIS_PASSWORD = "whx";            // Redis 密码
+constexpr std::size_t REDIS_DB_INDEX = 0;                // Redis 数据库索引
+constexpr std::size_t REDIS_MAX_POOL_SIZE = 16;          // Redis 最大连接池大小
+constexpr std::size_t REDIS_TIMEOUT = 3;                 // Redis 连接超时时间
+constexpr std::size_t REDIS_ASYNC_CONNECTIONS = 4;       // 协程客户端的连接数，每条连接上可同时在途多条命令
+constexpr std::int64_t REDIS_ASYNC_RECONNECT_MS = 1000;  // 协程客户端断线后的重连间隔
 
 constexpr const char* USER_INFO_PREFIX = "user_info:";  // 用户信息前缀
 constexpr std::size_t USER_INFO_EXPIRE_TIME_S = 3600;   // 用户信息过期时间 1小时
 
+constexpr std::size_t PROFILE_CACHE_SHARDS = 16;                          // 本地资料缓存的分片数，每片一把锁
+constexpr std::size_t PROFILE_CACHE_CAPACITY = 65536;                     // 本地资料缓存的总条数，各分片均分后按 LRU 淘汰
+constexpr std::int64_t PROFILE_CACHE_TTL_S = 600;                         // 本地副本最长存活时间，兜底漏收的失效消息
+constexpr const char* PROFILE_INVALIDATE_CHANNEL = "profile:invalidate";  // 资料变更后发布 uuid 的频道
+
+constexpr const char* HISTORY_CACHE_PREFIX = "history:";  // 会话最近消息的有序集合前缀，按 seq 排序
+constexpr std::size_t HISTORY_CACHE_MESSAGES = 200;       // 每个会话缓存的最近消息条数，即最近 4 页
+constexpr std::size_t HISTORY_CACHE_EXPIRE_S = 3600;      // 会话 1 小时没有新消息或拉取时缓存过期
+constexpr std::uint32_t HISTORY_PAGE_DEFAULT = 50;        // 请求未指定条数时每页的消息数
+constexpr std::uint32_t HISTORY_PAGE_MAX = 100;           // 每页最多的消息数
+
+constexpr std::size_t UUID_LENGTH = 36;                                // 用户 uuid 的长度，单聊的会话 id 为双方 uuid 按字典序拼接
+constexpr const char* CONVERSATION_SEQ_PREFIX = "conversation_seq:";  // 会话内消息序号的计数器前缀，INCR 分配 seq，不设过期时间
+
+constexpr const char* RESUME_TOKEN_KEYS_ENV = "CHATSERVER_RESUME_KEYS";  // 恢复令牌的 HMAC-SHA256 密钥环所在的环境变量，各 ChatServer 相同，未设置时拒绝启动
+constexpr std::int64_t RESUME_TOKEN_TTL_S = 300;                         // 恢复令牌有效期，断线超过该时长需完整登录
+constexpr std::size_t RESUME_MAX_CURSORS = 64;                           // 一次恢复最多补发的会话数，多出的游标被忽略
+
 }  // namespace server
 
 }  // namespace global
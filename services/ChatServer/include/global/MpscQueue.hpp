@@ -0,0 +1,139 @@
+/******************************************************************************
+ *
+ * @file       MpscQueue.hpp
+ * @brief      按需分配的无锁多生产者单消费者链表队列
+ *
+ * @author     KBchulan
+ * @date       2026/10/17
+ * @history    用于替换 Session 内嵌的定长发送队列，空闲时仅占用几十字节
+ ******************************************************************************/
+
+#ifndef MPSC_QUEUE_HPP
+#define MPSC_QUEUE_HPP
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace global
+{
+
+// 基于 Vyukov 的非侵入式 MPSC 算法:
+// - 生产者只做一次 exchange + 一次 store，无 CAS 重试，永不失败
+// - 消费者必须唯一，pop 不与其他 pop 并发
+// - 哨兵节点内嵌在队列对象中，空队列不产生任何堆分配
+// 生产者刚 exchange 完尚未链接 next 时，消费者会短暂看到空队列，
+// 调用方需要在 push 之后再做唤醒，保证不会丢失通知
+template <typename T>
+class MpscQueue
+{
+private:
+  static_assert(std::is_nothrow_move_constructible_v<T> || std::is_nothrow_copy_constructible_v<T>,
+                "the copy or move shouldn't throw error");
+
+  struct Node
+  {
+    std::atomic<Node*> _next{nullptr};
+    alignas(T) std::array<std::byte, sizeof(T)> _storage;
+
+    T* data() noexcept
+    {
+      return std::launder(reinterpret_cast<T*>(_storage.data()));
+    }
+  };
+
+  // 队列对象会被大量会话各自持有，因此这里不做缓存行填充，以空间换取少量伪共享
+  std::atomic<Node*> _head;  // 生产者端，指向最新入队的节点
+  Node* _tail;               // 消费者端，指向当前哨兵节点
+  std::atomic<std::size_t> _size{0};
+  Node _stub;
+
+public:
+  MpscQueue() : _head(&_stub), _tail(&_stub)
+  {
+  }
+
+  ~MpscQueue()
+  {
+    // 析构剩余的元素，哨兵节点中不存放元素
+    Node* node = _tail->_next.load(std::memory_order_acquire);
+    release_node(_tail);
+
+    while (node != nullptr)
+    {
+      Node* next = node->_next.load(std::memory_order_acquire);
+      std::destroy_at(node->data());
+      release_node(node);
+      node = next;
+    }
+  }
+
+  template <typename... Args>
+  void emplace(Args&&... args)
+  {
+    auto* node = new Node;
+    std::construct_at(node->data(), std::forward<Args>(args)...);
+
+    _size.fetch_add(1, std::memory_order_relaxed);
+
+    // 先抢占队尾，再把前驱链接到新节点，链接完成后对消费者可见
+    Node* prev = _head.exchange(node, std::memory_order_acq_rel);
+    prev->_next.store(node, std::memory_order_release);
+  }
+
+  bool pop(T& result)
+  {
+    Node* tail = _tail;
+    Node* next = tail->_next.load(std::memory_order_acquire);
+
+    if (next == nullptr)
+    {
+      // 队列空，或生产者尚未完成链接
+      return false;
+    }
+
+    // next 成为新的哨兵，其中的元素移出后立即析构
+    result = std::move(*next->data());
+    std::destroy_at(next->data());
+
+    _tail = next;
+    release_node(tail);
+
+    _size.fetch_sub(1, std::memory_order_relaxed);
+    return true;
+  }
+
+  // 获取当前队列大小，并发下为近似值
+  [[nodiscard]] std::size_t size() const noexcept
+  {
+    return _size.load(std::memory_order_relaxed);
+  }
+
+  // 检查是否为空
+  [[nodiscard]] bool empty() const noexcept
+  {
+    return size() == 0;
+  }
+
+  MpscQueue(const MpscQueue&) = delete;
+  MpscQueue& operator=(const MpscQueue&) = delete;
+  MpscQueue(MpscQueue&&) = delete;
+  MpscQueue& operator=(MpscQueue&&) = delete;
+
+private:
+  void release_node(Node* node) noexcept
+  {
+    if (node != &_stub)
+    {
+      delete node;
+    }
+  }
+};
+
+}  // namespace global
+
+#endif  // MPSC_QUEUE_HPP
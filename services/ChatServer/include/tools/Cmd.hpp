@@ -5,13 +5,15 @@
  *
  * @author     KBchulan
  * @date       2026/01/06
- * @history
+ * @history    2026/10/18 新增 --takeover，从运行中的旧进程接管连接
  ******************************************************************************/
 
 #ifndef CMD_HPP
 #define CMD_HPP
 
 #include <global/Global.hpp>
+#include <string>
+#include <vector>
 
 namespace tools
 {
@@ -19,6 +21,8 @@ namespace tools
 struct CmdOptions
 {
   unsigned short port = global::server::DEFAULT_SERVER_PORT;
+  std::vector<std::string> peers;  // 其他聊天服务器的转发地址 host:port
+  bool takeover = false;           // 启动时从同端口的旧进程接管监听 socket 与会话
   bool show_help = false;
 };
 
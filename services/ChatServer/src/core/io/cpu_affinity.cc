@@ -0,0 +1,150 @@
+#include "cpu_affinity.hpp"
+
+#include <linux/filter.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/socket.h>
+
+#include <algorithm>
+#include <charconv>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <utility>
+
+namespace core
+{
+
+namespace
+{
+
+constexpr const char* NUMA_NODE_DIR = "/sys/devices/system/node";
+
+// 解析 "0-3,8-11" 形式的 cpulist
+std::vector<int> parse_cpu_list(std::string_view list)
+{
+  std::vector<int> cpus;
+  while (!list.empty())
+  {
+    auto comma = list.find(',');
+    auto range = list.substr(0, comma);
+    list = comma == std::string_view::npos ? std::string_view{} : list.substr(comma + 1);
+
+    int first = 0;
+    auto [end, errc] = std::from_chars(range.data(), range.data() + range.size(), first);
+    if (errc != std::errc{})
+    {
+      continue;
+    }
+    int last = first;
+    if (end != range.data() + range.size() && *end == '-')
+    {
+      std::from_chars(end + 1, range.data() + range.size(), last);
+    }
+    for (int cpu = first; cpu <= last; ++cpu)
+    {
+      cpus.push_back(cpu);
+    }
+  }
+  return cpus;
+}
+
+// 每个核所在的 NUMA 节点，下标为核编号，未列出的核记为节点 0
+std::vector<int> numa_node_of_cpus()
+{
+  std::vector<int> node_of;
+
+  std::error_code errc;
+  for (const auto& entry : std::filesystem::directory_iterator(NUMA_NODE_DIR, errc))
+  {
+    auto name = entry.path().filename().string();
+    int node = 0;
+    if (!name.starts_with("node") ||
+        std::from_chars(name.data() + 4, name.data() + name.size(), node).ec != std::errc{})
+    {
+      continue;
+    }
+
+    std::ifstream file(entry.path() / "cpulist");
+    std::string list;
+    std::getline(file, list);
+    for (auto cpu : parse_cpu_list(list))
+    {
+      if (static_cast<std::size_t>(cpu) >= node_of.size())
+      {
+        node_of.resize(static_cast<std::size_t>(cpu) + 1, 0);
+      }
+      node_of[static_cast<std::size_t>(cpu)] = node;
+    }
+  }
+  return node_of;
+}
+
+}  // namespace
+
+std::vector<int> CpuAffinity::AvailableCpus()
+{
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  if (sched_getaffinity(0, sizeof(set), &set) != 0)
+  {
+    return {};
+  }
+
+  auto node_of = numa_node_of_cpus();
+  std::vector<std::pair<int, int>> ordered;  // (节点, 核)
+  for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu)
+  {
+    if (CPU_ISSET(cpu, &set))
+    {
+      auto idx = static_cast<std::size_t>(cpu);
+      ordered.emplace_back(idx < node_of.size() ? node_of[idx] : 0, cpu);
+    }
+  }
+  std::ranges::sort(ordered);
+
+  std::vector<int> cpus;
+  cpus.reserve(ordered.size());
+  std::ranges::transform(ordered, std::back_inserter(cpus), [](const auto& node_cpu) { return node_cpu.second; });
+  return cpus;
+}
+
+bool CpuAffinity::PinCurrentThread(int cpu)
+{
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  CPU_SET(cpu, &set);
+  return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+}
+
+bool CpuAffinity::AttachReuseportSteering(int fd, std::span<const int> cpus)
+{
+  // A = 当前处理该包的 CPU；逐个比较，命中第 i 个核时返回 i，多个 socket 绑同一核时取第一个
+  std::vector<sock_filter> code;
+  code.reserve(cpus.size() * 2 + 2);
+  code.push_back(BPF_STMT(BPF_LD | BPF_W | BPF_ABS, static_cast<std::uint32_t>(SKF_AD_OFF + SKF_AD_CPU)));
+  for (std::size_t i = 0; i < cpus.size(); ++i)
+  {
+    if (std::ranges::find(cpus.first(i), cpus[i]) != cpus.first(i).end())
+    {
+      continue;
+    }
+    code.push_back(BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K, static_cast<std::uint32_t>(cpus[i]), 0, 1));
+    code.push_back(BPF_STMT(BPF_RET | BPF_K, static_cast<std::uint32_t>(i)));
+  }
+  code.push_back(BPF_STMT(BPF_RET | BPF_K, static_cast<std::uint32_t>(cpus.size())));
+
+  sock_fprog prog{.len = static_cast<unsigned short>(code.size()), .filter = code.data()};
+  return setsockopt(fd, SOL_SOCKET, SO_ATTACH_REUSEPORT_CBPF, &prog, sizeof(prog)) == 0;
+}
+
+bool CpuAffinity::SetIncomingCpu(int fd, int cpu)
+{
+  return setsockopt(fd, SOL_SOCKET, SO_INCOMING_CPU, &cpu, sizeof(cpu)) == 0;
+}
+
+}  // namespace core
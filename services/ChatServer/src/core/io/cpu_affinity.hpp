@@ -0,0 +1,41 @@
+/******************************************************************************
+ *
+ * @file       cpu_affinity.hpp
+ * @brief      io 线程绑核与 reuseport 按收包 CPU 分发
+ *
+ * @author     KBchulan
+ * @date       2026/10/18
+ * @history    按 NUMA 节点排列可用的核供 io 线程绑定，并为 reuseport 组挂载 CBPF 程序，
+ *             让连接由绑定在收包核上的 acceptor 接入
+ ******************************************************************************/
+
+#ifndef CPU_AFFINITY_HPP
+#define CPU_AFFINITY_HPP
+
+#include <core/CoreExport.hpp>
+#include <span>
+#include <vector>
+
+namespace core
+{
+
+class CORE_EXPORT CpuAffinity
+{
+public:
+  // 本进程允许运行的核，同一 NUMA 节点的排在一起，依次取用时先占满一个节点；读不到拓扑时视为单节点
+  [[nodiscard]] static std::vector<int> AvailableCpus();
+
+  // 把调用线程绑定到 cpu 上
+  static bool PinCurrentThread(int cpu);
+
+  // 为 fd 所在的 reuseport 组挂载 CBPF 程序，cpus[i] 为组内第 i 个 listen 的 socket 所在线程绑定的核
+  // 收包 CPU 不在 cpus 中时程序返回越界下标，内核退回按四元组哈希选择
+  static bool AttachReuseportSteering(int fd, std::span<const int> cpus);
+
+  // 标记 listen socket 所在的核，6.1 起的内核在哈希选择时优先取该值与收包核一致的 socket，不依赖 CBPF
+  static bool SetIncomingCpu(int fd, int cpu);
+};
+
+}  // namespace core
+
+#endif  // CPU_AFFINITY_HPP
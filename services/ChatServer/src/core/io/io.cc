@@ -3,6 +3,8 @@
 #include <algorithm>
 #include <atomic>
 #include <boost/asio/executor_work_guard.hpp>
+#include <core/io/cpu_affinity.hpp>
+#include <core/io/recv_slab.hpp>
 #include <cstddef>
 #include <global/Global.hpp>
 #include <iterator>
@@ -17,7 +19,9 @@ struct IO::_impl
 {
   std::size_t _pool_size;
   std::vector<std::unique_ptr<boost::asio::io_context>> _io_contexts;
+  std::vector<std::unique_ptr<RecvSlab>> _recv_slabs;  // 在 io 线程退出之后、io_context 析构之前注销
   std::vector<std::jthread> _io_threads;
+  std::vector<int> _cpus;
   std::vector<boost::asio::executor_work_guard<boost::asio::io_context::executor_type>> _work_guards;
   std::atomic<std::size_t> _next_idx;
 
@@ -33,11 +37,53 @@ struct IO::_impl
     std::ranges::transform(_io_contexts, std::back_inserter(_work_guards),
                            [](const auto& ioc) { return boost::asio::make_work_guard(*ioc); });
 
+    assign_cpus();
+
+    // io_uring 后端下的注册要在 io_context 运行之前完成
+    _recv_slabs.reserve(_pool_size);
+    for (const auto& ioc : _io_contexts)
+    {
+      _recv_slabs.emplace_back(
+          std::make_unique<RecvSlab>(*ioc, global::server::RECV_SLAB_SLOTS, global::server::RECV_SLOT_SIZE));
+    }
+
     _io_threads.reserve(_pool_size);
-    std::ranges::transform(_io_contexts, std::back_inserter(_io_threads),
-                           [](const auto& ioc) { return std::jthread([&ioc]() { (*ioc).run(); }); });
+    for (std::size_t i = 0; i < _pool_size; ++i)
+    {
+      _io_threads.emplace_back(
+          [ioc = _io_contexts[i].get(), cpu = _cpus[i]]()
+          {
+            // 在线程内绑定，run 之前完成，之后该线程的内存首次分配都落在绑定核所在的节点上
+            if (cpu >= 0 && !CpuAffinity::PinCurrentThread(cpu))
+            {
+              tools::Logger::getInstance().warning("Failed to pin io thread to cpu {}", cpu);
+            }
+            ioc->run();
+          });
+    }
 
-    tools::Logger::getInstance().info("io pool initialized successful");
+    tools::Logger::getInstance().info("io pool initialized successful on {}", IO::GetBackendName());
+  }
+
+  // 线程数超过可用核数时从头复用，多个 io 线程共享一个核
+  void assign_cpus()
+  {
+    _cpus.assign(_pool_size, -1);
+    if (!global::server::IO_PIN_CPUS)
+    {
+      return;
+    }
+
+    auto cpus = CpuAffinity::AvailableCpus();
+    if (cpus.empty())
+    {
+      tools::Logger::getInstance().warning("No cpu available for pinning, io threads stay unpinned");
+      return;
+    }
+    for (std::size_t i = 0; i < _pool_size; ++i)
+    {
+      _cpus[i] = cpus[i % cpus.size()];
+    }
   }
 
   ~_impl()
@@ -76,4 +122,30 @@ boost::asio::io_context& IO::GetIOContextAt(std::size_t idx)
   return *_pimpl->_io_contexts[idx % _pimpl->_pool_size];
 }
 
+int IO::GetCpuAt(std::size_t idx) const
+{
+  return _pimpl->_cpus[idx % _pimpl->_pool_size];
+}
+
+RecvSlab* IO::FindRecvSlab(const boost::asio::execution_context& ctx)
+{
+  for (const auto& slab : _pimpl->_recv_slabs)
+  {
+    if (&slab->GetIOContext() == &ctx)
+    {
+      return slab.get();
+    }
+  }
+  return nullptr;
+}
+
+const char* IO::GetBackendName() noexcept
+{
+#if defined(BOOST_ASIO_HAS_IO_URING_AS_DEFAULT)
+  return "io_uring";
+#else
+  return "epoll";
+#endif
+}
+
 }  // namespace core
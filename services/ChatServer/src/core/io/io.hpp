@@ -5,7 +5,8 @@
  *
  * @author     KBchulan
  * @date       2025/12/07
- * @history
+ * @history    2026/10/18 可选按 NUMA 节点顺序把 io 线程绑定到各个核上
+ *             2026/10/18 每个 io_context 一块会话接收槽，io_uring 后端下整块注册
  ******************************************************************************/
 
 #ifndef IO_HPP
@@ -19,6 +20,8 @@
 namespace core
 {
 
+class RecvSlab;
+
 class CORE_EXPORT IO
 {
 public:
@@ -33,6 +36,15 @@ public:
   // 根据索引获取 io_context
   [[nodiscard]] boost::asio::io_context& GetIOContextAt(std::size_t idx);
 
+  // 根据索引获取 io 线程绑定的核，未绑核时返回 -1
+  [[nodiscard]] int GetCpuAt(std::size_t idx) const;
+
+  // 根据 io_context 获取它的会话接收槽，不属于本池时返回 nullptr
+  [[nodiscard]] RecvSlab* FindRecvSlab(const boost::asio::execution_context& ctx);
+
+  // 构建时选定的后端，"io_uring" 或 "epoll"
+  [[nodiscard]] static const char* GetBackendName() noexcept;
+
   IO(const IO&) = delete;
   IO& operator=(const IO&) = delete;
   IO(IO&&) = delete;
@@ -0,0 +1,129 @@
+#include "recv_slab.hpp"
+
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace core
+{
+
+// 槽所在的内存与空闲表，会话接入与断开时才会访问，可能不在本 io 线程上
+struct RecvSlab::_slot_table
+{
+  std::unique_ptr<char[]> _memory;
+  std::mutex _mutex;
+  std::vector<std::size_t> _free;
+
+  _slot_table(std::size_t slots, std::size_t slot_size)
+      : _memory(std::make_unique_for_overwrite<char[]>(slots * slot_size))
+  {
+    // 不做初始化，页面在会话第一次读入时才真正分配；倒序压入，先分出去的是低地址的槽
+    _free.reserve(slots);
+    for (std::size_t slot = slots; slot > 0; --slot)
+    {
+      _free.push_back(slot - 1);
+    }
+  }
+};
+
+struct RecvSlab::_impl
+{
+  boost::asio::io_context& _io_context;
+  std::size_t _slot_size;
+  std::shared_ptr<_slot_table> _slots;
+
+#if defined(BOOST_ASIO_HAS_IO_URING_AS_DEFAULT)
+  // 整块只注册一次，一个 io_context 同时只能有一份注册；先于 io_context 析构时注销
+  boost::asio::buffer_registration<std::vector<boost::asio::mutable_buffer>> _registration;
+#endif
+
+  _impl(boost::asio::io_context& ioc, std::size_t slots, std::size_t slot_size)
+      : _io_context(ioc),
+        _slot_size(slot_size),
+        _slots(std::make_shared<RecvSlab::_slot_table>(slots, slot_size))
+#if defined(BOOST_ASIO_HAS_IO_URING_AS_DEFAULT)
+        ,
+        _registration(boost::asio::register_buffers(
+            ioc,
+            std::vector<boost::asio::mutable_buffer>{boost::asio::buffer(_slots->_memory.get(), slots * slot_size)}))
+#endif
+  {
+  }
+
+  [[nodiscard]] Buffer slot_buffer(std::size_t slot) const
+  {
+    const auto offset = slot * _slot_size;
+#if defined(BOOST_ASIO_HAS_IO_URING_AS_DEFAULT)
+    return boost::asio::buffer(*_registration.begin() + offset, _slot_size);
+#else
+    return boost::asio::buffer(_slots->_memory.get() + offset, _slot_size);
+#endif
+  }
+};
+
+RecvSlab::Lease::Lease(std::shared_ptr<_slot_table> slots, std::size_t slot, Buffer buffer) noexcept
+    : _slots(std::move(slots)), _slot(slot), _buffer(buffer)
+{
+}
+
+RecvSlab::Lease::~Lease()
+{
+  release();
+}
+
+RecvSlab::Lease& RecvSlab::Lease::operator=(Lease&& other) noexcept
+{
+  if (this != &other)
+  {
+    release();
+    _slots = std::move(other._slots);
+    _slot = other._slot;
+    _buffer = other._buffer;
+  }
+  return *this;
+}
+
+void RecvSlab::Lease::release() noexcept
+{
+  if (_slots != nullptr)
+  {
+    std::lock_guard lock{_slots->_mutex};
+    _slots->_free.push_back(_slot);
+  }
+}
+
+RecvSlab::RecvSlab(boost::asio::io_context& ioc, std::size_t slots, std::size_t slot_size)
+    : _pimpl(std::make_unique<_impl>(ioc, slots, slot_size))
+{
+}
+
+RecvSlab::~RecvSlab() = default;
+
+RecvSlab::Lease RecvSlab::Acquire()
+{
+  auto& slots = *_pimpl->_slots;
+
+  std::size_t slot = 0;
+  {
+    std::lock_guard lock{slots._mutex};
+    if (slots._free.empty())
+    {
+      return {};
+    }
+    slot = slots._free.back();
+    slots._free.pop_back();
+  }
+  return {_pimpl->_slots, slot, _pimpl->slot_buffer(slot)};
+}
+
+boost::asio::io_context& RecvSlab::GetIOContext() const noexcept
+{
+  return _pimpl->_io_context;
+}
+
+std::size_t RecvSlab::GetSlotSize() const noexcept
+{
+  return _pimpl->_slot_size;
+}
+
+}  // namespace core
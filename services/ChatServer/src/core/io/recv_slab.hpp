@@ -0,0 +1,95 @@
+/******************************************************************************
+ *
+ * @file       recv_slab.hpp
+ * @brief      会话接收槽
+ *
+ * @author     KBchulan
+ * @date       2026/10/18
+ * @history    每个 io_context 一块连续内存，按固定大小切成槽分给会话，一次读取尽量多的字节；
+ *             io_uring 后端下整块注册一次，读操作以 READ_FIXED 提交，内核不必每次重新映射用户页
+ ******************************************************************************/
+
+#ifndef RECV_SLAB_HPP
+#define RECV_SLAB_HPP
+
+#include <boost/asio/buffer.hpp>
+#include <boost/asio/io_context.hpp>
+#include <core/CoreExport.hpp>
+#include <cstddef>
+#include <memory>
+
+#if defined(BOOST_ASIO_HAS_IO_URING_AS_DEFAULT)
+#include <boost/asio/registered_buffer.hpp>
+#endif
+
+namespace core
+{
+
+class CORE_EXPORT RecvSlab
+{
+public:
+#if defined(BOOST_ASIO_HAS_IO_URING_AS_DEFAULT)
+  using Buffer = boost::asio::mutable_registered_buffer;
+#else
+  using Buffer = boost::asio::mutable_buffer;
+#endif
+
+private:
+  struct _slot_table;
+
+public:
+  // 持有一个槽，析构时归还，可在任意线程析构；槽所在的内存由租约共同持有，晚于 RecvSlab 析构也是安全的
+  class CORE_EXPORT Lease
+  {
+  public:
+    Lease() = default;
+    Lease(std::shared_ptr<_slot_table> slots, std::size_t slot, Buffer buffer) noexcept;
+    ~Lease();
+
+    Lease(Lease&& other) noexcept = default;
+    Lease& operator=(Lease&& other) noexcept;
+    Lease(const Lease&) = delete;
+    Lease& operator=(const Lease&) = delete;
+
+    explicit operator bool() const noexcept
+    {
+      return _slots != nullptr;
+    }
+
+    // 整个槽，注册缓冲区上的切片仍带着注册 id
+    [[nodiscard]] const Buffer& GetBuffer() const noexcept
+    {
+      return _buffer;
+    }
+
+  private:
+    void release() noexcept;
+
+    std::shared_ptr<_slot_table> _slots;
+    std::size_t _slot = 0;
+    Buffer _buffer;
+  };
+
+  // 申请 slots * slot_size 字节，io_uring 后端下在 ioc 上注册，需在 ioc 运行之前构造
+  RecvSlab(boost::asio::io_context& ioc, std::size_t slots, std::size_t slot_size);
+  ~RecvSlab();
+
+  // 槽用尽时返回空租约，调用方退回普通读取
+  [[nodiscard]] Lease Acquire();
+
+  [[nodiscard]] boost::asio::io_context& GetIOContext() const noexcept;
+  [[nodiscard]] std::size_t GetSlotSize() const noexcept;
+
+  RecvSlab(const RecvSlab&) = delete;
+  RecvSlab& operator=(const RecvSlab&) = delete;
+  RecvSlab(RecvSlab&&) = delete;
+  RecvSlab& operator=(RecvSlab&&) = delete;
+
+private:
+  struct _impl;
+  std::unique_ptr<_impl> _pimpl;
+};
+
+}  // namespace core
+
+#endif  // RECV_SLAB_HPP
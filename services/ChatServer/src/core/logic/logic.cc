@@ -1,39 +1,80 @@
 #include "logic.hpp"
 
-#include <json/json.h>
-
+#include <algorithm>
 #include <atomic>
-#include <core/repository/user_repository.hpp>
+#include <boost/asio/co_spawn.hpp>
+#include <boost/asio/detached.hpp>
+#include <chrono>
+#include <core/io/io.hpp>
+#include <core/manager/fan_out.hpp>
+#include <core/manager/user_manager.hpp>
+#include <core/msg-node/frame-compressor.hpp>
+#include <core/repository/history_cache.hpp>
+#include <core/repository/login_activity.hpp>
+#include <core/repository/message_repository.hpp>
+#include <core/repository/message_writer.hpp>
+#include <core/repository/profile_cache.hpp>
+#include <core/session/resume_token.hpp>
 #include <core/session/session.hpp>
+#include <cstdint>
+#include <exception>
 #include <global/Global.hpp>
+#include <global/MpscQueue.hpp>
 #include <global/SuperQueue.hpp>
 #include <memory>
-#include <optional>
+#include <mutex>
+#include <string>
+#include <string_view>
 #include <thread>
 #include <tools/Logger.hpp>
 #include <unordered_map>
+#include <utility>
+#include <utils/codec/message_codec.hpp>
 #include <utils/common/code.hpp>
+#include <utils/grpc/client/chat_server_client.hpp>
 #include <utils/grpc/client/status_server_client.hpp>
-#include <utils/pool/redis/redis_pool.hpp>
+#include <utils/pool/redis/async_redis_client.hpp>
+#include <vector>
 
 namespace core
 {
 
 struct LogicTask
 {
-  Session::Ptr session;
-  std::shared_ptr<RecvNode> msg;
+  Session::Ptr session{};
+  std::shared_ptr<RecvNode> msg{};
+  Logic::Task resume{};  // 异步操作完成后的续体，非空时不再分发 msg
 };
 
-struct Logic::_impl
+// 登录握手协商出的会话参数，在登录响应入队之后才生效
+struct LoginOptions
 {
-  std::atomic<bool> _running{true};
-  std::atomic<bool> _has_task{false};
+  utils::WireProtocol protocol;
+  CompressionMode compression;
+};
 
+// 单个逻辑线程，拥有独立的队列，同一会话的消息总是落在同一个 worker 上以保证顺序
+struct LogicWorker
+{
+  std::atomic<bool> _has_task{false};
   global::SuperQueue<LogicTask, global::server::LOGIC_QUEUE_CAPACITY> _queue;
+  global::MpscQueue<LogicTask> _resumes;  // 续体不设上限，丢弃续体会让登录等流程停在半途
   std::jthread _thread;
 
+  // 登录或恢复尚未完成的会话及其随后到达的消息，只由本线程访问
+  std::unordered_map<const Session*, std::vector<LogicTask>> _parked;
+};
+
+struct Logic::_impl
+{
+  std::atomic<bool> _running{true};
+
+  // 处理函数表在第一条消息投递之前冻结，之后逻辑线程无锁读取；_started 置位之后不再修改
   std::unordered_map<short, Logic::CallBack> _handlers;
+  std::unordered_map<short, Logic::ChunkedCallBack> _chunked_handlers;
+  std::vector<std::unique_ptr<LogicWorker>> _workers;
+  std::mutex _start_mutex;
+  std::atomic<bool> _started{false};
 
   utils::StatusServerClinet& _status_server_client = utils::StatusServerClinet::GetInstance();
 
@@ -41,10 +82,28 @@ struct Logic::_impl
   {
     auto msg_id = msg->GetMsgId();
 
+    // 大帧优先交给分块处理函数，省去拼接
+    if (msg->IsChunked())
+    {
+      if (auto iter = _chunked_handlers.find(msg_id); iter != _chunked_handlers.end())
+      {
+        iter->second(session, msg->GetChunks());
+        return;
+      }
+    }
+
     // 分发消息
-    if (_handlers.contains(msg_id))
+    if (auto iter = _handlers.find(msg_id); iter != _handlers.end())
     {
-      _handlers[msg_id](session, msg->GetData());
+      if (msg->IsChunked())
+      {
+        auto body = flatten(*msg);
+        iter->second(session, body);
+      }
+      else
+      {
+        iter->second(session, msg->GetData());
+      }
     }
     else
     {
@@ -52,39 +111,744 @@ struct Logic::_impl
     }
   }
 
-  void run()
+  static std::string flatten(const RecvNode& msg)
+  {
+    std::string body;
+    body.reserve(msg.GetBodySize());
+    for (auto chunk : msg.GetChunks())
+    {
+      body.append(chunk.data(), chunk.size());
+    }
+    return body;
+  }
+
+  void run(LogicWorker& worker, std::size_t idx)
   {
-    tools::Logger::getInstance().info("Logic thread started");
+    tools::Logger::getInstance().info("Logic thread {} started", idx);
 
     while (_running.load(std::memory_order_acquire))
     {
       LogicTask task;
 
-      if (_queue.pop(task))
+      // 续体优先，它们多半在等着发出响应或结束暂存
+      if (worker._resumes.pop(task) || worker._queue.pop(task))
+      {
+        if (task.resume)
+        {
+          task.resume();
+        }
+        else if (!park(worker, task))
+        {
+          handle_message(task.session, task.msg);
+        }
+        continue;
+      }
+
+      // 先清除标记再复查队列，与 PostToLogic 中的 fence 配对，避免清除标记覆盖掉刚到达的通知
+      worker._has_task.store(false, std::memory_order_relaxed);
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      if (!worker._resumes.empty() || !worker._queue.empty())
       {
-        handle_message(task.session, task.msg);
         continue;
       }
 
-      _has_task.store(false, std::memory_order_relaxed);
-      _has_task.wait(false, std::memory_order_acquire);
+      worker._has_task.wait(false, std::memory_order_acquire);
+    }
+
+    tools::Logger::getInstance().info("Logic thread {} stopped", idx);
+  }
+
+  // 按会话对象地址哈希分片，会话生命周期内地址不变，且比哈希 uuid 字符串便宜
+  [[nodiscard]] std::size_t shard_of(const Session* session) const
+  {
+    auto key = static_cast<std::uint64_t>(reinterpret_cast<std::uintptr_t>(session));
+    key = (key ^ (key >> 33U)) * 0x9E3779B97F4A7C15ULL;
+    return static_cast<std::size_t>(key >> 32U) % _workers.size();
+  }
+
+  [[nodiscard]] LogicWorker& worker_of(const Session::Ptr& session)
+  {
+    return *_workers[shard_of(session.get())];
+  }
+
+  // 会话的登录尚未完成时暂存消息，返回 false 表示应立即处理
+  static bool park(LogicWorker& worker, LogicTask& task)
+  {
+    auto iter = worker._parked.find(task.session.get());
+    if (iter == worker._parked.end())
+    {
+      return false;
+    }
+
+    if (iter->second.size() >= global::server::LOGIN_PARKED_MAX)
+    {
+      tools::Logger::getInstance().warning("Session {} sent too many messages during login, message {} dropped",
+                                           task.session->GetUuid(), task.msg->GetMsgId());
+      return true;
+    }
+    iter->second.emplace_back(std::move(task));
+    return true;
+  }
+
+  // 登录与恢复在 io 线程上异步完成，会话在续体中才绑定用户；其间到达的消息先暂存，
+  // 否则会在绑定之前处理并被当作未登录拒绝，破坏同一会话内的顺序
+  void begin_login(const Session::Ptr& session)
+  {
+    worker_of(session)._parked.try_emplace(session.get());
+  }
+
+  // 在登录续体中、发送响应之后调用，按到达顺序处理暂存的消息
+  void end_login(const Session::Ptr& session)
+  {
+    auto& worker = worker_of(session);
+    auto iter = worker._parked.find(session.get());
+    if (iter == worker._parked.end())
+    {
+      return;
+    }
+
+    auto parked = std::move(iter->second);
+    worker._parked.erase(iter);
+    for (auto& task : parked)
+    {
+      // 暂存的消息中可能又有一次登录，其后的消息继续暂存
+      if (!park(worker, task))
+      {
+        handle_message(task.session, task.msg);
+      }
+    }
+  }
+
+  // 登录与恢复协程按值持有，随协程帧销毁；协程没有交出续体就结束时（抛出异常，或协程帧未运行即被销毁）
+  // 投递 on_abort 回复失败，之后同样结束暂存，会话随后到达的消息不会一直暂存
+  class LoginScope
+  {
+  public:
+    LoginScope(_impl& owner, Session::Ptr session, Logic::Task on_abort)
+        : _owner(&owner), _session(std::move(session)), _on_abort(std::move(on_abort))
+    {
+    }
+
+    LoginScope(LoginScope&& other) noexcept
+        : _owner(std::exchange(other._owner, nullptr)),
+          _session(std::move(other._session)),
+          _on_abort(std::move(other._on_abort))
+    {
+    }
+
+    ~LoginScope()
+    {
+      if (_owner != nullptr)
+      {
+        Finish(std::move(_on_abort));
+      }
+    }
+
+    LoginScope(const LoginScope&) = delete;
+    LoginScope& operator=(const LoginScope&) = delete;
+    LoginScope& operator=(LoginScope&&) = delete;
+
+    [[nodiscard]] const Session::Ptr& GetSession() const
+    {
+      return _session;
+    }
+
+    // 交出续体，续体在会话所属的逻辑线程上发送响应，随后按到达顺序处理暂存的消息；只能调用一次
+    void Finish(Logic::Task respond)
+    {
+      auto* owner = std::exchange(_owner, nullptr);
+      owner->dispatch(LogicTask{.session = _session,
+                                .resume = [owner, session = _session, respond = std::move(respond)]
+                                {
+                                  respond();
+                                  owner->end_login(session);
+                                }});
+    }
+
+  private:
+    _impl* _owner;
+    Session::Ptr _session;
+    Logic::Task _on_abort;
+  };
+
+  // 会话关闭后不会再有登录续体处理它暂存的消息，在所属的逻辑线程上丢弃；任务持有会话，地址不会先被复用
+  void drop_parked(const Session::Ptr& session)
+  {
+    dispatch(LogicTask{.session = session,
+                       .resume = [this, session] { worker_of(session)._parked.erase(session.get()); }});
+  }
+
+  // 第一次投递时冻结处理函数表并启动逻辑线程，线程的创建保证它们看到完整的表
+  void ensure_started()
+  {
+    if (_started.load(std::memory_order_acquire))
+    {
+      return;
+    }
+
+    std::lock_guard lock{_start_mutex};
+    if (_started.load(std::memory_order_relaxed))
+    {
+      return;
+    }
+    for (std::size_t i = 0; i < _workers.size(); ++i)
+    {
+      _workers[i]->_thread = std::jthread([this, &ref = *_workers[i], i] { run(ref, i); });
+    }
+    _started.store(true, std::memory_order_release);
+  }
+
+  // 冻结之后的注册会与逻辑线程的查找并发，直接拒绝
+  template <typename Handler>
+  bool register_handler(std::unordered_map<short, Handler>& handlers, short msg_id, Handler handler)
+  {
+    std::lock_guard lock{_start_mutex};
+    if (_started.load(std::memory_order_relaxed))
+    {
+      tools::Logger::getInstance().error("Handler for message id {} registered after logic started, ignored", msg_id);
+      return false;
+    }
+    handlers[msg_id] = std::move(handler);
+    return true;
+  }
+
+  // 续体总是入队；消息队列已满时返回 false，由 io 线程暂停读取后重试，不丢弃消息
+  bool dispatch(LogicTask&& task)
+  {
+    ensure_started();
+
+    auto& worker = *_workers[shard_of(task.session.get())];
+
+    if (task.resume)
+    {
+      worker._resumes.emplace(std::move(task));
+    }
+    else if (!worker._queue.emplace(std::move(task)))
+    {
+      return false;
+    }
+
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (!worker._has_task.exchange(true, std::memory_order_release))
+    {
+      worker._has_task.notify_one();
+    }
+    return true;
+  }
+
+  // 登录成功后的持久化，在 io 线程上以协程方式访问数据库，参数按值传入协程帧
+  boost::asio::awaitable<void> persist_login(LoginScope scope, std::string uuid, LoginOptions options)
+  {
+    // 登录时间交给聚合器按间隔合并写入，不再为每次登录单独执行一条 UPDATE
+    if (!LoginActivity::GetInstance().Record(uuid))
+    {
+      tools::Logger::getInstance().warning("Login activity not running, last login of user {} not recorded", uuid);
+    }
+
+    // 查询用户基本信息，本地缓存命中时不访问数据库
+    UserDO user = (co_await ProfileCache::GetInstance().GetAsync(uuid)).value_or(UserDO{});
+
+    // 写入缓存后回到会话所属的逻辑线程组装响应
+    co_await cache_user_info(uuid, user);
+    scope.Finish([session = scope.GetSession(), uuid = std::move(uuid), user = std::move(user), options]
+                 { send_login_success(session, uuid, user, options); });
+  }
+
+  // 存入 redis，按照 prefix + uuid 作为 key，该哈希同时是 GateWay 判断已登录的标记
+  static boost::asio::awaitable<void> cache_user_info(const std::string& uuid, const UserDO& user)
+  {
+    auto key = global::server::USER_INFO_PREFIX + uuid;
+    auto pipeline = utils::AsyncRedisClient::GetInstance().NewPipeLine();
+    pipeline
+        .Append("HSET %s nickname %s avatar %s email %s", key.c_str(), user.nickname.c_str(), user.avatar.c_str(),
+                user.email.c_str())
+        .Append("EXPIRE %s %d", key.c_str(), global::server::USER_INFO_EXPIRE_TIME_S);
+    co_await pipeline.Execute();
+  }
+
+  // 退出登录时删除 redis 中的登录信息，完成后回到逻辑线程发送响应
+  boost::asio::awaitable<void> remove_login(Session::Ptr session, std::string uuid)
+  {
+    auto key = global::server::USER_INFO_PREFIX + uuid;
+    auto reply = co_await utils::AsyncRedisClient::GetInstance().Del(key);
+    bool removed = reply.IsValid() && !reply.IsError();
+    if (!removed)
+    {
+      tools::Logger::getInstance().error("Failed to delete user info from Redis for user {}", uuid);
+    }
+
+    dispatch(LogicTask{.session = session, .resume = [session, removed] { send_exit_login_result(session, removed); }});
+  }
+
+  // 令牌已在逻辑线程上校验，这里只续期 user_info: 哈希：键不存在说明已退出登录或登录已过期，拒绝恢复
+  // 随后从热缓存中取出各会话错过的消息，缓存不足以补齐时回源数据库
+  boost::asio::awaitable<void> resume_login(LoginScope scope, std::string uuid, LoginOptions options,
+                                            std::vector<utils::ResumeCursor> cursors)
+  {
+    auto key = global::server::USER_INFO_PREFIX + uuid;
+    auto reply = co_await utils::AsyncRedisClient::GetInstance().Expire(key, global::server::USER_INFO_EXPIRE_TIME_S);
+    if (!reply.IsValid() || reply.IsError() || reply.AsInteger().value_or(0) == 0)
+    {
+      scope.Finish([session = scope.GetSession()]
+                   { send_resume_failed(session, utils::RESUME_REJECTED, "Login expired"); });
+      co_return;
+    }
+
+    std::vector<utils::MissedMessages> missed;
+    missed.reserve(cursors.size());
+    for (const auto& cursor : cursors)
+    {
+      using global::server::HISTORY_PAGE_MAX;
+
+      auto range = co_await HistoryCache::RangeAsync(cursor.conversation_id(), 0, HISTORY_PAGE_MAX);
+      auto result = collect_missed(cursor, range.messages);
+
+      // 缓存非空时以最新消息结尾，取出的部分紧接 last_seq 即已补齐；缓存为空、过期或有空缺时与 load_history 一样回源
+      if (!range.complete && (range.messages.empty() || result.has_more()))
+      {
+        auto stored = co_await MessageRepository::getHistoryAsync(cursor.conversation_id(), 0, HISTORY_PAGE_MAX);
+        if (stored.has_value())
+        {
+          co_await HistoryCache::FillAsync(cursor.conversation_id(), *stored);
+          result = collect_missed(cursor,
+                                  merge_history(std::move(*stored), std::move(range.messages), HISTORY_PAGE_MAX));
+        }
+        else
+        {
+          // 保留缓存中取出的部分，由客户端之后以 ID_LOAD_HISTORY 补齐
+          result.set_has_more(true);
+        }
+      }
+      missed.emplace_back(std::move(result));
+    }
+
+    scope.Finish([session = scope.GetSession(), uuid = std::move(uuid), options, missed = std::move(missed)]
+                 { send_resume_success(session, uuid, options, missed); });
+  }
+
+  static void fill_chat_msg(const MessageDO& message, utils::ChatMsg& msg)
+  {
+    msg.set_conversation_id(message.conversation_id);
+    msg.set_seq(message.seq);
+    msg.set_sender_uuid(message.sender_uuid);
+    msg.set_msg_type(message.msg_type);
+    msg.set_content(message.content);
+    msg.set_created_at(message.created_at);
+  }
+
+  // messages 按 seq 降序且以最新消息开头，取出 seq 大于 last_seq 的部分，遇到空缺即停止
+  static utils::MissedMessages collect_missed(const utils::ResumeCursor& cursor,
+                                              const std::vector<MessageDO>& messages)
+  {
+    utils::MissedMessages result;
+    result.set_conversation_id(cursor.conversation_id());
+
+    std::uint64_t expected = 0;
+    for (const auto& message : messages)
+    {
+      if (message.seq <= cursor.last_seq() || (expected != 0 && message.seq != expected))
+      {
+        break;
+      }
+
+      fill_chat_msg(message, *result.add_messages());
+      expected = message.seq - 1;
+    }
+
+    // 最后一条紧接在 last_seq 之后时已补齐，否则超出一页、缓存不够或区间有空缺，由客户端继续拉取
+    result.set_has_more(result.messages_size() > 0 && expected != cursor.last_seq());
+    return result;
+  }
+
+  // 先读 Redis 热缓存，缓存中的区间不连续或不够一页时按主键回源数据库
+  boost::asio::awaitable<void> load_history(Session::Ptr session, std::string conversation_id,
+                                            std::uint64_t before_seq, std::uint32_t limit)
+  {
+    auto range = co_await HistoryCache::RangeAsync(conversation_id, before_seq, limit);
+    auto messages = std::move(range.messages);
+
+    if (!range.complete)
+    {
+      auto stored = co_await MessageRepository::getHistoryAsync(conversation_id, before_seq, limit);
+      if (!stored.has_value())
+      {
+        dispatch(LogicTask{.session = session,
+                           .resume = [session]
+                           { send_history_error(session, utils::DB_ERROR, "Failed to load history"); }});
+        co_return;
+      }
+
+      // 与缓存相接的页才写回，保证缓存仍是以最新消息结尾的连续区间
+      if (range.anchored)
+      {
+        co_await HistoryCache::FillAsync(conversation_id, *stored);
+      }
+
+      // 落库是异步的，最新的几条可能只在缓存中
+      messages = merge_history(std::move(*stored), std::move(messages), limit);
     }
 
-    tools::Logger::getInstance().info("Logic thread stopped");
+    dispatch(LogicTask{.session = session,
+                       .resume = [session, conversation_id = std::move(conversation_id),
+                                  messages = std::move(messages)]
+                       { send_history(session, conversation_id, messages); }});
   }
 
-  static std::optional<Json::Value> parse_json(const std::string& json_str)
+  // 两路都按 seq 降序，归并去重后取前 limit 条
+  static std::vector<MessageDO> merge_history(std::vector<MessageDO> stored, std::vector<MessageDO> cached,
+                                              std::uint32_t limit)
   {
-    Json::Value root;
-    Json::CharReaderBuilder builder;
-    std::string errors;
-    std::istringstream stream(json_str);
+    std::vector<MessageDO> merged;
+    merged.reserve(std::min<std::size_t>(limit, stored.size() + cached.size()));
 
-    if (!Json::parseFromStream(builder, stream, &root, &errors))
+    auto lhs = stored.begin();
+    auto rhs = cached.begin();
+    while (merged.size() < limit && (lhs != stored.end() || rhs != cached.end()))
     {
-      return std::nullopt;
+      if (rhs == cached.end() || (lhs != stored.end() && lhs->seq >= rhs->seq))
+      {
+        if (rhs != cached.end() && rhs->seq == lhs->seq)
+        {
+          ++rhs;
+        }
+        merged.push_back(std::move(*lhs++));
+      }
+      else
+      {
+        merged.push_back(std::move(*rhs++));
+      }
     }
-    return root;
+    return merged;
+  }
+
+  // 单聊的会话 id 为双方 uuid 按字典序拼接，调用方须是其中一方；群聊尚无成员关系的数据模型，一律拒绝
+  static bool is_member(const std::string& conversation_id, const std::string& uuid)
+  {
+    using global::server::UUID_LENGTH;
+
+    if (conversation_id.size() != 2 * UUID_LENGTH || uuid.size() != UUID_LENGTH)
+    {
+      return false;
+    }
+
+    std::string_view first{conversation_id.data(), UUID_LENGTH};
+    std::string_view second{conversation_id.data() + UUID_LENGTH, UUID_LENGTH};
+    return first < second && (first == uuid || second == uuid);
+  }
+
+  // 单聊中另一方的 uuid，调用方须已通过 is_member 检查
+  static std::string peer_of(const std::string& conversation_id, const std::string& uuid)
+  {
+    using global::server::UUID_LENGTH;
+
+    return conversation_id.compare(0, UUID_LENGTH, uuid) == 0 ? conversation_id.substr(UUID_LENGTH)
+                                                              : conversation_id.substr(0, UUID_LENGTH);
+  }
+
+  // 计数器存在时一次往返完成 INCR；不存在时是新会话或 Redis 丢失了计数器，以已落库的最大 seq、本进程落库队列中
+  // 的最大 seq 与历史缓存中最新一条的 seq 三者的较大者起算，数据库落后于写线程时也不会重号；
+  // SETNX 保证并发的首条消息只起算一次。分配失败返回 0
+  static boost::asio::awaitable<std::uint64_t> next_seq(const std::string& conversation_id)
+  {
+    constexpr const char* incr_if_exists =
+        "if redis.call('EXISTS', KEYS[1]) == 1 then return redis.call('INCR', KEYS[1]) end return false";
+
+    auto& redis = utils::AsyncRedisClient::GetInstance();
+    auto key = global::server::CONVERSATION_SEQ_PREFIX + conversation_id;
+
+    auto reply = co_await redis.Command("EVAL %s 1 %b", incr_if_exists, key.data(), key.size());
+    if (!reply.IsValid() || reply.IsError())
+    {
+      co_return 0;
+    }
+    if (!reply.IsNil())
+    {
+      co_return static_cast<std::uint64_t>(reply.AsInteger().value_or(0));
+    }
+
+    // 先读队列再读数据库：读队列时已写完出队的消息，读数据库时一定已经落库
+    auto pending = MessageWriter::GetInstance().GetPendingMaxSeq(conversation_id);
+    auto stored = co_await MessageRepository::getMaxSeqAsync(conversation_id);
+    auto cached = co_await HistoryCache::LatestSeqAsync(conversation_id);
+    if (!stored.has_value() || !cached.has_value())
+    {
+      co_return 0;
+    }
+
+    auto seed = std::max({pending, *stored, *cached});
+    auto seeded = co_await redis.SetNX(key, std::to_string(seed));
+    if (!seeded.IsValid() || seeded.IsError())
+    {
+      co_return 0;
+    }
+
+    reply = co_await redis.Incr(key);
+    if (!reply.IsValid() || reply.IsError())
+    {
+      co_return 0;
+    }
+    co_return static_cast<std::uint64_t>(reply.AsInteger().value_or(0));
+  }
+
+  // 分配 seq 后交给写线程落库，不等待数据库往返；入队被拒绝时该 seq 留下空缺，历史读取遇到空缺会回源数据库
+  boost::asio::awaitable<void> send_chat(Session::Ptr session, std::string uuid, utils::ChatSendRequest request)
+  {
+    utils::ChatSendResponse response;
+    response.set_conversation_id(request.conversation_id());
+    response.set_client_msg_id(request.client_msg_id());
+
+    auto seq = co_await next_seq(request.conversation_id());
+    if (seq == 0)
+    {
+      tools::Logger::getInstance().error("Failed to assign seq for conversation {}", request.conversation_id());
+      response.set_code(utils::REDIS_ERROR);
+      response.set_message("Failed to assign seq");
+    }
+    else
+    {
+      auto created_at = std::chrono::duration_cast<std::chrono::milliseconds>(
+          std::chrono::system_clock::now().time_since_epoch());
+      MessageDO message{.conversation_id = request.conversation_id(),
+                        .seq = seq,
+                        .sender_uuid = std::move(uuid),
+                        .msg_type = static_cast<std::uint8_t>(request.msg_type()),
+                        .content = std::move(*request.mutable_content()),
+                        .created_at = static_cast<std::uint64_t>(created_at.count())};
+
+      if (MessageWriter::GetInstance().Submit(message))
+      {
+        // 落库之前的历史读取从缓存中取到这条消息
+        co_await HistoryCache::AppendAsync(message);
+        push_message(session, message);
+
+        response.set_code(utils::SUCCESS);
+        response.set_message("Send successful");
+        response.set_seq(seq);
+        response.set_created_at(static_cast<std::uint64_t>(created_at.count()));
+      }
+      else
+      {
+        response.set_code(utils::PERSIST_BUSY);
+        response.set_message("Message queue is full, retry later");
+      }
+    }
+
+    dispatch(LogicTask{.session = session,
+                       .resume = [session, response = std::move(response)]
+                       { send_message(session, utils::ID_CHAT_SEND_RESPONSE, response); }});
+  }
+
+  // 推送给双方在本服务器上的全部设备，按各设备协商的编码各序列化一次；发送消息的会话已从回包中得到 seq，不再推送
+  // 双方在其他服务器上的设备经转发流送达，尚无用户所在服务器的索引，转发给全部对端，由对端投递给本地在线的会话
+  static void push_message(const Session::Ptr& sender, const MessageDO& message)
+  {
+    utils::ChatMsg push;
+    fill_chat_msg(message, push);
+
+    auto receiver = peer_of(message.conversation_id, message.sender_uuid);
+    auto& users = UserManager::GetInstance();
+    auto targets = users.GetSessions(message.sender_uuid);
+    std::erase(targets, sender);
+    for (auto& session : users.GetSessions(receiver))
+    {
+      targets.push_back(std::move(session));
+    }
+
+    auto encode = [&push](utils::WireProtocol protocol) { return utils::MessageCodec::Encode(protocol, push); };
+    FanOut::GetInstance().Publish(utils::ID_CHAT_PUSH, encode, targets);
+
+    // 转发的帧统一以 protobuf 编码，对端按各会话的编码转码
+    auto& relay = utils::ChatServerClient::GetInstance();
+    if (relay.GetPeerCount() != 0)
+    {
+      auto body = utils::MessageCodec::Encode(utils::WireProtocol::PROTOBUF, push);
+      relay.Broadcast(message.sender_uuid, utils::ID_CHAT_PUSH, utils::WireProtocol::PROTOBUF, body);
+      relay.Broadcast(receiver, utils::ID_CHAT_PUSH, utils::WireProtocol::PROTOBUF, body);
+    }
+  }
+
+  static void send_chat_error(const Session::Ptr& session, const utils::ChatSendRequest& request, std::int16_t code,
+                              const char* message)
+  {
+    utils::ChatSendResponse response;
+    response.set_code(code);
+    response.set_message(message);
+    response.set_conversation_id(request.conversation_id());
+    response.set_client_msg_id(request.client_msg_id());
+    send_message(session, utils::ID_CHAT_SEND_RESPONSE, response);
+  }
+
+  static void send_history(const Session::Ptr& session, const std::string& conversation_id,
+                           const std::vector<MessageDO>& messages)
+  {
+    utils::LoadHistoryResponse response;
+    response.set_code(utils::SUCCESS);
+    response.set_message("Load history successful");
+    response.set_conversation_id(conversation_id);
+
+    for (const auto& message : messages)
+    {
+      fill_chat_msg(message, *response.add_messages());
+    }
+    response.set_has_more(!messages.empty() && messages.back().seq > 1);
+    send_message(session, utils::ID_LOAD_HISTORY_RESPONSE, response);
+  }
+
+  static void send_history_error(const Session::Ptr& session, std::int16_t code, const char* message)
+  {
+    utils::LoadHistoryResponse response;
+    response.set_code(code);
+    response.set_message(message);
+    send_message(session, utils::ID_LOAD_HISTORY_RESPONSE, response);
+  }
+
+  // 按会话当前协商的编码与压缩方式发送
+  template <typename Message>
+  static void send_message(const Session::Ptr& session, short msg_id, const Message& msg)
+  {
+    session->Send(msg_id, utils::MessageCodec::Encode(session->GetProtocol(), msg));
+  }
+
+  static void send_exit_login_result(const Session::Ptr& session, bool removed)
+  {
+    utils::ExitLoginResponse response;
+
+    if (removed)
+    {
+      response.set_code(utils::SUCCESS);
+      response.set_message("Exit login successful");
+    }
+    else
+    {
+      response.set_code(utils::REDIS_ERROR);
+      response.set_message("Failed to delete user info from Redis");
+    }
+    send_message(session, utils::ID_EXIT_LOGIN_RESPONSE, response);
+  }
+
+  // 校验 RPC 的完成回调，运行在 gRPC 内部线程上
+  void on_login_verified(const Session::Ptr& session, const std::string& uuid, LoginOptions options,
+                         utils::LoginVerifyResult res)
+  {
+    if (!res)
+    {
+      fail_login(session, std::move(res.error()));
+      return;
+    }
+
+    // 数据库访问不在 gRPC 线程上进行，交给 io 线程上的协程；协程因异常退出时由 LoginScope 回复失败并结束登录
+    LoginScope scope{*this, session,
+                     [session]
+                     { send_login_failed(session, {.code = grpc::StatusCode::INTERNAL, .message = "Login failed"}); }};
+    boost::asio::co_spawn(IO::GetInstance().GetIOContext(), persist_login(std::move(scope), uuid, options),
+                          [uuid](const std::exception_ptr& error) { log_coroutine_error("Login", uuid, error); });
+  }
+
+  static void log_coroutine_error(std::string_view what, const std::string& uuid, const std::exception_ptr& error)
+  {
+    if (!error)
+    {
+      return;
+    }
+
+    try
+    {
+      std::rethrow_exception(error);
+    }
+    catch (const std::exception& e)
+    {
+      tools::Logger::getInstance().error("{} of user {} failed: {}", what, uuid, e.what());
+    }
+    catch (...)
+    {
+      tools::Logger::getInstance().error("{} of user {} failed with an unknown error", what, uuid);
+    }
+  }
+
+  void fail_login(const Session::Ptr& session, utils::GrpcError error)
+  {
+    dispatch(LogicTask{.session = session,
+                       .resume = [this, session, error = std::move(error)]
+                       {
+                         send_login_failed(session, error);
+                         end_login(session);
+                       }});
+  }
+
+  // 登录响应属于握手，总是以 JSON 编码，失败时会话保持原有编码
+  static void send_login_failed(const Session::Ptr& session, const utils::GrpcError& error)
+  {
+    utils::LoginChatResponse response;
+
+    tools::Logger::getInstance().error("Login failed: {}", error.message);
+    response.set_code(error.code);
+    response.set_message(error.message);
+    session->Send(SendNode::Create(utils::ID_LOGIN_CHAT_RESPONSE,
+                                   utils::MessageCodec::Encode(utils::WireProtocol::JSON, response)));
+  }
+
+  // 响应中带上确认的编码与压缩方式，入队之后再切换会话，客户端收到响应后同样切换
+  // 切换完成后写入在线索引，此后投递给该用户的消息已按新编码组帧
+  static void send_login_success(const Session::Ptr& session, const std::string& uuid, const UserDO& user,
+                                 LoginOptions options)
+  {
+    utils::LoginChatResponse response;
+
+    auto* user_info = response.mutable_data();
+    user_info->set_nickname(user.nickname);
+    user_info->set_avatar(user.avatar);
+    user_info->set_email(user.email);
+
+    response.set_code(utils::SUCCESS);
+    response.set_message("Login successful");
+    response.set_resume_token(ResumeToken::Issue(uuid));
+    response.set_protocol(static_cast<std::uint32_t>(options.protocol));
+    response.set_compression(static_cast<std::uint32_t>(options.compression.algorithm));
+    if (options.compression.use_dict)
+    {
+      response.set_dict_id(FrameCompressor::GetInstance().GetDictId());
+    }
+    session->Send(SendNode::Create(utils::ID_LOGIN_CHAT_RESPONSE,
+                                   utils::MessageCodec::Encode(utils::WireProtocol::JSON, response)));
+    session->SetProtocol(options.protocol);
+    session->SetCompression(options.compression);
+    UserManager::GetInstance().Bind(uuid, session);
+  }
+
+  // 与登录响应一样以 JSON 编码，失败时会话保持原有编码，客户端改走完整登录
+  static void send_resume_failed(const Session::Ptr& session, std::int16_t code, const char* message)
+  {
+    utils::ResumeResponse response;
+    response.set_code(code);
+    response.set_message(message);
+    session->Send(SendNode::Create(utils::ID_RESUME_RESPONSE,
+                                   utils::MessageCodec::Encode(utils::WireProtocol::JSON, response)));
+  }
+
+  // 与登录成功相同：响应入队后切换编码并写入在线索引，同时签发新的令牌
+  static void send_resume_success(const Session::Ptr& session, const std::string& uuid, LoginOptions options,
+                                  const std::vector<utils::MissedMessages>& missed)
+  {
+    utils::ResumeResponse response;
+    response.set_code(utils::SUCCESS);
+    response.set_message("Resume successful");
+    response.set_protocol(static_cast<std::uint32_t>(options.protocol));
+    response.set_compression(static_cast<std::uint32_t>(options.compression.algorithm));
+    if (options.compression.use_dict)
+    {
+      response.set_dict_id(FrameCompressor::GetInstance().GetDictId());
+    }
+    response.set_resume_token(ResumeToken::Issue(uuid));
+    for (const auto& conversation : missed)
+    {
+      *response.add_missed() = conversation;
+    }
+
+    session->Send(SendNode::Create(utils::ID_RESUME_RESPONSE,
+                                   utils::MessageCodec::Encode(utils::WireProtocol::JSON, response)));
+    session->SetProtocol(options.protocol);
+    session->SetCompression(options.compression);
+    UserManager::GetInstance().Bind(uuid, session);
   }
 
   void init_handlers()
@@ -92,117 +856,174 @@ struct Logic::_impl
     // 注册消息处理函数
     _handlers[utils::ID_LOGIN_CHAT] = [this](const Session::Ptr& session, const std::span<const char>& data)
     {
-      Json::Value response;
-      Json::StreamWriterBuilder writer;
-
-      auto root = parse_json(std::string(data.data(), data.size()));
-      if (!root)
+      utils::LoginChatRequest request;
+      if (!utils::MessageCodec::Decode(utils::WireProtocol::JSON, data, request))
       {
         tools::Logger::getInstance().error("Failed to parse JSON");
-        response["code"] = utils::JSON_PARSE_ERROR;
-        response["message"] = "Failed to parse JSON";
-        session->Send(std::make_shared<SendNode>(utils::ID_LOGIN_CHAT_RESPONSE, Json::writeString(writer, response)));
+
+        utils::LoginChatResponse response;
+        response.set_code(utils::JSON_PARSE_ERROR);
+        response.set_message("Failed to parse JSON");
+        session->Send(SendNode::Create(utils::ID_LOGIN_CHAT_RESPONSE,
+                                       utils::MessageCodec::Encode(utils::WireProtocol::JSON, response)));
         return;
       }
 
-      // 调用 RPC 校验
-      auto uuid = root.value()["uuid"].asString();
-      auto token = root.value()["token"].asString();
-      auto res = _status_server_client.VerifyLoginInfo(uuid, token);
-      if (!res)
+      // 异步 RPC 校验，等待期间逻辑线程继续处理其他会话的消息
+      LoginOptions options{
+          .protocol = utils::MessageCodec::Negotiate(request.protocol()),
+          .compression = FrameCompressor::GetInstance().Negotiate(request.compression(), request.dict_id())};
+      begin_login(session);
+      _status_server_client.AsyncVerifyLoginInfo(request.uuid(), request.token(),
+                                                 [this, session, uuid = request.uuid(), options](
+                                                     utils::LoginVerifyResult res)
+                                                 { on_login_verified(session, uuid, options, std::move(res)); });
+    };
+
+    _handlers[utils::ID_EXIT_LOGIN] = [this](const Session::Ptr& session, const std::span<const char>& data)
+    {
+      auto protocol = session->GetProtocol();
+
+      utils::ExitLoginRequest request;
+      if (!utils::MessageCodec::Decode(protocol, data, request))
       {
-        tools::Logger::getInstance().error("Login failed: {}", res.error().message);
-        response["code"] = res.error().code;
-        response["message"] = res.error().message;
-        session->Send(std::make_shared<SendNode>(utils::ID_LOGIN_CHAT_RESPONSE, Json::writeString(writer, response)));
+        tools::Logger::getInstance().error("Failed to parse exit login request");
+
+        utils::ExitLoginResponse response;
+        response.set_code(utils::MessageCodec::ParseErrorCode(protocol));
+        response.set_message("Failed to parse request");
+        send_message(session, utils::ID_EXIT_LOGIN_RESPONSE, response);
         return;
       }
 
-      // 更新登录时间
-      if (UserRepository::updateLastLogin(uuid))
+      // 先从在线索引中移除，之后不再向该会话投递消息；再删除 redis 中的登录信息，在 io 线程上以协程方式等待
+      UserManager::GetInstance().Unbind(*session);
+      boost::asio::co_spawn(IO::GetInstance().GetIOContext(), remove_login(session, request.uuid()),
+                            boost::asio::detached);
+    };
+
+    _handlers[utils::ID_RESUME] = [this](const Session::Ptr& session, const std::span<const char>& data)
+    {
+      utils::ResumeRequest request;
+      if (!utils::MessageCodec::Decode(utils::WireProtocol::JSON, data, request))
       {
-        tools::Logger::getInstance().info("Updated last login time for user {}", uuid);
+        tools::Logger::getInstance().error("Failed to parse resume request");
+        send_resume_failed(session, utils::JSON_PARSE_ERROR, "Failed to parse JSON");
+        return;
       }
-      else
+
+      // 签名与过期时间在本地校验，伪造或过期的令牌不产生任何网络往返
+      auto claims = ResumeToken::Verify(request.token());
+      if (!claims.has_value())
       {
-        tools::Logger::getInstance().error("Failed to update last login time for user {}", uuid);
+        send_resume_failed(session, utils::RESUME_REJECTED, "Resume token invalid or expired");
+        return;
       }
 
-      // 查询用户基本信息
-      UserDO user = UserRepository::getUserById(uuid);
+      LoginOptions options{
+          .protocol = utils::MessageCodec::Negotiate(request.protocol()),
+          .compression = FrameCompressor::GetInstance().Negotiate(request.compression(), request.dict_id())};
+      auto count = std::min<std::size_t>(static_cast<std::size_t>(request.cursors_size()),
+                                         global::server::RESUME_MAX_CURSORS);
+      std::vector<utils::ResumeCursor> cursors(request.cursors().begin(), request.cursors().begin() + count);
+
+      // 与拉取历史消息相同，只补发令牌所属用户参与的会话，其余游标忽略
+      std::erase_if(cursors, [&uuid = claims->uuid](const utils::ResumeCursor& cursor)
+                    { return !is_member(cursor.conversation_id(), uuid); });
+      begin_login(session);
+      LoginScope scope{*this, session, [session] { send_resume_failed(session, utils::REDIS_ERROR, "Resume failed"); }};
+      boost::asio::co_spawn(IO::GetInstance().GetIOContext(),
+                            resume_login(std::move(scope), claims->uuid, options, std::move(cursors)),
+                            [uuid = claims->uuid](const std::exception_ptr& error)
+                            { log_coroutine_error("Resume", uuid, error); });
+    };
+
+    _handlers[utils::ID_LOAD_HISTORY] = [this](const Session::Ptr& session, const std::span<const char>& data)
+    {
+      using namespace global::server;
 
-      Json::Value user_info;
-      user_info["nickname"] = user.nickname;
-      user_info["avatar"] = user.avatar;
-      user_info["email"] = user.email;
+      utils::LoadHistoryRequest request;
+      if (!utils::MessageCodec::Decode(session->GetProtocol(), data, request))
+      {
+        tools::Logger::getInstance().error("Failed to parse load history request");
+        send_history_error(session, utils::MessageCodec::ParseErrorCode(session->GetProtocol()),
+                           "Failed to parse request");
+        return;
+      }
 
-      // 存入 redis，按照 prefix + uuid 作为 key
-      auto redis_conn = utils::RedisPool::GetInstance().GetConnection();
-      auto key = global::server::USER_INFO_PREFIX + uuid;
-      auto pipeline = redis_conn.NewPipeLine();
-      pipeline.Append("HSET %s nickname %s", key.c_str(), user.nickname.c_str())
-          .Append("HSET %s avatar %s", key.c_str(), user.avatar.c_str())
-          .Append("HSET %s email %s", key.c_str(), user.email.c_str())
-          .Append("EXPIRE %s %d", key.c_str(), global::server::USER_INFO_EXPIRE_TIME_S);
-      pipeline.Execute();
+      auto uuid = session->GetUserId();
+      if (uuid.empty())
+      {
+        send_history_error(session, utils::NOT_LOGGED_IN, "Not logged in");
+        return;
+      }
+      if (!is_member(request.conversation_id(), uuid))
+      {
+        send_history_error(session, utils::NOT_A_MEMBER, "Not a member of the conversation");
+        return;
+      }
 
-      // 返回响应
-      response["code"] = utils::SUCCESS;
-      response["message"] = "Login successful";
-      response["data"] = user_info;
-      session->Send(std::make_shared<SendNode>(utils::ID_LOGIN_CHAT_RESPONSE, Json::writeString(writer, response)));
+      auto limit = request.limit() == 0 ? HISTORY_PAGE_DEFAULT : std::min(request.limit(), HISTORY_PAGE_MAX);
+      boost::asio::co_spawn(IO::GetInstance().GetIOContext(),
+                            load_history(session, request.conversation_id(), request.before_seq(), limit),
+                            boost::asio::detached);
     };
 
-    _handlers[utils::ID_EXIT_LOGIN] = [](const Session::Ptr& session, const std::span<const char>& data)
+    _handlers[utils::ID_CHAT_SEND] = [this](const Session::Ptr& session, const std::span<const char>& data)
     {
-      Json::Value response;
-      Json::StreamWriterBuilder writer;
-
-      auto root = parse_json(std::string(data.data(), data.size()));
-      if (!root)
+      utils::ChatSendRequest request;
+      if (!utils::MessageCodec::Decode(session->GetProtocol(), data, request))
       {
-        tools::Logger::getInstance().error("Failed to parse JSON");
-        response["code"] = utils::JSON_PARSE_ERROR;
-        response["message"] = "Failed to parse JSON";
-        session->Send(std::make_shared<SendNode>(utils::ID_EXIT_LOGIN_RESPONSE, Json::writeString(writer, response)));
+        tools::Logger::getInstance().error("Failed to parse chat send request");
+        send_chat_error(session, request, utils::MessageCodec::ParseErrorCode(session->GetProtocol()),
+                        "Failed to parse request");
         return;
       }
 
-      // 删除 redis 中的登录信息
-      auto uuid = root.value()["uuid"].asString();
-      auto key = global::server::USER_INFO_PREFIX + uuid;
-      auto redis_conn = utils::RedisPool::GetInstance().GetConnection();
-      auto reply = redis_conn.Del(key);
-      if (!reply.IsValid() || reply.IsError())
+      auto uuid = session->GetUserId();
+      if (uuid.empty())
+      {
+        send_chat_error(session, request, utils::NOT_LOGGED_IN, "Not logged in");
+        return;
+      }
+      if (!is_member(request.conversation_id(), uuid))
       {
-        tools::Logger::getInstance().error("Failed to delete user info from Redis for user {}", uuid);
-        response["code"] = utils::REDIS_ERROR;
-        response["message"] = "Failed to delete user info from Redis";
-        session->Send(std::make_shared<SendNode>(utils::ID_EXIT_LOGIN_RESPONSE, Json::writeString(writer, response)));
+        send_chat_error(session, request, utils::NOT_A_MEMBER, "Not a member of the conversation");
         return;
       }
 
-      // 返回响应
-      response["code"] = utils::SUCCESS;
-      response["message"] = "Exit login successful";
-      session->Send(std::make_shared<SendNode>(utils::ID_EXIT_LOGIN_RESPONSE, Json::writeString(writer, response)));
+      boost::asio::co_spawn(IO::GetInstance().GetIOContext(),
+                            send_chat(session, std::move(uuid), std::move(request)), boost::asio::detached);
     };
   }
 
-  _impl() : _thread([this] { run(); })
+  // 线程在第一次投递时才启动，此前可以继续注册处理函数
+  explicit _impl(std::size_t worker_count)
   {
     init_handlers();
+
+    _workers.reserve(worker_count);
+    for (std::size_t i = 0; i < worker_count; ++i)
+    {
+      _workers.emplace_back(std::make_unique<LogicWorker>());
+    }
   }
 
   ~_impl()
   {
     _running.store(false, std::memory_order_release);
-    _has_task.store(true, std::memory_order_release);
-    _has_task.notify_one();
+    for (auto& worker : _workers)
+    {
+      worker->_has_task.store(true, std::memory_order_release);
+      worker->_has_task.notify_one();
+    }
+
+    // 在 _handlers 析构之前等待所有线程退出
+    _workers.clear();
   }
 };
 
-Logic::Logic() : _pimpl(std::make_unique<_impl>())
+Logic::Logic() : _pimpl(std::make_unique<_impl>(static_cast<std::size_t>(global::server::LOGIC_WORKER_COUNT)))
 {
 }
 
@@ -214,17 +1035,40 @@ Logic& Logic::GetInstance()
   return instance;
 }
 
-void Logic::PostToLogic(const std::shared_ptr<Session>& session, const std::shared_ptr<RecvNode>& msg)
+bool Logic::PostToLogic(const std::shared_ptr<Session>& session, const std::shared_ptr<RecvNode>& msg)
 {
-  if (_pimpl->_queue.emplace(LogicTask{.session = session, .msg = msg}))
-  {
-    _pimpl->_has_task.store(true, std::memory_order_release);
-    _pimpl->_has_task.notify_one();
-  }
-  else
-  {
-    tools::Logger::getInstance().error("Logic queue is full");
-  }
+  return _pimpl->dispatch(LogicTask{.session = session, .msg = msg});
+}
+
+void Logic::PostToLogic(const std::shared_ptr<Session>& session, Task task)
+{
+  _pimpl->dispatch(LogicTask{.session = session, .resume = std::move(task)});
+}
+
+void Logic::OnSessionClosed(const std::shared_ptr<Session>& session)
+{
+  _pimpl->drop_parked(session);
+}
+
+bool Logic::RegisterHandler(short msg_id, CallBack handler)
+{
+  return _pimpl->register_handler(_pimpl->_handlers, msg_id, std::move(handler));
+}
+
+bool Logic::RegisterChunkedHandler(short msg_id, ChunkedCallBack handler)
+{
+  return _pimpl->register_handler(_pimpl->_chunked_handlers, msg_id, std::move(handler));
+}
+
+std::size_t Logic::GetWorkerCount() const
+{
+  return _pimpl->_workers.size();
+}
+
+std::size_t Logic::GetQueueDepth(std::size_t worker) const
+{
+  const auto& target = *_pimpl->_workers[worker % _pimpl->_workers.size()];
+  return target._queue.size() + target._resumes.size();
 }
 
 }  // namespace core
\ No newline at end of file
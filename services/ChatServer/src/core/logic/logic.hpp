@@ -13,6 +13,7 @@
 
 #include <core/CoreExport.hpp>
 #include <core/msg-node/msg-node.hpp>
+#include <cstddef>
 #include <functional>
 #include <memory>
 #include <span>
@@ -25,10 +26,32 @@ class CORE_EXPORT Logic
 {
 public:
   using CallBack = std::function<void(const std::shared_ptr<Session>&, std::span<const char>)>;
+  using ChunkedCallBack = std::function<void(const std::shared_ptr<Session>&, std::span<const std::span<char>>)>;
+  using Task = std::function<void()>;
 
   static Logic& GetInstance();
 
-  void PostToLogic(const std::shared_ptr<Session>& session, const std::shared_ptr<RecvNode>& msg);
+  // 按会话哈希投递到固定的逻辑线程，同一会话内保持顺序；该线程的队列已满时返回 false，调用方稍后重试
+  [[nodiscard]] bool PostToLogic(const std::shared_ptr<Session>& session, const std::shared_ptr<RecvNode>& msg);
+
+  // 异步操作完成后，把续体投递回会话所属的逻辑线程执行，续体单独排队且不设上限，从不丢弃
+  void PostToLogic(const std::shared_ptr<Session>& session, Task task);
+
+  // 会话关闭时调用，丢弃它在登录或恢复期间暂存的消息
+  void OnSessionClosed(const std::shared_ptr<Session>& session);
+
+  // 注册消息处理函数，只能在第一次 PostToLogic 之前调用：此后处理函数表冻结，逻辑线程无锁读取，
+  // 再注册时拒绝并返回 false
+  bool RegisterHandler(short msg_id, CallBack handler);
+
+  // 注册大帧的分块处理函数，未注册时大帧消息体会拼成连续内存交给 RegisterHandler 注册的处理函数，限制同上
+  bool RegisterChunkedHandler(short msg_id, ChunkedCallBack handler);
+
+  // 逻辑线程数量
+  [[nodiscard]] std::size_t GetWorkerCount() const;
+
+  // 指定逻辑线程当前积压的任务数
+  [[nodiscard]] std::size_t GetQueueDepth(std::size_t worker) const;
 
   Logic(const Logic&) = delete;
   Logic& operator=(const Logic&) = delete;
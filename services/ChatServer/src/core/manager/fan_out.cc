@@ -0,0 +1,131 @@
+#include "fan_out.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <boost/asio/any_io_executor.hpp>
+#include <boost/asio/post.hpp>
+#include <core/msg-node/frame-compressor.hpp>
+#include <core/msg-node/msg-node.hpp>
+#include <core/session/session.hpp>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace core
+{
+
+namespace
+{
+
+struct alignas(64) FanOutCounters
+{
+  std::atomic<std::uint64_t> _publishes{0};
+  std::atomic<std::uint64_t> _frames_encoded{0};
+  std::atomic<std::uint64_t> _sessions{0};
+  std::atomic<std::uint64_t> _posts{0};
+};
+
+FanOutCounters g_fan_out_counters;
+
+// 一种帧对应一种编码与压缩方式的组合
+struct Variant
+{
+  utils::WireProtocol _protocol;
+  CompressionMode _mode;
+};
+
+// 同一 executor 上的目标会话，_variants[i] 为 _sessions[i] 使用的帧在 _nodes 中的下标
+struct Batch
+{
+  boost::asio::any_io_executor _executor;
+  std::vector<std::shared_ptr<Session>> _sessions;
+  std::vector<std::uint8_t> _variants;
+};
+
+bool same_mode(const CompressionMode& lhs, const CompressionMode& rhs)
+{
+  return lhs.algorithm == rhs.algorithm && lhs.use_dict == rhs.use_dict;
+}
+
+}  // namespace
+
+FanOut& FanOut::GetInstance()
+{
+  static FanOut instance;
+  return instance;
+}
+
+std::size_t FanOut::Publish(short msg_id, const Encoder& encode,
+                            std::span<const std::shared_ptr<Session>> targets) const
+{
+  // 编码、压缩方式与 executor 都只有少数几种，线性查找即可
+  std::vector<std::pair<utils::WireProtocol, std::string>> bodies;
+  std::vector<Variant> variants;
+  auto nodes = std::make_shared<std::vector<std::shared_ptr<SendNode>>>();
+  std::vector<Batch> batches;
+  std::size_t delivered = 0;
+
+  for (const auto& session : targets)
+  {
+    if (!session || session->IsClosed())
+    {
+      continue;
+    }
+
+    auto protocol = session->GetProtocol();
+    auto mode = session->GetCompression();
+    auto variant = std::ranges::find_if(variants, [protocol, &mode](const Variant& known)
+                                        { return known._protocol == protocol && same_mode(known._mode, mode); });
+    if (variant == variants.end())
+    {
+      auto body = std::ranges::find_if(bodies, [protocol](const auto& known) { return known.first == protocol; });
+      if (body == bodies.end())
+      {
+        body = bodies.insert(bodies.end(), {protocol, encode(protocol)});
+      }
+      nodes->emplace_back(FrameCompressor::GetInstance().MakeSendNode(msg_id, body->second, mode));
+      variant = variants.insert(variants.end(), Variant{._protocol = protocol, ._mode = mode});
+    }
+
+    auto executor = session->GetExecutor();
+    auto batch = std::ranges::find_if(batches, [&executor](const Batch& known) { return known._executor == executor; });
+    if (batch == batches.end())
+    {
+      batch = batches.insert(batches.end(), Batch{._executor = std::move(executor), ._sessions = {}, ._variants = {}});
+    }
+
+    batch->_sessions.push_back(session);
+    batch->_variants.push_back(static_cast<std::uint8_t>(variant - variants.begin()));
+    ++delivered;
+  }
+
+  for (auto& batch : batches)
+  {
+    auto executor = batch._executor;
+    boost::asio::post(executor,
+                      [batch = std::move(batch), nodes]()
+                      {
+                        // 在会话自己的 io 线程上入队，写协程的启动也只是同线程的一次 post
+                        for (std::size_t i = 0; i < batch._sessions.size(); ++i)
+                        {
+                          batch._sessions[i]->Send((*nodes)[batch._variants[i]]);
+                        }
+                      });
+  }
+
+  g_fan_out_counters._publishes.fetch_add(1, std::memory_order_relaxed);
+  g_fan_out_counters._frames_encoded.fetch_add(nodes->size(), std::memory_order_relaxed);
+  g_fan_out_counters._sessions.fetch_add(delivered, std::memory_order_relaxed);
+  g_fan_out_counters._posts.fetch_add(batches.size(), std::memory_order_relaxed);
+  return delivered;
+}
+
+FanOutStats FanOut::GetStats()
+{
+  return {.publishes = g_fan_out_counters._publishes.load(std::memory_order_relaxed),
+          .frames_encoded = g_fan_out_counters._frames_encoded.load(std::memory_order_relaxed),
+          .sessions = g_fan_out_counters._sessions.load(std::memory_order_relaxed),
+          .posts = g_fan_out_counters._posts.load(std::memory_order_relaxed)};
+}
+
+}  // namespace core
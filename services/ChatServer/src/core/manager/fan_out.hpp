@@ -0,0 +1,65 @@
+/******************************************************************************
+ *
+ * @file       fan_out.hpp
+ * @brief      群聊与广播的消息扇出，一条消息只组帧一次，按 io_context 合并投递
+ *
+ * @author     KBchulan
+ * @date       2026/10/18
+ * @history    SendNode 构造后不可变，同一压缩方式的全部会话共享一个帧，每个 executor 只 post 一次
+ *             2026/10/18 消息体按目标会话的编码各序列化一次，不再跳过编码不同的会话
+ ******************************************************************************/
+
+#ifndef FAN_OUT_HPP
+#define FAN_OUT_HPP
+
+#include <core/CoreExport.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <span>
+#include <string>
+#include <utils/common/code.hpp>
+
+namespace core
+{
+
+class Session;
+
+// 所有扇出累计的统计，sessions / frames_encoded 即平均每次组帧复用的会话数
+struct CORE_EXPORT FanOutStats
+{
+  std::uint64_t publishes;       // Publish 调用次数
+  std::uint64_t frames_encoded;  // 组帧次数，每次扇出按目标会话用到的编码与压缩方式的组合各一次
+  std::uint64_t sessions;        // 投递的会话数
+  std::uint64_t posts;           // 投递到 executor 的任务数
+};
+
+class CORE_EXPORT FanOut
+{
+public:
+  // 按会话协商的编码序列化消息体，每次扇出对目标会话用到的每种编码只调用一次
+  using Encoder = std::function<std::string(utils::WireProtocol protocol)>;
+
+  static FanOut& GetInstance();
+
+  // 投递给 targets 中全部未关闭的会话，返回投递的会话数
+  // 目标按所属 executor 分组，每组 post 一个任务，在会话自己的 io 线程上依次入队，不逐个会话跨线程唤醒
+  // 入队发生在 post 之后，与调用方随后直接调用的 Session::Send 之间不保证先后顺序
+  std::size_t Publish(short msg_id, const Encoder& encode, std::span<const std::shared_ptr<Session>> targets) const;
+
+  [[nodiscard]] static FanOutStats GetStats();
+
+  FanOut(const FanOut&) = delete;
+  FanOut& operator=(const FanOut&) = delete;
+  FanOut(FanOut&&) = delete;
+  FanOut& operator=(FanOut&&) = delete;
+
+private:
+  FanOut() = default;
+  ~FanOut() = default;
+};
+
+}  // namespace core
+
+#endif  // FAN_OUT_HPP
@@ -1,11 +1,84 @@
 #include "user_manager.hpp"
 
+#include <algorithm>
+#include <array>
+#include <core/session/session.hpp>
+#include <functional>
+#include <global/Global.hpp>
+#include <mutex>
+#include <optional>
+#include <shared_mutex>
+#include <string>
+#include <tools/Logger.hpp>
+#include <unordered_map>
+#include <utility>
+#include <utils/codec/message_codec.hpp>
+
 namespace core
 {
 
 struct UserManager::_impl
 {
-  // TODO: 后续实现用户管理的具体逻辑
+  // 以会话地址作为键，解绑时会话仍然存活，不需要提升 weak_ptr 即可比较
+  struct Device
+  {
+    const Session* _key;
+    std::weak_ptr<Session> _session;
+  };
+
+  // 查找远多于登录与断开，读写锁让并发查找互不阻塞；分片各占独立的缓存行
+  struct alignas(64) Shard
+  {
+    mutable std::shared_mutex _mutex;
+    std::unordered_map<std::string, std::vector<Device>> _users;
+  };
+
+  std::array<Shard, global::server::USER_INDEX_SHARD_COUNT> _shards;
+
+  Shard& shard_of(const std::string& user_id)
+  {
+    return _shards[std::hash<std::string>{}(user_id) % _shards.size()];
+  }
+
+  const Shard& shard_of(const std::string& user_id) const
+  {
+    return _shards[std::hash<std::string>{}(user_id) % _shards.size()];
+  }
+
+  void insert(const std::string& user_id, const std::shared_ptr<Session>& session)
+  {
+    auto& shard = shard_of(user_id);
+
+    std::unique_lock lock{shard._mutex};
+    auto& devices = shard._users[user_id];
+
+    // 先清理已经析构的会话，新会话可能复用了其地址
+    std::erase_if(devices, [](const Device& device) { return device._session.expired(); });
+    if (std::ranges::none_of(devices, [&session](const Device& device) { return device._key == session.get(); }))
+    {
+      devices.push_back(Device{._key = session.get(), ._session = session});
+    }
+  }
+
+  // 同时清理已经析构的会话，用户没有剩余设备时删除该项
+  void erase(const std::string& user_id, const Session& session)
+  {
+    auto& shard = shard_of(user_id);
+
+    std::unique_lock lock{shard._mutex};
+    auto iter = shard._users.find(user_id);
+    if (iter == shard._users.end())
+    {
+      return;
+    }
+
+    std::erase_if(iter->second, [&session](const Device& device)
+                  { return device._key == &session || device._session.expired(); });
+    if (iter->second.empty())
+    {
+      shard._users.erase(iter);
+    }
+  }
 };
 
 UserManager::UserManager() : _pimpl(std::make_unique<_impl>())
@@ -20,4 +93,105 @@ UserManager& UserManager::GetInstance()
   return instance;
 }
 
-}  // namespace core
\ No newline at end of file
+void UserManager::Bind(const std::string& user_id, const std::shared_ptr<Session>& session)
+{
+  if (auto previous = session->GetUserId(); !previous.empty() && previous != user_id)
+  {
+    _pimpl->erase(previous, *session);
+  }
+
+  session->SetUserId(user_id);
+  _pimpl->insert(user_id, session);
+
+  // 绑定与断开可能同时发生：断开一侧先置位关闭标记再解绑，这里插入后再检查一次，避免留下已断开的会话
+  if (session->IsClosed())
+  {
+    _pimpl->erase(user_id, *session);
+  }
+}
+
+void UserManager::Unbind(const Session& session)
+{
+  auto user_id = session.GetUserId();
+  if (user_id.empty())
+  {
+    return;
+  }
+
+  _pimpl->erase(user_id, session);
+}
+
+std::vector<std::shared_ptr<Session>> UserManager::GetSessions(const std::string& user_id) const
+{
+  const auto& shard = _pimpl->shard_of(user_id);
+  std::vector<std::shared_ptr<Session>> sessions;
+
+  std::shared_lock lock{shard._mutex};
+  if (auto iter = shard._users.find(user_id); iter != shard._users.end())
+  {
+    sessions.reserve(iter->second.size());
+    for (const auto& device : iter->second)
+    {
+      if (auto session = device._session.lock(); session && !session->IsClosed())
+      {
+        sessions.push_back(std::move(session));
+      }
+    }
+  }
+  return sessions;
+}
+
+bool UserManager::IsOnline(const std::string& user_id) const
+{
+  return !GetSessions(user_id).empty();
+}
+
+std::size_t UserManager::Deliver(const std::string& user_id, short msg_id, utils::WireProtocol protocol,
+                                 std::span<const char> body) const
+{
+  // 编码不同的会话按其编码转码，每种编码只转一次；编码只有少数几种，线性查找即可
+  std::vector<std::pair<utils::WireProtocol, std::optional<std::string>>> transcoded;
+  std::size_t delivered = 0;
+
+  for (const auto& session : GetSessions(user_id))
+  {
+    auto target = session->GetProtocol();
+    if (target == protocol)
+    {
+      session->Send(msg_id, body);
+      ++delivered;
+      continue;
+    }
+
+    auto variant = std::ranges::find_if(transcoded, [target](const auto& known) { return known.first == target; });
+    if (variant == transcoded.end())
+    {
+      variant = transcoded.insert(transcoded.end(),
+                                  {target, utils::MessageCodec::Transcode(msg_id, protocol, target, body)});
+      if (!variant->second.has_value())
+      {
+        tools::Logger::getInstance().warning("Message {} of user {} cannot be transcoded to protocol {}", msg_id,
+                                             user_id, static_cast<unsigned>(target));
+      }
+    }
+    if (variant->second.has_value())
+    {
+      session->Send(msg_id, *variant->second);
+      ++delivered;
+    }
+  }
+  return delivered;
+}
+
+std::size_t UserManager::GetOnlineCount() const
+{
+  std::size_t count = 0;
+  for (const auto& shard : _pimpl->_shards)
+  {
+    std::shared_lock lock{shard._mutex};
+    count += shard._users.size();
+  }
+  return count;
+}
+
+}  // namespace core
@@ -1,22 +1,31 @@
 /******************************************************************************
  *
  * @file       user_manager.hpp
- * @brief      用户管理，用于后续踢人等逻辑的实现
+ * @brief      用户管理，维护在线用户到会话的索引，用于消息投递、踢人等逻辑
  *
  * @author     KBchulan
  * @date       2026/03/02
- * @history
+ * @history    2026/10/18 新增按用户 id 分片的在线索引，支持同一用户多设备登录，跨服转发的帧由 Deliver 投递
+ *             2026/10/18 Deliver 为编码不同的会话转码，不再跳过
+ *             2026/10/18 Deliver 为编码不同的会话转码，不再跳过
  ******************************************************************************/
 
 #ifndef USER_MANAGER_HPP
 #define USER_MANAGER_HPP
 
 #include <core/CoreExport.hpp>
+#include <cstddef>
 #include <memory>
+#include <span>
+#include <string>
+#include <utils/common/code.hpp>
+#include <vector>
 
 namespace core
 {
 
+class Session;
+
 class CORE_EXPORT UserManager
 {
 public:
@@ -25,6 +34,30 @@ public:
 
   static UserManager& GetInstance();
 
+  // 登录成功后绑定用户与会话，同一用户的多个设备各自绑定；会话此前绑定了其他用户时先解绑
+  void Bind(const std::string& user_id, const std::shared_ptr<Session>& session);
+
+  // 会话断开或退出登录时解绑，未绑定的会话直接返回
+  void Unbind(const Session& session);
+
+  // 用户当前在线的全部会话，只锁该用户所在的分片
+  [[nodiscard]] std::vector<std::shared_ptr<Session>> GetSessions(const std::string& user_id) const;
+
+  [[nodiscard]] bool IsOnline(const std::string& user_id) const;
+
+  // 投递给用户在本服务器上的全部会话，body 为 protocol 编码，编码不同的会话先经 MessageCodec::Transcode 转码，
+  // 按各会话的压缩方式组帧，返回投递的会话数；消息 id 不支持转码时编码不同的会话不计入
+  std::size_t Deliver(const std::string& user_id, short msg_id, utils::WireProtocol protocol,
+                      std::span<const char> body) const;
+
+  // 在线用户数，需要依次查看各个分片
+  [[nodiscard]] std::size_t GetOnlineCount() const;
+
+  UserManager(const UserManager&) = delete;
+  UserManager& operator=(const UserManager&) = delete;
+  UserManager(UserManager&&) = delete;
+  UserManager& operator=(UserManager&&) = delete;
+
 private:
   struct _impl;
   std::unique_ptr<_impl> _pimpl;
@@ -32,4 +65,4 @@ private:
 
 }  // namespace core
 
-#endif  // USER_MANAGER_HPP
\ No newline at end of file
+#endif  // USER_MANAGER_HPP
@@ -0,0 +1,34 @@
+/******************************************************************************
+ *
+ * @file       message_do.hpp
+ * @brief      聊天消息的基本数据结构
+ *
+ * @author     KBchulan
+ * @date       2026/10/18
+ * @history
+ ******************************************************************************/
+
+#ifndef MESSAGE_DO_HPP
+#define MESSAGE_DO_HPP
+
+#include <core/CoreExport.hpp>
+#include <cstdint>
+#include <string>
+
+namespace core
+{
+
+// 对应 messages 表的一行，(conversation_id, seq) 唯一确定一条消息
+struct CORE_EXPORT MessageDO
+{
+  std::string conversation_id;
+  std::uint64_t seq;
+  std::string sender_uuid;
+  std::uint8_t msg_type;
+  std::string content;
+  std::uint64_t created_at;  // 毫秒时间戳
+};
+
+}  // namespace core
+
+#endif  // MESSAGE_DO_HPP
@@ -5,7 +5,7 @@
  *
  * @author     KBchulan
  * @date       2025/12/16
- * @history
+ * @history    2026/10/18 新增按批更新登录时间所用的 LastLoginDO
  ******************************************************************************/
 
 #ifndef USER_DO_HPP
@@ -31,6 +31,13 @@ struct CORE_EXPORT UserDO
   std::string updated_at;
 };
 
+// 用户最近一次登录的时间，由 LoginActivity 合并后按批写入 users.last_login
+struct CORE_EXPORT LastLoginDO
+{
+  std::string uuid;
+  std::int64_t login_at;  // 秒级时间戳
+};
+
 }  // namespace core
 
 #endif  // USER_DO_HPP
\ No newline at end of file
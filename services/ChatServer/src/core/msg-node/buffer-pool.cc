@@ -0,0 +1,191 @@
+#include "buffer-pool.hpp"
+
+#include <algorithm>
+#include <new>
+#include <vector>
+
+namespace core
+{
+
+namespace
+{
+
+constexpr std::size_t CLASS_COUNT = BufferPool::SIZE_CLASSES.size();
+
+// 超过最大档位时返回 CLASS_COUNT
+std::size_t class_of(std::size_t size) noexcept
+{
+  return static_cast<std::size_t>(std::ranges::lower_bound(BufferPool::SIZE_CLASSES, size) -
+                                  BufferPool::SIZE_CLASSES.begin());
+}
+
+// 每档缓存的块数，大块至少保留几个，避免在两次申请之间反复进出全局队列
+std::size_t cache_limit(std::size_t cls) noexcept
+{
+  return std::max<std::size_t>(global::server::BUFFER_POOL_THREAD_CACHE_BYTES / BufferPool::SIZE_CLASSES[cls], 8);
+}
+
+// 线程退出时缓存已经析构，此后的归还直接进入全局队列；标记是平凡类型，在整个线程生命周期内都可以读取
+thread_local bool t_cache_destroyed = false;
+
+}  // namespace
+
+struct BufferPool::_thread_cache
+{
+  std::array<std::vector<void*>, CLASS_COUNT> _free;
+
+  _thread_cache()
+  {
+    // 预留到上限加一，归还时的 push_back 不会再申请内存
+    for (std::size_t cls = 0; cls < CLASS_COUNT; ++cls)
+    {
+      _free[cls].reserve(cache_limit(cls) + 1);
+    }
+  }
+
+  ~_thread_cache()
+  {
+    t_cache_destroyed = true;
+
+    auto& pool = BufferPool::GetInstance();
+    for (std::size_t cls = 0; cls < CLASS_COUNT; ++cls)
+    {
+      for (auto* block : _free[cls])
+      {
+        pool.release(cls, block);
+      }
+    }
+  }
+
+  _thread_cache(const _thread_cache&) = delete;
+  _thread_cache& operator=(const _thread_cache&) = delete;
+  _thread_cache(_thread_cache&&) = delete;
+  _thread_cache& operator=(_thread_cache&&) = delete;
+
+  static _thread_cache* local() noexcept
+  {
+    if (t_cache_destroyed)
+    {
+      return nullptr;
+    }
+    thread_local _thread_cache cache;
+    return &cache;
+  }
+};
+
+BufferPool& BufferPool::GetInstance()
+{
+  static BufferPool instance;
+  return instance;
+}
+
+void* BufferPool::Allocate(std::size_t size)
+{
+  auto cls = class_of(size);
+  if (cls == CLASS_COUNT)
+  {
+    _oversize.fetch_add(1, std::memory_order_relaxed);
+    _system_allocs.fetch_add(1, std::memory_order_relaxed);
+    return ::operator new(size);
+  }
+
+  void* block = nullptr;
+  if (auto* cache = _thread_cache::local(); cache != nullptr)
+  {
+    auto& free = cache->_free[cls];
+    if (free.empty())
+    {
+      // 一次补充半个缓存，之后的申请都在本线程内完成
+      for (auto batch = cache_limit(cls) / 2; batch > 0 && _depot[cls].pop(block); --batch)
+      {
+        free.push_back(block);
+      }
+    }
+    if (!free.empty())
+    {
+      block = free.back();
+      free.pop_back();
+      return block;
+    }
+  }
+  else if (_depot[cls].pop(block))
+  {
+    return block;
+  }
+
+  _system_allocs.fetch_add(1, std::memory_order_relaxed);
+  return ::operator new(SIZE_CLASSES[cls]);
+}
+
+void BufferPool::Deallocate(void* block, std::size_t size) noexcept
+{
+  if (block == nullptr)
+  {
+    return;
+  }
+
+  auto cls = class_of(size);
+  if (cls == CLASS_COUNT)
+  {
+    _system_frees.fetch_add(1, std::memory_order_relaxed);
+    ::operator delete(block);
+    return;
+  }
+
+  auto* cache = _thread_cache::local();
+  if (cache == nullptr)
+  {
+    release(cls, block);
+    return;
+  }
+
+  auto& free = cache->_free[cls];
+  free.push_back(block);
+
+  // 只在本线程归还而不申请时（如逻辑线程释放 RecvNode）触发，移出一半留给申请方线程
+  if (auto limit = cache_limit(cls); free.size() > limit)
+  {
+    while (free.size() > limit / 2)
+    {
+      release(cls, free.back());
+      free.pop_back();
+    }
+  }
+}
+
+BufferPoolStats BufferPool::GetStats() const noexcept
+{
+  std::size_t depot_blocks = 0;
+  for (const auto& depot : _depot)
+  {
+    depot_blocks += depot.size();
+  }
+
+  return {.system_allocs = _system_allocs.load(std::memory_order_relaxed),
+          .system_frees = _system_frees.load(std::memory_order_relaxed),
+          .oversize = _oversize.load(std::memory_order_relaxed),
+          .depot_blocks = depot_blocks};
+}
+
+BufferPool::~BufferPool()
+{
+  for (auto& depot : _depot)
+  {
+    void* block = nullptr;
+    while (depot.pop(block))
+    {
+      ::operator delete(block);
+    }
+  }
+}
+
+void BufferPool::release(std::size_t cls, void* block) noexcept
+{
+  if (!_depot[cls].emplace(block))
+  {
+    _system_frees.fetch_add(1, std::memory_order_relaxed);
+    ::operator delete(block);
+  }
+}
+
+}  // namespace core
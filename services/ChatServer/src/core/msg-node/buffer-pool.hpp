@@ -0,0 +1,74 @@
+/******************************************************************************
+ *
+ * @file       buffer-pool.hpp
+ * @brief      消息节点的分档内存池
+ *
+ * @author     KBchulan
+ * @date       2026/10/18
+ * @history    按尺寸档位复用内存块，每个线程先取自己的缓存，线程之间通过无锁空闲队列流转
+ ******************************************************************************/
+
+#ifndef BUFFER_POOL_HPP
+#define BUFFER_POOL_HPP
+
+#include <array>
+#include <atomic>
+#include <core/CoreExport.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <global/Global.hpp>
+#include <global/SuperQueue.hpp>
+
+namespace core
+{
+
+// 向系统申请与归还的块数，两者之差即池中与使用中的块数
+struct CORE_EXPORT BufferPoolStats
+{
+  std::uint64_t system_allocs;  // 向系统申请的块数，包括超过最大档位的
+  std::uint64_t system_frees;   // 归还给系统的块数
+  std::uint64_t oversize;       // 超过最大档位、不经过池的申请次数
+  std::size_t depot_blocks;     // 全局空闲队列中的块数
+};
+
+class CORE_EXPORT BufferPool
+{
+public:
+  // 申请时向上取整到最近的一档；最大一档容纳 RECV_BUFFER_SIZE 的普通帧连同节点本身
+  static constexpr std::array<std::size_t, 7> SIZE_CLASSES{128, 256, 512, 1024, 2048, 4096, 9216};
+
+  static BufferPool& GetInstance();
+
+  // 返回至少 size 字节、按 operator new 默认对齐的块，内容未初始化
+  // 先取当前线程的缓存，缓存空时从全局空闲队列补充半个缓存，仍没有时向系统申请
+  [[nodiscard]] void* Allocate(std::size_t size);
+
+  // size 需与申请时相同，可在任意线程归还；线程缓存超过上限时把一半移入全局空闲队列，队列满时释放
+  void Deallocate(void* block, std::size_t size) noexcept;
+
+  [[nodiscard]] BufferPoolStats GetStats() const noexcept;
+
+  BufferPool(const BufferPool&) = delete;
+  BufferPool& operator=(const BufferPool&) = delete;
+  BufferPool(BufferPool&&) = delete;
+  BufferPool& operator=(BufferPool&&) = delete;
+
+private:
+  BufferPool() = default;
+  ~BufferPool();
+
+  struct _thread_cache;
+
+  void release(std::size_t cls, void* block) noexcept;
+
+  // RecvNode 在 io 线程分配、逻辑线程释放，SendNode 反之，空闲块经此在线程之间流转
+  std::array<global::SuperQueue<void*, global::server::BUFFER_POOL_DEPOT_CAPACITY>, SIZE_CLASSES.size()> _depot;
+
+  std::atomic<std::uint64_t> _system_allocs{0};
+  std::atomic<std::uint64_t> _system_frees{0};
+  std::atomic<std::uint64_t> _oversize{0};
+};
+
+}  // namespace core
+
+#endif  // BUFFER_POOL_HPP
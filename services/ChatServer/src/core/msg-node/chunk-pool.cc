@@ -0,0 +1,54 @@
+#include "chunk-pool.hpp"
+
+namespace core
+{
+
+void ChunkPool::Deleter::operator()(char* chunk) const noexcept
+{
+  ChunkPool::GetInstance().release(chunk);
+}
+
+ChunkPool& ChunkPool::GetInstance()
+{
+  static ChunkPool instance;
+  return instance;
+}
+
+ChunkPool::Chunk ChunkPool::Acquire()
+{
+  char* chunk = nullptr;
+  if (!_idle.pop(chunk))
+  {
+    chunk = new char[global::server::LARGE_FRAME_CHUNK_SIZE];
+  }
+  return Chunk{chunk};
+}
+
+std::size_t ChunkPool::GetIdleCount() const noexcept
+{
+  return _idle.size();
+}
+
+ChunkPool::~ChunkPool()
+{
+  char* chunk = nullptr;
+  while (_idle.pop(chunk))
+  {
+    delete[] chunk;
+  }
+}
+
+void ChunkPool::release(char* chunk) noexcept
+{
+  if (chunk == nullptr)
+  {
+    return;
+  }
+
+  if (!_idle.emplace(chunk))
+  {
+    delete[] chunk;
+  }
+}
+
+}  // namespace core
@@ -0,0 +1,58 @@
+/******************************************************************************
+ *
+ * @file       chunk-pool.hpp
+ * @brief      大帧消息体的定长分块池
+ *
+ * @author     KBchulan
+ * @date       2026/10/18
+ * @history    大帧按 LARGE_FRAME_CHUNK_SIZE 分块收发，分块在会话之间复用
+ ******************************************************************************/
+
+#ifndef CHUNK_POOL_HPP
+#define CHUNK_POOL_HPP
+
+#include <core/CoreExport.hpp>
+#include <cstddef>
+#include <global/Global.hpp>
+#include <global/SuperQueue.hpp>
+#include <memory>
+
+namespace core
+{
+
+class CORE_EXPORT ChunkPool
+{
+public:
+  // 分块析构时归还给池，池满时直接释放
+  struct CORE_EXPORT Deleter
+  {
+    void operator()(char* chunk) const noexcept;
+  };
+  using Chunk = std::unique_ptr<char[], Deleter>;
+
+  static ChunkPool& GetInstance();
+
+  // 取一个 LARGE_FRAME_CHUNK_SIZE 大小的分块，池空时新分配，内容未初始化
+  [[nodiscard]] Chunk Acquire();
+
+  // 当前缓存的空闲分块数
+  [[nodiscard]] std::size_t GetIdleCount() const noexcept;
+
+  ChunkPool(const ChunkPool&) = delete;
+  ChunkPool& operator=(const ChunkPool&) = delete;
+  ChunkPool(ChunkPool&&) = delete;
+  ChunkPool& operator=(ChunkPool&&) = delete;
+
+private:
+  ChunkPool() = default;
+  ~ChunkPool();
+
+  void release(char* chunk) noexcept;
+
+  // 空闲分块由多个 io 线程与逻辑线程并发取还
+  global::SuperQueue<char*, global::server::CHUNK_POOL_CAPACITY> _idle;
+};
+
+}  // namespace core
+
+#endif  // CHUNK_POOL_HPP
@@ -0,0 +1,390 @@
+#include "frame-compressor.hpp"
+
+#include <lz4frame.h>
+#include <zstd.h>
+
+#include <boost/asio/detail/socket_ops.hpp>
+#include <core/msg-node/msg-node.hpp>
+#include <cstddef>
+#include <cstring>
+#include <fstream>
+#include <global/Global.hpp>
+#include <iterator>
+#include <tools/Logger.hpp>
+#include <vector>
+
+namespace core
+{
+
+using namespace global::server;
+
+namespace
+{
+
+constexpr int ZSTD_WINDOW_LOG_MAX = 24;  // 解压窗口上限 16MB，与大帧上限一致，拒绝声明超大窗口的帧
+
+struct ZstdCCtxDeleter
+{
+  void operator()(ZSTD_CCtx* ctx) const noexcept
+  {
+    ZSTD_freeCCtx(ctx);
+  }
+};
+
+struct ZstdDCtxDeleter
+{
+  void operator()(ZSTD_DCtx* ctx) const noexcept
+  {
+    ZSTD_freeDCtx(ctx);
+  }
+};
+
+struct Lz4DCtxDeleter
+{
+  void operator()(LZ4F_dctx* ctx) const noexcept
+  {
+    LZ4F_freeDecompressionContext(ctx);
+  }
+};
+
+struct ZstdCDictDeleter
+{
+  void operator()(ZSTD_CDict* dict) const noexcept
+  {
+    ZSTD_freeCDict(dict);
+  }
+};
+
+struct ZstdDDictDeleter
+{
+  void operator()(ZSTD_DDict* dict) const noexcept
+  {
+    ZSTD_freeDDict(dict);
+  }
+};
+
+// 每个线程一份压缩与解压上下文，避免每帧分配
+struct ThreadContexts
+{
+  std::unique_ptr<ZSTD_CCtx, ZstdCCtxDeleter> _zstd_cctx{ZSTD_createCCtx()};
+  std::unique_ptr<ZSTD_DCtx, ZstdDCtxDeleter> _zstd_dctx{ZSTD_createDCtx()};
+  std::unique_ptr<LZ4F_dctx, Lz4DCtxDeleter> _lz4_dctx;
+  std::vector<char> _scratch;  // 压缩输出的暂存区
+
+  ThreadContexts()
+  {
+    ZSTD_DCtx_setParameter(_zstd_dctx.get(), ZSTD_d_windowLogMax, ZSTD_WINDOW_LOG_MAX);
+
+    LZ4F_dctx* lz4_dctx = nullptr;
+    if (LZ4F_isError(LZ4F_createDecompressionContext(&lz4_dctx, LZ4F_VERSION)) == 0U)
+    {
+      _lz4_dctx.reset(lz4_dctx);
+    }
+  }
+};
+
+ThreadContexts& thread_contexts()
+{
+  thread_local ThreadContexts contexts;
+  return contexts;
+}
+
+// 单步解压的结果，hint 为 0 表示帧已完整解出
+struct StepResult
+{
+  std::size_t consumed;
+  std::size_t produced;
+  std::size_t hint;
+  bool error;
+};
+
+// 把分段的压缩数据流式解压到分段的输出缓冲区，帧结束时输入与输出都必须恰好用完
+template <typename Step>
+bool stream_decompress(std::span<const std::span<const char>> inputs, std::span<const std::span<char>> outputs,
+                       Step&& step)
+{
+  std::size_t in_idx = 0;
+  std::size_t in_pos = 0;
+  std::size_t out_idx = 0;
+  std::size_t out_pos = 0;
+
+  // 跳过已读完的输入段与已写满的输出段
+  auto advance = [&]
+  {
+    while (in_idx < inputs.size() && in_pos == inputs[in_idx].size())
+    {
+      ++in_idx;
+      in_pos = 0;
+    }
+    while (out_idx < outputs.size() && out_pos == outputs[out_idx].size())
+    {
+      ++out_idx;
+      out_pos = 0;
+    }
+  };
+
+  while (true)
+  {
+    advance();
+
+    auto src = in_idx < inputs.size() ? inputs[in_idx].subspan(in_pos) : std::span<const char>{};
+    auto dst = out_idx < outputs.size() ? outputs[out_idx].subspan(out_pos) : std::span<char>{};
+
+    auto result = step(src, dst);
+    if (result.error)
+    {
+      return false;
+    }
+    in_pos += result.consumed;
+    out_pos += result.produced;
+
+    if (result.hint == 0)
+    {
+      advance();
+      return in_idx == inputs.size() && out_idx == outputs.size();
+    }
+
+    // 没有任何进展说明输入不完整，或解压结果超出了声明的长度
+    if (result.consumed == 0 && result.produced == 0)
+    {
+      return false;
+    }
+  }
+}
+
+bool zstd_decompress(std::span<const std::span<const char>> inputs, std::span<const std::span<char>> outputs,
+                     const ZSTD_DDict* ddict)
+{
+  auto* dctx = thread_contexts()._zstd_dctx.get();
+  ZSTD_DCtx_reset(dctx, ZSTD_reset_session_only);
+  ZSTD_DCtx_refDDict(dctx, ddict);
+
+  return stream_decompress(inputs, outputs,
+                           [dctx](std::span<const char> src, std::span<char> dst)
+                           {
+                             ZSTD_inBuffer in{src.data(), src.size(), 0};
+                             ZSTD_outBuffer out{dst.data(), dst.size(), 0};
+                             auto ret = ZSTD_decompressStream(dctx, &out, &in);
+                             bool error = ZSTD_isError(ret) != 0U;
+                             return StepResult{.consumed = in.pos,
+                                               .produced = out.pos,
+                                               .hint = error ? 1 : ret,
+                                               .error = error};
+                           });
+}
+
+bool lz4_decompress(std::span<const std::span<const char>> inputs, std::span<const std::span<char>> outputs)
+{
+  auto* dctx = thread_contexts()._lz4_dctx.get();
+  if (dctx == nullptr)
+  {
+    return false;
+  }
+  LZ4F_resetDecompressionContext(dctx);
+
+  return stream_decompress(inputs, outputs,
+                           [dctx](std::span<const char> src, std::span<char> dst)
+                           {
+                             std::size_t src_size = src.size();
+                             std::size_t dst_size = dst.size();
+                             auto ret = LZ4F_decompress(dctx, dst.data(), &dst_size, src.data(), &src_size, nullptr);
+                             bool error = LZ4F_isError(ret) != 0U;
+                             return StepResult{.consumed = error ? 0 : src_size,
+                                               .produced = error ? 0 : dst_size,
+                                               .hint = error ? 1 : ret,
+                                               .error = error};
+                           });
+}
+
+}  // namespace
+
+struct FrameCompressor::_impl
+{
+  std::vector<char> _dict;
+  std::unique_ptr<ZSTD_CDict, ZstdCDictDeleter> _cdict;
+  std::unique_ptr<ZSTD_DDict, ZstdDDictDeleter> _ddict;
+  std::uint32_t _dict_id{0};
+};
+
+FrameCompressor& FrameCompressor::GetInstance()
+{
+  static FrameCompressor instance;
+  return instance;
+}
+
+bool FrameCompressor::LoadDictionary(const std::string& path)
+{
+  std::ifstream file(path, std::ios::binary);
+  if (!file)
+  {
+    tools::Logger::getInstance().info("zstd dictionary {} not found, compressing without dictionary", path);
+    return false;
+  }
+
+  std::vector<char> dict{std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>()};
+  auto dict_id = ZSTD_getDictID_fromDict(dict.data(), dict.size());
+  if (dict_id == 0)
+  {
+    tools::Logger::getInstance().error("{} is not a zstd dictionary", path);
+    return false;
+  }
+
+  std::unique_ptr<ZSTD_CDict, ZstdCDictDeleter> cdict{
+      ZSTD_createCDict(dict.data(), dict.size(), COMPRESS_ZSTD_LEVEL)};
+  std::unique_ptr<ZSTD_DDict, ZstdDDictDeleter> ddict{ZSTD_createDDict(dict.data(), dict.size())};
+  if (!cdict || !ddict)
+  {
+    tools::Logger::getInstance().error("Failed to load zstd dictionary {}", path);
+    return false;
+  }
+
+  _pimpl->_dict = std::move(dict);
+  _pimpl->_cdict = std::move(cdict);
+  _pimpl->_ddict = std::move(ddict);
+  _pimpl->_dict_id = dict_id;
+
+  tools::Logger::getInstance().info("Loaded zstd dictionary {} (id {}, {} bytes)", path, dict_id,
+                                    _pimpl->_dict.size());
+  return true;
+}
+
+std::uint32_t FrameCompressor::GetDictId() const noexcept
+{
+  return _pimpl->_dict_id;
+}
+
+CompressionMode FrameCompressor::Negotiate(std::uint32_t requested, std::uint32_t dict_id) const noexcept
+{
+  switch (requested)
+  {
+    case static_cast<std::uint32_t>(utils::Compression::LZ4):
+      return {.algorithm = utils::Compression::LZ4, .use_dict = false};
+    case static_cast<std::uint32_t>(utils::Compression::ZSTD):
+      return {.algorithm = utils::Compression::ZSTD, .use_dict = dict_id != 0 && dict_id == _pimpl->_dict_id};
+    default:
+      return {};
+  }
+}
+
+std::shared_ptr<SendNode> FrameCompressor::MakeSendNode(short msg_id, std::span<const char> body,
+                                                        CompressionMode mode) const
+{
+  bool use_dict = mode.use_dict && _pimpl->_cdict;
+  auto threshold = use_dict ? COMPRESS_DICT_MIN_SIZE : COMPRESS_MIN_SIZE;
+  if (mode.algorithm == utils::Compression::NONE || body.size() < threshold)
+  {
+    return SendNode::Create(msg_id, body);
+  }
+
+  auto& contexts = thread_contexts();
+  auto& scratch = contexts._scratch;
+
+  std::size_t size = 0;
+  if (mode.algorithm == utils::Compression::ZSTD)
+  {
+    scratch.resize(MSG_RAW_LEN_LENGTH + ZSTD_compressBound(body.size()));
+    auto* dst = scratch.data() + MSG_RAW_LEN_LENGTH;
+    auto capacity = scratch.size() - MSG_RAW_LEN_LENGTH;
+
+    size = use_dict ? ZSTD_compress_usingCDict(contexts._zstd_cctx.get(), dst, capacity, body.data(), body.size(),
+                                               _pimpl->_cdict.get())
+                    : ZSTD_compressCCtx(contexts._zstd_cctx.get(), dst, capacity, body.data(), body.size(),
+                                        COMPRESS_ZSTD_LEVEL);
+    size = ZSTD_isError(size) != 0U ? body.size() : size;
+  }
+  else
+  {
+    scratch.resize(MSG_RAW_LEN_LENGTH + LZ4F_compressFrameBound(body.size(), nullptr));
+    size = LZ4F_compressFrame(scratch.data() + MSG_RAW_LEN_LENGTH, scratch.size() - MSG_RAW_LEN_LENGTH, body.data(),
+                              body.size(), nullptr);
+    size = LZ4F_isError(size) != 0U ? body.size() : size;
+  }
+
+  // 压缩失败或压缩后不比原文小时发送原文
+  std::shared_ptr<SendNode> node;
+  if (MSG_RAW_LEN_LENGTH + size >= body.size())
+  {
+    node = SendNode::Create(msg_id, body);
+  }
+  else
+  {
+    auto net_len = boost::asio::detail::socket_ops::host_to_network_long(static_cast<std::uint32_t>(body.size()));
+    std::memcpy(scratch.data(), &net_len, MSG_RAW_LEN_LENGTH);
+
+    auto flagged_id = static_cast<short>(static_cast<std::uint16_t>(msg_id) | MSG_COMPRESSED_FLAG);
+    node = SendNode::Create(flagged_id, std::span<const char>(scratch.data(), MSG_RAW_LEN_LENGTH + size));
+  }
+
+  // 大帧用过的暂存区不常驻，避免每个线程长期占用最大帧大小的内存
+  if (scratch.capacity() > LARGE_FRAME_CHUNK_SIZE)
+  {
+    scratch = std::vector<char>();
+  }
+  return node;
+}
+
+std::shared_ptr<RecvNode> FrameCompressor::Decompress(const RecvNode& node, CompressionMode mode) const
+{
+  if (mode.algorithm == utils::Compression::NONE)
+  {
+    return nullptr;
+  }
+
+  // 收集压缩数据的各段，第一段开头是解压后的长度
+  std::vector<std::span<const char>> inputs;
+  if (node.IsChunked())
+  {
+    for (auto chunk : node.GetChunks())
+    {
+      inputs.emplace_back(chunk);
+    }
+  }
+  else
+  {
+    inputs.emplace_back(node.GetData());
+  }
+
+  if (inputs.front().size() <= static_cast<std::size_t>(MSG_RAW_LEN_LENGTH))
+  {
+    return nullptr;
+  }
+
+  std::uint32_t raw_len = 0;
+  std::memcpy(&raw_len, inputs.front().data(), MSG_RAW_LEN_LENGTH);
+  raw_len = boost::asio::detail::socket_ops::network_to_host_long(raw_len);
+  inputs.front() = inputs.front().subspan(MSG_RAW_LEN_LENGTH);
+
+  if (raw_len == 0 || raw_len > MAX_LARGE_FRAME_SIZE)
+  {
+    return nullptr;
+  }
+
+  // 解压结果直接写入新节点，大消息同样分块存放
+  std::shared_ptr<RecvNode> output;
+  std::span<char> buffer;
+  std::span<const std::span<char>> outputs;
+  if (raw_len > RECV_BUFFER_SIZE)
+  {
+    output = RecvNode::CreateChunked(node.GetMsgId(), raw_len);
+    outputs = output->GetChunks();
+  }
+  else
+  {
+    output = RecvNode::Create(node.GetMsgId(), static_cast<short>(raw_len));
+    buffer = output->GetBuffer();
+    outputs = {&buffer, 1};
+  }
+
+  bool success = mode.algorithm == utils::Compression::ZSTD
+                     ? zstd_decompress(inputs, outputs, mode.use_dict ? _pimpl->_ddict.get() : nullptr)
+                     : lz4_decompress(inputs, outputs);
+  return success ? output : nullptr;
+}
+
+FrameCompressor::FrameCompressor() : _pimpl(std::make_unique<_impl>())
+{
+}
+
+FrameCompressor::~FrameCompressor() = default;
+
+}  // namespace core
@@ -0,0 +1,72 @@
+/******************************************************************************
+ *
+ * @file       frame-compressor.hpp
+ * @brief      消息体的按帧压缩与解压
+ *
+ * @author     KBchulan
+ * @date       2026/10/18
+ * @history    登录时协商 LZ4 或 zstd，超过阈值的消息体压缩后以消息 id 最高位标记
+ ******************************************************************************/
+
+#ifndef FRAME_COMPRESSOR_HPP
+#define FRAME_COMPRESSOR_HPP
+
+#include <core/CoreExport.hpp>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <string>
+#include <utils/common/code.hpp>
+
+namespace core
+{
+
+class RecvNode;
+class SendNode;
+
+// 会话协商出的压缩方式，use_dict 只对 zstd 有效
+struct CORE_EXPORT CompressionMode
+{
+  utils::Compression algorithm{utils::Compression::NONE};
+  bool use_dict{false};
+};
+
+// 压缩帧的消息体为 4 字节解压后长度加上压缩数据，压缩数据是完整的 LZ4 frame 或 zstd frame
+// 压缩与解压上下文按线程复用，可以在任意 io 线程与逻辑线程上并发调用
+class CORE_EXPORT FrameCompressor
+{
+public:
+  static FrameCompressor& GetInstance();
+
+  // 加载用业务消息样本训练出的 zstd 字典，只在启动阶段调用，失败时不启用字典
+  bool LoadDictionary(const std::string& path);
+
+  // 已加载字典的 id，未加载时为 0
+  [[nodiscard]] std::uint32_t GetDictId() const noexcept;
+
+  // 不支持的算法按不压缩处理，客户端字典与服务端一致时才启用字典
+  [[nodiscard]] CompressionMode Negotiate(std::uint32_t requested, std::uint32_t dict_id) const noexcept;
+
+  // 消息体达到阈值且压缩后更小时，返回带压缩标记的 SendNode，否则按原文组帧
+  [[nodiscard]] std::shared_ptr<SendNode> MakeSendNode(short msg_id, std::span<const char> body,
+                                                       CompressionMode mode) const;
+
+  // 将压缩帧解压为新的 RecvNode，解压后超过 RECV_BUFFER_SIZE 时同样分块存放，数据非法时返回空
+  [[nodiscard]] std::shared_ptr<RecvNode> Decompress(const RecvNode& node, CompressionMode mode) const;
+
+  FrameCompressor(const FrameCompressor&) = delete;
+  FrameCompressor& operator=(const FrameCompressor&) = delete;
+  FrameCompressor(FrameCompressor&&) = delete;
+  FrameCompressor& operator=(FrameCompressor&&) = delete;
+
+private:
+  FrameCompressor();
+  ~FrameCompressor();
+
+  struct _impl;
+  std::unique_ptr<_impl> _pimpl;
+};
+
+}  // namespace core
+
+#endif  // FRAME_COMPRESSOR_HPP
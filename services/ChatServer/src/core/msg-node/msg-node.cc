@@ -1,15 +1,89 @@
 #include "msg-node.hpp"
 
+#include <algorithm>
 #include <boost/asio/detail/socket_ops.hpp>
+#include <core/msg-node/buffer-pool.hpp>
 #include <cstddef>
+#include <cstring>
 #include <global/Global.hpp>
+#include <utility>
 
 namespace core
 {
 
 using namespace global::server;
 
-MsgNode::MsgNode(short capacity) : _cur_len(0), _data(static_cast<std::size_t>(capacity))
+struct MsgNode::Payload
+{
+  char* data;
+  std::size_t size;
+};
+
+namespace
+{
+
+// allocate_shared 的分配器：在控制块（其中包含节点本身）之后多申请 payload 字节作为节点的缓冲区，
+// 节点、引用计数与消息体只占一次分配，且从 BufferPool 的线程缓存中取得
+template <typename T>
+struct NodeAllocator
+{
+  using value_type = T;
+
+  // slot 只在 allocate 中写入一次，分配完成后不再使用
+  std::size_t _payload;
+  char** _slot;
+
+  NodeAllocator(std::size_t payload, char** slot) noexcept : _payload(payload), _slot(slot)
+  {
+  }
+
+  template <typename U>
+  NodeAllocator(const NodeAllocator<U>& other) noexcept : _payload(other._payload), _slot(other._slot)
+  {
+  }
+
+  T* allocate(std::size_t count)
+  {
+    auto head = count * sizeof(T);
+    auto* block = static_cast<char*>(BufferPool::GetInstance().Allocate(head + _payload));
+    *_slot = block + head;
+    return reinterpret_cast<T*>(block);
+  }
+
+  void deallocate(T* block, std::size_t count) noexcept
+  {
+    BufferPool::GetInstance().Deallocate(block, count * sizeof(T) + _payload);
+  }
+
+  template <typename U>
+  bool operator==(const NodeAllocator<U>& other) const noexcept
+  {
+    return _payload == other._payload;
+  }
+};
+
+// 分配发生在构造之前，节点构造时 payload.data 已指向缓冲区
+template <typename Node, typename... Args>
+std::shared_ptr<Node> make_node(std::size_t capacity, Args&&... args)
+{
+  MsgNode::Payload payload{.data = nullptr, .size = capacity};
+  return std::allocate_shared<Node>(NodeAllocator<Node>(capacity, &payload.data), std::as_const(payload),
+                                    std::forward<Args>(args)...);
+}
+
+// 普通帧为 4 字节消息头加消息体，大帧为 8 字节消息头，消息体另行分块
+short frame_capacity(std::size_t body_len)
+{
+  if (body_len > RECV_BUFFER_SIZE)
+  {
+    return static_cast<short>(MSG_HEAD_TOTAL_LEN + MSG_EXT_LEN_LENGTH);
+  }
+  return static_cast<short>(MSG_HEAD_TOTAL_LEN + body_len);
+}
+
+}  // namespace
+
+MsgNode::MsgNode(const Payload& payload) : _cur_len(0), _data(payload.data, payload.size)
 {
 }
 
@@ -33,10 +107,64 @@ std::span<const char> MsgNode::GetData() const noexcept
   return {_data.data(), static_cast<size_t>(_cur_len)};
 }
 
-RecvNode::RecvNode(short msg_id, std::span<const char> body) : MsgNode(static_cast<short>(body.size())), _msg_id(msg_id)
+bool MsgNode::IsChunked() const noexcept
+{
+  return !_chunks.empty();
+}
+
+std::span<const std::span<char>> MsgNode::GetChunks() const noexcept
+{
+  return _chunk_views;
+}
+
+void MsgNode::alloc_chunks(std::size_t body_len)
+{
+  auto& pool = ChunkPool::GetInstance();
+  auto count = (body_len + LARGE_FRAME_CHUNK_SIZE - 1) / LARGE_FRAME_CHUNK_SIZE;
+  _chunks.reserve(count);
+  _chunk_views.reserve(count);
+
+  for (std::size_t offset = 0; offset < body_len; offset += LARGE_FRAME_CHUNK_SIZE)
+  {
+    auto& chunk = _chunks.emplace_back(pool.Acquire());
+    _chunk_views.emplace_back(chunk.get(), std::min(LARGE_FRAME_CHUNK_SIZE, body_len - offset));
+  }
+}
+
+RecvNode::RecvNode(const Payload& payload, short msg_id, std::size_t body_len)
+    : MsgNode(payload), _msg_id(msg_id), _body_len(body_len)
+{
+  _cur_len = static_cast<short>(payload.size);
+}
+
+std::shared_ptr<RecvNode> RecvNode::Create(short msg_id, std::span<const char> body)
+{
+  auto node = make_node<RecvNode>(body.size(), msg_id, body.size());
+  std::memcpy(node->_data.data(), body.data(), body.size());
+  return node;
+}
+
+std::shared_ptr<RecvNode> RecvNode::Create(short msg_id, short msg_len)
+{
+  auto body_len = static_cast<std::size_t>(msg_len);
+  return make_node<RecvNode>(body_len, msg_id, body_len);
+}
+
+std::shared_ptr<RecvNode> RecvNode::CreateChunked(short msg_id, std::size_t body_len)
+{
+  auto node = make_node<RecvNode>(0, msg_id, body_len);
+  node->alloc_chunks(body_len);
+  return node;
+}
+
+std::span<char> RecvNode::GetBuffer() noexcept
+{
+  return {_data.data(), static_cast<std::size_t>(_cur_len)};
+}
+
+std::size_t RecvNode::GetBodySize() const noexcept
 {
-  std::memcpy(_data.data(), body.data(), body.size());
-  _cur_len = static_cast<short>(body.size());
+  return _body_len;
 }
 
 short RecvNode::GetMsgId() const noexcept
@@ -44,13 +172,34 @@ short RecvNode::GetMsgId() const noexcept
   return _msg_id;
 }
 
-SendNode::SendNode(short msg_id, std::span<const char> body)
-    : MsgNode(static_cast<short>(MSG_HEAD_TOTAL_LEN + body.size())), _msg_id(msg_id)
+SendNode::SendNode(const Payload& payload, short msg_id, std::span<const char> body)
+    : MsgNode(payload), _msg_id(msg_id)
 {
   // 写入消息
   auto net_id = boost::asio::detail::socket_ops::host_to_network_short(static_cast<uint16_t>(msg_id));
   std::memcpy(_data.data(), &net_id, MSG_TYPE_LENGTH);
 
+  // 大帧：长度字段写入标记值，其后是 4 字节消息体长度，消息体按块拷贝
+  if (body.size() > RECV_BUFFER_SIZE)
+  {
+    auto net_marker = boost::asio::detail::socket_ops::host_to_network_short(MSG_EXT_LEN_MARKER);
+    std::memcpy(_data.data() + MSG_TYPE_LENGTH, &net_marker, MSG_LEN_LENGTH);
+
+    auto net_len = boost::asio::detail::socket_ops::host_to_network_long(static_cast<uint32_t>(body.size()));
+    std::memcpy(_data.data() + MSG_HEAD_TOTAL_LEN, &net_len, MSG_EXT_LEN_LENGTH);
+
+    alloc_chunks(body.size());
+    std::size_t offset = 0;
+    for (auto chunk : _chunk_views)
+    {
+      std::memcpy(chunk.data(), body.data() + offset, chunk.size());
+      offset += chunk.size();
+    }
+
+    _cur_len = static_cast<short>(MSG_HEAD_TOTAL_LEN + MSG_EXT_LEN_LENGTH);
+    return;
+  }
+
   // 写入消息长度
   auto net_len = boost::asio::detail::socket_ops::host_to_network_short(static_cast<uint16_t>(body.size()));
   std::memcpy(_data.data() + MSG_TYPE_LENGTH, &net_len, MSG_LEN_LENGTH);
@@ -65,6 +214,11 @@ SendNode::SendNode(short msg_id, std::span<const char> body)
   _cur_len = static_cast<short>(MSG_HEAD_TOTAL_LEN + body.size());
 }
 
+std::shared_ptr<SendNode> SendNode::Create(short msg_id, std::span<const char> body)
+{
+  return make_node<SendNode>(static_cast<std::size_t>(frame_capacity(body.size())), msg_id, body);
+}
+
 short SendNode::GetMsgId() const noexcept
 {
   return _msg_id;
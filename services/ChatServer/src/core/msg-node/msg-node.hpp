@@ -6,12 +6,16 @@
  * @author     KBchulan
  * @date       2025/12/13
  * @history
+ *             2026/10/18 节点与缓冲区在同一块内存中，从 BufferPool 按尺寸档位分配，只能通过工厂函数创建
  ******************************************************************************/
 
 #ifndef MSGNODE_HPP
 #define MSGNODE_HPP
 
 #include <core/CoreExport.hpp>
+#include <core/msg-node/chunk-pool.hpp>
+#include <cstddef>
+#include <memory>
 #include <span>
 #include <vector>
 
@@ -21,7 +25,10 @@ namespace core
 class CORE_EXPORT MsgNode
 {
 public:
-  explicit MsgNode(short capacity);
+  // 缓冲区紧跟在 shared_ptr 控制块与节点之后，由工厂函数分配节点时填入，构造函数因此不能直接调用
+  struct Payload;
+
+  explicit MsgNode(const Payload& payload);
   virtual ~MsgNode() = default;
 
   void Clear() noexcept;
@@ -30,31 +37,58 @@ public:
   [[nodiscard]] short GetSize() const noexcept;
   [[nodiscard]] std::span<const char> GetData() const noexcept;
 
+  // 大帧的消息体不在 GetData 中，而是按 LARGE_FRAME_CHUNK_SIZE 分块存放在池化缓冲区里
+  [[nodiscard]] bool IsChunked() const noexcept;
+  [[nodiscard]] std::span<const std::span<char>> GetChunks() const noexcept;
+
   MsgNode(const MsgNode&) = delete;
   MsgNode(MsgNode&&) = delete;
   MsgNode& operator=(const MsgNode&) = delete;
   MsgNode& operator=(MsgNode&&) = delete;
 
 protected:
+  // 从 ChunkPool 中取足 body_len 字节的分块
+  void alloc_chunks(std::size_t body_len);
+
   short _cur_len;
-  std::vector<char> _data;
+  std::span<char> _data;
+
+  std::vector<ChunkPool::Chunk> _chunks;
+  std::vector<std::span<char>> _chunk_views;
 };
 
 class CORE_EXPORT RecvNode : public MsgNode
 {
 public:
-  RecvNode(short msg_id, std::span<const char> body);
+  RecvNode(const Payload& payload, short msg_id, std::size_t body_len);
+
+  [[nodiscard]] static std::shared_ptr<RecvNode> Create(short msg_id, std::span<const char> body);
+
+  // 仅分配 msg_len 大小的消息体，由调用方通过 GetBuffer 直接写入，省去一次拷贝
+  [[nodiscard]] static std::shared_ptr<RecvNode> Create(short msg_id, short msg_len);
+
+  // 大帧的接收节点，消息体分块存放，由调用方通过 GetChunks 直接写入
+  [[nodiscard]] static std::shared_ptr<RecvNode> CreateChunked(short msg_id, std::size_t body_len);
+
+  [[nodiscard]] std::span<char> GetBuffer() noexcept;
+
+  // 消息体长度，对普通帧和大帧都有效
+  [[nodiscard]] std::size_t GetBodySize() const noexcept;
 
   [[nodiscard]] short GetMsgId() const noexcept override;
 
 private:
   short _msg_id;
+  std::size_t _body_len;
 };
 
 class CORE_EXPORT SendNode : public MsgNode
 {
 public:
-  SendNode(short msg_id, std::span<const char> body);
+  SendNode(const Payload& payload, short msg_id, std::span<const char> body);
+
+  // 消息体超过 RECV_BUFFER_SIZE 时编码为大帧，GetData 只包含 8 字节的消息头，消息体拷入分块
+  [[nodiscard]] static std::shared_ptr<SendNode> Create(short msg_id, std::span<const char> body);
 
   [[nodiscard]] short GetMsgId() const noexcept override;
 
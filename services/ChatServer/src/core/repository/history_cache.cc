@@ -0,0 +1,204 @@
+#include "history_cache.hpp"
+
+#include <charconv>
+#include <global/Global.hpp>
+#include <tools/Logger.hpp>
+#include <utils/codec/message_codec.hpp>
+#include <utils/pool/redis/async_redis_client.hpp>
+
+namespace core
+{
+
+namespace
+{
+
+using ull = unsigned long long;
+
+std::string key_of(const std::string& conversation_id)
+{
+  return global::server::HISTORY_CACHE_PREFIX + conversation_id;
+}
+
+// 成员不重复保存会话 id，读出时由 key 补上
+std::string encode_member(const MessageDO& message)
+{
+  utils::ChatMsg msg;
+  msg.set_seq(message.seq);
+  msg.set_sender_uuid(message.sender_uuid);
+  msg.set_msg_type(message.msg_type);
+  msg.set_content(message.content);
+  msg.set_created_at(message.created_at);
+  return msg.SerializeAsString();
+}
+
+bool decode_member(const std::string& conversation_id, const std::string& member, MessageDO& message)
+{
+  utils::ChatMsg msg;
+  if (!msg.ParseFromString(member))
+  {
+    return false;
+  }
+  message = MessageDO{.conversation_id = conversation_id,
+                      .seq = msg.seq(),
+                      .sender_uuid = msg.sender_uuid(),
+                      .msg_type = static_cast<std::uint8_t>(msg.msg_type()),
+                      .content = msg.content(),
+                      .created_at = msg.created_at()};
+  return true;
+}
+
+// 追加成员之后裁剪到条数上限并续期，与 ZADD 在同一次写出中完成
+void append_trim(utils::AsyncPipeLine& pipeline, const std::string& key)
+{
+  using namespace global::server;
+
+  pipeline.Append("ZREMRANGEBYRANK %s 0 %lld", key.c_str(), -static_cast<long long>(HISTORY_CACHE_MESSAGES) - 1)
+      .Append("EXPIRE %s %llu", key.c_str(), static_cast<ull>(HISTORY_CACHE_EXPIRE_S));
+}
+
+bool all_ok(const std::vector<utils::RedisReply>& replies, std::size_t expected)
+{
+  if (replies.size() != expected)
+  {
+    return false;
+  }
+  for (const auto& reply : replies)
+  {
+    if (!reply.IsValid() || reply.IsError())
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+}  // namespace
+
+boost::asio::awaitable<void> HistoryCache::AppendAsync(const MessageDO& message)
+{
+  auto key = key_of(message.conversation_id);
+  auto member = encode_member(message);
+
+  auto pipeline = utils::AsyncRedisClient::GetInstance().NewPipeLine();
+  pipeline.Append("ZADD %s %llu %b", key.c_str(), static_cast<ull>(message.seq), member.data(), member.size());
+  append_trim(pipeline, key);
+
+  if (all_ok(co_await pipeline.Execute(), 3))
+  {
+    co_return;
+  }
+
+  // 缺了最新一条的缓存仍然连续，首页会被当作完整的一页返回；删掉整个会话，之后的读取回源数据库并重建
+  tools::Logger::getInstance().warning("Failed to append message {} of {} to history cache, dropping it",
+                                       message.seq, message.conversation_id);
+  auto reply = co_await utils::AsyncRedisClient::GetInstance().Del(key);
+  if (!reply.IsValid() || reply.IsError())
+  {
+    tools::Logger::getInstance().error("Failed to drop history cache of {}", message.conversation_id);
+  }
+}
+
+boost::asio::awaitable<void> HistoryCache::FillAsync(const std::string& conversation_id,
+                                                     std::span<const MessageDO> messages)
+{
+  if (messages.empty())
+  {
+    co_return;
+  }
+
+  auto key = key_of(conversation_id);
+  auto pipeline = utils::AsyncRedisClient::GetInstance().NewPipeLine();
+  for (const auto& message : messages)
+  {
+    auto member = encode_member(message);
+    pipeline.Append("ZADD %s %llu %b", key.c_str(), static_cast<ull>(message.seq), member.data(), member.size());
+  }
+  append_trim(pipeline, key);
+
+  if (!all_ok(co_await pipeline.Execute(), messages.size() + 2))
+  {
+    tools::Logger::getInstance().warning("Failed to fill history cache of {}", conversation_id);
+  }
+}
+
+boost::asio::awaitable<HistoryRange> HistoryCache::RangeAsync(const std::string& conversation_id,
+                                                              std::uint64_t before_seq, std::uint32_t limit)
+{
+  using namespace global::server;
+
+  auto key = key_of(conversation_id);
+  auto upper = before_seq == 0 ? std::string{"+inf"} : "(" + std::to_string(before_seq);
+
+  // 范围读取、锚点检查与续期一次往返完成
+  auto pipeline = utils::AsyncRedisClient::GetInstance().NewPipeLine();
+  pipeline.Append("ZREVRANGEBYSCORE %s %s -inf LIMIT 0 %u", key.c_str(), upper.c_str(), limit)
+      .Append("ZCOUNT %s %llu %llu", key.c_str(), static_cast<ull>(before_seq), static_cast<ull>(before_seq))
+      .Append("EXPIRE %s %llu", key.c_str(), static_cast<ull>(HISTORY_CACHE_EXPIRE_S));
+  auto replies = co_await pipeline.Execute();
+
+  HistoryRange range{.messages = {}, .complete = false, .anchored = before_seq == 0};
+  if (!all_ok(replies, 3))
+  {
+    tools::Logger::getInstance().warning("Failed to read history cache of {}", conversation_id);
+    co_return range;
+  }
+
+  auto members = replies[0].AsArray().value_or(std::vector<std::string>{});
+  range.messages.reserve(members.size());
+  for (const auto& member : members)
+  {
+    // 无法解析的成员留下空缺，连续性检查会让这一页回源
+    if (MessageDO message; decode_member(conversation_id, member, message))
+    {
+      range.messages.emplace_back(std::move(message));
+    }
+  }
+
+  range.complete = IsComplete(range.messages, before_seq, limit);
+  range.anchored = range.anchored || replies[1].AsInteger().value_or(0) > 0;
+  co_return range;
+}
+
+boost::asio::awaitable<std::optional<std::uint64_t>> HistoryCache::LatestSeqAsync(const std::string& conversation_id)
+{
+  auto key = key_of(conversation_id);
+  auto reply = co_await utils::AsyncRedisClient::GetInstance().Command("ZREVRANGE %s 0 0 WITHSCORES", key.c_str());
+  if (!reply.IsValid() || reply.IsError())
+  {
+    co_return std::nullopt;
+  }
+
+  // 分值即 seq，不解析成员，成员损坏时也能起算
+  auto members = reply.AsArray().value_or(std::vector<std::string>{});
+  if (members.empty())
+  {
+    co_return 0;
+  }
+
+  std::uint64_t seq = 0;
+  const auto& score = members.back();
+  auto [ptr, ec] = std::from_chars(score.data(), score.data() + score.size(), seq);
+  if (members.size() != 2 || ec != std::errc{} || ptr != score.data() + score.size())
+  {
+    co_return std::nullopt;
+  }
+  co_return seq;
+}
+
+bool HistoryCache::IsComplete(std::span<const MessageDO> messages, std::uint64_t before_seq, std::uint32_t limit)
+{
+  if (messages.empty() || (before_seq != 0 && messages.front().seq + 1 != before_seq))
+  {
+    return false;
+  }
+  for (std::size_t i = 1; i < messages.size(); ++i)
+  {
+    if (messages[i - 1].seq != messages[i].seq + 1)
+    {
+      return false;
+    }
+  }
+  return messages.size() == limit || messages.back().seq == 1;
+}
+
+}  // namespace core
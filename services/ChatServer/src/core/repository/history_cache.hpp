@@ -0,0 +1,64 @@
+/******************************************************************************
+ *
+ * @file       history_cache.hpp
+ * @brief      活跃会话最近消息的 Redis 热缓存
+ *
+ * @author     KBchulan
+ * @date       2026/10/18
+ * @history    每个会话一个以 seq 为分值的有序集合，最近几页历史消息不回源数据库
+ *             2026/10/18 发送路径追加新消息，追加失败时删除该会话的缓存
+ *             2026/10/18 完整性判断改为公开的静态函数，便于单独测试
+ *             2026/10/18 读取缓存中最新一条的 seq，供 seq 计数器丢失后起算
+ ******************************************************************************/
+
+#ifndef HISTORY_CACHE_HPP
+#define HISTORY_CACHE_HPP
+
+#include <boost/asio/awaitable.hpp>
+#include <core/CoreExport.hpp>
+#include <core/model/message_do.hpp>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace core
+{
+
+// 一次范围读取的结果，messages 按 seq 降序
+struct CORE_EXPORT HistoryRange
+{
+  std::vector<MessageDO> messages;
+  bool complete;  // seq 连续且条数足够一页，可直接作为响应
+  bool anchored;  // 缓存中存在 seq 等于 before_seq 的消息，回源得到的这一页与缓存相接
+};
+
+// 缓存只保存每个会话最新的 HISTORY_CACHE_MESSAGES 条，且始终是以最新消息结尾的连续区间：
+// 新消息由发送路径追加，回源的页只在与缓存相接时写回，过期时整个会话一起过期
+class CORE_EXPORT HistoryCache
+{
+public:
+  // 新消息进入落库队列后追加到缓存，并裁掉超出条数上限的旧消息；追加失败时删除该会话的缓存，
+  // 否则缺了最新消息的区间仍然连续，首页会被当作完整的一页返回
+  static boost::asio::awaitable<void> AppendAsync(const MessageDO& message);
+
+  // 回源数据库得到的一页写回缓存，messages 需属于同一会话
+  static boost::asio::awaitable<void> FillAsync(const std::string& conversation_id,
+                                                std::span<const MessageDO> messages);
+
+  // 读取 seq 小于 before_seq 的最近 limit 条，before_seq 为 0 时从最新一条开始，同时续期
+  static boost::asio::awaitable<HistoryRange> RangeAsync(const std::string& conversation_id,
+                                                         std::uint64_t before_seq, std::uint32_t limit);
+
+  // 缓存中最新一条消息的 seq，缓存为空时为 0，读取失败时返回空；缓存包含尚未落库的消息，比数据库中的最大 seq 更新
+  static boost::asio::awaitable<std::optional<std::uint64_t>> LatestSeqAsync(const std::string& conversation_id);
+
+  // messages 按 seq 降序，seq 逐条连续、紧接在 before_seq 之前，且够一页或已到会话的第一条消息时为完整的一页
+  [[nodiscard]] static bool IsComplete(std::span<const MessageDO> messages, std::uint64_t before_seq,
+                                       std::uint32_t limit);
+};
+
+}  // namespace core
+
+#endif  // HISTORY_CACHE_HPP
@@ -0,0 +1,229 @@
+#include "login_activity.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <core/repository/user_repository.hpp>
+#include <exception>
+#include <global/Global.hpp>
+#include <mutex>
+#include <stop_token>
+#include <thread>
+#include <tools/Logger.hpp>
+#include <unordered_map>
+#include <vector>
+
+namespace core
+{
+
+struct LoginActivity::_impl
+{
+  // uuid 到最近一次登录时间，写线程每个间隔整体换出一次
+  std::mutex _mutex;
+  std::unordered_map<std::string, std::int64_t> _pending;
+  bool _accepting = false;
+
+  std::atomic<std::uint64_t> _recorded{0};
+  std::atomic<std::uint64_t> _written{0};
+  std::atomic<std::uint64_t> _batches{0};
+  std::atomic<std::uint64_t> _failures{0};
+  std::atomic<std::uint64_t> _dropped{0};
+
+  Sink _sink;
+  std::mutex _wait_mutex;
+  std::condition_variable_any _cv;
+  std::jthread _writer;
+
+  bool record(const std::string& uuid, std::int64_t login_at)
+  {
+    {
+      std::lock_guard lock{_mutex};
+      if (!_accepting)
+      {
+        return false;
+      }
+      merge(uuid, login_at);
+    }
+    _recorded.fetch_add(1, std::memory_order_relaxed);
+    return true;
+  }
+
+  // 调用方持有 _mutex；乱序到达或并回的旧记录不会覆盖更新的时间
+  void merge(const std::string& uuid, std::int64_t login_at)
+  {
+    auto [it, inserted] = _pending.try_emplace(uuid, login_at);
+    if (!inserted)
+    {
+      it->second = std::max(it->second, login_at);
+    }
+  }
+
+  void run(const std::stop_token& token)
+  {
+    while (!token.stop_requested())
+    {
+      {
+        std::unique_lock lock{_wait_mutex};
+        _cv.wait_for(lock, token, std::chrono::milliseconds(global::server::LOGIN_FLUSH_INTERVAL_MS),
+                     [] { return false; });
+      }
+      flush(false);
+    }
+
+    // Stop 已拒绝新的记录，缓冲中剩余的只再尝试一次
+    flush(true);
+  }
+
+  void flush(bool stopping)
+  {
+    std::unordered_map<std::string, std::int64_t> pending;
+    {
+      std::lock_guard lock{_mutex};
+      pending.swap(_pending);
+    }
+    if (pending.empty())
+    {
+      return;
+    }
+
+    std::vector<LastLoginDO> batch;
+    batch.reserve(std::min(pending.size(), global::server::LOGIN_BATCH_MAX_ROWS));
+    for (auto& [uuid, login_at] : pending)
+    {
+      batch.push_back(LastLoginDO{.uuid = uuid, .login_at = login_at});
+      if (batch.size() == global::server::LOGIN_BATCH_MAX_ROWS)
+      {
+        write(batch, stopping);
+      }
+    }
+    write(batch, stopping);
+  }
+
+  void write(std::vector<LastLoginDO>& batch, bool stopping)
+  {
+    if (batch.empty())
+    {
+      return;
+    }
+
+    if (sink(batch))
+    {
+      _written.fetch_add(batch.size(), std::memory_order_relaxed);
+      _batches.fetch_add(1, std::memory_order_relaxed);
+    }
+    else if (stopping)
+    {
+      _dropped.fetch_add(batch.size(), std::memory_order_relaxed);
+      tools::Logger::getInstance().error("Login activity dropped {} last login updates on shutdown", batch.size());
+    }
+    else
+    {
+      // 并回缓冲，与下一个间隔的记录一起写出
+      _failures.fetch_add(1, std::memory_order_relaxed);
+      tools::Logger::getInstance().warning("Login activity failed to update {} users, retrying next interval",
+                                           batch.size());
+
+      std::lock_guard lock{_mutex};
+      for (const auto& login : batch)
+      {
+        merge(login.uuid, login.login_at);
+      }
+    }
+    batch.clear();
+  }
+
+  bool sink(const std::vector<LastLoginDO>& batch)
+  {
+    try
+    {
+      return _sink(batch);
+    }
+    catch (const std::exception& e)
+    {
+      // 连接池重连失败时抛出异常，与写入失败一样处理
+      tools::Logger::getInstance().error("Login activity sink error: {}", e.what());
+      return false;
+    }
+  }
+};
+
+LoginActivity::LoginActivity() : _pimpl(std::make_unique<_impl>())
+{
+}
+
+LoginActivity::~LoginActivity()
+{
+  Stop();
+}
+
+LoginActivity& LoginActivity::GetInstance()
+{
+  static LoginActivity instance;
+  return instance;
+}
+
+void LoginActivity::Start(Sink sink)
+{
+  if (_pimpl->_writer.joinable())
+  {
+    return;
+  }
+
+  _pimpl->_sink = sink ? std::move(sink) : Sink{UserRepository::updateLastLoginBatch};
+  {
+    std::lock_guard lock{_pimpl->_mutex};
+    _pimpl->_accepting = true;
+  }
+  _pimpl->_writer = std::jthread([this](const std::stop_token& token) { _pimpl->run(token); });
+
+  tools::Logger::getInstance().info("Login activity started");
+}
+
+void LoginActivity::Stop()
+{
+  if (!_pimpl->_writer.joinable())
+  {
+    return;
+  }
+
+  {
+    std::lock_guard lock{_pimpl->_mutex};
+    _pimpl->_accepting = false;
+  }
+  _pimpl->_writer.request_stop();
+  _pimpl->_writer.join();
+
+  tools::Logger::getInstance().info("Login activity stopped, {} logins written in {} batches",
+                                    _pimpl->_written.load(std::memory_order_relaxed),
+                                    _pimpl->_batches.load(std::memory_order_relaxed));
+}
+
+bool LoginActivity::Record(const std::string& uuid, std::int64_t login_at)
+{
+  return _pimpl->record(uuid, login_at);
+}
+
+bool LoginActivity::Record(const std::string& uuid)
+{
+  auto now = std::chrono::duration_cast<std::chrono::seconds>(std::chrono::system_clock::now().time_since_epoch());
+  return _pimpl->record(uuid, now.count());
+}
+
+LoginActivityStats LoginActivity::GetStats() const
+{
+  std::size_t pending = 0;
+  {
+    std::lock_guard lock{_pimpl->_mutex};
+    pending = _pimpl->_pending.size();
+  }
+
+  return {.recorded = _pimpl->_recorded.load(std::memory_order_relaxed),
+          .written = _pimpl->_written.load(std::memory_order_relaxed),
+          .batches = _pimpl->_batches.load(std::memory_order_relaxed),
+          .failures = _pimpl->_failures.load(std::memory_order_relaxed),
+          .dropped = _pimpl->_dropped.load(std::memory_order_relaxed),
+          .pending = pending};
+}
+
+}  // namespace core
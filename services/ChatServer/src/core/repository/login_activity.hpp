@@ -0,0 +1,75 @@
+/******************************************************************************
+ *
+ * @file       login_activity.hpp
+ * @brief      登录时间的合并写入
+ *
+ * @author     KBchulan
+ * @date       2026/10/18
+ * @history    登录成功只在内存中记下 uuid 与时间，同一用户在一个间隔内多次登录只保留最新一次，
+ *             由单独的线程按间隔以多行 UPDATE ... CASE 写入，登录路径不再占用数据库连接
+ ******************************************************************************/
+
+#ifndef LOGIN_ACTIVITY_HPP
+#define LOGIN_ACTIVITY_HPP
+
+#include <core/CoreExport.hpp>
+#include <core/model/user_do.hpp>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <span>
+#include <string>
+
+namespace core
+{
+
+// recorded 与 written 之差即合并掉的重复登录与尚未写出的记录
+struct CORE_EXPORT LoginActivityStats
+{
+  std::uint64_t recorded;  // Record 接受的次数
+  std::uint64_t written;   // 已写入的用户数
+  std::uint64_t batches;   // 成功执行的 UPDATE 数
+  std::uint64_t failures;  // 失败的 UPDATE 数，其中的记录并回下一个间隔
+  std::uint64_t dropped;   // 停止时写入失败而丢弃的记录数
+  std::size_t pending;     // 等待写出的用户数
+};
+
+class CORE_EXPORT LoginActivity
+{
+public:
+  // 写出一批登录时间，返回 false 时并回缓冲，下一个间隔再写
+  using Sink = std::function<bool(std::span<const LastLoginDO> batch)>;
+
+  static LoginActivity& GetInstance();
+
+  // 启动写线程，每隔 LOGIN_FLUSH_INTERVAL_MS 写出一次，每条 UPDATE 最多 LOGIN_BATCH_MAX_ROWS 个用户
+  // sink 为空时由 UserRepository 写入 MariaDB，需在 DBPool 初始化之后调用
+  void Start(Sink sink = nullptr);
+
+  // 再写出一次缓冲中的记录后退出，之后的 Record 均被拒绝
+  void Stop();
+
+  // 记下 uuid 在 login_at（秒级时间戳）登录，任意线程可调用；未启动或已停止时返回 false
+  bool Record(const std::string& uuid, std::int64_t login_at);
+
+  // 以当前时间记录
+  bool Record(const std::string& uuid);
+
+  [[nodiscard]] LoginActivityStats GetStats() const;
+
+  LoginActivity(const LoginActivity&) = delete;
+  LoginActivity& operator=(const LoginActivity&) = delete;
+  LoginActivity(LoginActivity&&) = delete;
+  LoginActivity& operator=(LoginActivity&&) = delete;
+
+private:
+  LoginActivity();
+  ~LoginActivity();
+
+  struct _impl;
+  std::unique_ptr<_impl> _pimpl;
+};
+
+}  // namespace core
+
+#endif  // LOGIN_ACTIVITY_HPP
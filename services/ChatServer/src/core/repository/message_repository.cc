@@ -0,0 +1,185 @@
+#include "message_repository.hpp"
+
+#include <mysql/mysqld_error.h>
+
+#include <limits>
+#include <string>
+#include <tools/Logger.hpp>
+#include <utils/pool/mariadb/async_db_pool.hpp>
+#include <utils/pool/mariadb/db_pool.hpp>
+#include <vector>
+
+namespace core
+{
+
+namespace
+{
+
+// 多行 INSERT，主键 (conversation_id, seq) 重复时整条语句失败，一行也不写入
+bool insert_rows(utils::PooledConnection& conn, std::span<const MessageDO> messages)
+{
+  constexpr const char* head =
+      "INSERT INTO messages (conversation_id, seq, sender_uuid, msg_type, content, created_at) VALUES ";
+  constexpr const char* row = "(?, ?, ?, ?, ?, ?)";
+
+  std::string sql{head};
+  sql.reserve(sql.size() + messages.size() * (std::char_traits<char>::length(row) + 1));
+
+  std::vector<utils::ParamHolder> params;
+  params.reserve(messages.size() * 6);
+
+  for (const auto& message : messages)
+  {
+    if (&message != messages.data())
+    {
+      sql += ',';
+    }
+    sql += row;
+
+    params.push_back(utils::MakeBind(message.conversation_id));
+    params.push_back(utils::MakeBind(message.seq));
+    params.push_back(utils::MakeBind(message.sender_uuid));
+    params.push_back(utils::MakeBind(message.msg_type));
+    params.push_back(utils::MakeBind(message.content));
+    params.push_back(utils::MakeBind(message.created_at));
+  }
+
+  // MakeBind 返回的字符串绑定指向临时对象中的长度，拷贝进数组后改指向数组内的副本
+  for (auto& holder : params)
+  {
+    if (holder.bind.length != nullptr)
+    {
+      holder.bind.length = &holder.length;
+    }
+  }
+
+  return conn.Execute(sql.c_str(), params);
+}
+
+// 已落库的同一 seq 是否就是这条消息：上次写入已成功但结果没有返回时，重试会遇到自己写入的行
+std::optional<bool> is_stored(utils::PooledConnection& conn, const MessageDO& message)
+{
+  const char* sql = "SELECT sender_uuid, created_at FROM messages WHERE conversation_id = ? AND seq = ?";
+
+  auto conversation_id = message.conversation_id;
+  auto seq = message.seq;
+  utils::StringBuffer<36> sender_uuid;
+  std::uint64_t created_at = 0;
+
+  auto params = utils::MakeParams(conversation_id, seq);
+  params.front().bind.length = &params.front().length;
+  auto results = utils::MakeResults(sender_uuid, created_at);
+
+  if (!conn.QueryOne(sql, params, results))
+  {
+    return std::nullopt;
+  }
+  return sender_uuid.str() == message.sender_uuid && created_at == message.created_at;
+}
+
+}  // namespace
+
+bool MessageRepository::insertBatch(std::span<const MessageDO> messages)
+{
+  if (messages.empty())
+  {
+    return true;
+  }
+
+  auto conn = utils::DBPool::GetInstance().GetConnection();
+  if (insert_rows(conn, messages))
+  {
+    return true;
+  }
+  if (conn.GetLastErrno() != ER_DUP_ENTRY)
+  {
+    return false;
+  }
+
+  // 主键重复：逐行写入，已是同一条消息的行跳过，seq 被其他消息占用的行记录错误后丢弃，不让整批无限重试
+  for (const auto& message : messages)
+  {
+    if (insert_rows(conn, {&message, 1}))
+    {
+      continue;
+    }
+    if (conn.GetLastErrno() != ER_DUP_ENTRY)
+    {
+      return false;
+    }
+
+    auto stored = is_stored(conn, message);
+    if (!stored.has_value())
+    {
+      return false;
+    }
+    if (!*stored)
+    {
+      tools::Logger::getInstance().error("Seq {} of conversation {} is already taken, dropping message from {}",
+                                         message.seq, message.conversation_id, message.sender_uuid);
+    }
+  }
+  return true;
+}
+
+boost::asio::awaitable<std::optional<std::vector<MessageDO>>> MessageRepository::getHistoryAsync(
+    std::string conversation_id, std::uint64_t before_seq, std::uint32_t limit)
+{
+  // 常见的短消息直接放进协程帧内的 buffer，更长的内容由 QueryMany 按实际长度重新读取
+  constexpr std::size_t content_capacity = 4 * 1024;
+
+  const char* sql = "SELECT seq, sender_uuid, msg_type, content, created_at FROM messages "
+                    "WHERE conversation_id = ? AND seq < ? ORDER BY seq DESC LIMIT ?";
+
+  std::uint64_t upper = before_seq == 0 ? std::numeric_limits<std::uint64_t>::max() : before_seq;
+
+  std::uint64_t seq = 0;
+  utils::StringBuffer<36> sender_uuid;
+  std::uint8_t msg_type = 0;
+  utils::VarStringBuffer<content_capacity> content;
+  std::uint64_t created_at = 0;
+
+  auto params = utils::MakeParams(conversation_id, upper, limit);
+  params.front().bind.length = &params.front().length;  // 同 insertBatch，改指向数组内的长度
+  auto results = utils::MakeResults(seq, sender_uuid, msg_type, content, created_at);
+
+  std::vector<MessageDO> messages;
+  messages.reserve(limit);
+
+  auto conn = co_await utils::AsyncDBPool::GetInstance().GetConnection();
+  auto count = co_await conn.QueryMany(sql, params, results,
+                                       [&]
+                                       {
+                                         messages.push_back(MessageDO{.conversation_id = conversation_id,
+                                                                      .seq = seq,
+                                                                      .sender_uuid = sender_uuid.str(),
+                                                                      .msg_type = msg_type,
+                                                                      .content = content.str(),
+                                                                      .created_at = created_at});
+                                       });
+  if (!count.has_value())
+  {
+    tools::Logger::getInstance().error("Failed to load history of {} before seq {}", conversation_id, before_seq);
+    co_return std::nullopt;
+  }
+  co_return messages;
+}
+
+boost::asio::awaitable<std::optional<std::uint64_t>> MessageRepository::getMaxSeqAsync(std::string conversation_id)
+{
+  const char* sql = "SELECT COALESCE(MAX(seq), 0) FROM messages WHERE conversation_id = ?";
+
+  std::uint64_t max_seq = 0;
+  auto params = utils::MakeParams(conversation_id);
+  params.front().bind.length = &params.front().length;  // 同 insertBatch，改指向数组内的长度
+  auto results = utils::MakeResults(max_seq);
+
+  auto conn = co_await utils::AsyncDBPool::GetInstance().GetConnection();
+  if (!co_await conn.QueryOne(sql, params, results))
+  {
+    co_return std::nullopt;
+  }
+  co_return max_seq;
+}
+
+}  // namespace core
@@ -0,0 +1,49 @@
+/******************************************************************************
+ *
+ * @file       message_repository.hpp
+ * @brief      聊天消息的持久化
+ *
+ * @author     KBchulan
+ * @date       2026/10/18
+ * @history
+ *             2026/10/18 新增按 (conversation_id, seq) 键集分页的历史查询
+ *             2026/10/18 新增会话已落库的最大 seq，序号计数器丢失后由此重新起算
+ *             2026/10/18 历史查询按实际长度读取超出 buffer 的消息内容，查询失败时不再当作没有消息
+ *             2026/10/18 写入不再忽略主键冲突，seq 重号的消息记录错误而不是静默丢弃
+ ******************************************************************************/
+
+#ifndef MESSAGE_REPOSITORY_HPP
+#define MESSAGE_REPOSITORY_HPP
+
+#include <boost/asio/awaitable.hpp>
+#include <core/CoreExport.hpp>
+#include <core/model/message_do.hpp>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace core
+{
+
+class CORE_EXPORT MessageRepository
+{
+public:
+  // 多行 INSERT 一次写入，一个往返落库整批消息；主键冲突时逐行写入，与已落库的同一条消息冲突（重试）的行跳过，
+  // 被其他消息占用 seq 的行记录错误后丢弃；其余失败返回 false，由写线程整批重试
+  static bool insertBatch(std::span<const MessageDO> messages);
+
+  // 取 seq 小于 before_seq 的最近 limit 条，按 seq 降序；before_seq 为 0 时从最新一条开始
+  // 沿主键索引定位后顺序读 limit 行，翻到多深都不需要 OFFSET 扫过前面的行；查询失败返回 std::nullopt
+  static boost::asio::awaitable<std::optional<std::vector<MessageDO>>> getHistoryAsync(std::string conversation_id,
+                                                                                      std::uint64_t before_seq,
+                                                                                      std::uint32_t limit);
+
+  // 会话中已落库的最大 seq，没有消息时为 0，查询失败返回 std::nullopt
+  static boost::asio::awaitable<std::optional<std::uint64_t>> getMaxSeqAsync(std::string conversation_id);
+};
+
+}  // namespace core
+
+#endif  // MESSAGE_REPOSITORY_HPP
@@ -0,0 +1,308 @@
+#include "message_writer.hpp"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <core/repository/message_repository.hpp>
+#include <exception>
+#include <global/Global.hpp>
+#include <global/MpscQueue.hpp>
+#include <mutex>
+#include <stop_token>
+#include <string>
+#include <thread>
+#include <tools/Logger.hpp>
+#include <unordered_map>
+#include <vector>
+
+namespace core
+{
+
+namespace
+{
+
+constexpr std::size_t SEQ_SHARDS = 16;  // 排队中最大 seq 的分片数，入队时只锁会话所在的分片
+
+// 每个会话排队与写入中的最大 seq，seq 计数器丢失后起算时与数据库中的最大 seq 取较大者
+struct SeqShard
+{
+  std::mutex _mutex;
+  std::unordered_map<std::string, std::uint64_t> _max_seq;
+};
+
+}  // namespace
+
+struct MessageWriter::_impl
+{
+  // 入队无锁，只有写线程出队
+  global::MpscQueue<MessageDO> _queue;
+
+  // 已入队但尚未写完的消息数，入队前增加，整批写完或丢弃后减少，用于限流与唤醒
+  std::atomic<std::size_t> _pending{0};
+  std::atomic<bool> _accepting{false};
+  std::atomic<bool> _saturated{false};
+
+  std::atomic<std::uint64_t> _submitted{0};
+  std::atomic<std::uint64_t> _rejected{0};
+  std::atomic<std::uint64_t> _written{0};
+  std::atomic<std::uint64_t> _batches{0};
+  std::atomic<std::uint64_t> _retries{0};
+  std::atomic<std::uint64_t> _dropped{0};
+
+  std::array<SeqShard, SEQ_SHARDS> _seq_shards;
+
+  Sink _sink;
+  std::mutex _mutex;
+  std::condition_variable_any _cv;
+  std::jthread _writer;
+
+  bool submit(MessageDO&& message)
+  {
+    using namespace global::server;
+
+    // 先占位再检查，与 Stop 配对：通过检查的消息一定在写线程退出前计入 _pending
+    auto pending = _pending.fetch_add(1, std::memory_order_seq_cst) + 1;
+    if (!_accepting.load(std::memory_order_seq_cst) || pending > PERSIST_MAX_PENDING)
+    {
+      _pending.fetch_sub(1, std::memory_order_relaxed);
+      _rejected.fetch_add(1, std::memory_order_relaxed);
+
+      if (pending > PERSIST_MAX_PENDING && !_saturated.exchange(true, std::memory_order_relaxed))
+      {
+        tools::Logger::getInstance().warning("Message writer saturated with {} pending messages, rejecting new ones",
+                                             PERSIST_MAX_PENDING);
+      }
+      return false;
+    }
+
+    // 先登记再入队，写线程写完这条消息时一定能看到登记
+    track(message);
+    _queue.emplace(std::move(message));
+    _submitted.fetch_add(1, std::memory_order_relaxed);
+
+    // 只在攒够一批的那次入队时唤醒，其余由写线程按时间间隔取走；加锁避免唤醒落在写线程检查条件与等待之间
+    if (pending == PERSIST_BATCH_MAX_ROWS)
+    {
+      {
+        std::lock_guard lock{_mutex};
+      }
+      _cv.notify_one();
+    }
+    return true;
+  }
+
+  void run(const std::stop_token& token)
+  {
+    using namespace global::server;
+
+    std::vector<MessageDO> batch;
+    batch.reserve(PERSIST_BATCH_MAX_ROWS);
+
+    while (true)
+    {
+      {
+        std::unique_lock lock{_mutex};
+        _cv.wait_for(lock, token, std::chrono::milliseconds(PERSIST_FLUSH_INTERVAL_MS),
+                     [this] { return _pending.load(std::memory_order_relaxed) >= PERSIST_BATCH_MAX_ROWS; });
+      }
+
+      // 取空队列，每攒满一批写出一次，尾部不足一批的也一并写出
+      while (fill(batch))
+      {
+        flush(batch, token);
+      }
+
+      if (token.stop_requested())
+      {
+        if (_pending.load(std::memory_order_seq_cst) == 0)
+        {
+          return;
+        }
+
+        // 有生产者已经占位但尚未链接节点
+        std::this_thread::yield();
+      }
+    }
+  }
+
+  bool fill(std::vector<MessageDO>& batch)
+  {
+    using namespace global::server;
+
+    std::size_t bytes = 0;
+    MessageDO message;
+    while (batch.size() < PERSIST_BATCH_MAX_ROWS && bytes < PERSIST_BATCH_MAX_BYTES && _queue.pop(message))
+    {
+      bytes += message.content.size();
+      batch.emplace_back(std::move(message));
+    }
+    return !batch.empty();
+  }
+
+  // 写入失败时整批重试，间隔逐次翻倍；期间新消息继续排队，排满后 Submit 拒绝
+  void flush(std::vector<MessageDO>& batch, const std::stop_token& token)
+  {
+    using namespace global::server;
+
+    const auto& logger = tools::Logger::getInstance();
+    auto backoff = std::chrono::milliseconds(PERSIST_RETRY_BACKOFF_MS);
+    std::size_t attempts = 0;
+
+    while (!write(batch))
+    {
+      ++attempts;
+      _retries.fetch_add(1, std::memory_order_relaxed);
+
+      if (token.stop_requested() && attempts > PERSIST_SHUTDOWN_RETRIES)
+      {
+        _dropped.fetch_add(batch.size(), std::memory_order_relaxed);
+        logger.error("Message writer dropped {} messages after {} failed attempts", batch.size(), attempts);
+        release(batch);
+        return;
+      }
+
+      logger.warning("Message writer failed to insert {} messages, retrying in {}ms", batch.size(), backoff.count());
+
+      // 停止时不再等待，剩余的重试立即进行
+      std::unique_lock lock{_mutex};
+      _cv.wait_for(lock, token, backoff, [] { return false; });
+      backoff = std::min(backoff * 2, std::chrono::milliseconds(PERSIST_RETRY_BACKOFF_MAX_MS));
+    }
+
+    _written.fetch_add(batch.size(), std::memory_order_relaxed);
+    _batches.fetch_add(1, std::memory_order_relaxed);
+    release(batch);
+  }
+
+  bool write(const std::vector<MessageDO>& batch)
+  {
+    try
+    {
+      return _sink(batch);
+    }
+    catch (const std::exception& e)
+    {
+      // 连接池重连失败时抛出异常，与写入失败一样重试
+      tools::Logger::getInstance().error("Message writer sink error: {}", e.what());
+      return false;
+    }
+  }
+
+  SeqShard& shard_of(const std::string& conversation_id)
+  {
+    return _seq_shards[std::hash<std::string>{}(conversation_id) % SEQ_SHARDS];
+  }
+
+  void track(const MessageDO& message)
+  {
+    auto& shard = shard_of(message.conversation_id);
+    std::lock_guard lock{shard._mutex};
+    auto& max_seq = shard._max_seq[message.conversation_id];
+    max_seq = std::max(max_seq, message.seq);
+  }
+
+  // 会话最新的一条写完或丢弃后不再登记，之后起算只依赖数据库与缓存
+  void untrack(const std::vector<MessageDO>& batch)
+  {
+    for (const auto& message : batch)
+    {
+      auto& shard = shard_of(message.conversation_id);
+      std::lock_guard lock{shard._mutex};
+      auto iter = shard._max_seq.find(message.conversation_id);
+      if (iter != shard._max_seq.end() && iter->second <= message.seq)
+      {
+        shard._max_seq.erase(iter);
+      }
+    }
+  }
+
+  std::uint64_t pending_max_seq(const std::string& conversation_id)
+  {
+    auto& shard = shard_of(conversation_id);
+    std::lock_guard lock{shard._mutex};
+    auto iter = shard._max_seq.find(conversation_id);
+    return iter == shard._max_seq.end() ? 0 : iter->second;
+  }
+
+  void release(std::vector<MessageDO>& batch)
+  {
+    untrack(batch);
+    auto pending = _pending.fetch_sub(batch.size(), std::memory_order_seq_cst) - batch.size();
+    batch.clear();
+
+    if (pending < global::server::PERSIST_MAX_PENDING / 2 && _saturated.exchange(false, std::memory_order_relaxed))
+    {
+      tools::Logger::getInstance().info("Message writer recovered, {} messages pending", pending);
+    }
+  }
+};
+
+MessageWriter::MessageWriter() : _pimpl(std::make_unique<_impl>())
+{
+}
+
+MessageWriter::~MessageWriter()
+{
+  Stop();
+}
+
+MessageWriter& MessageWriter::GetInstance()
+{
+  static MessageWriter instance;
+  return instance;
+}
+
+void MessageWriter::Start(Sink sink)
+{
+  if (_pimpl->_writer.joinable())
+  {
+    return;
+  }
+
+  _pimpl->_sink = sink ? std::move(sink) : Sink{MessageRepository::insertBatch};
+  _pimpl->_accepting.store(true, std::memory_order_seq_cst);
+  _pimpl->_writer = std::jthread([this](const std::stop_token& token) { _pimpl->run(token); });
+
+  tools::Logger::getInstance().info("Message writer started");
+}
+
+void MessageWriter::Stop()
+{
+  if (!_pimpl->_writer.joinable())
+  {
+    return;
+  }
+
+  _pimpl->_accepting.store(false, std::memory_order_seq_cst);
+  _pimpl->_writer.request_stop();
+  _pimpl->_writer.join();
+
+  tools::Logger::getInstance().info("Message writer stopped, {} messages written in {} batches",
+                                    _pimpl->_written.load(std::memory_order_relaxed),
+                                    _pimpl->_batches.load(std::memory_order_relaxed));
+}
+
+bool MessageWriter::Submit(MessageDO message)
+{
+  return _pimpl->submit(std::move(message));
+}
+
+std::uint64_t MessageWriter::GetPendingMaxSeq(const std::string& conversation_id) const
+{
+  return _pimpl->pending_max_seq(conversation_id);
+}
+
+MessageWriterStats MessageWriter::GetStats() const
+{
+  return {.submitted = _pimpl->_submitted.load(std::memory_order_relaxed),
+          .rejected = _pimpl->_rejected.load(std::memory_order_relaxed),
+          .written = _pimpl->_written.load(std::memory_order_relaxed),
+          .batches = _pimpl->_batches.load(std::memory_order_relaxed),
+          .retries = _pimpl->_retries.load(std::memory_order_relaxed),
+          .dropped = _pimpl->_dropped.load(std::memory_order_relaxed),
+          .pending = _pimpl->_pending.load(std::memory_order_relaxed)};
+}
+
+}  // namespace core
@@ -0,0 +1,77 @@
+/******************************************************************************
+ *
+ * @file       message_writer.hpp
+ * @brief      聊天消息的异步落库
+ *
+ * @author     KBchulan
+ * @date       2026/10/18
+ * @history    消息先进入无锁队列，由单独的写线程攒批后以多行 INSERT 写入，发送路径不等待数据库往返
+ *             2026/10/18 按会话记录排队中的最大 seq，seq 计数器丢失后据此起算，不再与未落库的消息重号
+ ******************************************************************************/
+
+#ifndef MESSAGE_WRITER_HPP
+#define MESSAGE_WRITER_HPP
+
+#include <core/CoreExport.hpp>
+#include <core/model/message_do.hpp>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <span>
+#include <string>
+
+namespace core
+{
+
+// 落库统计，written / batches 即平均每条 INSERT 写入的行数
+struct CORE_EXPORT MessageWriterStats
+{
+  std::uint64_t submitted;  // 入队的消息数
+  std::uint64_t rejected;   // 排队达到上限被拒绝的消息数
+  std::uint64_t written;    // 已写入的消息数
+  std::uint64_t batches;    // 成功执行的 INSERT 数
+  std::uint64_t retries;    // 写入失败后的重试次数
+  std::uint64_t dropped;    // 停止时重试仍失败而丢弃的消息数
+  std::uint64_t pending;    // 当前排队与写入中的消息数
+};
+
+class CORE_EXPORT MessageWriter
+{
+public:
+  // 写出一批消息，返回 false 时整批重试
+  using Sink = std::function<bool(std::span<const MessageDO> batch)>;
+
+  static MessageWriter& GetInstance();
+
+  // 启动写线程，攒够 PERSIST_BATCH_MAX_ROWS 行或等待 PERSIST_FLUSH_INTERVAL_MS 后写出一批
+  // sink 为空时由 MessageRepository 写入 MariaDB，需在 DBPool 初始化之后调用
+  void Start(Sink sink = nullptr);
+
+  // 写出全部已入队的消息后退出，之后的 Submit 均被拒绝
+  void Stop();
+
+  // 非阻塞入队，任意线程可调用；排队与写入中的消息达到 PERSIST_MAX_PENDING 时返回 false，
+  // 数据库长时间不可用时由此把压力传回发送方，而不是无限占用内存
+  bool Submit(MessageDO message);
+
+  // 该会话排队与写入中的最大 seq，没有时为 0；只统计本进程的队列
+  [[nodiscard]] std::uint64_t GetPendingMaxSeq(const std::string& conversation_id) const;
+
+  [[nodiscard]] MessageWriterStats GetStats() const;
+
+  MessageWriter(const MessageWriter&) = delete;
+  MessageWriter& operator=(const MessageWriter&) = delete;
+  MessageWriter(MessageWriter&&) = delete;
+  MessageWriter& operator=(MessageWriter&&) = delete;
+
+private:
+  MessageWriter();
+  ~MessageWriter();
+
+  struct _impl;
+  std::unique_ptr<_impl> _pimpl;
+};
+
+}  // namespace core
+
+#endif  // MESSAGE_WRITER_HPP
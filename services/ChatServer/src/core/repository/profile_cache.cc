@@ -0,0 +1,310 @@
+#include "profile_cache.hpp"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <core/repository/user_repository.hpp>
+#include <functional>
+#include <global/Global.hpp>
+#include <list>
+#include <mutex>
+#include <string_view>
+#include <tools/Logger.hpp>
+#include <unordered_map>
+#include <utils/pool/redis/async_redis_client.hpp>
+
+namespace core
+{
+
+namespace
+{
+
+using Clock = std::chrono::steady_clock;
+
+constexpr std::size_t SHARD_CAPACITY =
+    std::max<std::size_t>(1, global::server::PROFILE_CACHE_CAPACITY / global::server::PROFILE_CACHE_SHARDS);
+
+UserDO make_profile(const std::string& uuid, std::string nickname, std::string avatar, std::string email)
+{
+  return UserDO{.id = 0,
+                .uuid = uuid,
+                .nickname = std::move(nickname),
+                .avatar = std::move(avatar),
+                .email = std::move(email),
+                .password_hash = {},
+                .last_login = {},
+                .created_at = {},
+                .updated_at = {}};
+}
+
+// HGETALL 的回复是字段与值交替的数组，只有登录流程写入的完整哈希才算命中
+std::optional<UserDO> parse_user_info(const std::string& uuid, const utils::RedisReply& reply)
+{
+  if (!reply.IsValid() || reply.IsError())
+  {
+    return std::nullopt;
+  }
+
+  auto fields = reply.AsArray();
+  if (!fields.has_value() || fields->empty())
+  {
+    return std::nullopt;
+  }
+
+  std::optional<std::string> nickname;
+  std::optional<std::string> avatar;
+  std::optional<std::string> email;
+  for (std::size_t i = 0; i + 1 < fields->size(); i += 2)
+  {
+    auto& value = (*fields)[i + 1];
+    if ((*fields)[i] == "nickname")
+    {
+      nickname = std::move(value);
+    }
+    else if ((*fields)[i] == "avatar")
+    {
+      avatar = std::move(value);
+    }
+    else if ((*fields)[i] == "email")
+    {
+      email = std::move(value);
+    }
+  }
+
+  if (!nickname.has_value() || !avatar.has_value() || !email.has_value())
+  {
+    return std::nullopt;
+  }
+  return make_profile(uuid, std::move(*nickname), std::move(*avatar), std::move(*email));
+}
+
+}  // namespace
+
+struct ProfileCache::_impl
+{
+  // 一个分片一把锁，链表队首是最近使用的条目
+  struct Shard
+  {
+    struct Entry
+    {
+      std::string _uuid;
+      UserDO _user;
+      Clock::time_point _expire_at;
+    };
+
+    std::mutex _mutex;
+    std::list<Entry> _lru;
+    std::unordered_map<std::string, std::list<Entry>::iterator> _index;
+
+    // 每次失效或清空时递增，回源期间发生过失效的结果不再放入
+    std::uint64_t _generation = 0;
+  };
+
+  std::array<Shard, global::server::PROFILE_CACHE_SHARDS> _shards;
+
+  std::atomic<std::uint64_t> _local_hits{0};
+  std::atomic<std::uint64_t> _redis_hits{0};
+  std::atomic<std::uint64_t> _db_loads{0};
+  std::atomic<std::uint64_t> _misses{0};
+  std::atomic<std::uint64_t> _invalidations{0};
+
+  Shard& shard_of(const std::string& uuid)
+  {
+    return _shards[std::hash<std::string>{}(uuid) % _shards.size()];
+  }
+
+  std::optional<UserDO> find(const std::string& uuid)
+  {
+    auto& shard = shard_of(uuid);
+    std::lock_guard lock{shard._mutex};
+
+    auto it = shard._index.find(uuid);
+    if (it == shard._index.end())
+    {
+      return std::nullopt;
+    }
+    if (it->second->_expire_at <= Clock::now())
+    {
+      shard._lru.erase(it->second);
+      shard._index.erase(it);
+      return std::nullopt;
+    }
+
+    shard._lru.splice(shard._lru.begin(), shard._lru, it->second);
+    return it->second->_user;
+  }
+
+  std::uint64_t generation_of(const std::string& uuid)
+  {
+    auto& shard = shard_of(uuid);
+    std::lock_guard lock{shard._mutex};
+    return shard._generation;
+  }
+
+  // generation 为空时无条件放入
+  void store(const std::string& uuid, const UserDO& user, std::optional<std::uint64_t> generation)
+  {
+    auto& shard = shard_of(uuid);
+    std::lock_guard lock{shard._mutex};
+
+    if (generation.has_value() && *generation != shard._generation)
+    {
+      return;
+    }
+
+    auto expire_at = Clock::now() + std::chrono::seconds(global::server::PROFILE_CACHE_TTL_S);
+    if (auto it = shard._index.find(uuid); it != shard._index.end())
+    {
+      it->second->_user = user;
+      it->second->_expire_at = expire_at;
+      shard._lru.splice(shard._lru.begin(), shard._lru, it->second);
+      return;
+    }
+
+    shard._lru.push_front(Shard::Entry{._uuid = uuid, ._user = user, ._expire_at = expire_at});
+    shard._index.emplace(uuid, shard._lru.begin());
+    if (shard._lru.size() > SHARD_CAPACITY)
+    {
+      shard._index.erase(shard._lru.back()._uuid);
+      shard._lru.pop_back();
+    }
+  }
+
+  void erase(const std::string& uuid)
+  {
+    auto& shard = shard_of(uuid);
+    std::lock_guard lock{shard._mutex};
+
+    ++shard._generation;
+    if (auto it = shard._index.find(uuid); it != shard._index.end())
+    {
+      shard._lru.erase(it->second);
+      shard._index.erase(it);
+    }
+  }
+
+  void clear()
+  {
+    for (auto& shard : _shards)
+    {
+      std::lock_guard lock{shard._mutex};
+      ++shard._generation;
+      shard._lru.clear();
+      shard._index.clear();
+    }
+  }
+
+  boost::asio::awaitable<std::optional<UserDO>> load(const std::string& uuid)
+  {
+    auto generation = generation_of(uuid);
+
+    auto key = global::server::USER_INFO_PREFIX + uuid;
+    auto cached = parse_user_info(uuid, co_await utils::AsyncRedisClient::GetInstance().HGetAll(key));
+    if (cached.has_value())
+    {
+      _redis_hits.fetch_add(1, std::memory_order_relaxed);
+      store(uuid, *cached, generation);
+      co_return cached;
+    }
+
+    // 查询失败与用户不存在都返回空的 UserDO，两者都不放入缓存
+    auto user = co_await UserRepository::getUserByIdAsync(uuid);
+    if (user.nickname.empty() && user.email.empty())
+    {
+      _misses.fetch_add(1, std::memory_order_relaxed);
+      co_return std::nullopt;
+    }
+
+    _db_loads.fetch_add(1, std::memory_order_relaxed);
+    auto profile = make_profile(uuid, std::move(user.nickname), std::move(user.avatar), std::move(user.email));
+    store(uuid, profile, generation);
+    co_return profile;
+  }
+};
+
+ProfileCache::ProfileCache() : _pimpl(std::make_unique<_impl>())
+{
+}
+
+ProfileCache::~ProfileCache() = default;
+
+ProfileCache& ProfileCache::GetInstance()
+{
+  static ProfileCache instance;
+  return instance;
+}
+
+void ProfileCache::Init(const boost::asio::any_io_executor& executor)
+{
+  utils::AsyncRedisClient::GetInstance().Subscribe(
+      executor, global::server::PROFILE_INVALIDATE_CHANNEL,
+      [this](std::string_view uuid)
+      {
+        _pimpl->_invalidations.fetch_add(1, std::memory_order_relaxed);
+        _pimpl->erase(std::string{uuid});
+      },
+      [this] { _pimpl->clear(); });
+
+  tools::Logger::getInstance().info("Profile cache init successful");
+}
+
+std::optional<UserDO> ProfileCache::Peek(const std::string& uuid)
+{
+  auto user = _pimpl->find(uuid);
+  if (user.has_value())
+  {
+    _pimpl->_local_hits.fetch_add(1, std::memory_order_relaxed);
+  }
+  return user;
+}
+
+boost::asio::awaitable<std::optional<UserDO>> ProfileCache::GetAsync(const std::string& uuid)
+{
+  if (auto user = Peek(uuid); user.has_value())
+  {
+    co_return user;
+  }
+  co_return co_await _pimpl->load(uuid);
+}
+
+void ProfileCache::Put(const std::string& uuid, const UserDO& user)
+{
+  _pimpl->store(uuid, user, std::nullopt);
+}
+
+void ProfileCache::Invalidate(const std::string& uuid)
+{
+  _pimpl->erase(uuid);
+}
+
+boost::asio::awaitable<void> ProfileCache::PublishInvalidateAsync(const std::string& uuid)
+{
+  _pimpl->erase(uuid);
+
+  auto& redis = utils::AsyncRedisClient::GetInstance();
+  auto reply = co_await redis.Publish(global::server::PROFILE_INVALIDATE_CHANNEL, uuid);
+  if (!reply.IsValid() || reply.IsError())
+  {
+    tools::Logger::getInstance().error("Failed to publish profile invalidation for user {}", uuid);
+  }
+}
+
+ProfileCacheStats ProfileCache::GetStats() const
+{
+  std::size_t size = 0;
+  for (auto& shard : _pimpl->_shards)
+  {
+    std::lock_guard lock{shard._mutex};
+    size += shard._lru.size();
+  }
+
+  return {.local_hits = _pimpl->_local_hits.load(std::memory_order_relaxed),
+          .redis_hits = _pimpl->_redis_hits.load(std::memory_order_relaxed),
+          .db_loads = _pimpl->_db_loads.load(std::memory_order_relaxed),
+          .misses = _pimpl->_misses.load(std::memory_order_relaxed),
+          .invalidations = _pimpl->_invalidations.load(std::memory_order_relaxed),
+          .size = size};
+}
+
+}  // namespace core
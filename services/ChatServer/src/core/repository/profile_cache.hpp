@@ -0,0 +1,82 @@
+/******************************************************************************
+ *
+ * @file       profile_cache.hpp
+ * @brief      用户资料的进程内近端缓存
+ *
+ * @author     KBchulan
+ * @date       2026/10/18
+ * @history    分片 LRU 保存 nickname/avatar/email，未命中时依次读取 user_info: 哈希与 MariaDB；
+ *             资料变更时经 Redis 频道广播 uuid，各服务器清除本地副本
+ ******************************************************************************/
+
+#ifndef PROFILE_CACHE_HPP
+#define PROFILE_CACHE_HPP
+
+#include <boost/asio/any_io_executor.hpp>
+#include <boost/asio/awaitable.hpp>
+#include <core/CoreExport.hpp>
+#include <core/model/user_do.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+
+namespace core
+{
+
+// local_hits + redis_hits + db_loads 即全部查询次数，misses 为三级都未找到的次数
+struct CORE_EXPORT ProfileCacheStats
+{
+  std::uint64_t local_hits;     // 本地命中，不产生网络往返
+  std::uint64_t redis_hits;     // user_info: 哈希命中，即对方在线
+  std::uint64_t db_loads;       // 回源数据库
+  std::uint64_t misses;         // 用户不存在
+  std::uint64_t invalidations;  // 收到的失效消息数
+  std::size_t size;             // 本地缓存的条数
+};
+
+// user_info: 哈希同时是 GateWay 判断用户已登录的标记，只由登录流程写入；
+// 查询其他用户时回源数据库得到的资料只放入本地，不写回 Redis
+class CORE_EXPORT ProfileCache
+{
+public:
+  static ProfileCache& GetInstance();
+
+  // 在 executor 上订阅 PROFILE_INVALIDATE_CHANNEL，需在 AsyncRedisClient 初始化之后调用
+  // 每次（重新）订阅成功时清空本地缓存，断线期间漏收的失效消息不会留下过期副本
+  void Init(const boost::asio::any_io_executor& executor);
+
+  // 只查本地，任意线程可调用，逻辑线程上渲染资料时使用
+  [[nodiscard]] std::optional<UserDO> Peek(const std::string& uuid);
+
+  // 本地未命中时依次读取 Redis 与数据库并放入本地，用户不存在时返回空
+  boost::asio::awaitable<std::optional<UserDO>> GetAsync(const std::string& uuid);
+
+  // 放入本地，覆盖已有的副本
+  void Put(const std::string& uuid, const UserDO& user);
+
+  // 只清除本地副本
+  void Invalidate(const std::string& uuid);
+
+  // 资料写入数据库之后调用：清除本地副本并广播给其他服务器
+  boost::asio::awaitable<void> PublishInvalidateAsync(const std::string& uuid);
+
+  [[nodiscard]] ProfileCacheStats GetStats() const;
+
+  ProfileCache(const ProfileCache&) = delete;
+  ProfileCache& operator=(const ProfileCache&) = delete;
+  ProfileCache(ProfileCache&&) = delete;
+  ProfileCache& operator=(ProfileCache&&) = delete;
+
+private:
+  ProfileCache();
+  ~ProfileCache();
+
+  struct _impl;
+  std::unique_ptr<_impl> _pimpl;
+};
+
+}  // namespace core
+
+#endif  // PROFILE_CACHE_HPP
@@ -1,6 +1,9 @@
 #include "user_repository.hpp"
 
+#include <string>
+#include <utils/pool/mariadb/async_db_pool.hpp>
 #include <utils/pool/mariadb/db_pool.hpp>
+#include <vector>
 
 namespace core
 {
@@ -41,4 +44,83 @@ bool UserRepository::updateLastLogin(const std::string& userId)
   return conn.Execute(sql, params);
 }
 
+bool UserRepository::updateLastLoginBatch(std::span<const LastLoginDO> logins)
+{
+  if (logins.empty())
+  {
+    return true;
+  }
+
+  // UPDATE users SET last_login = CASE uuid WHEN ? THEN FROM_UNIXTIME(?) ... END WHERE uuid IN (?, ...)
+  std::string sql{"UPDATE users SET last_login = CASE uuid"};
+  std::string in_list;
+  sql.reserve(sql.size() + logins.size() * 32);
+  in_list.reserve(logins.size() * 3);
+
+  std::vector<utils::ParamHolder> params;
+  params.reserve(logins.size() * 3);
+
+  for (const auto& login : logins)
+  {
+    sql += " WHEN ? THEN FROM_UNIXTIME(?)";
+    params.push_back(utils::MakeBind(login.uuid));
+    params.push_back(utils::MakeBind(login.login_at));
+
+    in_list += in_list.empty() ? "?" : ",?";
+  }
+  for (const auto& login : logins)
+  {
+    params.push_back(utils::MakeBind(login.uuid));
+  }
+  sql += " END WHERE uuid IN (" + in_list + ")";
+
+  // 与 MessageRepository::insertBatch 相同，字符串绑定改指向数组内的长度
+  for (auto& holder : params)
+  {
+    if (holder.bind.length != nullptr)
+    {
+      holder.bind.length = &holder.length;
+    }
+  }
+
+  auto conn = utils::DBPool::GetInstance().GetConnection();
+  return conn.Execute(sql.c_str(), params);
+}
+
+boost::asio::awaitable<UserDO> UserRepository::getUserByIdAsync(const std::string& userId)
+{
+  auto conn = co_await utils::AsyncDBPool::GetInstance().GetConnection();
+
+  const char* sql = "SELECT nickname, avatar, email FROM users WHERE uuid = ?";
+
+  utils::StringBuffer<64> nickname;
+  utils::StringBuffer<128> avatar;
+  utils::StringBuffer<255> email;
+
+  auto params = utils::MakeParams(userId);
+  auto results = utils::MakeResults(nickname, avatar, email);
+
+  if (co_await conn.QueryOne(sql, params, results))
+  {
+    co_return UserDO{.id = 0,
+                     .uuid = {},
+                     .nickname = nickname.str(),
+                     .avatar = avatar.str(),
+                     .email = email.str(),
+                     .password_hash = {},
+                     .last_login = {},
+                     .created_at = {},
+                     .updated_at = {}};
+  }
+  co_return UserDO{};
+}
+
+boost::asio::awaitable<bool> UserRepository::updateLastLoginAsync(const std::string& userId)
+{
+  auto conn = co_await utils::AsyncDBPool::GetInstance().GetConnection();
+  const char* sql = "UPDATE users SET last_login = NOW() WHERE uuid = ?";
+  auto params = utils::MakeParams(userId);
+  co_return co_await conn.Execute(sql, params);
+}
+
 }  // namespace core
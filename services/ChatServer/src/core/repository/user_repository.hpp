@@ -5,14 +5,16 @@
  *
  * @author     KBchulan
  * @date       2025/12/16
- * @history
+ * @history    2026/10/18 新增多行合并的登录时间更新
  ******************************************************************************/
 
 #ifndef USER_REPOSITORY_HPP
 #define USER_REPOSITORY_HPP
 
+#include <boost/asio/awaitable.hpp>
 #include <core/CoreExport.hpp>
 #include <core/model/user_do.hpp>
+#include <span>
 
 namespace core
 {
@@ -22,6 +24,13 @@ class CORE_EXPORT UserRepository
 public:
   static UserDO getUserById(const std::string& userId);
   static bool updateLastLogin(const std::string& userId);
+
+  // 一条 UPDATE ... CASE 写入多个用户的登录时间，uuid 不能重复
+  static bool updateLastLoginBatch(std::span<const LastLoginDO> logins);
+
+  // 协程版本，基于 AsyncDBPool，等待数据库期间不占用 io 线程
+  static boost::asio::awaitable<UserDO> getUserByIdAsync(const std::string& userId);
+  static boost::asio::awaitable<bool> updateLastLoginAsync(const std::string& userId);
 };
 
 }  // namespace core
@@ -0,0 +1,503 @@
+#include "hot_restart.hpp"
+
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <global/Global.hpp>
+#include <optional>
+#include <stop_token>
+#include <string_view>
+#include <thread>
+#include <tools/Logger.hpp>
+#include <utility>
+#include <vector>
+
+namespace core
+{
+
+namespace
+{
+
+constexpr std::uint32_t HANDOFF_MAGIC = 0x43534852;   // "CSHR"
+constexpr int ACCEPT_POLL_MS = 200;                   // 交接线程检查退出标记的间隔
+constexpr std::size_t MAX_LISTEN_FDS = 1024;          // 头部中监听 socket 数的上限，超出视为损坏
+constexpr std::size_t MAX_SESSIONS = 1 << 24;         // 头部中会话数的上限
+constexpr std::size_t MAX_USER_ID_LEN = 256;          // 会话记录中用户 id 的长度上限
+constexpr std::size_t MAX_PENDING_OUT_LEN = 1 << 26;  // 会话记录中待写出字节数的上限
+constexpr std::int64_t TAKEOVER_MARGIN_MS = 1000;     // 新进程等待旧进程排空之外的余量
+
+// 新进程 -> 旧进程：请求交接
+struct Hello
+{
+  std::uint32_t magic;
+  std::uint32_t version;
+};
+
+// 旧进程 -> 新进程：随后依次是 listen_count 条监听 socket 记录与 session_count 条会话记录
+struct Header
+{
+  std::uint32_t magic;
+  std::uint32_t version;
+  std::uint32_t listen_count;
+  std::uint32_t session_count;
+};
+
+// 携带一个监听 socket
+struct ListenRecord
+{
+  std::uint32_t index;
+};
+
+// 携带会话的 socket，随后是 user_id、pending_in、pending_out 依次拼接的数据，按 HOT_RESTART_CHUNK_SIZE 分条
+struct SessionRecord
+{
+  std::uint64_t io_index;
+  std::uint32_t user_id_len;
+  std::uint32_t pending_in_len;
+  std::uint32_t pending_out_len;
+  std::uint8_t protocol;
+  std::uint8_t algorithm;
+  std::uint8_t use_dict;
+};
+
+// 新进程 -> 旧进程：收到的会话数，只用于记录日志
+struct Ack
+{
+  std::uint32_t magic;
+  std::uint32_t received;
+};
+
+// SOCK_SEQPACKET 保留消息边界，fd 不为 -1 时随消息以 SCM_RIGHTS 传递
+bool send_message(int sock, const void* data, std::size_t len, int fd = -1)
+{
+  iovec iov{.iov_base = const_cast<void*>(data), .iov_len = len};
+  msghdr msg{};
+  msg.msg_iov = &iov;
+  msg.msg_iovlen = 1;
+
+  alignas(cmsghdr) std::array<char, CMSG_SPACE(sizeof(int))> control{};
+  if (fd >= 0)
+  {
+    msg.msg_control = control.data();
+    msg.msg_controllen = control.size();
+    auto* cmsg = CMSG_FIRSTHDR(&msg);
+    cmsg->cmsg_level = SOL_SOCKET;
+    cmsg->cmsg_type = SCM_RIGHTS;
+    cmsg->cmsg_len = CMSG_LEN(sizeof(int));
+    std::memcpy(CMSG_DATA(cmsg), &fd, sizeof(int));
+  }
+
+  ssize_t sent = 0;
+  do
+  {
+    sent = ::sendmsg(sock, &msg, MSG_NOSIGNAL);
+  } while (sent < 0 && errno == EINTR);
+  return sent == static_cast<ssize_t>(len);
+}
+
+// 返回消息长度，出错、对端关闭或消息被截断时返回 -1；收到的 fd 已设置 CLOEXEC
+ssize_t recv_message(int sock, void* data, std::size_t cap, int* fd = nullptr)
+{
+  iovec iov{.iov_base = data, .iov_len = cap};
+  msghdr msg{};
+  msg.msg_iov = &iov;
+  msg.msg_iovlen = 1;
+
+  alignas(cmsghdr) std::array<char, CMSG_SPACE(sizeof(int))> control{};
+  msg.msg_control = control.data();
+  msg.msg_controllen = control.size();
+
+  ssize_t received = 0;
+  do
+  {
+    received = ::recvmsg(sock, &msg, MSG_CMSG_CLOEXEC);
+  } while (received < 0 && errno == EINTR);
+
+  int passed = -1;
+  for (auto* cmsg = CMSG_FIRSTHDR(&msg); cmsg != nullptr; cmsg = CMSG_NXTHDR(&msg, cmsg))
+  {
+    if (cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_RIGHTS && cmsg->cmsg_len == CMSG_LEN(sizeof(int)))
+    {
+      std::memcpy(&passed, CMSG_DATA(cmsg), sizeof(int));
+    }
+  }
+
+  // 调用方不接收 fd 时收到的 fd 同样关闭，不泄漏到本进程
+  bool broken = received <= 0 || (msg.msg_flags & (MSG_TRUNC | MSG_CTRUNC)) != 0;
+  if (broken || fd == nullptr)
+  {
+    if (passed >= 0)
+    {
+      ::close(passed);
+    }
+    passed = -1;
+  }
+  if (fd != nullptr)
+  {
+    *fd = passed;
+  }
+  return broken ? -1 : received;
+}
+
+template <typename T>
+bool recv_struct(int sock, T& value, int* fd = nullptr)
+{
+  return recv_message(sock, &value, sizeof(T), fd) == static_cast<ssize_t>(sizeof(T));
+}
+
+void set_timeout(int sock, std::chrono::milliseconds timeout)
+{
+  timeval tv{.tv_sec = static_cast<time_t>(timeout.count() / 1000),
+             .tv_usec = static_cast<suseconds_t>((timeout.count() % 1000) * 1000)};
+  setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+  setsockopt(sock, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
+}
+
+bool fill_address(const std::string& path, sockaddr_un& addr)
+{
+  if (path.size() >= sizeof(addr.sun_path))
+  {
+    tools::Logger::getInstance().error("Hot restart socket path too long: {}", path);
+    return false;
+  }
+  addr.sun_family = AF_UNIX;
+  std::memcpy(addr.sun_path, path.c_str(), path.size() + 1);
+  return true;
+}
+
+bool send_session(int sock, const SessionSnapshot& session)
+{
+  SessionRecord record{.io_index = session.io_index,
+                       .user_id_len = static_cast<std::uint32_t>(session.user_id.size()),
+                       .pending_in_len = static_cast<std::uint32_t>(session.pending_in.size()),
+                       .pending_out_len = static_cast<std::uint32_t>(session.pending_out.size()),
+                       .protocol = static_cast<std::uint8_t>(session.protocol),
+                       .algorithm = static_cast<std::uint8_t>(session.compression.algorithm),
+                       .use_dict = static_cast<std::uint8_t>(session.compression.use_dict ? 1 : 0)};
+  if (!send_message(sock, &record, sizeof(record), session.fd))
+  {
+    return false;
+  }
+
+  std::string payload = session.user_id + session.pending_in + session.pending_out;
+  for (std::size_t offset = 0; offset < payload.size(); offset += global::server::HOT_RESTART_CHUNK_SIZE)
+  {
+    auto len = std::min(global::server::HOT_RESTART_CHUNK_SIZE, payload.size() - offset);
+    if (!send_message(sock, payload.data() + offset, len))
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+std::optional<SessionSnapshot> recv_session(int sock)
+{
+  SessionRecord record{};
+  int fd = -1;
+  if (!recv_struct(sock, record, &fd) || fd < 0)
+  {
+    return std::nullopt;
+  }
+
+  // 交接只发生在帧边界，pending_in 不会有完整的消息头
+  if (record.user_id_len > MAX_USER_ID_LEN || record.pending_in_len >= static_cast<std::uint32_t>(global::server::MSG_HEAD_TOTAL_LEN) ||
+      record.pending_out_len > MAX_PENDING_OUT_LEN)
+  {
+    tools::Logger::getInstance().error("Hot restart received a malformed session record");
+    ::close(fd);
+    return std::nullopt;
+  }
+
+  std::string payload;
+  payload.resize(static_cast<std::size_t>(record.user_id_len) + record.pending_in_len + record.pending_out_len);
+  for (std::size_t offset = 0; offset < payload.size();)
+  {
+    auto len = std::min(global::server::HOT_RESTART_CHUNK_SIZE, payload.size() - offset);
+    if (recv_message(sock, payload.data() + offset, len) != static_cast<ssize_t>(len))
+    {
+      ::close(fd);
+      return std::nullopt;
+    }
+    offset += len;
+  }
+
+  std::string_view view{payload};
+  return SessionSnapshot{
+      .fd = fd,
+      .io_index = static_cast<std::size_t>(record.io_index),
+      .user_id = std::string{view.substr(0, record.user_id_len)},
+      .protocol = static_cast<utils::WireProtocol>(record.protocol),
+      .compression = CompressionMode{.algorithm = static_cast<utils::Compression>(record.algorithm),
+                                     .use_dict = record.use_dict != 0},
+      .pending_in = std::string{view.substr(record.user_id_len, record.pending_in_len)},
+      .pending_out = std::string{view.substr(record.user_id_len + record.pending_in_len)}};
+}
+
+}  // namespace
+
+std::string HotRestart::SocketPath(unsigned short port)
+{
+  return std::string(global::server::HOT_RESTART_SOCKET_PREFIX) + std::to_string(port) + ".sock";
+}
+
+std::optional<ServerHandoff> HotRestart::TakeOver(const std::string& path)
+{
+  const auto& logger = tools::Logger::getInstance();
+
+  sockaddr_un addr{};
+  if (!fill_address(path, addr))
+  {
+    return std::nullopt;
+  }
+
+  int sock = ::socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0);
+  if (sock < 0)
+  {
+    logger.error("Failed to create hot restart socket: {}", std::strerror(errno));
+    return std::nullopt;
+  }
+
+  if (::connect(sock, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0)
+  {
+    logger.warning("No running ChatServer at {} to take over: {}", path, std::strerror(errno));
+    ::close(sock);
+    return std::nullopt;
+  }
+
+  // 旧进程收到请求后先等待会话停在帧边界，再发出头部
+  set_timeout(sock, std::chrono::milliseconds(global::server::HOT_RESTART_DRAIN_MS +
+                                              global::server::HOT_RESTART_WRITE_DRAIN_MS + TAKEOVER_MARGIN_MS));
+
+  Hello hello{.magic = HANDOFF_MAGIC, .version = global::server::HOT_RESTART_VERSION};
+  Header header{};
+  if (!send_message(sock, &hello, sizeof(hello)) || !recv_struct(sock, header))
+  {
+    logger.error("Hot restart handshake with {} failed", path);
+    ::close(sock);
+    return std::nullopt;
+  }
+
+  if (header.magic != HANDOFF_MAGIC || header.version != global::server::HOT_RESTART_VERSION ||
+      header.listen_count > MAX_LISTEN_FDS || header.session_count > MAX_SESSIONS)
+  {
+    logger.error("Hot restart header rejected, version {} expected {}", header.version,
+                 global::server::HOT_RESTART_VERSION);
+    ::close(sock);
+    return std::nullopt;
+  }
+
+  // 监听 socket 缺失时由对应的 acceptor 重新绑定端口
+  ServerHandoff handoff;
+  for (std::uint32_t i = 0; i < header.listen_count; ++i)
+  {
+    ListenRecord record{};
+    int fd = -1;
+    if (!recv_struct(sock, record, &fd) || fd < 0)
+    {
+      logger.error("Hot restart lost listen socket {} of {}", i, header.listen_count);
+      break;
+    }
+    handoff.listen_fds.push_back(fd);
+  }
+
+  if (handoff.listen_fds.size() == header.listen_count)
+  {
+    handoff.sessions.reserve(header.session_count);
+    for (std::uint32_t i = 0; i < header.session_count; ++i)
+    {
+      auto session = recv_session(sock);
+      if (!session.has_value())
+      {
+        logger.error("Hot restart lost sessions after {} of {}", i, header.session_count);
+        break;
+      }
+      handoff.sessions.emplace_back(std::move(*session));
+    }
+  }
+
+  Ack ack{.magic = HANDOFF_MAGIC, .received = static_cast<std::uint32_t>(handoff.sessions.size())};
+  send_message(sock, &ack, sizeof(ack));
+  ::close(sock);
+
+  logger.info("Took over {} listen sockets and {} sessions from {}", handoff.listen_fds.size(),
+              handoff.sessions.size(), path);
+  return handoff;
+}
+
+struct HotRestartListener::_impl
+{
+  std::string _path;
+  std::shared_ptr<Server> _server;
+  std::function<void()> _on_handed_off;
+
+  int _listen_fd = -1;
+  bool _handed_off = false;
+  std::jthread _thread;
+
+  _impl(std::string path, std::shared_ptr<Server> server, std::function<void()> on_handed_off)
+      : _path(std::move(path)), _server(std::move(server)), _on_handed_off(std::move(on_handed_off))
+  {
+  }
+
+  // 失败时只记录日志，本进程照常服务，只是不能被热重启
+  bool open()
+  {
+    const auto& logger = tools::Logger::getInstance();
+
+    sockaddr_un addr{};
+    if (!fill_address(_path, addr))
+    {
+      return false;
+    }
+
+    _listen_fd = ::socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0);
+    if (_listen_fd < 0)
+    {
+      logger.error("Failed to create hot restart socket: {}", std::strerror(errno));
+      return false;
+    }
+
+    // 旧进程交出后不删除路径，这里留下的是上一个进程的 socket 文件
+    ::unlink(_path.c_str());
+    if (::bind(_listen_fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 ||
+        ::chmod(_path.c_str(), S_IRUSR | S_IWUSR) != 0 || ::listen(_listen_fd, 1) != 0)
+    {
+      logger.error("Failed to listen on hot restart socket {}: {}", _path, std::strerror(errno));
+      ::close(_listen_fd);
+      _listen_fd = -1;
+      return false;
+    }
+
+    logger.info("Hot restart socket listening on {}", _path);
+    return true;
+  }
+
+  void run(const std::stop_token& token)
+  {
+    while (!token.stop_requested())
+    {
+      pollfd pfd{.fd = _listen_fd, .events = POLLIN, .revents = 0};
+      if (::poll(&pfd, 1, ACCEPT_POLL_MS) <= 0)
+      {
+        continue;
+      }
+
+      int conn = ::accept4(_listen_fd, nullptr, nullptr, SOCK_CLOEXEC);
+      if (conn < 0)
+      {
+        continue;
+      }
+
+      bool handed_off = serve(conn);
+      ::close(conn);
+      if (handed_off)
+      {
+        _handed_off = true;
+        _on_handed_off();
+        return;
+      }
+    }
+  }
+
+  // 返回 true 表示已停止接入，无论发送是否完整本进程都不能再继续服务
+  bool serve(int conn)
+  {
+    const auto& logger = tools::Logger::getInstance();
+
+    // 只接受同一用户的进程
+    ucred cred{};
+    socklen_t cred_len = sizeof(cred);
+    if (::getsockopt(conn, SOL_SOCKET, SO_PEERCRED, &cred, &cred_len) != 0 || cred.uid != ::geteuid())
+    {
+      logger.warning("Rejected hot restart request from uid {}", cred.uid);
+      return false;
+    }
+
+    set_timeout(conn, std::chrono::milliseconds(global::server::HOT_RESTART_DRAIN_MS));
+
+    Hello hello{};
+    if (!recv_struct(conn, hello) || hello.magic != HANDOFF_MAGIC ||
+        hello.version != global::server::HOT_RESTART_VERSION)
+    {
+      logger.warning("Rejected hot restart request from pid {}, version {} expected {}", cred.pid, hello.version,
+                     global::server::HOT_RESTART_VERSION);
+      return false;
+    }
+
+    logger.info("Handing off to pid {}", cred.pid);
+    auto handoff = _server->Handoff(std::chrono::milliseconds(global::server::HOT_RESTART_DRAIN_MS));
+
+    Header header{.magic = HANDOFF_MAGIC,
+                  .version = global::server::HOT_RESTART_VERSION,
+                  .listen_count = static_cast<std::uint32_t>(handoff.listen_fds.size()),
+                  .session_count = static_cast<std::uint32_t>(handoff.sessions.size())};
+    bool ok = send_message(conn, &header, sizeof(header));
+
+    // fd 在 sendmsg 时已复制进对端，本进程的副本逐个关闭；发送失败之后的会话随关闭而断开
+    for (std::size_t i = 0; i < handoff.listen_fds.size(); ++i)
+    {
+      ListenRecord record{.index = static_cast<std::uint32_t>(i)};
+      ok = ok && send_message(conn, &record, sizeof(record), handoff.listen_fds[i]);
+      ::close(handoff.listen_fds[i]);
+    }
+    for (const auto& session : handoff.sessions)
+    {
+      ok = ok && send_session(conn, session);
+      ::close(session.fd);
+    }
+
+    Ack ack{};
+    if (ok && recv_struct(conn, ack) && ack.magic == HANDOFF_MAGIC)
+    {
+      logger.info("Handed off {} listen sockets and {} sessions, {} accepted", handoff.listen_fds.size(),
+                  handoff.sessions.size(), ack.received);
+    }
+    else
+    {
+      logger.error("Hot restart transfer to pid {} did not complete", cred.pid);
+    }
+    return true;
+  }
+};
+
+HotRestartListener::HotRestartListener(std::string path, std::shared_ptr<Server> server,
+                                       std::function<void()> on_handed_off)
+    : _pimpl(std::make_unique<_impl>(std::move(path), std::move(server), std::move(on_handed_off)))
+{
+  if (_pimpl->open())
+  {
+    _pimpl->_thread = std::jthread([this](const std::stop_token& token) { _pimpl->run(token); });
+  }
+}
+
+HotRestartListener::~HotRestartListener()
+{
+  if (_pimpl->_thread.joinable())
+  {
+    _pimpl->_thread.request_stop();
+    _pimpl->_thread.join();
+  }
+
+  if (_pimpl->_listen_fd >= 0)
+  {
+    ::close(_pimpl->_listen_fd);
+
+    // 交出之后路径上可能已是新进程的 socket
+    if (!_pimpl->_handed_off)
+    {
+      ::unlink(_pimpl->_path.c_str());
+    }
+  }
+}
+
+}  // namespace core
@@ -0,0 +1,55 @@
+/******************************************************************************
+ *
+ * @file       hot_restart.hpp
+ * @brief      热重启：旧进程经 Unix socket 把监听 socket 与会话交给新进程
+ *
+ * @author     KBchulan
+ * @date       2026/10/18
+ * @history    新进程以 --takeover 启动后连接旧进程的交接 socket，以 SCM_RIGHTS 收下全部 fd 与会话状态，
+ *             旧进程交出之后退出，客户端的 TCP 连接不断开
+ ******************************************************************************/
+
+#ifndef HOT_RESTART_HPP
+#define HOT_RESTART_HPP
+
+#include <core/CoreExport.hpp>
+#include <core/server/server.hpp>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string>
+
+namespace core
+{
+
+class CORE_EXPORT HotRestart
+{
+public:
+  // 每个 TCP 端口一个交接 socket，同一台机器上的多个 ChatServer 互不干扰
+  [[nodiscard]] static std::string SocketPath(unsigned short port);
+
+  // 新进程：连接旧进程并收下交出的内容，旧进程不存在或版本不一致时返回空，此时照常绑定端口启动
+  // 会话记录中途出错时返回已收到的部分，余下的会话在旧进程中随 socket 关闭而断开
+  [[nodiscard]] static std::optional<ServerHandoff> TakeOver(const std::string& path);
+};
+
+// 旧进程：在独立线程上等待新进程连接，交出之后调用 on_handed_off，由调用方退出主循环
+class CORE_EXPORT HotRestartListener
+{
+public:
+  HotRestartListener(std::string path, std::shared_ptr<Server> server, std::function<void()> on_handed_off);
+  ~HotRestartListener();
+
+  HotRestartListener(const HotRestartListener&) = delete;
+  HotRestartListener& operator=(const HotRestartListener&) = delete;
+  HotRestartListener(HotRestartListener&&) = delete;
+  HotRestartListener& operator=(HotRestartListener&&) = delete;
+
+private:
+  struct _impl;
+  std::unique_ptr<_impl> _pimpl;
+};
+
+}  // namespace core
+
+#endif  // HOT_RESTART_HPP
@@ -1,34 +1,64 @@
 #include "server.hpp"
 
 #include <sys/socket.h>
+#include <unistd.h>
 
+#include <algorithm>
 #include <boost/asio/awaitable.hpp>
 #include <boost/asio/co_spawn.hpp>
 #include <boost/asio/detached.hpp>
 #include <boost/asio/ip/tcp.hpp>
 #include <boost/asio/socket_base.hpp>
 #include <boost/system/detail/error_code.hpp>
+#include <chrono>
+#include <condition_variable>
+#include <core/io/cpu_affinity.hpp>
 #include <core/io/io.hpp>
+#include <core/logic/logic.hpp>
+#include <core/manager/user_manager.hpp>
+#include <core/server/session_registry.hpp>
 #include <core/session/session.hpp>
+#include <core/timer/timing-wheel.hpp>
 #include <functional>
+#include <future>
+#include <global/Global.hpp>
+#include <mutex>
+#include <optional>
+#include <span>
 #include <tools/Logger.hpp>
-#include <unordered_map>
+#include <vector>
 
 namespace core
 {
 
 // 单个 Acceptor 工作单元，每个 io_context 对应一个，使用协程风格
+// 接入的连接留在本 io_context 上，连接在各个 acceptor 之间的均衡由 SO_REUSEPORT 完成，绑核时按收包 CPU 分发
+// 本 io_context 上的会话共用一个时间轮做空闲检测，整个 io 线程只有一个定时器
 class AcceptorWorker
 {
 public:
   using SessionCallback = std::function<void(std::shared_ptr<Session>)>;
 
-  AcceptorWorker(boost::asio::io_context& ioc, unsigned short port, std::weak_ptr<Server> server,
-                 SessionCallback on_session)
-      : _io_context(ioc), _acceptor(ioc), _server(std::move(server)), _on_session(std::move(on_session))
+  // inherited_fd 为旧进程交出的监听 socket，此时不再设置选项与绑定端口，为 -1 时新建
+  AcceptorWorker(boost::asio::io_context& ioc, std::size_t io_index, unsigned short port, int inherited_fd,
+                 std::weak_ptr<Server> server, SessionCallback on_session)
+      : _io_context(ioc),
+        _io_index(io_index),
+        _acceptor(ioc),
+        _idle_wheel(std::make_shared<TimingWheel>(ioc, std::chrono::milliseconds(global::server::IDLE_WHEEL_TICK_MS),
+                                                  global::server::IDLE_WHEEL_SLOTS)),
+        _server(std::move(server)),
+        _on_session(std::move(on_session))
   {
     boost::asio::ip::tcp::endpoint endpoint(boost::asio::ip::tcp::v4(), port);
 
+    if (inherited_fd >= 0)
+    {
+      _acceptor.assign(endpoint.protocol(), inherited_fd);
+      boost::asio::co_spawn(_io_context, accept_loop(), boost::asio::detached);
+      return;
+    }
+
     _acceptor.open(endpoint.protocol());
     _acceptor.set_option(boost::asio::socket_base::reuse_address(true));
 
@@ -36,6 +66,11 @@ public:
     int reuse_port = 1;
     setsockopt(_acceptor.native_handle(), SOL_SOCKET, SO_REUSEPORT, &reuse_port, sizeof(reuse_port));
 
+    if (auto cpu = IO::GetInstance().GetCpuAt(io_index); global::server::REUSEPORT_CPU_STEERING && cpu >= 0)
+    {
+      CpuAffinity::SetIncomingCpu(_acceptor.native_handle(), cpu);
+    }
+
     _acceptor.bind(endpoint);
     _acceptor.listen(boost::asio::socket_base::max_listen_connections);
 
@@ -49,6 +84,41 @@ public:
     _acceptor.close(errc);
   }
 
+  [[nodiscard]] int NativeHandle()
+  {
+    return _acceptor.native_handle();
+  }
+
+  // 在本 io 线程上停止接入并交出监听 socket，调用线程阻塞等待；之后到达的连接留在内核的接入队列中
+  [[nodiscard]] int Release()
+  {
+    std::promise<int> released;
+    boost::asio::post(_io_context,
+                      [this, &released]()
+                      {
+                        boost::system::error_code errc;
+                        auto fd = _acceptor.release(errc);
+                        if (errc)
+                        {
+                          tools::Logger::getInstance().error("Failed to release acceptor {}: {}", _io_index,
+                                                             errc.message());
+                          fd = -1;
+                        }
+                        released.set_value(fd);
+                      });
+    return released.get_future().get();
+  }
+
+  // 接管旧进程交出的会话，与新接入的连接一样使用本 io_context 的时间轮
+  void Adopt(const std::shared_ptr<Session>& session)
+  {
+    session->Start(_idle_wheel);
+    if (_on_session)
+    {
+      _on_session(session);
+    }
+  }
+
 private:
   boost::asio::awaitable<void> accept_loop()
   {
@@ -56,16 +126,13 @@ private:
     {
       try
       {
-        // 从池子里获取一个 io_context 给新连接使用
-        auto& client_ioc = IO::GetInstance().GetIOContext();
-
-        // 异步挂起，等待新的连接
-        auto socket = co_await _acceptor.async_accept(client_ioc, boost::asio::use_awaitable);
+        // 异步挂起，等待新的连接，会话的接入、读写与断开都在本 io 线程上
+        auto socket = co_await _acceptor.async_accept(_io_context, boost::asio::use_awaitable);
         auto eip = socket.remote_endpoint().address().to_string();
 
         // 启动一个新会话来处理连接
-        auto session = Session::Create(std::move(socket), _server);
-        session->Start();
+        auto session = Session::Create(std::move(socket), _server, _io_index);
+        session->Start(_idle_wheel);
 
         // 通过回调注册到 Server 的 session 管理
         if (_on_session)
@@ -87,7 +154,12 @@ private:
   }
 
   boost::asio::io_context& _io_context;
+  std::size_t _io_index;
   boost::asio::ip::tcp::acceptor _acceptor;
+
+  // 会话各持有一份引用，Server 析构后仍在断开中的会话可以安全地摘除节点
+  std::shared_ptr<TimingWheel> _idle_wheel;
+
   std::weak_ptr<Server> _server;
   SessionCallback _on_session;
 };
@@ -97,12 +169,12 @@ struct Server::_impl
   unsigned short _port;
   std::vector<std::unique_ptr<AcceptorWorker>> _workers;
 
-  std::mutex _mutex;
-  std::unordered_map<std::string, std::shared_ptr<Session>> _sessions;
+  // 按 io_context 分片，接入与断开只获取本 io 线程对应的分片锁
+  SessionRegistry _sessions;
 
   std::weak_ptr<Server> _self;
 
-  void start(const std::shared_ptr<Server>& self)
+  void start(const std::shared_ptr<Server>& self, std::span<const int> listen_fds)
   {
     _self = self;
 
@@ -111,21 +183,150 @@ struct Server::_impl
 
     _workers.reserve(pool_size);
 
-    // 每个 io_context 创建一个 acceptor worker
+    // 每个 io_context 创建一个 acceptor worker，有交出的监听 socket 时按下标接管
     for (std::size_t i = 0; i < pool_size; ++i)
     {
-      _workers.emplace_back(std::make_unique<AcceptorWorker>(io_pool.GetIOContextAt(i), _port, _self,
-                                                             [this](std::shared_ptr<Session> session)
-                                                             {
-                                                               std::lock_guard lock{_mutex};
-                                                               _sessions[session->GetUuid()] = std::move(session);
-                                                             }));
+      auto inherited_fd = i < listen_fds.size() ? listen_fds[i] : -1;
+      _workers.emplace_back(std::make_unique<AcceptorWorker>(io_pool.GetIOContextAt(i), i, _port, inherited_fd, _self,
+                                                             [this](const std::shared_ptr<Session>& session)
+                                                             { _sessions.Add(session); }));
+    }
+
+    // io 线程比旧进程少时多出的监听 socket 只能关闭，其接入队列中的连接会被重置
+    for (auto fd : listen_fds.subspan(std::min(listen_fds.size(), pool_size)))
+    {
+      tools::Logger::getInstance().warning("No io context for inherited listen socket {}, closing", fd);
+      ::close(fd);
+    }
+
+    if (global::server::REUSEPORT_CPU_STEERING)
+    {
+      attach_steering(io_pool);
     }
 
     tools::Logger::getInstance().info("ChatServer started on port {} with {} acceptors", _port, pool_size);
   }
 
-  explicit _impl(unsigned short port) : _port(port)
+  // 组内 socket 的下标即 listen 的先后顺序，与 io_context 的索引一致，挂到任一 socket 上对整组生效
+  void attach_steering(IO& io_pool)
+  {
+    std::vector<int> cpus(_workers.size());
+    for (std::size_t i = 0; i < cpus.size(); ++i)
+    {
+      cpus[i] = io_pool.GetCpuAt(i);
+    }
+
+    if (std::ranges::find(cpus, -1) != cpus.end())
+    {
+      tools::Logger::getInstance().warning("Reuseport steering needs pinned io threads, keep hashing");
+      return;
+    }
+    if (!CpuAffinity::AttachReuseportSteering(_workers.front()->NativeHandle(), cpus))
+    {
+      tools::Logger::getInstance().warning("Failed to attach reuseport steering program, keep hashing");
+      return;
+    }
+    tools::Logger::getInstance().info("Reuseport steering attached for {} acceptors", cpus.size());
+  }
+
+  // 旧进程的 io 线程数与本进程相同时会话留在原下标的 io_context 上，绑核与按收包 CPU 分发的对应关系不变
+  void restore(std::vector<SessionSnapshot> snapshots)
+  {
+    auto& io_pool = IO::GetInstance();
+    auto pool_size = io_pool.GetPoolSize();
+
+    std::size_t restored = 0;
+    for (std::size_t i = 0; i < snapshots.size(); ++i)
+    {
+      auto& snapshot = snapshots[i];
+      auto io_index = snapshot.io_index < pool_size ? snapshot.io_index : i % pool_size;
+
+      boost::asio::ip::tcp::socket socket(io_pool.GetIOContextAt(io_index));
+      boost::system::error_code errc;
+      socket.assign(boost::asio::ip::tcp::v4(), snapshot.fd, errc);
+      if (errc)
+      {
+        tools::Logger::getInstance().error("Failed to adopt inherited session socket: {}", errc.message());
+        ::close(snapshot.fd);
+        continue;
+      }
+
+      // 先启动再绑定用户，绑定之后投递的消息排在旧进程交出的帧之后
+      auto user_id = snapshot.user_id;
+      auto session = Session::Create(std::move(socket), _self, io_index);
+      session->Resume(std::move(snapshot));
+      _workers[io_index]->Adopt(session);
+      if (!user_id.empty())
+      {
+        UserManager::GetInstance().Bind(user_id, session);
+      }
+      ++restored;
+    }
+
+    tools::Logger::getInstance().info("Restored {} of {} sessions handed over", restored, snapshots.size());
+  }
+
+  ServerHandoff handoff(std::chrono::milliseconds timeout)
+  {
+    ServerHandoff result;
+
+    // 先停止接入，此后到达的连接留在内核的接入队列中，由新进程接入
+    for (auto& worker : _workers)
+    {
+      if (auto fd = worker->Release(); fd >= 0)
+      {
+        result.listen_fds.push_back(fd);
+      }
+    }
+
+    // 交接期间逐个回调，超时之后才交出的会话没有人接收，直接关闭 fd
+    struct Collector
+    {
+      std::mutex _mutex;
+      std::condition_variable _cv;
+      std::size_t _remaining;
+      bool _expired = false;
+      std::vector<SessionSnapshot> _snapshots;
+    };
+
+    auto sessions = _sessions.Drain();
+    auto collector = std::make_shared<Collector>();
+    collector->_remaining = sessions.size();
+    collector->_snapshots.reserve(sessions.size());
+
+    for (const auto& session : sessions)
+    {
+      session->Detach(
+          [collector](std::optional<SessionSnapshot> snapshot)
+          {
+            std::lock_guard lock{collector->_mutex};
+            if (snapshot.has_value())
+            {
+              if (collector->_expired)
+              {
+                ::close(snapshot->fd);
+              }
+              else
+              {
+                collector->_snapshots.emplace_back(std::move(*snapshot));
+              }
+            }
+            --collector->_remaining;
+            collector->_cv.notify_one();
+          });
+    }
+
+    std::unique_lock lock{collector->_mutex};
+    collector->_cv.wait_for(lock, timeout, [&collector] { return collector->_remaining == 0; });
+    collector->_expired = true;
+    result.sessions = std::move(collector->_snapshots);
+
+    tools::Logger::getInstance().info("Handing off {} listen sockets and {} of {} sessions", result.listen_fds.size(),
+                                      result.sessions.size(), sessions.size());
+    return result;
+  }
+
+  explicit _impl(unsigned short port) : _port(port), _sessions(IO::GetInstance().GetPoolSize())
   {
   }
 
@@ -133,12 +334,10 @@ struct Server::_impl
   {
     tools::Logger::getInstance().info("ChatServer is shutting down");
 
-    std::lock_guard lock{_mutex};
-    for (auto& [uuid, session] : _sessions)
+    for (const auto& session : _sessions.Drain())
     {
       session->Stop();
     }
-    _sessions.clear();
   }
 };
 
@@ -148,20 +347,32 @@ Server::Server(unsigned short port) : _pimpl(std::make_unique<_impl>(port))
 
 Server::~Server() = default;
 
-void Server::RemoveSession(const std::string& uuid)
+void Server::RemoveSession(const Session& session)
 {
-  std::lock_guard lock{_pimpl->_mutex};
-
-  if (auto iter = _pimpl->_sessions.find(uuid); iter != _pimpl->_sessions.end())
+  if (auto removed = _pimpl->_sessions.Remove(session))
   {
-    iter->second->Stop();
-    _pimpl->_sessions.erase(iter);
+    removed->Stop();
+    Logic::GetInstance().OnSessionClosed(removed);
   }
+
+  // Stop 已置位关闭标记，与登录绑定同时发生时由 UserManager::Bind 再次清理
+  UserManager::GetInstance().Unbind(session);
 }
 
 void Server::Start()
 {
-  _pimpl->start(shared_from_this());
+  _pimpl->start(shared_from_this(), {});
+}
+
+void Server::Start(ServerHandoff inherited)
+{
+  _pimpl->start(shared_from_this(), inherited.listen_fds);
+  _pimpl->restore(std::move(inherited.sessions));
+}
+
+ServerHandoff Server::Handoff(std::chrono::milliseconds timeout)
+{
+  return _pimpl->handoff(timeout);
 }
 
 }  // namespace core
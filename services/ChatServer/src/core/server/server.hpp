@@ -5,18 +5,28 @@
  *
  * @author     KBchulan
  * @date       2025/12/13
- * @history
+ * @history    2026/10/18 热重启时交出监听 socket 与会话，新进程以交出的状态启动
  ******************************************************************************/
 
 #ifndef SERVER_HPP
 #define SERVER_HPP
 
+#include <chrono>
 #include <core/CoreExport.hpp>
+#include <core/session/session.hpp>
 #include <memory>
+#include <vector>
 
 namespace core
 {
 
+// 热重启时旧进程交给新进程的全部内容
+struct CORE_EXPORT ServerHandoff
+{
+  std::vector<int> listen_fds;  // 按 listen 的先后顺序，即 reuseport 组内下标与 io_context 的索引
+  std::vector<SessionSnapshot> sessions;
+};
+
 class CORE_EXPORT Server : public std::enable_shared_from_this<Server>
 {
 public:
@@ -24,7 +34,16 @@ public:
   ~Server();
 
   void Start();
-  void RemoveSession(const std::string& uuid);
+
+  // 新进程：以旧进程交出的监听 socket 启动，不再绑定端口，并恢复交出的会话
+  void Start(ServerHandoff inherited);
+
+  // 旧进程：停止接入并交出监听 socket 与会话，阻塞到全部会话交出或 timeout 到期，不能在 io 线程上调用
+  // 未能在期限内交出的会话照常断开，客户端重连
+  [[nodiscard]] ServerHandoff Handoff(std::chrono::milliseconds timeout);
+
+  // 会话断开时调用，从会话表中移除并停止
+  void RemoveSession(const Session& session);
 
 private:
   struct _impl;
@@ -0,0 +1,91 @@
+#include "session_registry.hpp"
+
+#include <core/session/session.hpp>
+#include <global/Global.hpp>
+
+namespace core
+{
+
+SessionRegistry::SessionRegistry(std::size_t shard_count)
+    : _shard_count(shard_count == 0 ? 1 : shard_count), _shards(std::make_unique<Shard[]>(_shard_count))
+{
+  // 预留桶，接入风暴时不在持锁期间整体 rehash
+  for (std::size_t i = 0; i < _shard_count; ++i)
+  {
+    _shards[i]._sessions.reserve(global::server::SESSION_SHARD_RESERVE);
+  }
+}
+
+SessionRegistry::~SessionRegistry() = default;
+
+void SessionRegistry::Add(const std::shared_ptr<Session>& session)
+{
+  auto& shard = shard_of(*session);
+
+  std::lock_guard lock{shard._mutex};
+  shard._sessions[session->GetUuid()] = session;
+}
+
+std::shared_ptr<Session> SessionRegistry::Remove(const Session& session)
+{
+  auto& shard = shard_of(session);
+  std::shared_ptr<Session> removed;
+
+  {
+    std::lock_guard lock{shard._mutex};
+    if (auto iter = shard._sessions.find(session.GetUuid()); iter != shard._sessions.end())
+    {
+      removed = std::move(iter->second);
+      shard._sessions.erase(iter);
+    }
+  }
+
+  // 会话可能在这里析构，放到锁外
+  return removed;
+}
+
+std::shared_ptr<Session> SessionRegistry::Find(const std::string& uuid) const
+{
+  for (std::size_t i = 0; i < _shard_count; ++i)
+  {
+    std::lock_guard lock{_shards[i]._mutex};
+    if (auto iter = _shards[i]._sessions.find(uuid); iter != _shards[i]._sessions.end())
+    {
+      return iter->second;
+    }
+  }
+  return nullptr;
+}
+
+std::size_t SessionRegistry::Size() const
+{
+  std::size_t size = 0;
+  for (std::size_t i = 0; i < _shard_count; ++i)
+  {
+    std::lock_guard lock{_shards[i]._mutex};
+    size += _shards[i]._sessions.size();
+  }
+  return size;
+}
+
+std::vector<std::shared_ptr<Session>> SessionRegistry::Drain()
+{
+  std::vector<std::shared_ptr<Session>> sessions;
+  for (std::size_t i = 0; i < _shard_count; ++i)
+  {
+    std::lock_guard lock{_shards[i]._mutex};
+    for (auto& [uuid, session] : _shards[i]._sessions)
+    {
+      sessions.emplace_back(std::move(session));
+    }
+    _shards[i]._sessions.clear();
+  }
+  return sessions;
+}
+
+SessionRegistry::Shard& SessionRegistry::shard_of(const Session& session) const
+{
+  return _shards[session.GetIOIndex() % _shard_count];
+}
+
+}  // namespace core
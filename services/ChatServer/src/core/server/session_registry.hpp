@@ -0,0 +1,69 @@
+/******************************************************************************
+ *
+ * @file       session_registry.hpp
+ * @brief      按 io_context 分片的在线会话表
+ *
+ * @author     KBchulan
+ * @date       2026/10/18
+ * @history    替换 Server 中单把锁保护的会话表，重连风暴时各 io 线程只竞争自己的分片
+ ******************************************************************************/
+
+#ifndef SESSION_REGISTRY_HPP
+#define SESSION_REGISTRY_HPP
+
+#include <core/CoreExport.hpp>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace core
+{
+
+class Session;
+
+// 分片下标取会话所属 io_context 在 IO 池中的下标，会话的接入与断开都发生在该 io 线程上
+// 因此每把分片锁通常只被一个线程获取，只有停机与跨线程查找时才会竞争
+class CORE_EXPORT SessionRegistry
+{
+public:
+  explicit SessionRegistry(std::size_t shard_count);
+  ~SessionRegistry();
+
+  void Add(const std::shared_ptr<Session>& session);
+
+  // 返回被移除的会话，不存在时返回空
+  std::shared_ptr<Session> Remove(const Session& session);
+
+  // 按 uuid 查找，需要依次查看各个分片
+  [[nodiscard]] std::shared_ptr<Session> Find(const std::string& uuid) const;
+
+  [[nodiscard]] std::size_t Size() const;
+
+  // 取出全部会话并清空，用于停机
+  [[nodiscard]] std::vector<std::shared_ptr<Session>> Drain();
+
+  SessionRegistry(const SessionRegistry&) = delete;
+  SessionRegistry& operator=(const SessionRegistry&) = delete;
+  SessionRegistry(SessionRegistry&&) = delete;
+  SessionRegistry& operator=(SessionRegistry&&) = delete;
+
+private:
+  // 分片各占独立的缓存行，相邻分片的锁不会互相失效
+  struct alignas(64) Shard
+  {
+    mutable std::mutex _mutex;
+    std::unordered_map<std::string, std::shared_ptr<Session>> _sessions;
+  };
+
+  [[nodiscard]] Shard& shard_of(const Session& session) const;
+
+  std::size_t _shard_count;
+  std::unique_ptr<Shard[]> _shards;
+};
+
+}  // namespace core
+
+#endif  // SESSION_REGISTRY_HPP
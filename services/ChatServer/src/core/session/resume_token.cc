@@ -0,0 +1,207 @@
+#include "resume_token.hpp"
+
+#include <openssl/crypto.h>
+#include <openssl/evp.h>
+#include <openssl/hmac.h>
+
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <charconv>
+#include <chrono>
+#include <global/Global.hpp>
+#include <stdexcept>
+#include <vector>
+
+namespace core
+{
+
+namespace
+{
+
+constexpr std::string_view TOKEN_VERSION = "2";  // 令牌格式版本，签名覆盖版本号与密钥 id
+constexpr std::size_t MAX_KEY_ID_LEN = 16;       // 密钥 id 的长度上限，只允许字母、数字、'-' 与 '_'
+constexpr std::size_t MIN_SECRET_LEN = 32;       // 密钥的长度下限，与 HMAC-SHA256 的输出等长
+constexpr std::size_t MAX_UUID_LEN = 64;         // uuid 的长度上限，超出视为格式错误
+constexpr std::size_t SIGNATURE_LEN = 32;        // HMAC-SHA256 输出长度，令牌中以十六进制表示
+
+using Signature = std::array<unsigned char, SIGNATURE_LEN>;
+
+struct Key
+{
+  std::string id;
+  std::string secret;
+};
+
+// 启动阶段写入一次，之后各线程只读
+std::vector<Key>& key_ring()
+{
+  static std::vector<Key> keys;
+  return keys;
+}
+
+const Key* find_key(std::string_view id)
+{
+  auto& keys = key_ring();
+  auto iter = std::ranges::find(keys, id, &Key::id);
+  return iter == keys.end() ? nullptr : &*iter;
+}
+
+bool valid_key_id(std::string_view id)
+{
+  auto allowed = [](char ch) { return std::isalnum(static_cast<unsigned char>(ch)) != 0 || ch == '-' || ch == '_'; };
+  return !id.empty() && id.size() <= MAX_KEY_ID_LEN && std::ranges::all_of(id, allowed);
+}
+
+std::int64_t now_seconds()
+{
+  return std::chrono::duration_cast<std::chrono::seconds>(std::chrono::system_clock::now().time_since_epoch())
+      .count();
+}
+
+Signature sign(const Key& key, std::string_view payload)
+{
+  Signature signature{};
+  unsigned int len = 0;
+  HMAC(EVP_sha256(), key.secret.data(), static_cast<int>(key.secret.size()),
+       reinterpret_cast<const unsigned char*>(payload.data()), payload.size(), signature.data(), &len);
+  return signature;
+}
+
+std::string to_hex(const Signature& signature)
+{
+  constexpr std::string_view digits = "0123456789abcdef";
+  std::string hex;
+  hex.reserve(SIGNATURE_LEN * 2);
+  for (auto byte : signature)
+  {
+    hex.push_back(digits[byte >> 4U]);
+    hex.push_back(digits[byte & 0x0FU]);
+  }
+  return hex;
+}
+
+std::optional<Signature> from_hex(std::string_view hex)
+{
+  if (hex.size() != SIGNATURE_LEN * 2)
+  {
+    return std::nullopt;
+  }
+
+  Signature signature{};
+  for (std::size_t i = 0; i < SIGNATURE_LEN; ++i)
+  {
+    auto [ptr, ec] = std::from_chars(hex.data() + (i * 2), hex.data() + (i * 2) + 2, signature[i], 16);
+    if (ec != std::errc{} || ptr != hex.data() + (i * 2) + 2)
+    {
+      return std::nullopt;
+    }
+  }
+  return signature;
+}
+
+}  // namespace
+
+void ResumeToken::LoadKeys(std::string_view spec)
+{
+  std::vector<Key> keys;
+  while (!spec.empty())
+  {
+    auto entry = spec.substr(0, spec.find(','));
+    spec.remove_prefix(std::min(entry.size() + 1, spec.size()));
+
+    auto colon = entry.find(':');
+    if (colon == std::string_view::npos)
+    {
+      throw std::invalid_argument("Resume key entry must be kid:secret");
+    }
+
+    Key key{.id = std::string{entry.substr(0, colon)}, .secret = std::string{entry.substr(colon + 1)}};
+    if (!valid_key_id(key.id))
+    {
+      throw std::invalid_argument("Invalid resume key id '" + key.id + "'");
+    }
+    if (key.secret.size() < MIN_SECRET_LEN)
+    {
+      throw std::invalid_argument("Resume key '" + key.id + "' is shorter than " + std::to_string(MIN_SECRET_LEN) +
+                                  " bytes");
+    }
+    if (std::ranges::find(keys, key.id, &Key::id) != keys.end())
+    {
+      throw std::invalid_argument("Duplicate resume key id '" + key.id + "'");
+    }
+    keys.emplace_back(std::move(key));
+  }
+
+  if (keys.empty())
+  {
+    throw std::invalid_argument("No resume key configured");
+  }
+  key_ring() = std::move(keys);
+}
+
+std::string ResumeToken::Issue(const std::string& uuid)
+{
+  return Issue(uuid, now_seconds());
+}
+
+std::string ResumeToken::Issue(const std::string& uuid, std::int64_t now)
+{
+  if (key_ring().empty())
+  {
+    return {};
+  }
+
+  const auto& key = key_ring().front();
+  auto payload = std::string{TOKEN_VERSION} + "." + key.id + "." + uuid + "." +
+                 std::to_string(now + global::server::RESUME_TOKEN_TTL_S);
+  return payload + "." + to_hex(sign(key, payload));
+}
+
+std::optional<ResumeClaims> ResumeToken::Verify(std::string_view token)
+{
+  return Verify(token, now_seconds());
+}
+
+std::optional<ResumeClaims> ResumeToken::Verify(std::string_view token, std::int64_t now)
+{
+  // 版本.密钥 id.uuid.过期时刻 为签名的内容，uuid 取第二个与最后一个 '.' 之间的部分
+  auto sig_pos = token.rfind('.');
+  if (sig_pos == std::string_view::npos)
+  {
+    return std::nullopt;
+  }
+  auto payload = token.substr(0, sig_pos);
+  auto signature = from_hex(token.substr(sig_pos + 1));
+
+  auto kid_pos = payload.find('.');
+  auto uuid_pos = kid_pos == std::string_view::npos ? kid_pos : payload.find('.', kid_pos + 1);
+  auto expire_pos = payload.rfind('.');
+  if (!signature.has_value() || uuid_pos == std::string_view::npos || uuid_pos == expire_pos ||
+      payload.substr(0, kid_pos) != TOKEN_VERSION)
+  {
+    return std::nullopt;
+  }
+
+  // 未知的密钥 id 说明令牌来自已撤下的密钥或伪造，不再计算签名
+  const auto* key = find_key(payload.substr(kid_pos + 1, uuid_pos - kid_pos - 1));
+  auto uuid = payload.substr(uuid_pos + 1, expire_pos - uuid_pos - 1);
+  auto expires = payload.substr(expire_pos + 1);
+  std::int64_t expires_at = 0;
+  auto [ptr, ec] = std::from_chars(expires.data(), expires.data() + expires.size(), expires_at);
+  if (key == nullptr || uuid.empty() || uuid.size() > MAX_UUID_LEN || ec != std::errc{} ||
+      ptr != expires.data() + expires.size())
+  {
+    return std::nullopt;
+  }
+
+  // 先校验签名再判断过期，比较不因前缀相同而提前返回
+  auto expected = sign(*key, payload);
+  if (CRYPTO_memcmp(expected.data(), signature->data(), SIGNATURE_LEN) != 0 || expires_at <= now)
+  {
+    return std::nullopt;
+  }
+  return ResumeClaims{.uuid = std::string{uuid}, .expires_at = expires_at};
+}
+
+}  // namespace core
@@ -0,0 +1,51 @@
+/******************************************************************************
+ *
+ * @file       resume_token.hpp
+ * @brief      断线恢复令牌的签发与校验
+ *
+ * @author     KBchulan
+ * @date       2026/10/18
+ * @history    登录成功时签发带过期时间的 HMAC-SHA256 令牌，断线重连时在本地校验，
+ *             不经过 GateWay 的密码校验与 StatusServer 的登录校验
+ *             2026/10/18 密钥改为启动时从环境变量加载的密钥环，令牌携带密钥 id，支持轮换
+ ******************************************************************************/
+
+#ifndef RESUME_TOKEN_HPP
+#define RESUME_TOKEN_HPP
+
+#include <core/CoreExport.hpp>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+
+namespace core
+{
+
+struct CORE_EXPORT ResumeClaims
+{
+  std::string uuid;         // 签发时登录的用户
+  std::int64_t expires_at;  // 过期时刻，秒级时间戳
+};
+
+// 令牌为 "版本.密钥 id.uuid.过期时刻.签名"，以密钥环中的第一个密钥签名，校验时按密钥 id 选择密钥，
+// 各 ChatServer 加载相同的密钥环即可互相校验；令牌本身不可撤销，退出登录后由 user_info: 哈希的删除拒绝恢复
+class CORE_EXPORT ResumeToken
+{
+public:
+  // 在启动阶段调用，spec 为 "kid:secret[,kid:secret]..."：第一个密钥签发新令牌，其余只校验轮换前签发的令牌；
+  // 格式错误、密钥 id 重复或密钥过短时抛出 std::invalid_argument，异常信息中不含密钥
+  static void LoadKeys(std::string_view spec);
+
+  // 以当前时间签发，有效期 RESUME_TOKEN_TTL_S；尚未加载密钥时返回空串，客户端视为不支持恢复
+  [[nodiscard]] static std::string Issue(const std::string& uuid);
+  [[nodiscard]] static std::string Issue(const std::string& uuid, std::int64_t now);
+
+  // 格式错误、密钥 id 未知、签名不符或已过期时返回空
+  [[nodiscard]] static std::optional<ResumeClaims> Verify(std::string_view token);
+  [[nodiscard]] static std::optional<ResumeClaims> Verify(std::string_view token, std::int64_t now);
+};
+
+}  // namespace core
+
+#endif  // RESUME_TOKEN_HPP
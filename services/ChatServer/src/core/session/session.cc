@@ -1,117 +1,628 @@
 #include "session.hpp"
 
+#include <algorithm>
 #include <array>
 #include <atomic>
 #include <boost/asio/awaitable.hpp>
+#include <boost/asio/buffer.hpp>
 #include <boost/asio/co_spawn.hpp>
 #include <boost/asio/detached.hpp>
+#include <boost/asio/post.hpp>
 #include <boost/asio/read.hpp>
 #include <boost/asio/redirect_error.hpp>
 #include <boost/asio/steady_timer.hpp>
 #include <boost/asio/use_awaitable.hpp>
 #include <boost/asio/write.hpp>
+#include <chrono>
+#include <core/io/io.hpp>
+#include <core/io/recv_slab.hpp>
 #include <core/logic/logic.hpp>
+#include <core/msg-node/frame-compressor.hpp>
 #include <core/msg-node/msg-node.hpp>
 #include <core/server/server.hpp>
+#include <core/timer/timing-wheel.hpp>
+#include <cstdint>
+#include <cstring>
 #include <global/Global.hpp>
-#include <global/SuperQueue.hpp>
+#include <global/MpscQueue.hpp>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <string>
 #include <tools/Id.hpp>
 #include <tools/Logger.hpp>
+#include <utility>
+#include <vector>
 
 namespace core
 {
 
-struct Session::_impl
+namespace
+{
+
+// 全部会话共享的合并写统计，每批次只累加一次
+struct alignas(64) WriteCounters
+{
+  std::atomic<std::uint64_t> _writes{0};
+  std::atomic<std::uint64_t> _frames{0};
+  std::atomic<std::uint64_t> _bytes{0};
+};
+
+WriteCounters g_write_counters;
+
+// 全部会话共享的慢消费者统计，只在越过水位或丢弃时累加
+struct alignas(64) BackpressureCounters
+{
+  std::atomic<std::uint64_t> _stalled_sessions{0};
+  std::atomic<std::uint64_t> _stall_events{0};
+  std::atomic<std::uint64_t> _frames_dropped{0};
+  std::atomic<std::uint64_t> _bytes_dropped{0};
+  std::atomic<std::uint64_t> _frames_spilled{0};
+  std::atomic<std::uint64_t> _disconnects{0};
+};
+
+BackpressureCounters g_backpressure_counters;
+
+Session::SpillHandler g_spill_handler;
+
+// 帧在发送队列中占用的字节数，大帧的消息体在分块中
+std::size_t frame_size(const SendNode& msg)
+{
+  auto size = msg.GetData().size();
+  for (auto chunk : msg.GetChunks())
+  {
+    size += chunk.size();
+  }
+  return size;
+}
+
+bool is_control(const SendNode& msg)
+{
+  auto raw_id = static_cast<std::uint16_t>(static_cast<std::uint16_t>(msg.GetMsgId()) &
+                                           static_cast<std::uint16_t>(~global::server::MSG_COMPRESSED_FLAG));
+  return utils::IsControlMessage(static_cast<std::int16_t>(raw_id));
+}
+
+// 最高位为压缩标记，消息体照常读入 RecvNode 后再解压
+struct FrameHead
+{
+  short msg_id;
+  std::uint16_t msg_len;
+  bool compressed;
+};
+
+FrameHead decode_head(const char* data)
+{
+  using namespace global::server;
+
+  std::uint16_t raw_id = 0;
+  std::uint16_t msg_len = 0;
+  std::memcpy(&raw_id, data, MSG_TYPE_LENGTH);
+  std::memcpy(&msg_len, data + MSG_TYPE_LENGTH, MSG_LEN_LENGTH);
+
+  raw_id = boost::asio::detail::socket_ops::network_to_host_short(raw_id);
+  return {.msg_id = static_cast<short>(raw_id & static_cast<std::uint16_t>(~MSG_COMPRESSED_FLAG)),
+          .msg_len = boost::asio::detail::socket_ops::network_to_host_short(msg_len),
+          .compressed = (raw_id & MSG_COMPRESSED_FLAG) != 0};
+}
+
+std::uint32_t decode_ext_len(const char* data)
+{
+  std::uint32_t body_len = 0;
+  std::memcpy(&body_len, data, global::server::MSG_EXT_LEN_LENGTH);
+  return boost::asio::detail::socket_ops::network_to_host_long(body_len);
+}
+
+}  // namespace
+
+// 会话自身即为时间轮节点，接入空闲检测不额外分配内存
+struct Session::_impl final : TimingWheel::Node
 {
   std::atomic<bool> _closed;
   boost::asio::ip::tcp::socket _socket;
 
-  // 用于发送的结构
-  global::SuperQueue<std::shared_ptr<SendNode>, global::server::SEND_QUEUE_CAPACITY> _send_queue;
-  boost::asio::steady_timer _send_notify_timer;
+  // 用于发送的结构，队列按需分配节点，空闲会话不占用额外内存
+  // 控制帧与普通帧各一个队列，写协程先取控制帧；入队无锁，出队由写协程与按策略丢弃的生产者共用 _pop_mutex
+  // _write_armed 为 true 表示已有写协程负责清空队列，Send 只在空闲到忙碌的跳变时投递一次
+  global::MpscQueue<std::shared_ptr<SendNode>> _control_queue;
+  global::MpscQueue<std::shared_ptr<SendNode>> _send_queue;
+  std::mutex _pop_mutex;
+  std::atomic<bool> _write_armed;
+
+  // 两个队列合计排队的帧数与字节数，入队前增加，取出或丢弃后减少，因此不会出现负数
+  std::atomic<std::size_t> _queued_frames;
+  std::atomic<std::size_t> _queued_bytes;
+  std::atomic<bool> _stalled;
+
+  // 发送水位与慢消费者策略，生产者入队时读取
+  std::atomic<std::size_t> _high_bytes;
+  std::atomic<std::size_t> _low_bytes;
+  std::atomic<std::size_t> _high_frames;
+  std::atomic<std::size_t> _low_frames;
+  std::atomic<SlowConsumerPolicy> _policy;
 
-  // 用于接收的结构
-  std::array<char, global::server::RECV_BUFFER_SIZE> _recv_buffer;
+  // 用于接收的结构，只常驻消息头，消息体直接读入 RecvNode
+  std::array<char, global::server::MSG_HEAD_TOTAL_LEN> _recv_head;
+  std::array<char, global::server::MSG_EXT_LEN_LENGTH> _recv_ext_len;
 
   std::string _uuid;
   std::weak_ptr<Server> _server;
+  std::size_t _io_index;
+
+  // 绑定的用户 id，逻辑线程写入，断开时在 io 线程读取
+  mutable std::mutex _user_mutex;
+  std::string _user_id;
+
+  // 协商出的消息体编码，由逻辑线程写入，发送方可能在其他线程读取
+  std::atomic<utils::WireProtocol> _protocol;
+  std::atomic<CompressionMode> _compression;
+
+  // 所属 io_context 的时间轮，只在 io 线程上访问；为空时不做空闲检测
+  std::shared_ptr<TimingWheel> _idle_wheel;
+
+  // 热重启交接，只在 io 线程上访问：_parked 表示读协程停在帧边界等待数据，_handoff_ready 表示读协程已为交接退出
+  // _pending_in 与 _pending_out 在旧进程中是截取的状态，在新进程中是 Resume 带来、Start 时先消费的状态
+  bool _detaching = false;
+  bool _parked = false;
+  bool _handoff_ready = false;
+  DetachHandler _on_detached;
+  std::string _pending_in;
+  std::string _pending_out;
+
+  // finish_detach 等待写协程退出时挂在这里的定时器，写协程退出时取消它，不必轮询 _write_armed
+  boost::asio::steady_timer* _drain_waiter = nullptr;
 
   boost::asio::awaitable<void> read_loop(Ptr self)
+  {
+    // 热重启恢复的会话先用上旧进程已读到的半个消息头
+    std::size_t got = _pending_in.size();
+    std::memcpy(_recv_head.data(), _pending_in.data(), got);
+    _pending_in.clear();
+
+    while (!_closed.load(std::memory_order_acquire))
+    {
+      if (!co_await read_frame(self, std::exchange(got, 0)))
+      {
+        co_return;
+      }
+    }
+  }
+
+  // 逐帧读取一帧，_recv_head 中已有 got 字节的消息头；返回 false 表示读协程应当退出
+  boost::asio::awaitable<bool> read_frame(const Ptr& self, std::size_t got)
+  {
+    // 消息头以 read_some 累积读入，停在帧边界时已读到的字节数是确定的，热重启可以原样交出
+    while (got < static_cast<std::size_t>(global::server::MSG_HEAD_TOTAL_LEN))
+    {
+      auto bytes = co_await read_at_boundary({_recv_head.data(), got},
+                                             boost::asio::buffer(_recv_head.data() + got, _recv_head.size() - got));
+      if (bytes == 0)
+      {
+        co_return false;
+      }
+      got += bytes;
+    }
+
+    // 收到任何帧都说明连接仍然存活，只改写到期刻度
+    if (_idle_wheel)
+    {
+      _idle_wheel->Touch(*this);
+    }
+
+    auto head = decode_head(_recv_head.data());
+    if (head.msg_len == global::server::MSG_EXT_LEN_MARKER)
+    {
+      co_await boost::asio::async_read(_socket, boost::asio::buffer(_recv_ext_len), boost::asio::use_awaitable);
+      co_return co_await read_chunked(self, head, decode_ext_len(_recv_ext_len.data()), {});
+    }
+
+    co_return co_await read_body(self, head, {});
+  }
+
+  // 使用接收槽的读循环：每次把尽量多的字节读入槽中，消息头与小消息体通常一次读齐，连续到达的多帧也只需一次读取；
+  // 槽中已有的部分拷贝进 RecvNode，剩余部分照常直接读入节点。io_uring 后端下槽位于注册缓冲区上
+  // 槽只在读取进行中租用：帧边界上没有未消费的字节时先归还，等到 socket 可读再租，空闲的会话不占用槽
+  boost::asio::awaitable<void> read_loop_staged(Ptr self, RecvSlab& slab)
   {
     using namespace global::server;
 
+    RecvSlab::Lease lease;
+    char* base = nullptr;
+    std::size_t begin = 0;
+    std::size_t end = 0;
+
+    auto acquire = [&]()
+    {
+      lease = slab.Acquire();
+      base = lease ? static_cast<char*>(lease.GetBuffer().data()) : nullptr;
+      return static_cast<bool>(lease);
+    };
+
+    // 热重启恢复的会话先用上旧进程已读到的半个消息头，此时槽用尽则整条连接退回逐帧读取
+    if (!_pending_in.empty())
+    {
+      if (!acquire())
+      {
+        co_await read_loop(self);
+        co_return;
+      }
+      end = _pending_in.size();
+      std::memcpy(base, _pending_in.data(), end);
+      _pending_in.clear();
+    }
+
+    // 把未消费的字节移到槽首
+    auto compact = [&]()
+    {
+      if (begin > 0)
+      {
+        std::memmove(base, base + begin, end - begin);
+        end -= begin;
+        begin = 0;
+      }
+    };
+
+    // 帧中间的读取，再读一次到槽尾
+    auto fill = [&]() -> boost::asio::awaitable<void>
+    {
+      compact();
+      end += co_await _socket.async_read_some(lease.GetBuffer() + end, boost::asio::use_awaitable);
+    };
+
+    auto take = [&](std::size_t limit)
+    {
+      std::span<const char> staged(base + begin, std::min(end - begin, limit));
+      begin += staged.size();
+      return staged;
+    };
+
     while (!_closed.load(std::memory_order_acquire))
     {
-      co_await boost::asio::async_read(_socket, boost::asio::buffer(_recv_buffer.data(), MSG_HEAD_TOTAL_LEN),
-                                       boost::asio::use_awaitable);
+      if (begin == end)
+      {
+        lease = RecvSlab::Lease{};
+        begin = 0;
+        end = 0;
+        if (!co_await wait_at_boundary())
+        {
+          co_return;
+        }
+
+        // 槽用尽时这一帧退回逐帧读取，下一帧再尝试租用
+        if (!acquire())
+        {
+          if (!co_await read_frame(self, 0))
+          {
+            co_return;
+          }
+          continue;
+        }
+      }
+
+      while (end - begin < MSG_HEAD_TOTAL_LEN)
+      {
+        compact();
+        auto bytes = co_await read_at_boundary({base, end}, lease.GetBuffer() + end);
+        if (bytes == 0)
+        {
+          co_return;
+        }
+        end += bytes;
+      }
 
-      short msg_id = 0;
-      short msg_len = 0;
+      if (_idle_wheel)
+      {
+        _idle_wheel->Touch(*this);
+      }
+
+      auto head = decode_head(base + begin);
+      begin += MSG_HEAD_TOTAL_LEN;
 
-      std::memcpy(&msg_id, _recv_buffer.data(), MSG_TYPE_LENGTH);
-      std::memcpy(&msg_len, _recv_buffer.data() + MSG_TYPE_LENGTH, MSG_LEN_LENGTH);
+      if (head.msg_len == MSG_EXT_LEN_MARKER)
+      {
+        while (end - begin < static_cast<std::size_t>(MSG_EXT_LEN_LENGTH))
+        {
+          co_await fill();
+        }
+        auto body_len = decode_ext_len(base + begin);
+        begin += MSG_EXT_LEN_LENGTH;
 
-      msg_id = static_cast<short>(
-          boost::asio::detail::socket_ops::network_to_host_short(static_cast<unsigned short>(msg_id)));
-      msg_len = static_cast<short>(
-          boost::asio::detail::socket_ops::network_to_host_short(static_cast<unsigned short>(msg_len)));
+        if (!co_await read_chunked(self, head, body_len, take(body_len)))
+        {
+          co_return;
+        }
+        continue;
+      }
 
-      if (msg_len <= 0 || static_cast<std::size_t>(msg_len) > RECV_BUFFER_SIZE)
+      if (!co_await read_body(self, head, take(head.msg_len)))
       {
-        tools::Logger::getInstance().error("Session received invalid msg_len: {}", msg_len);
         co_return;
       }
+    }
+  }
+
+  // 帧边界上没有已读到的字节时只等待 socket 可读，不占用缓冲区；与 read_at_boundary 一样响应热重启交接
+  boost::asio::awaitable<bool> wait_at_boundary()
+  {
+    if (!_detaching)
+    {
+      _parked = true;
+      try
+      {
+        co_await _socket.async_wait(boost::asio::ip::tcp::socket::wait_read, boost::asio::use_awaitable);
+        _parked = false;
+        co_return true;
+      }
+      catch (const boost::system::system_error& errc)
+      {
+        _parked = false;
+        if (errc.code() != boost::asio::error::operation_aborted || !_detaching)
+        {
+          throw;
+        }
+      }
+    }
+
+    _pending_in.clear();
+    _handoff_ready = true;
+    co_return false;
+  }
+
+  // 在帧边界处读取一次，staged 为此前已读到的不足一个消息头的字节；读协程停在这里时 _parked 为 true
+  // 已请求热重启交接时不再读取或取消这次读取，staged 原样留给新进程，返回 0 表示读协程应当退出
+  template <typename Buffer>
+  boost::asio::awaitable<std::size_t> read_at_boundary(std::span<const char> staged, const Buffer& free_space)
+  {
+    if (!_detaching)
+    {
+      _parked = true;
+      try
+      {
+        auto bytes = co_await _socket.async_read_some(free_space, boost::asio::use_awaitable);
+        _parked = false;
+        co_return bytes;
+      }
+      catch (const boost::system::system_error& errc)
+      {
+        _parked = false;
+        if (errc.code() != boost::asio::error::operation_aborted || !_detaching)
+        {
+          throw;
+        }
+      }
+    }
+
+    _pending_in.assign(staged.begin(), staged.end());
+    _handoff_ready = true;
+    co_return 0;
+  }
 
-      co_await boost::asio::async_read(_socket,
-                                       boost::asio::buffer(_recv_buffer.data(), static_cast<std::size_t>(msg_len)),
+  // 普通帧的消息体，staged 为已经读到的开头部分；只有心跳允许空消息体，回包同样为空
+  boost::asio::awaitable<bool> read_body(const Ptr& self, const FrameHead& head, std::span<const char> staged)
+  {
+    if ((head.msg_len == 0 && head.msg_id != utils::ID_HEARTBEAT) || head.msg_len > global::server::RECV_BUFFER_SIZE)
+    {
+      tools::Logger::getInstance().error("Session received invalid msg_len: {}", head.msg_len);
+      co_return false;
+    }
+
+    auto recv_node = RecvNode::Create(head.msg_id, static_cast<short>(head.msg_len));
+    auto body = recv_node->GetBuffer();
+    std::memcpy(body.data(), staged.data(), staged.size());
+    if (auto rest = body.subspan(staged.size()); !rest.empty())
+    {
+      co_await boost::asio::async_read(_socket, boost::asio::buffer(rest.data(), rest.size()),
                                        boost::asio::use_awaitable);
+    }
+
+    co_return co_await deliver(self, recv_node, head.compressed);
+  }
+
+  // 大帧在消息头后再跟 4 字节长度，消息体以分散读直接写入池化分块，不做整块分配
+  boost::asio::awaitable<bool> read_chunked(const Ptr& self, const FrameHead& head, std::uint32_t body_len,
+                                            std::span<const char> staged)
+  {
+    if (body_len == 0 || body_len > global::server::MAX_LARGE_FRAME_SIZE)
+    {
+      tools::Logger::getInstance().error("Session received invalid large frame length: {}", body_len);
+      co_return false;
+    }
 
-      auto recv_node = std::make_shared<RecvNode>(
-          msg_id, std::span<const char>(_recv_buffer.data(), static_cast<std::size_t>(msg_len)));
-      Logic::GetInstance().PostToLogic(self, recv_node);
+    auto recv_node = RecvNode::CreateChunked(head.msg_id, body_len);
+
+    std::vector<boost::asio::mutable_buffer> buffers;
+    buffers.reserve(recv_node->GetChunks().size());
+    for (auto chunk : recv_node->GetChunks())
+    {
+      auto copied = std::min(chunk.size(), staged.size());
+      std::memcpy(chunk.data(), staged.data(), copied);
+      staged = staged.subspan(copied);
+      if (copied < chunk.size())
+      {
+        buffers.emplace_back(chunk.data() + copied, chunk.size() - copied);
+      }
+    }
+    if (!buffers.empty())
+    {
+      co_await boost::asio::async_read(_socket, buffers, boost::asio::use_awaitable);
+    }
+
+    co_return co_await deliver(self, recv_node, head.compressed);
+  }
+
+  // 压缩帧在 io 线程上解压成新的 RecvNode 再交给逻辑线程，未协商压缩或数据非法时关闭会话
+  boost::asio::awaitable<bool> deliver(const Ptr& self, std::shared_ptr<RecvNode> recv_node, bool compressed)
+  {
+    if (compressed)
+    {
+      recv_node = FrameCompressor::GetInstance().Decompress(*recv_node, _compression.load(std::memory_order_acquire));
+      if (!recv_node)
+      {
+        tools::Logger::getInstance().error("Session {} received invalid compressed frame", _uuid);
+        co_return false;
+      }
+    }
+
+    // 心跳在 io 线程上直接回包，不经过逻辑线程；超过普通帧长度的心跳只刷新空闲计时
+    if (recv_node->GetMsgId() == utils::ID_HEARTBEAT)
+    {
+      if (recv_node->GetChunks().empty())
+      {
+        send(self, FrameCompressor::GetInstance().MakeSendNode(utils::ID_HEARTBEAT_RESPONSE, recv_node->GetBuffer(),
+                                                               _compression.load(std::memory_order_acquire)));
+      }
+      co_return true;
+    }
+
+    // 逻辑线程积压满时不丢弃消息，暂停读取该会话，由 TCP 接收窗口把压力传回客户端
+    if (Logic::GetInstance().PostToLogic(self, recv_node))
+    {
+      co_return true;
     }
+
+    tools::Logger::getInstance().warning("Logic queue full, pausing reads of session {}", _uuid);
+    boost::asio::steady_timer retry(_socket.get_executor());
+    do
+    {
+      retry.expires_after(std::chrono::milliseconds(global::server::LOGIC_QUEUE_RETRY_MS));
+      co_await retry.async_wait(boost::asio::use_awaitable);
+      if (_closed.load(std::memory_order_acquire))
+      {
+        co_return false;
+      }
+    } while (!Logic::GetInstance().PostToLogic(self, recv_node));
+    co_return true;
   }
 
-  boost::asio::awaitable<void> write_loop([[maybe_unused]] Ptr self)
+  // 写协程按需启动，队列清空后退出，不常驻也不依赖定时器唤醒
+  boost::asio::awaitable<void> write_loop(Ptr self)
   {
     using namespace global::server;
 
+    std::vector<std::shared_ptr<SendNode>> batch;
+    std::vector<boost::asio::const_buffer> buffers;
+
+    // 无论清空队列退出还是写出出错，都唤醒等待写出完成的热重启交接，由它复查 _write_armed
+    struct ExitNotifier
+    {
+      _impl& _owner;
+
+      ~ExitNotifier()
+      {
+        _owner.wake_drain_waiter();
+      }
+    } notifier{*this};
+
     while (!_closed.load(std::memory_order_acquire))
     {
-      std::shared_ptr<SendNode> msg;
+      // 把队列中已有的消息一起取出，控制帧在前，合并为一次 writev，大帧的消息头与各个分块各占一个 iovec
+      std::size_t batch_bytes = 0;
+      {
+        std::lock_guard lock{_pop_mutex};
+
+        std::shared_ptr<SendNode> msg;
+        while (buffers.size() < WRITE_BATCH_MAX_FRAMES && batch_bytes < WRITE_BATCH_MAX_BYTES &&
+               (_control_queue.pop(msg) || _send_queue.pop(msg)))
+        {
+          auto data = msg->GetData();
+          batch_bytes += data.size();
+          buffers.emplace_back(data.data(), data.size());
+          for (auto chunk : msg->GetChunks())
+          {
+            batch_bytes += chunk.size();
+            buffers.emplace_back(chunk.data(), chunk.size());
+          }
+          batch.emplace_back(std::move(msg));
+        }
+      }
 
-      // 如果队列中没有消息，启动一个定时器
-      while (!_send_queue.pop(msg))
+      if (batch.empty())
       {
-        if (_closed.load(std::memory_order_acquire))
+        // 先解除武装再复查队列，与 Send 中的 fence 配对，保证入队的消息要么被这里看到，要么由 Send 重新启动写协程
+        _write_armed.store(false, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+
+        if ((_control_queue.empty() && _send_queue.empty()) || _write_armed.exchange(true, std::memory_order_acq_rel))
         {
           co_return;
         }
+        continue;
+      }
+
+      _queued_frames.fetch_sub(batch.size(), std::memory_order_relaxed);
+      _queued_bytes.fetch_sub(batch_bytes, std::memory_order_relaxed);
 
-        _send_notify_timer.expires_after(std::chrono::seconds(SEND_EXPIRE_TIME_S));
-        boost::system::error_code errc;
-        co_await _send_notify_timer.async_wait(boost::asio::redirect_error(boost::asio::use_awaitable, errc));
+      try
+      {
+        co_await boost::asio::async_write(_socket, buffers, boost::asio::use_awaitable);
+      }
+      catch (const boost::system::system_error& errc)
+      {
+        // 解除武装后关闭会话，读协程随之出错并从会话表中移除；本端已关闭时写出被取消，不必再打印
+        if (!_closed.load(std::memory_order_acquire))
+        {
+          tools::Logger::getInstance().error("Session {} write error: {}", _uuid, errc.what());
+        }
+        _write_armed.store(false, std::memory_order_release);
+        stop(self);
+        co_return;
       }
 
-      auto data = msg->GetData();
-      co_await boost::asio::async_write(_socket, boost::asio::buffer(data.data(), data.size()),
-                                        boost::asio::use_awaitable);
+      g_write_counters._writes.fetch_add(1, std::memory_order_relaxed);
+      g_write_counters._frames.fetch_add(batch.size(), std::memory_order_relaxed);
+      g_write_counters._bytes.fetch_add(batch_bytes, std::memory_order_relaxed);
+
+      buffers.clear();
+      batch.clear();
+
+      // 写出完成说明客户端恢复读取，排队回落到低水位以下时解除拥塞
+      if (_stalled.load(std::memory_order_relaxed) &&
+          _queued_frames.load(std::memory_order_relaxed) <= _low_frames.load(std::memory_order_relaxed) &&
+          _queued_bytes.load(std::memory_order_relaxed) <= _low_bytes.load(std::memory_order_relaxed) &&
+          _stalled.exchange(false, std::memory_order_acq_rel))
+      {
+        g_backpressure_counters._stalled_sessions.fetch_sub(1, std::memory_order_relaxed);
+        tools::Logger::getInstance().info("Session {} send queue drained below low watermark", _uuid);
+      }
     }
+
+    // 会话已关闭，Send 不再入队，解除武装让热重启交接不必等到截止时刻
+    _write_armed.store(false, std::memory_order_release);
   }
 
-  void start(const Ptr& self)
+  void start(const Ptr& self, std::shared_ptr<TimingWheel> idle_wheel)
   {
+    _idle_wheel = std::move(idle_wheel);
+
+    // 旧进程交出时尚未写出的帧先于任何新消息写出，写协程在此期间保持武装，Send 只入队
+    if (!_pending_out.empty())
+    {
+      _write_armed.store(true, std::memory_order_release);
+      boost::asio::co_spawn(_socket.get_executor(), write_pending(self), boost::asio::detached);
+    }
+
     boost::asio::co_spawn(
         _socket.get_executor(),
         [self, this]() -> boost::asio::awaitable<void>
         {
           const auto& logger = tools::Logger::getInstance();
 
+          if (_idle_wheel)
+          {
+            _idle_wheel->Add(*this, std::chrono::seconds(global::server::SESSION_IDLE_TIMEOUT_S));
+          }
+
           try
           {
-            // 启动读写协程
-            boost::asio::co_spawn(_socket.get_executor(), self->_pimpl->write_loop(self), boost::asio::detached);
-            co_await self->_pimpl->read_loop(self);
+            // 启动读协程，写协程由 Send 按需启动；没有接收槽时逐帧读取消息头与消息体
+            if (auto* slab = IO::GetInstance().FindRecvSlab(_socket.get_executor().context()); slab != nullptr)
+            {
+              co_await self->_pimpl->read_loop_staged(self, *slab);
+            }
+            else
+            {
+              co_await self->_pimpl->read_loop(self);
+            }
           }
           catch (const boost::system::system_error& errc)
           {
@@ -119,78 +630,440 @@ struct Session::_impl
             {
               logger.debug("Client {} disconnected", _uuid);
             }
+            else if (_closed.load(std::memory_order_acquire))
+            {
+              // 本端调用了 Stop 或空闲超时，读操作被取消
+              logger.debug("Session {} read cancelled", _uuid);
+            }
             else
             {
               logger.error("Session {} network error: {} ({})", _uuid, errc.what(), errc.code().message());
             }
           }
 
+          if (_idle_wheel)
+          {
+            _idle_wheel->Remove(*this);
+          }
+
+          if (_handoff_ready)
+          {
+            co_await finish_detach(self);
+          }
+          else if (auto handler = std::exchange(_on_detached, nullptr))
+          {
+            // 交接请求到达时会话已在断开
+            handler(std::nullopt);
+          }
+
           if (auto server = _server.lock())
           {
-            server->RemoveSession(_uuid);
+            server->RemoveSession(*self);
           }
         },
         boost::asio::detached);
   }
 
-  void stop()
+  void detach(const Ptr& self, DetachHandler on_detached)
+  {
+    boost::asio::post(_socket.get_executor(),
+                      [self, on_detached = std::move(on_detached)]() mutable
+                      {
+                        auto& impl = *self->_pimpl;
+                        if (impl._closed.load(std::memory_order_acquire) || impl._detaching)
+                        {
+                          on_detached(std::nullopt);
+                          return;
+                        }
+
+                        impl._on_detached = std::move(on_detached);
+                        impl._detaching = true;
+
+                        // 停在帧边界的读取直接取消，读到一半的帧读完后在下一个边界退出
+                        if (impl._parked)
+                        {
+                          boost::system::error_code errc;
+                          impl._socket.cancel(errc);
+                        }
+                      });
+  }
+
+  // 读协程已停在帧边界，等在途的写出完成后截取排队的帧并释放 fd；写出超时的会话照常关闭
+  boost::asio::awaitable<void> finish_detach(const Ptr& self)
+  {
+    using namespace global::server;
+
+    auto handler = std::exchange(_on_detached, nullptr);
+
+    // 定时器在截止时刻到期，写协程退出时提前取消；Send 可能又启动了新的写协程，醒来后复查
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(HOT_RESTART_WRITE_DRAIN_MS);
+    boost::asio::steady_timer drained(_socket.get_executor(), deadline);
+    _drain_waiter = &drained;
+    while (_write_armed.load(std::memory_order_acquire) && std::chrono::steady_clock::now() < deadline)
+    {
+      boost::system::error_code ignored;
+      co_await drained.async_wait(boost::asio::redirect_error(boost::asio::use_awaitable, ignored));
+    }
+    _drain_waiter = nullptr;
+
+    // 此后 Send 一律拒绝，已经越过检查的 Send 入队的帧由下面一并取出
+    _closed.store(true, std::memory_order_release);
+    if (_write_armed.load(std::memory_order_acquire) || !_socket.is_open())
+    {
+      tools::Logger::getInstance().warning("Session {} still writing, closing instead of handing off", _uuid);
+      handler(std::nullopt);
+      co_return;
+    }
+
+    SessionSnapshot snapshot{.fd = -1,
+                             .io_index = _io_index,
+                             .user_id = self->GetUserId(),
+                             .protocol = _protocol.load(std::memory_order_acquire),
+                             .compression = _compression.load(std::memory_order_acquire),
+                             .pending_in = std::move(_pending_in),
+                             .pending_out = take_queued()};
+
+    boost::system::error_code errc;
+    snapshot.fd = _socket.release(errc);
+    if (errc)
+    {
+      tools::Logger::getInstance().error("Session {} failed to release socket: {}", _uuid, errc.message());
+      handler(std::nullopt);
+      co_return;
+    }
+    handler(std::move(snapshot));
+  }
+
+  // 取出两个队列中的全部帧，按写协程的顺序拼接，控制帧在前
+  std::string take_queued()
+  {
+    std::string bytes;
+    std::lock_guard lock{_pop_mutex};
+
+    std::shared_ptr<SendNode> msg;
+    while (_control_queue.pop(msg) || _send_queue.pop(msg))
+    {
+      auto data = msg->GetData();
+      bytes.append(data.data(), data.size());
+      for (auto chunk : msg->GetChunks())
+      {
+        bytes.append(chunk.data(), chunk.size());
+      }
+      _queued_frames.fetch_sub(1, std::memory_order_relaxed);
+      _queued_bytes.fetch_sub(frame_size(*msg), std::memory_order_relaxed);
+    }
+    return bytes;
+  }
+
+  // 新进程中先写出旧进程交出的帧，再照常清空队列
+  boost::asio::awaitable<void> write_pending(Ptr self)
+  {
+    try
+    {
+      auto pending = std::move(_pending_out);
+      co_await boost::asio::async_write(_socket, boost::asio::buffer(pending), boost::asio::use_awaitable);
+    }
+    catch (const boost::system::system_error& errc)
+    {
+      // 连接出错时读协程同样会出错并移除会话
+      tools::Logger::getInstance().error("Session {} failed to write frames handed over: {}", _uuid, errc.what());
+      _write_armed.store(false, std::memory_order_release);
+      wake_drain_waiter();
+      co_return;
+    }
+    co_await write_loop(self);
+  }
+
+  // 只在 io 线程上调用，与 finish_detach 串行
+  void wake_drain_waiter()
+  {
+    if (_drain_waiter != nullptr)
+    {
+      _drain_waiter->cancel();
+    }
+  }
+
+  SendStatus send(const Ptr& self, const std::shared_ptr<SendNode>& msg)
+  {
+    // 先计数再入队，写协程取出时减去的总是已经计入的数值
+    auto bytes = frame_size(*msg);
+    auto frames = _queued_frames.fetch_add(1, std::memory_order_relaxed) + 1;
+    auto queued = _queued_bytes.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+
+    if (is_control(*msg))
+    {
+      _control_queue.emplace(msg);
+    }
+    else
+    {
+      _send_queue.emplace(msg);
+    }
+
+    auto status = SendStatus::QUEUED;
+    if (frames > _high_frames.load(std::memory_order_relaxed) || queued > _high_bytes.load(std::memory_order_relaxed))
+    {
+      status = on_congested(self);
+      if (status == SendStatus::REJECTED)
+      {
+        return status;
+      }
+    }
+
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+
+    // 只有把状态从空闲切到忙碌的那次调用才投递写协程，co_spawn 会先 post 到会话所属的 executor 上再执行
+    if (!_write_armed.exchange(true, std::memory_order_acq_rel))
+    {
+      boost::asio::co_spawn(_socket.get_executor(), write_loop(self), boost::asio::detached);
+    }
+    return status;
+  }
+
+  // 排队超过高水位，客户端读得比服务端写得慢，按策略处理较早的普通帧，控制帧始终保留
+  SendStatus on_congested(const Ptr& self)
+  {
+    if (!_stalled.exchange(true, std::memory_order_acq_rel))
+    {
+      g_backpressure_counters._stalled_sessions.fetch_add(1, std::memory_order_relaxed);
+      g_backpressure_counters._stall_events.fetch_add(1, std::memory_order_relaxed);
+      tools::Logger::getInstance().warning("Session {} send queue over high watermark: {} frames, {} bytes", _uuid,
+                                           _queued_frames.load(std::memory_order_relaxed),
+                                           _queued_bytes.load(std::memory_order_relaxed));
+    }
+
+    auto policy = _policy.load(std::memory_order_relaxed);
+    if (policy == SlowConsumerPolicy::DISCONNECT)
+    {
+      close_slow_consumer(self);
+      return SendStatus::REJECTED;
+    }
+
+    auto evicted = shed();
+    if (policy == SlowConsumerPolicy::SPILL && g_spill_handler)
+    {
+      g_backpressure_counters._frames_spilled.fetch_add(evicted.size(), std::memory_order_relaxed);
+      for (auto& msg : evicted)
+      {
+        g_spill_handler(*self, std::move(msg));
+      }
+    }
+    else
+    {
+      std::size_t bytes = 0;
+      for (const auto& msg : evicted)
+      {
+        bytes += frame_size(*msg);
+      }
+      g_backpressure_counters._frames_dropped.fetch_add(evicted.size(), std::memory_order_relaxed);
+      g_backpressure_counters._bytes_dropped.fetch_add(bytes, std::memory_order_relaxed);
+    }
+
+    // 丢弃普通帧后仍然超过帧数高水位，说明积压的是控制帧，客户端已经完全不读
+    if (_queued_frames.load(std::memory_order_relaxed) > _high_frames.load(std::memory_order_relaxed))
+    {
+      close_slow_consumer(self);
+      return SendStatus::REJECTED;
+    }
+    return SendStatus::CONGESTED;
+  }
+
+  // 从普通队列队首取出到低水位为止，最新入队的一帧总是保留，单帧超过水位的大帧仍然可以发出
+  std::vector<std::shared_ptr<SendNode>> shed()
+  {
+    auto low_frames = _low_frames.load(std::memory_order_relaxed);
+    auto low_bytes = _low_bytes.load(std::memory_order_relaxed);
+    std::vector<std::shared_ptr<SendNode>> evicted;
+
+    std::lock_guard lock{_pop_mutex};
+
+    std::shared_ptr<SendNode> msg;
+    while ((_queued_frames.load(std::memory_order_relaxed) > low_frames ||
+            _queued_bytes.load(std::memory_order_relaxed) > low_bytes) &&
+           _send_queue.size() > 1 && _send_queue.pop(msg))
+    {
+      _queued_frames.fetch_sub(1, std::memory_order_relaxed);
+      _queued_bytes.fetch_sub(frame_size(*msg), std::memory_order_relaxed);
+      evicted.emplace_back(std::move(msg));
+    }
+    return evicted;
+  }
+
+  void close_slow_consumer(const Ptr& self)
+  {
+    if (!_closed.exchange(true, std::memory_order_acq_rel))
+    {
+      g_backpressure_counters._disconnects.fetch_add(1, std::memory_order_relaxed);
+      tools::Logger::getInstance().warning("Session {} is not reading, disconnecting with {} frames queued", _uuid,
+                                           _queued_frames.load(std::memory_order_relaxed));
+    }
+    close_socket(self);
+  }
+
+  // 时间轮在 io 线程上回调，直接关闭 socket，读协程随之退出并从会话表中移除
+  void OnExpire() override
   {
+    tools::Logger::getInstance().info("Session {} idle for {}s, closing", _uuid,
+                                      global::server::SESSION_IDLE_TIMEOUT_S);
+
     _closed.store(true, std::memory_order_release);
-    _send_notify_timer.cancel();
 
     boost::system::error_code errc;
     _socket.shutdown(boost::asio::ip::tcp::socket::shutdown_both, errc);
     _socket.close(errc);
   }
 
-  _impl(boost::asio::ip::tcp::socket socket, const std::weak_ptr<Server>& server)
+  void stop(const Ptr& self)
+  {
+    _closed.store(true, std::memory_order_release);
+    close_socket(self);
+  }
+
+  // socket 只在所属 executor 上关闭，避免与读写协程跨线程竞争
+  void close_socket(const Ptr& self)
+  {
+    boost::asio::post(_socket.get_executor(),
+                      [self]()
+                      {
+                        boost::system::error_code errc;
+                        self->_pimpl->_socket.shutdown(boost::asio::ip::tcp::socket::shutdown_both, errc);
+                        self->_pimpl->_socket.close(errc);
+                      });
+  }
+
+  _impl(boost::asio::ip::tcp::socket socket, const std::weak_ptr<Server>& server, std::size_t io_index)
       : _closed(false),
         _socket(std::move(socket)),
-        _send_notify_timer(_socket.get_executor()),
-        _recv_buffer(),
+        _write_armed(false),
+        _queued_frames(0),
+        _queued_bytes(0),
+        _stalled(false),
+        _high_bytes(global::server::SEND_HIGH_WATERMARK_BYTES),
+        _low_bytes(global::server::SEND_LOW_WATERMARK_BYTES),
+        _high_frames(global::server::SEND_HIGH_WATERMARK_FRAMES),
+        _low_frames(global::server::SEND_LOW_WATERMARK_FRAMES),
+        _policy(SlowConsumerPolicy::DROP_OLDEST),
+        _recv_head(),
+        _recv_ext_len(),
         _uuid(tools::UuidGenerator::generateUuid().value()),
-        _server(server)
+        _server(server),
+        _io_index(io_index),
+        _protocol(utils::WireProtocol::JSON),
+        _compression(CompressionMode{})
   {
   }
 
-  ~_impl()
+  ~_impl() override
   {
+    // 读协程未能运行到结尾时（如 io_context 先于会话销毁）由这里摘除，正常断开时节点已经摘除
+    if (_idle_wheel)
+    {
+      _idle_wheel->Remove(*this);
+    }
+
+    if (_stalled.load(std::memory_order_relaxed))
+    {
+      g_backpressure_counters._stalled_sessions.fetch_sub(1, std::memory_order_relaxed);
+    }
+
     tools::Logger::getInstance().info("Session {} closed", _uuid);
   }
 };
 
-Session::Ptr Session::Create(boost::asio::ip::tcp::socket socket, const std::weak_ptr<Server>& server)
+Session::Ptr Session::Create(boost::asio::ip::tcp::socket socket, const std::weak_ptr<Server>& server,
+                             std::size_t io_index)
 {
-  return Ptr{new Session(std::move(socket), server)};
+  return Ptr{new Session(std::move(socket), server, io_index)};
 }
 
 Session::~Session() = default;
 
-void Session::Start()
+void Session::Start(std::shared_ptr<TimingWheel> idle_wheel)
 {
-  _pimpl->start(shared_from_this());
+  _pimpl->start(shared_from_this(), std::move(idle_wheel));
 }
 
 void Session::Stop()
 {
-  _pimpl->stop();
+  _pimpl->stop(shared_from_this());
+}
+
+void Session::Detach(DetachHandler on_detached)
+{
+  _pimpl->detach(shared_from_this(), std::move(on_detached));
+}
+
+void Session::Resume(SessionSnapshot snapshot)
+{
+  _pimpl->_protocol.store(snapshot.protocol, std::memory_order_release);
+  _pimpl->_compression.store(snapshot.compression, std::memory_order_release);
+  _pimpl->_pending_in = std::move(snapshot.pending_in);
+  _pimpl->_pending_out = std::move(snapshot.pending_out);
 }
 
-void Session::Send(const std::shared_ptr<SendNode>& msg)
+SendStatus Session::Send(const std::shared_ptr<SendNode>& msg)
 {
   if (_pimpl->_closed.load(std::memory_order_acquire))
   {
-    return;
+    return SendStatus::REJECTED;
   }
 
-  if (_pimpl->_send_queue.emplace(msg))
-  {
-    _pimpl->_send_notify_timer.cancel();
-  }
-  else
+  return _pimpl->send(shared_from_this(), msg);
+}
+
+SendStatus Session::Send(short msg_id, std::span<const char> body)
+{
+  if (_pimpl->_closed.load(std::memory_order_acquire))
   {
-    tools::Logger::getInstance().error("Session send queue is full");
+    return SendStatus::REJECTED;
   }
+
+  return _pimpl->send(shared_from_this(),
+                      FrameCompressor::GetInstance().MakeSendNode(msg_id, body, GetCompression()));
+}
+
+void Session::SetSendLimits(const SendLimits& limits)
+{
+  _pimpl->_high_bytes.store(limits.high_bytes, std::memory_order_relaxed);
+  _pimpl->_low_bytes.store(std::min(limits.low_bytes, limits.high_bytes), std::memory_order_relaxed);
+  _pimpl->_high_frames.store(limits.high_frames, std::memory_order_relaxed);
+  _pimpl->_low_frames.store(std::min(limits.low_frames, limits.high_frames), std::memory_order_relaxed);
+  _pimpl->_policy.store(limits.policy, std::memory_order_relaxed);
+}
+
+SendLimits Session::GetSendLimits() const
+{
+  return {.high_bytes = _pimpl->_high_bytes.load(std::memory_order_relaxed),
+          .low_bytes = _pimpl->_low_bytes.load(std::memory_order_relaxed),
+          .high_frames = _pimpl->_high_frames.load(std::memory_order_relaxed),
+          .low_frames = _pimpl->_low_frames.load(std::memory_order_relaxed),
+          .policy = _pimpl->_policy.load(std::memory_order_relaxed)};
+}
+
+std::size_t Session::GetQueuedBytes() const
+{
+  return _pimpl->_queued_bytes.load(std::memory_order_relaxed);
+}
+
+SessionWriteStats Session::GetWriteStats()
+{
+  return {.writes = g_write_counters._writes.load(std::memory_order_relaxed),
+          .frames = g_write_counters._frames.load(std::memory_order_relaxed),
+          .bytes = g_write_counters._bytes.load(std::memory_order_relaxed)};
+}
+
+BackpressureStats Session::GetBackpressureStats()
+{
+  return {.stalled_sessions = g_backpressure_counters._stalled_sessions.load(std::memory_order_relaxed),
+          .stall_events = g_backpressure_counters._stall_events.load(std::memory_order_relaxed),
+          .frames_dropped = g_backpressure_counters._frames_dropped.load(std::memory_order_relaxed),
+          .bytes_dropped = g_backpressure_counters._bytes_dropped.load(std::memory_order_relaxed),
+          .frames_spilled = g_backpressure_counters._frames_spilled.load(std::memory_order_relaxed),
+          .disconnects = g_backpressure_counters._disconnects.load(std::memory_order_relaxed)};
+}
+
+void Session::SetSpillHandler(SpillHandler handler)
+{
+  g_spill_handler = std::move(handler);
 }
 
 const std::string& Session::GetUuid() const
@@ -198,8 +1071,55 @@ const std::string& Session::GetUuid() const
   return _pimpl->_uuid;
 }
 
-Session::Session(boost::asio::ip::tcp::socket socket, const std::weak_ptr<Server>& server)
-    : _pimpl(std::make_unique<_impl>(std::move(socket), server))
+std::size_t Session::GetIOIndex() const
+{
+  return _pimpl->_io_index;
+}
+
+boost::asio::any_io_executor Session::GetExecutor() const
+{
+  return _pimpl->_socket.get_executor();
+}
+
+std::string Session::GetUserId() const
+{
+  std::lock_guard lock{_pimpl->_user_mutex};
+  return _pimpl->_user_id;
+}
+
+void Session::SetUserId(std::string user_id)
+{
+  std::lock_guard lock{_pimpl->_user_mutex};
+  _pimpl->_user_id = std::move(user_id);
+}
+
+bool Session::IsClosed() const
+{
+  return _pimpl->_closed.load(std::memory_order_acquire);
+}
+
+utils::WireProtocol Session::GetProtocol() const
+{
+  return _pimpl->_protocol.load(std::memory_order_acquire);
+}
+
+void Session::SetProtocol(utils::WireProtocol protocol)
+{
+  _pimpl->_protocol.store(protocol, std::memory_order_release);
+}
+
+CompressionMode Session::GetCompression() const
+{
+  return _pimpl->_compression.load(std::memory_order_acquire);
+}
+
+void Session::SetCompression(CompressionMode mode)
+{
+  _pimpl->_compression.store(mode, std::memory_order_release);
+}
+
+Session::Session(boost::asio::ip::tcp::socket socket, const std::weak_ptr<Server>& server, std::size_t io_index)
+    : _pimpl(std::make_unique<_impl>(std::move(socket), server, io_index))
 {
 }
 
@@ -5,7 +5,10 @@
  *
  * @author     KBchulan
  * @date       2025/12/13
- * @history
+ * @history    2026/10/18 接入所属 io_context 的时间轮，连续一段时间收不到任何帧时断开
+ *             2026/10/18 发送队列分为控制与普通两个通道，按水位与慢消费者策略限制排队的内存
+ *             2026/10/18 暴露所属 executor，供扇出按 io_context 合并投递
+ *             2026/10/18 新增热重启的交出与恢复，只在帧边界处截取状态
  ******************************************************************************/
 
 #ifndef SESSION_HPP
@@ -14,40 +17,163 @@
 #include <boost/asio/any_io_executor.hpp>
 #include <boost/asio/ip/tcp.hpp>
 #include <core/CoreExport.hpp>
+#include <core/msg-node/frame-compressor.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <global/Global.hpp>
 #include <memory>
+#include <optional>
+#include <span>
+#include <string>
+#include <utils/common/code.hpp>
 
 namespace core
 {
 
 class Server;
 class SendNode;
+class TimingWheel;
+
+// 发送端合并写统计，frames / writes 即平均每次系统调用发送的帧数
+struct CORE_EXPORT SessionWriteStats
+{
+  std::uint64_t writes;
+  std::uint64_t frames;
+  std::uint64_t bytes;
+};
+
+// 排队待发送的数据超过高水位时的处理方式，只作用于普通帧，控制帧不会被丢弃
+enum class SlowConsumerPolicy : std::uint8_t
+{
+  DROP_OLDEST,  // 从最早的普通帧开始丢弃，直到回落到低水位
+  DISCONNECT,   // 断开连接，客户端重连后重新同步
+  SPILL,        // 最早的普通帧交给转存回调写入离线存储，未设置回调时等同 DROP_OLDEST
+};
+
+// 单个会话的发送水位，字节数与帧数任一超过高水位即视为拥塞
+struct CORE_EXPORT SendLimits
+{
+  std::size_t high_bytes = global::server::SEND_HIGH_WATERMARK_BYTES;
+  std::size_t low_bytes = global::server::SEND_LOW_WATERMARK_BYTES;
+  std::size_t high_frames = global::server::SEND_HIGH_WATERMARK_FRAMES;
+  std::size_t low_frames = global::server::SEND_LOW_WATERMARK_FRAMES;
+  SlowConsumerPolicy policy = SlowConsumerPolicy::DROP_OLDEST;
+};
+
+// Send 的结果，调用方可以据此停止向该会话推送
+enum class SendStatus : std::uint8_t
+{
+  QUEUED,     // 已入队
+  CONGESTED,  // 已入队，但队列超过高水位，较早的普通帧已按策略丢弃或转存
+  REJECTED,   // 会话已关闭，或按策略断开，未发送
+};
+
+// 所有会话累计的慢消费者统计
+struct CORE_EXPORT BackpressureStats
+{
+  std::uint64_t stalled_sessions;  // 当前处于拥塞状态的会话数
+  std::uint64_t stall_events;      // 进入拥塞状态的累计次数
+  std::uint64_t frames_dropped;    // 按 DROP_OLDEST 丢弃的帧数
+  std::uint64_t bytes_dropped;     // 按 DROP_OLDEST 丢弃的字节数
+  std::uint64_t frames_spilled;    // 按 SPILL 交给转存回调的帧数
+  std::uint64_t disconnects;       // 按策略断开的会话数
+};
+
+// 热重启时交给新进程的会话状态，读协程停在帧边界、在途写出完成后截取，不会截断任何一帧
+struct CORE_EXPORT SessionSnapshot
+{
+  int fd;                        // 已从 asio 中释放的 socket
+  std::size_t io_index;          // 原所属 io_context 的下标
+  std::string user_id;           // 绑定的用户，未登录时为空
+  utils::WireProtocol protocol;  // 协商出的消息体编码
+  CompressionMode compression;   // 协商出的压缩方式
+  std::string pending_in;        // 已读入但不足一个消息头的字节
+  std::string pending_out;       // 排队尚未写出的帧，新进程最先写出
+};
+
 class CORE_EXPORT Session : public std::enable_shared_from_this<Session>
 {
 public:
   using Ptr = std::shared_ptr<Session>;
 
-  // 提供一个工厂方法来创建Session实例
-  [[nodiscard]] static Ptr Create(boost::asio::ip::tcp::socket socket, const std::weak_ptr<Server>& server);
+  // 在会话所属的 io 线程上调用；会话已在断开或写出迟迟不能完成时参数为空，此时会话照常关闭
+  using DetachHandler = std::function<void(std::optional<SessionSnapshot> snapshot)>;
+
+  // 转存回调在调用 Send 的线程上执行，需要自行处理并发
+  using SpillHandler = std::function<void(const Session& session, std::shared_ptr<SendNode> msg)>;
+
+  // 提供一个工厂方法来创建Session实例，io_index 为 socket 所属 io_context 在 IO 池中的下标
+  [[nodiscard]] static Ptr Create(boost::asio::ip::tcp::socket socket, const std::weak_ptr<Server>& server,
+                                  std::size_t io_index = 0);
   ~Session();
 
-  // 启动读写协程
-  void Start();
+  // 启动读写协程，idle_wheel 为所属 io_context 上的时间轮，超过 SESSION_IDLE_TIMEOUT_S 未收到任何帧时断开
+  // 不传时不做空闲检测
+  void Start(std::shared_ptr<TimingWheel> idle_wheel = nullptr);
 
   // 停止读写协程
   void Stop();
 
-  // 非阻塞发送消息
-  void Send(const std::shared_ptr<SendNode>& msg);
+  // 热重启：读协程停在帧边界后释放 fd，连同截取的状态交给 on_detached，之后会话从会话表中移除但不断开连接
+  void Detach(DetachHandler on_detached);
+
+  // 热重启：以旧进程交出的状态恢复编码、压缩方式与未处理的字节，需在 Start 之前调用，用户绑定由调用方完成
+  void Resume(SessionSnapshot snapshot);
+
+  // 非阻塞发送消息，utils::IsControlMessage 为真的消息走优先通道
+  SendStatus Send(const std::shared_ptr<SendNode>& msg);
+
+  // 按会话协商的压缩方式组帧后发送
+  SendStatus Send(short msg_id, std::span<const char> body);
+
+  // 可以随时调整，之后入队的消息按新的水位与策略处理
+  void SetSendLimits(const SendLimits& limits);
+  [[nodiscard]] SendLimits GetSendLimits() const;
+
+  // 当前排队待发送的字节数，不含正在写出的一批
+  [[nodiscard]] std::size_t GetQueuedBytes() const;
 
   [[nodiscard]] const std::string& GetUuid() const;
 
+  // 登录成功后绑定的用户 id，未登录时为空；由 UserManager 维护，跨线程读取时返回副本
+  [[nodiscard]] std::string GetUserId() const;
+  void SetUserId(std::string user_id);
+
+  // 已调用 Stop，或读写出错后已从会话表中移除
+  [[nodiscard]] bool IsClosed() const;
+
+  // 所属 io_context 的下标，会话表按它分片
+  [[nodiscard]] std::size_t GetIOIndex() const;
+
+  // socket 所属的 executor，在其上执行的任务与读写协程处于同一线程
+  [[nodiscard]] boost::asio::any_io_executor GetExecutor() const;
+
+  // 消息体编码，登录握手成功前为 JSON
+  [[nodiscard]] utils::WireProtocol GetProtocol() const;
+
+  // 登录响应入队后由逻辑线程切换，之后的消息按新编码收发
+  void SetProtocol(utils::WireProtocol protocol);
+
+  // 消息体压缩方式，登录握手成功前不压缩，切换时机与编码相同
+  [[nodiscard]] CompressionMode GetCompression() const;
+  void SetCompression(CompressionMode mode);
+
+  // 所有会话累计的发送统计
+  [[nodiscard]] static SessionWriteStats GetWriteStats();
+
+  [[nodiscard]] static BackpressureStats GetBackpressureStats();
+
+  // SPILL 策略的转存回调，所有会话共用，需要在接入连接之前设置
+  static void SetSpillHandler(SpillHandler handler);
+
   Session(const Session&) = delete;
   Session& operator=(const Session&) = delete;
   Session(Session&&) = delete;
   Session& operator=(Session&&) = delete;
 
 private:
-  Session(boost::asio::ip::tcp::socket socket, const std::weak_ptr<Server>& server);
+  Session(boost::asio::ip::tcp::socket socket, const std::weak_ptr<Server>& server, std::size_t io_index);
 
   struct _impl;
   std::unique_ptr<_impl> _pimpl;
@@ -0,0 +1,151 @@
+#include "timing-wheel.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <boost/asio/co_spawn.hpp>
+#include <boost/asio/detached.hpp>
+#include <boost/asio/use_awaitable.hpp>
+
+namespace core
+{
+
+TimingWheel::TimingWheel(boost::asio::io_context& io_context, std::chrono::milliseconds tick, std::size_t slots)
+    : _io_context(io_context),
+      _timer(io_context),
+      _tick(std::max(tick, std::chrono::milliseconds(1))),
+      _slots(std::bit_ceil(std::max<std::size_t>(slots, 2)), nullptr),
+      _mask(_slots.size() - 1),
+      _now(0),
+      _size(0),
+      _running(false)
+{
+}
+
+TimingWheel::~TimingWheel() = default;
+
+void TimingWheel::Add(Node& node, std::chrono::milliseconds timeout)
+{
+  if (node.IsLinked())
+  {
+    unlink(node);
+    --_size;
+  }
+
+  // 向上取整后再加一个刻度，加入时当前刻度已经走过一部分，这样超时只会推迟不会提前
+  auto ticks = (std::max(timeout, std::chrono::milliseconds(0)) + _tick - std::chrono::milliseconds(1)) / _tick + 1;
+  node._timeout = static_cast<std::uint32_t>(ticks);
+  node._deadline = _now + node._timeout;
+  link(node);
+  ++_size;
+
+  if (!_running)
+  {
+    _running = true;
+    boost::asio::co_spawn(_io_context, run(shared_from_this()), boost::asio::detached);
+  }
+}
+
+void TimingWheel::Remove(Node& node) noexcept
+{
+  if (!node.IsLinked())
+  {
+    return;
+  }
+
+  unlink(node);
+  --_size;
+}
+
+std::size_t TimingWheel::Advance()
+{
+  ++_now;
+
+  // 先把整条链表摘下，到期刻度与当前刻度相差整数圈的节点会挂回同一个槽位
+  auto index = _now & _mask;
+  Node* node = _slots[index];
+  _slots[index] = nullptr;
+
+  while (node != nullptr)
+  {
+    Node* next = node->_next;
+
+    if (node->_deadline <= _now)
+    {
+      node->_prev = nullptr;
+      node->_next = nullptr;
+      node->_slot = Node::UNLINKED;
+      --_size;
+      _expired.push_back(node);
+    }
+    else
+    {
+      // 期间被 Touch 过，挂到新的到期刻度所在的槽位
+      link(*node);
+    }
+
+    node = next;
+  }
+
+  auto expired = _expired.size();
+  for (auto* expired_node : _expired)
+  {
+    expired_node->OnExpire();
+  }
+  _expired.clear();
+
+  return expired;
+}
+
+void TimingWheel::link(Node& node) noexcept
+{
+  auto index = static_cast<std::uint32_t>(node._deadline & _mask);
+
+  node._slot = index;
+  node._prev = nullptr;
+  node._next = _slots[index];
+  if (node._next != nullptr)
+  {
+    node._next->_prev = &node;
+  }
+  _slots[index] = &node;
+}
+
+void TimingWheel::unlink(Node& node) noexcept
+{
+  if (node._prev != nullptr)
+  {
+    node._prev->_next = node._next;
+  }
+  else
+  {
+    _slots[node._slot] = node._next;
+  }
+
+  if (node._next != nullptr)
+  {
+    node._next->_prev = node._prev;
+  }
+
+  node._prev = nullptr;
+  node._next = nullptr;
+  node._slot = Node::UNLINKED;
+}
+
+boost::asio::awaitable<void> TimingWheel::run([[maybe_unused]] std::shared_ptr<TimingWheel> self)
+{
+  // 按绝对时间排定每个刻度，处理耗时不会累积成漂移；线程被阻塞过久时后续等待立即完成，逐格追上
+  auto next = boost::asio::steady_timer::clock_type::now();
+
+  while (_size != 0)
+  {
+    next += _tick;
+    _timer.expires_at(next);
+    co_await _timer.async_wait(boost::asio::use_awaitable);
+
+    Advance();
+  }
+
+  _running = false;
+}
+
+}  // namespace core
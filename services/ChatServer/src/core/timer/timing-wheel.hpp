@@ -0,0 +1,126 @@
+/******************************************************************************
+ *
+ * @file       timing-wheel.hpp
+ * @brief      单个 io_context 上的哈希时间轮，用于会话的空闲超时
+ *
+ * @author     KBchulan
+ * @date       2026/10/18
+ * @history    每个 io_context 一个时间轮和一个 steady_timer，代替每个会话各自的定时器
+ ******************************************************************************/
+
+#ifndef TIMING_WHEEL_HPP
+#define TIMING_WHEEL_HPP
+
+#include <boost/asio/awaitable.hpp>
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/steady_timer.hpp>
+#include <chrono>
+#include <core/CoreExport.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <vector>
+
+namespace core
+{
+
+// 节点侵入式地挂在槽位链表上，加入、刷新、移除均为 O(1) 且不分配内存
+// 刷新只改写节点的到期刻度，不移动节点；槽位到期时才把仍未超时的节点挂到新的槽位，
+// 因此频繁收到消息的会话每个超时周期只被时间轮处理一次
+// 全部接口只能在所属 io_context 的线程上调用
+class CORE_EXPORT TimingWheel : public std::enable_shared_from_this<TimingWheel>
+{
+public:
+  class CORE_EXPORT Node
+  {
+  public:
+    Node() = default;
+    virtual ~Node() = default;
+
+    [[nodiscard]] bool IsLinked() const noexcept
+    {
+      return _slot != UNLINKED;
+    }
+
+    Node(const Node&) = delete;
+    Node& operator=(const Node&) = delete;
+    Node(Node&&) = delete;
+    Node& operator=(Node&&) = delete;
+
+  protected:
+    // 超时后在 io 线程上调用，调用前节点已从时间轮摘除；不能在其中同步析构其他节点
+    virtual void OnExpire() = 0;
+
+  private:
+    friend class TimingWheel;
+
+    static constexpr std::uint32_t UNLINKED = std::numeric_limits<std::uint32_t>::max();
+
+    Node* _prev = nullptr;
+    Node* _next = nullptr;
+    std::uint64_t _deadline = 0;  // 到期时的刻度
+    std::uint32_t _timeout = 0;   // 超时时长，单位为刻度
+    std::uint32_t _slot = UNLINKED;
+  };
+
+  // slots 向上取整为 2 的幂，超时时长可以超过一圈，到期前多转几圈即可
+  TimingWheel(boost::asio::io_context& io_context, std::chrono::milliseconds tick, std::size_t slots);
+  ~TimingWheel();
+
+  // 加入后 timeout 内没有 Touch 则调用 OnExpire；节点已加入时重新设置超时时长
+  // 时间轮需由 shared_ptr 持有，由空变为非空时启动内部定时器
+  void Add(Node& node, std::chrono::milliseconds timeout);
+
+  // 从现在起重新计时
+  void Touch(Node& node) noexcept
+  {
+    node._deadline = _now + node._timeout;
+  }
+
+  // 未加入的节点直接返回
+  void Remove(Node& node) noexcept;
+
+  // 推进一个刻度并处理对应槽位，返回本次超时的节点数；平时由内部定时器调用，也可以手动驱动
+  std::size_t Advance();
+
+  [[nodiscard]] std::size_t Size() const noexcept
+  {
+    return _size;
+  }
+
+  // 单个节点占用的内存，即接入时间轮后每个会话增加的字节数
+  [[nodiscard]] static constexpr std::size_t NodeSize() noexcept
+  {
+    return sizeof(Node);
+  }
+
+  TimingWheel(const TimingWheel&) = delete;
+  TimingWheel& operator=(const TimingWheel&) = delete;
+  TimingWheel(TimingWheel&&) = delete;
+  TimingWheel& operator=(TimingWheel&&) = delete;
+
+private:
+  void link(Node& node) noexcept;
+  void unlink(Node& node) noexcept;
+
+  // 只在时间轮非空时运行，最后一个节点移除后的下一个刻度退出，空闲的 io 线程不会被定时唤醒
+  boost::asio::awaitable<void> run(std::shared_ptr<TimingWheel> self);
+
+  boost::asio::io_context& _io_context;
+  boost::asio::steady_timer _timer;
+  std::chrono::milliseconds _tick;
+
+  std::vector<Node*> _slots;
+  std::uint64_t _mask;
+  std::uint64_t _now;
+  std::size_t _size;
+  bool _running;
+
+  // 超时的节点先收集起来，全部槽位操作完成后再回调
+  std::vector<Node*> _expired;
+};
+
+}  // namespace core
+
+#endif  // TIMING_WHEEL_HPP
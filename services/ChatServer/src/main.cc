@@ -1,3 +1,7 @@
+#include <grpcpp/security/server_credentials.h>
+#include <grpcpp/server.h>
+#include <grpcpp/server_builder.h>
+
 #include <boost/asio/awaitable.hpp>
 #include <boost/asio/co_spawn.hpp>
 #include <boost/asio/detached.hpp>
@@ -6,11 +10,24 @@
 #include <boost/asio/use_awaitable.hpp>
 #include <core/io/io.hpp>
 #include <core/logic/logic.hpp>
+#include <core/manager/user_manager.hpp>
+#include <core/msg-node/frame-compressor.hpp>
+#include <core/repository/login_activity.hpp>
+#include <core/repository/message_writer.hpp>
+#include <core/repository/profile_cache.hpp>
+#include <core/server/hot_restart.hpp>
 #include <core/server/server.hpp>
+#include <core/session/resume_token.hpp>
+#include <cstdlib>
+#include <stdexcept>
 #include <tools/Cmd.hpp>
 #include <tools/Logger.hpp>
+#include <utils/grpc/client/chat_server_client.hpp>
 #include <utils/grpc/client/status_server_client.hpp>
+#include <utils/grpc/service/chat_service.hpp>
+#include <utils/pool/mariadb/async_db_pool.hpp>
 #include <utils/pool/mariadb/db_pool.hpp>
+#include <utils/pool/redis/async_redis_client.hpp>
 #include <utils/pool/redis/redis_pool.hpp>
 
 using namespace global::server;
@@ -36,6 +53,9 @@ void init_components()
                             .database = DB_NAME,
                             .pool_size = DB_MAX_POOL_SIZE};
 
+  utils::DBConfig async_db_config = db_config;
+  async_db_config.pool_size = DB_ASYNC_POOL_SIZE;
+
   utils::RedisConfig redis_config{.host = REDIS_HOST,
                                   .port = REDIS_PORT,
                                   .password = REDIS_PASSWORD,
@@ -43,21 +63,72 @@ void init_components()
                                   .pool_size = REDIS_MAX_POOL_SIZE,
                                   .timeout = std::chrono::seconds(REDIS_TIMEOUT)};
 
+  utils::RedisConfig async_redis_config = redis_config;
+  async_redis_config.pool_size = REDIS_ASYNC_CONNECTIONS;
+
   tools::Logger::getInstance();
+
+  // 恢复令牌的密钥不随代码发布，未配置时拒绝启动，而不是退回某个众所周知的默认密钥
+  const char* resume_keys = std::getenv(RESUME_TOKEN_KEYS_ENV);
+  if (resume_keys == nullptr || *resume_keys == '\0')
+  {
+    throw std::runtime_error(std::string("Resume token keys are not configured, set ") + RESUME_TOKEN_KEYS_ENV);
+  }
+  core::ResumeToken::LoadKeys(resume_keys);
+
   utils::StatusServerClinet::GetInstance().Init(status_address, STATUS_RPC_CONNECTION_POOL_SIZE);
   utils::DBPool::GetInstance().Init(db_config);
+  utils::AsyncDBPool::GetInstance().Init(async_db_config);
   utils::RedisPool::GetInstance().Init(redis_config);
   core::IO::GetInstance();
+  core::FrameCompressor::GetInstance().LoadDictionary(COMPRESS_DICT_PATH);
+
+  // 协程 Redis 客户端的连接分散绑定到 io 线程上
+  std::vector<boost::asio::any_io_executor> redis_executors;
+  for (std::size_t i = 0; i < core::IO::GetInstance().GetPoolSize(); ++i)
+  {
+    redis_executors.emplace_back(core::IO::GetInstance().GetIOContextAt(i).get_executor());
+  }
+  utils::AsyncRedisClient::GetInstance().Init(async_redis_config, redis_executors);
+  core::ProfileCache::GetInstance().Init(core::IO::GetInstance().GetIOContext().get_executor());
+
   core::Logic::GetInstance();
+  core::MessageWriter::GetInstance().Start();
+  core::LoginActivity::GetInstance().Start();
+}
+
+// 跨服转发的接收端，收到的帧直接投递给本服务器上的在线会话
+std::unique_ptr<grpc::Server> start_relay_server(unsigned short port, utils::ChatServiceImpl& service)
+{
+  auto address = "0.0.0.0:" + std::to_string(static_cast<unsigned>(port) + CHAT_RPC_PORT_OFFSET);
+
+  grpc::ServerBuilder builder;
+  builder.AddListeningPort(address, grpc::InsecureServerCredentials());
+  builder.SetMaxReceiveMessageSize(RPC_MAX_SEND_RECV_SIZE);
+  builder.SetMaxSendMessageSize(RPC_MAX_SEND_RECV_SIZE);
+  builder.RegisterService(&service);
+
+  auto server = builder.BuildAndStart();
+  if (!server)
+  {
+    throw std::runtime_error("Failed to start relay server on " + address);
+  }
+
+  tools::Logger::getInstance().info("Relay server listening on {}", address);
+  return server;
 }
 
 // 打印使用说明
 void print_usage(const char* program_name)
 {
-  std::cout << "Usage: " << program_name << " [-h] [-p <port>]\n"
+  std::cout << "Usage: " << program_name << " [-h] [-p <port>] [--peer <host:port>]... [--takeover]\n"
             << "Options:\n"
             << "  -h, --help         Show this help message\n"
-            << "  -p, --port <port>  Server port (default: " << DEFAULT_SERVER_PORT << ")\n";
+            << "  -p, --port <port>  Server port (default: " << DEFAULT_SERVER_PORT << ")\n"
+            << "  --peer <host:port> Relay address of another ChatServer (its port + " << CHAT_RPC_PORT_OFFSET
+            << "), repeatable\n"
+            << "  --takeover         Take over listening sockets and connections from the running ChatServer\n"
+            << "                     on the same port, which exits once they are handed over\n";
 }
 
 // 解析命令行参数
@@ -97,6 +168,21 @@ std::optional<tools::CmdOptions> parse_cmd(std::span<char*> args)
         return std::nullopt;
       }
     }
+
+    if (std::strcmp(args[i], "--peer") == 0)
+    {
+      if (i + 1 >= args.size())
+      {
+        std::cerr << "Error: missing peer address\n";
+        return std::nullopt;
+      }
+      options.peers.emplace_back(args[++i]);
+    }
+
+    if (std::strcmp(args[i], "--takeover") == 0)
+    {
+      options.takeover = true;
+    }
   }
 
   return options;
@@ -121,15 +207,46 @@ int main(int argc, char* argv[])
   try
   {
     init_components();
+    utils::ChatServerClient::GetInstance().Init(options->peers);
+
+    utils::ChatServiceImpl chat_service(
+        [](const utils::RelayFrame& frame)
+        {
+          // 编码不同的会话由 Deliver 转码，目标用户至少有一个会话收到即确认为已投递
+          return core::UserManager::GetInstance().Deliver(frame.to_uid(), static_cast<short>(frame.msg_id()),
+                                                          static_cast<utils::WireProtocol>(frame.protocol()),
+                                                          frame.body()) != 0;
+        });
+    auto relay_server = start_relay_server(options->port, chat_service);
 
     boost::asio::io_context signal_ioc;
     boost::asio::signal_set signals(signal_ioc, SIGINT, SIGTERM);
     boost::asio::co_spawn(signal_ioc, signal_handler(signals), boost::asio::detached);
 
+    // 热重启：旧进程交出之后新进程才绑定端口，没有旧进程时照常启动
     auto server = std::make_shared<core::Server>(options->port);
-    server->Start();
+    auto restart_path = core::HotRestart::SocketPath(options->port);
+    if (auto inherited = options->takeover ? core::HotRestart::TakeOver(restart_path) : std::nullopt)
+    {
+      server->Start(std::move(*inherited));
+    }
+    else
+    {
+      server->Start();
+    }
+
+    // 交出之后与收到信号一样退出主循环，余下的清理照常进行
+    core::HotRestartListener restart_listener(restart_path, server, [&signal_ioc] { signal_ioc.stop(); });
 
     signal_ioc.run();
+
+    // 先断开发往对端的转发流，再停止接收对端的转发；对端的流长期存在，不等待其结束而是立即取消
+    utils::ChatServerClient::GetInstance().Shutdown();
+    relay_server->Shutdown(std::chrono::system_clock::now());
+
+    // 已接受的消息全部落库后再退出，登录时间最后写出一次
+    core::MessageWriter::GetInstance().Stop();
+    core::LoginActivity::GetInstance().Stop();
   }
   catch (const boost::system::system_error& e)
   {
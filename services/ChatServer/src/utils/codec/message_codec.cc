@@ -0,0 +1,656 @@
+#include "message_codec.hpp"
+
+#include <json/json.h>
+
+#include <optional>
+#include <sstream>
+
+namespace utils
+{
+
+namespace
+{
+
+std::optional<Json::Value> parse_json(std::span<const char> data)
+{
+  Json::Value root;
+  Json::CharReaderBuilder builder;
+  std::string errors;
+  std::istringstream stream(std::string(data.data(), data.size()));
+
+  if (!Json::parseFromStream(builder, stream, &root, &errors) || !root.isObject())
+  {
+    return std::nullopt;
+  }
+  return root;
+}
+
+std::string write_json(const Json::Value& root)
+{
+  Json::StreamWriterBuilder writer;
+  return Json::writeString(writer, root);
+}
+
+// 键缺失或类型不符时取默认值，不让 jsoncpp 在类型转换时抛异常
+std::string read_string(const Json::Value& root, const char* key)
+{
+  const auto& value = root[key];
+  return value.isString() ? value.asString() : std::string{};
+}
+
+std::int32_t read_int(const Json::Value& root, const char* key)
+{
+  const auto& value = root[key];
+  return value.isInt() ? value.asInt() : 0;
+}
+
+std::uint32_t read_uint(const Json::Value& root, const char* key)
+{
+  const auto& value = root[key];
+  return value.isUInt() ? value.asUInt() : 0;
+}
+
+std::uint64_t read_uint64(const Json::Value& root, const char* key)
+{
+  const auto& value = root[key];
+  return value.isUInt64() ? value.asUInt64() : 0;
+}
+
+bool read_bool(const Json::Value& root, const char* key)
+{
+  const auto& value = root[key];
+  return value.isBool() && value.asBool();
+}
+
+Json::Value chat_msg_to_json(const ChatMsg& msg)
+{
+  Json::Value root;
+  root["conversation_id"] = msg.conversation_id();
+  root["seq"] = static_cast<Json::UInt64>(msg.seq());
+  root["sender_uuid"] = msg.sender_uuid();
+  root["msg_type"] = msg.msg_type();
+  root["content"] = msg.content();
+  root["created_at"] = static_cast<Json::UInt64>(msg.created_at());
+  return root;
+}
+
+void chat_msg_from_json(const Json::Value& root, ChatMsg& msg)
+{
+  msg.set_conversation_id(read_string(root, "conversation_id"));
+  msg.set_seq(read_uint64(root, "seq"));
+  msg.set_sender_uuid(read_string(root, "sender_uuid"));
+  msg.set_msg_type(read_uint(root, "msg_type"));
+  msg.set_content(read_string(root, "content"));
+  msg.set_created_at(read_uint64(root, "created_at"));
+}
+
+bool parse_proto(std::span<const char> data, google::protobuf::MessageLite& msg)
+{
+  return msg.ParseFromArray(data.data(), static_cast<int>(data.size()));
+}
+
+template <typename Message>
+std::optional<std::string> transcode_as(WireProtocol from, WireProtocol to, std::span<const char> body)
+{
+  Message msg;
+  if (!MessageCodec::Decode(from, body, msg))
+  {
+    return std::nullopt;
+  }
+  return MessageCodec::Encode(to, msg);
+}
+
+}  // namespace
+
+WireProtocol MessageCodec::Negotiate(std::uint32_t requested)
+{
+  if (requested <= static_cast<std::uint32_t>(WireProtocol::JSON))
+  {
+    return WireProtocol::JSON;
+  }
+  if (requested >= static_cast<std::uint32_t>(MAX_WIRE_PROTOCOL))
+  {
+    return MAX_WIRE_PROTOCOL;
+  }
+  return static_cast<WireProtocol>(requested);
+}
+
+std::string MessageCodec::Encode(WireProtocol protocol, const LoginChatRequest& msg)
+{
+  if (protocol == WireProtocol::PROTOBUF)
+  {
+    return msg.SerializeAsString();
+  }
+
+  Json::Value root;
+  root["uuid"] = msg.uuid();
+  root["token"] = msg.token();
+  if (msg.protocol() != 0)
+  {
+    root["protocol"] = msg.protocol();
+  }
+  if (msg.compression() != 0)
+  {
+    root["compression"] = msg.compression();
+  }
+  if (msg.dict_id() != 0)
+  {
+    root["dict_id"] = msg.dict_id();
+  }
+  return write_json(root);
+}
+
+std::string MessageCodec::Encode(WireProtocol protocol, const LoginChatResponse& msg)
+{
+  if (protocol == WireProtocol::PROTOBUF)
+  {
+    return msg.SerializeAsString();
+  }
+
+  Json::Value root;
+  root["code"] = msg.code();
+  root["message"] = msg.message();
+  if (msg.has_data())
+  {
+    Json::Value user_info;
+    user_info["nickname"] = msg.data().nickname();
+    user_info["avatar"] = msg.data().avatar();
+    user_info["email"] = msg.data().email();
+    root["data"] = user_info;
+  }
+  if (msg.protocol() != 0)
+  {
+    root["protocol"] = msg.protocol();
+  }
+  if (msg.compression() != 0)
+  {
+    root["compression"] = msg.compression();
+  }
+  if (msg.dict_id() != 0)
+  {
+    root["dict_id"] = msg.dict_id();
+  }
+  if (!msg.resume_token().empty())
+  {
+    root["resume_token"] = msg.resume_token();
+  }
+  return write_json(root);
+}
+
+std::string MessageCodec::Encode(WireProtocol protocol, const ExitLoginRequest& msg)
+{
+  if (protocol == WireProtocol::PROTOBUF)
+  {
+    return msg.SerializeAsString();
+  }
+
+  Json::Value root;
+  root["uuid"] = msg.uuid();
+  return write_json(root);
+}
+
+std::string MessageCodec::Encode(WireProtocol protocol, const ExitLoginResponse& msg)
+{
+  if (protocol == WireProtocol::PROTOBUF)
+  {
+    return msg.SerializeAsString();
+  }
+
+  Json::Value root;
+  root["code"] = msg.code();
+  root["message"] = msg.message();
+  return write_json(root);
+}
+
+std::string MessageCodec::Encode(WireProtocol protocol, const LoadHistoryRequest& msg)
+{
+  if (protocol == WireProtocol::PROTOBUF)
+  {
+    return msg.SerializeAsString();
+  }
+
+  Json::Value root;
+  root["conversation_id"] = msg.conversation_id();
+  if (msg.before_seq() != 0)
+  {
+    root["before_seq"] = static_cast<Json::UInt64>(msg.before_seq());
+  }
+  if (msg.limit() != 0)
+  {
+    root["limit"] = msg.limit();
+  }
+  return write_json(root);
+}
+
+std::string MessageCodec::Encode(WireProtocol protocol, const LoadHistoryResponse& msg)
+{
+  if (protocol == WireProtocol::PROTOBUF)
+  {
+    return msg.SerializeAsString();
+  }
+
+  Json::Value root;
+  root["code"] = msg.code();
+  root["message"] = msg.message();
+  root["conversation_id"] = msg.conversation_id();
+
+  Json::Value messages(Json::arrayValue);
+  for (const auto& chat_msg : msg.messages())
+  {
+    messages.append(chat_msg_to_json(chat_msg));
+  }
+  root["messages"] = std::move(messages);
+  root["has_more"] = msg.has_more();
+  return write_json(root);
+}
+
+std::string MessageCodec::Encode(WireProtocol protocol, const ResumeRequest& msg)
+{
+  if (protocol == WireProtocol::PROTOBUF)
+  {
+    return msg.SerializeAsString();
+  }
+
+  Json::Value root;
+  root["token"] = msg.token();
+  if (msg.protocol() != 0)
+  {
+    root["protocol"] = msg.protocol();
+  }
+  if (msg.compression() != 0)
+  {
+    root["compression"] = msg.compression();
+  }
+  if (msg.dict_id() != 0)
+  {
+    root["dict_id"] = msg.dict_id();
+  }
+
+  Json::Value cursors(Json::arrayValue);
+  for (const auto& cursor : msg.cursors())
+  {
+    Json::Value item;
+    item["conversation_id"] = cursor.conversation_id();
+    item["last_seq"] = static_cast<Json::UInt64>(cursor.last_seq());
+    cursors.append(std::move(item));
+  }
+  root["cursors"] = std::move(cursors);
+  return write_json(root);
+}
+
+std::string MessageCodec::Encode(WireProtocol protocol, const ResumeResponse& msg)
+{
+  if (protocol == WireProtocol::PROTOBUF)
+  {
+    return msg.SerializeAsString();
+  }
+
+  Json::Value root;
+  root["code"] = msg.code();
+  root["message"] = msg.message();
+  if (msg.protocol() != 0)
+  {
+    root["protocol"] = msg.protocol();
+  }
+  if (msg.compression() != 0)
+  {
+    root["compression"] = msg.compression();
+  }
+  if (msg.dict_id() != 0)
+  {
+    root["dict_id"] = msg.dict_id();
+  }
+  if (!msg.resume_token().empty())
+  {
+    root["resume_token"] = msg.resume_token();
+  }
+
+  Json::Value missed(Json::arrayValue);
+  for (const auto& conversation : msg.missed())
+  {
+    Json::Value item;
+    item["conversation_id"] = conversation.conversation_id();
+
+    Json::Value messages(Json::arrayValue);
+    for (const auto& chat_msg : conversation.messages())
+    {
+      messages.append(chat_msg_to_json(chat_msg));
+    }
+    item["messages"] = std::move(messages);
+    item["has_more"] = conversation.has_more();
+    missed.append(std::move(item));
+  }
+  root["missed"] = std::move(missed);
+  return write_json(root);
+}
+
+std::string MessageCodec::Encode(WireProtocol protocol, const ChatSendRequest& msg)
+{
+  if (protocol == WireProtocol::PROTOBUF)
+  {
+    return msg.SerializeAsString();
+  }
+
+  Json::Value root;
+  root["conversation_id"] = msg.conversation_id();
+  root["msg_type"] = msg.msg_type();
+  root["content"] = msg.content();
+  if (!msg.client_msg_id().empty())
+  {
+    root["client_msg_id"] = msg.client_msg_id();
+  }
+  return write_json(root);
+}
+
+std::string MessageCodec::Encode(WireProtocol protocol, const ChatSendResponse& msg)
+{
+  if (protocol == WireProtocol::PROTOBUF)
+  {
+    return msg.SerializeAsString();
+  }
+
+  Json::Value root;
+  root["code"] = msg.code();
+  root["message"] = msg.message();
+  root["conversation_id"] = msg.conversation_id();
+  root["seq"] = static_cast<Json::UInt64>(msg.seq());
+  root["created_at"] = static_cast<Json::UInt64>(msg.created_at());
+  if (!msg.client_msg_id().empty())
+  {
+    root["client_msg_id"] = msg.client_msg_id();
+  }
+  return write_json(root);
+}
+
+std::string MessageCodec::Encode(WireProtocol protocol, const ChatMsg& msg)
+{
+  if (protocol == WireProtocol::PROTOBUF)
+  {
+    return msg.SerializeAsString();
+  }
+  return write_json(chat_msg_to_json(msg));
+}
+
+bool MessageCodec::Decode(WireProtocol protocol, std::span<const char> data, LoginChatRequest& msg)
+{
+  if (protocol == WireProtocol::PROTOBUF)
+  {
+    return parse_proto(data, msg);
+  }
+
+  auto root = parse_json(data);
+  if (!root)
+  {
+    return false;
+  }
+  msg.set_uuid(read_string(*root, "uuid"));
+  msg.set_token(read_string(*root, "token"));
+  msg.set_protocol(read_uint(*root, "protocol"));
+  msg.set_compression(read_uint(*root, "compression"));
+  msg.set_dict_id(read_uint(*root, "dict_id"));
+  return true;
+}
+
+bool MessageCodec::Decode(WireProtocol protocol, std::span<const char> data, LoginChatResponse& msg)
+{
+  if (protocol == WireProtocol::PROTOBUF)
+  {
+    return parse_proto(data, msg);
+  }
+
+  auto root = parse_json(data);
+  if (!root)
+  {
+    return false;
+  }
+  msg.set_code(read_int(*root, "code"));
+  msg.set_message(read_string(*root, "message"));
+  if (const auto& user_info = (*root)["data"]; user_info.isObject())
+  {
+    auto* data_msg = msg.mutable_data();
+    data_msg->set_nickname(read_string(user_info, "nickname"));
+    data_msg->set_avatar(read_string(user_info, "avatar"));
+    data_msg->set_email(read_string(user_info, "email"));
+  }
+  msg.set_protocol(read_uint(*root, "protocol"));
+  msg.set_compression(read_uint(*root, "compression"));
+  msg.set_dict_id(read_uint(*root, "dict_id"));
+  msg.set_resume_token(read_string(*root, "resume_token"));
+  return true;
+}
+
+bool MessageCodec::Decode(WireProtocol protocol, std::span<const char> data, ExitLoginRequest& msg)
+{
+  if (protocol == WireProtocol::PROTOBUF)
+  {
+    return parse_proto(data, msg);
+  }
+
+  auto root = parse_json(data);
+  if (!root)
+  {
+    return false;
+  }
+  msg.set_uuid(read_string(*root, "uuid"));
+  return true;
+}
+
+bool MessageCodec::Decode(WireProtocol protocol, std::span<const char> data, ExitLoginResponse& msg)
+{
+  if (protocol == WireProtocol::PROTOBUF)
+  {
+    return parse_proto(data, msg);
+  }
+
+  auto root = parse_json(data);
+  if (!root)
+  {
+    return false;
+  }
+  msg.set_code(read_int(*root, "code"));
+  msg.set_message(read_string(*root, "message"));
+  return true;
+}
+
+bool MessageCodec::Decode(WireProtocol protocol, std::span<const char> data, LoadHistoryRequest& msg)
+{
+  if (protocol == WireProtocol::PROTOBUF)
+  {
+    return parse_proto(data, msg);
+  }
+
+  auto root = parse_json(data);
+  if (!root)
+  {
+    return false;
+  }
+  msg.set_conversation_id(read_string(*root, "conversation_id"));
+  msg.set_before_seq(read_uint64(*root, "before_seq"));
+  msg.set_limit(read_uint(*root, "limit"));
+  return true;
+}
+
+bool MessageCodec::Decode(WireProtocol protocol, std::span<const char> data, LoadHistoryResponse& msg)
+{
+  if (protocol == WireProtocol::PROTOBUF)
+  {
+    return parse_proto(data, msg);
+  }
+
+  auto root = parse_json(data);
+  if (!root)
+  {
+    return false;
+  }
+  msg.set_code(read_int(*root, "code"));
+  msg.set_message(read_string(*root, "message"));
+  msg.set_conversation_id(read_string(*root, "conversation_id"));
+  if (const auto& messages = (*root)["messages"]; messages.isArray())
+  {
+    for (const auto& chat_msg : messages)
+    {
+      if (chat_msg.isObject())
+      {
+        chat_msg_from_json(chat_msg, *msg.add_messages());
+      }
+    }
+  }
+  msg.set_has_more(read_bool(*root, "has_more"));
+  return true;
+}
+
+bool MessageCodec::Decode(WireProtocol protocol, std::span<const char> data, ResumeRequest& msg)
+{
+  if (protocol == WireProtocol::PROTOBUF)
+  {
+    return parse_proto(data, msg);
+  }
+
+  auto root = parse_json(data);
+  if (!root)
+  {
+    return false;
+  }
+  msg.set_token(read_string(*root, "token"));
+  msg.set_protocol(read_uint(*root, "protocol"));
+  msg.set_compression(read_uint(*root, "compression"));
+  msg.set_dict_id(read_uint(*root, "dict_id"));
+  if (const auto& cursors = (*root)["cursors"]; cursors.isArray())
+  {
+    for (const auto& item : cursors)
+    {
+      if (item.isObject())
+      {
+        auto* cursor = msg.add_cursors();
+        cursor->set_conversation_id(read_string(item, "conversation_id"));
+        cursor->set_last_seq(read_uint64(item, "last_seq"));
+      }
+    }
+  }
+  return true;
+}
+
+bool MessageCodec::Decode(WireProtocol protocol, std::span<const char> data, ResumeResponse& msg)
+{
+  if (protocol == WireProtocol::PROTOBUF)
+  {
+    return parse_proto(data, msg);
+  }
+
+  auto root = parse_json(data);
+  if (!root)
+  {
+    return false;
+  }
+  msg.set_code(read_int(*root, "code"));
+  msg.set_message(read_string(*root, "message"));
+  msg.set_protocol(read_uint(*root, "protocol"));
+  msg.set_compression(read_uint(*root, "compression"));
+  msg.set_dict_id(read_uint(*root, "dict_id"));
+  msg.set_resume_token(read_string(*root, "resume_token"));
+  if (const auto& missed = (*root)["missed"]; missed.isArray())
+  {
+    for (const auto& item : missed)
+    {
+      if (!item.isObject())
+      {
+        continue;
+      }
+
+      auto* conversation = msg.add_missed();
+      conversation->set_conversation_id(read_string(item, "conversation_id"));
+      if (const auto& messages = item["messages"]; messages.isArray())
+      {
+        for (const auto& chat_msg : messages)
+        {
+          if (chat_msg.isObject())
+          {
+            chat_msg_from_json(chat_msg, *conversation->add_messages());
+          }
+        }
+      }
+      conversation->set_has_more(read_bool(item, "has_more"));
+    }
+  }
+  return true;
+}
+
+bool MessageCodec::Decode(WireProtocol protocol, std::span<const char> data, ChatSendRequest& msg)
+{
+  if (protocol == WireProtocol::PROTOBUF)
+  {
+    return parse_proto(data, msg);
+  }
+
+  auto root = parse_json(data);
+  if (!root)
+  {
+    return false;
+  }
+  msg.set_conversation_id(read_string(*root, "conversation_id"));
+  msg.set_msg_type(read_uint(*root, "msg_type"));
+  msg.set_content(read_string(*root, "content"));
+  msg.set_client_msg_id(read_string(*root, "client_msg_id"));
+  return true;
+}
+
+bool MessageCodec::Decode(WireProtocol protocol, std::span<const char> data, ChatSendResponse& msg)
+{
+  if (protocol == WireProtocol::PROTOBUF)
+  {
+    return parse_proto(data, msg);
+  }
+
+  auto root = parse_json(data);
+  if (!root)
+  {
+    return false;
+  }
+  msg.set_code(read_int(*root, "code"));
+  msg.set_message(read_string(*root, "message"));
+  msg.set_conversation_id(read_string(*root, "conversation_id"));
+  msg.set_seq(read_uint64(*root, "seq"));
+  msg.set_created_at(read_uint64(*root, "created_at"));
+  msg.set_client_msg_id(read_string(*root, "client_msg_id"));
+  return true;
+}
+
+bool MessageCodec::Decode(WireProtocol protocol, std::span<const char> data, ChatMsg& msg)
+{
+  if (protocol == WireProtocol::PROTOBUF)
+  {
+    return parse_proto(data, msg);
+  }
+
+  auto root = parse_json(data);
+  if (!root)
+  {
+    return false;
+  }
+  chat_msg_from_json(*root, msg);
+  return true;
+}
+
+std::optional<std::string> MessageCodec::Transcode(short msg_id, WireProtocol from, WireProtocol to,
+                                                  std::span<const char> body)
+{
+  if (from == to)
+  {
+    return std::string(body.data(), body.size());
+  }
+
+  switch (msg_id)
+  {
+    case ID_CHAT_PUSH:
+      return transcode_as<ChatMsg>(from, to, body);
+    default:
+      return std::nullopt;
+  }
+}
+
+std::int16_t MessageCodec::ParseErrorCode(WireProtocol protocol)
+{
+  return protocol == WireProtocol::PROTOBUF ? PROTO_PARSE_ERROR : JSON_PARSE_ERROR;
+}
+
+}  // namespace utils
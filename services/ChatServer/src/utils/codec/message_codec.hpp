@@ -0,0 +1,80 @@
+/******************************************************************************
+ *
+ * @file       message_codec.hpp
+ * @brief      客户端消息体的编解码
+ *
+ * @author     KBchulan
+ * @date       2026/10/18
+ * @history    同一组消息类型按会话协商的编码输出为 JSON 或 protobuf
+ *             2026/10/18 新增历史消息的请求与响应
+ *             2026/10/18 新增断线恢复的请求与响应
+ *             2026/10/18 新增发送聊天消息的请求与响应
+ *             2026/10/18 新增推送给会话成员的单条聊天消息
+ *             2026/10/18 新增按消息 id 转码，跨服转发的帧可投递给编码不同的会话
+ ******************************************************************************/
+
+#ifndef MESSAGE_CODEC_HPP
+#define MESSAGE_CODEC_HPP
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wconversion"
+#include <utils/codec/chat_message/chat_message.pb.h>
+#pragma GCC diagnostic pop
+
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <string>
+#include <utils/UtilsExport.hpp>
+#include <utils/common/code.hpp>
+
+namespace utils
+{
+
+using namespace KBchulan::ChatRoom::ChatMessage;
+
+// 业务代码只操作生成的消息类型，具体编码由会话上的 WireProtocol 决定
+// JSON 编码下的键名与 proto 字段名一致，输出与原先手写的 JSON 相同
+class UTILS_EXPORT MessageCodec
+{
+public:
+  // 取客户端请求的版本与服务端支持版本中的较小者，未知或缺省的版本按 JSON 处理
+  [[nodiscard]] static WireProtocol Negotiate(std::uint32_t requested);
+
+  [[nodiscard]] static std::string Encode(WireProtocol protocol, const LoginChatRequest& msg);
+  [[nodiscard]] static std::string Encode(WireProtocol protocol, const LoginChatResponse& msg);
+  [[nodiscard]] static std::string Encode(WireProtocol protocol, const ExitLoginRequest& msg);
+  [[nodiscard]] static std::string Encode(WireProtocol protocol, const ExitLoginResponse& msg);
+  [[nodiscard]] static std::string Encode(WireProtocol protocol, const LoadHistoryRequest& msg);
+  [[nodiscard]] static std::string Encode(WireProtocol protocol, const LoadHistoryResponse& msg);
+  [[nodiscard]] static std::string Encode(WireProtocol protocol, const ResumeRequest& msg);
+  [[nodiscard]] static std::string Encode(WireProtocol protocol, const ResumeResponse& msg);
+  [[nodiscard]] static std::string Encode(WireProtocol protocol, const ChatSendRequest& msg);
+  [[nodiscard]] static std::string Encode(WireProtocol protocol, const ChatSendResponse& msg);
+  [[nodiscard]] static std::string Encode(WireProtocol protocol, const ChatMsg& msg);
+
+  // 解析失败返回 false，msg 的内容此时未定义
+  [[nodiscard]] static bool Decode(WireProtocol protocol, std::span<const char> data, LoginChatRequest& msg);
+  [[nodiscard]] static bool Decode(WireProtocol protocol, std::span<const char> data, LoginChatResponse& msg);
+  [[nodiscard]] static bool Decode(WireProtocol protocol, std::span<const char> data, ExitLoginRequest& msg);
+  [[nodiscard]] static bool Decode(WireProtocol protocol, std::span<const char> data, ExitLoginResponse& msg);
+  [[nodiscard]] static bool Decode(WireProtocol protocol, std::span<const char> data, LoadHistoryRequest& msg);
+  [[nodiscard]] static bool Decode(WireProtocol protocol, std::span<const char> data, LoadHistoryResponse& msg);
+  [[nodiscard]] static bool Decode(WireProtocol protocol, std::span<const char> data, ResumeRequest& msg);
+  [[nodiscard]] static bool Decode(WireProtocol protocol, std::span<const char> data, ResumeResponse& msg);
+  [[nodiscard]] static bool Decode(WireProtocol protocol, std::span<const char> data, ChatSendRequest& msg);
+  [[nodiscard]] static bool Decode(WireProtocol protocol, std::span<const char> data, ChatSendResponse& msg);
+  [[nodiscard]] static bool Decode(WireProtocol protocol, std::span<const char> data, ChatMsg& msg);
+
+  // 把 from 编码的消息体转为 to 编码，跨服转发的帧投递给编码不同的会话时使用
+  // 只支持会被转发的消息 id，其余 id 或解析失败时返回 std::nullopt
+  [[nodiscard]] static std::optional<std::string> Transcode(short msg_id, WireProtocol from, WireProtocol to,
+                                                            std::span<const char> body);
+
+  // 解析失败时回包使用的错误码
+  [[nodiscard]] static std::int16_t ParseErrorCode(WireProtocol protocol);
+};
+
+}  // namespace utils
+
+#endif  // MESSAGE_CODEC_HPP
@@ -17,15 +17,54 @@ namespace utils
 {
 
 // 错误码定义
-constexpr std::int16_t SUCCESS = 0;           // 成功
-constexpr std::int16_t JSON_PARSE_ERROR = 1;  // JSON 解析错误
-constexpr std::int16_t REDIS_ERROR = 2;       // Redis 错误
+constexpr std::int16_t SUCCESS = 0;            // 成功
+constexpr std::int16_t JSON_PARSE_ERROR = 1;   // JSON 解析错误
+constexpr std::int16_t REDIS_ERROR = 2;        // Redis 错误
+constexpr std::int16_t PROTO_PARSE_ERROR = 3;  // Protobuf 解析错误
+constexpr std::int16_t NOT_LOGGED_IN = 4;      // 尚未登录
+constexpr std::int16_t RESUME_REJECTED = 5;    // 恢复令牌无效、过期或已退出登录，需完整登录
+constexpr std::int16_t NOT_A_MEMBER = 6;       // 不是该会话的成员
+constexpr std::int16_t PERSIST_BUSY = 7;       // 消息落库排队已满，稍后重试
+constexpr std::int16_t DB_ERROR = 8;           // 数据库错误
 
 // 消息ID定义
-constexpr std::int16_t ID_LOGIN_CHAT = 1005;           // 逻辑登录
-constexpr std::int16_t ID_LOGIN_CHAT_RESPONSE = 1006;  // 逻辑登录回包
-constexpr std::int16_t ID_EXIT_LOGIN = 1007;           // 退出登录
-constexpr std::int16_t ID_EXIT_LOGIN_RESPONSE = 1008;  // 退出登录回包
+constexpr std::int16_t ID_LOGIN_CHAT = 1005;             // 逻辑登录
+constexpr std::int16_t ID_LOGIN_CHAT_RESPONSE = 1006;    // 逻辑登录回包
+constexpr std::int16_t ID_EXIT_LOGIN = 1007;             // 退出登录
+constexpr std::int16_t ID_EXIT_LOGIN_RESPONSE = 1008;    // 退出登录回包
+constexpr std::int16_t ID_HEARTBEAT = 1009;              // 心跳，消息体原样回显
+constexpr std::int16_t ID_HEARTBEAT_RESPONSE = 1010;     // 心跳回包
+constexpr std::int16_t ID_LOAD_HISTORY = 1011;           // 拉取历史消息
+constexpr std::int16_t ID_LOAD_HISTORY_RESPONSE = 1012;  // 拉取历史消息回包
+constexpr std::int16_t ID_RESUME = 1013;                 // 断线重连后以恢复令牌挂回会话
+constexpr std::int16_t ID_RESUME_RESPONSE = 1014;        // 恢复回包
+constexpr std::int16_t ID_CHAT_SEND = 1015;              // 发送聊天消息
+constexpr std::int16_t ID_CHAT_SEND_RESPONSE = 1016;     // 发送聊天消息回包
+constexpr std::int16_t ID_CHAT_PUSH = 1017;              // 向会话成员推送新消息，消息体为 ChatMsg
+
+// 控制帧走发送队列的优先通道，先于排队的普通消息发出，慢消费者策略也不会丢弃它们
+constexpr bool IsControlMessage(std::int16_t msg_id)
+{
+  return msg_id == ID_LOGIN_CHAT_RESPONSE || msg_id == ID_EXIT_LOGIN_RESPONSE || msg_id == ID_HEARTBEAT_RESPONSE ||
+         msg_id == ID_RESUME_RESPONSE;
+}
+
+// 消息体编码，登录时由客户端请求、服务端确认，未携带时按 JSON 处理以兼容旧客户端
+enum class WireProtocol : std::uint8_t
+{
+  JSON = 1,      // JSON 文本
+  PROTOBUF = 2,  // proto/chat_message.proto
+};
+
+constexpr WireProtocol MAX_WIRE_PROTOCOL = WireProtocol::PROTOBUF;  // 服务端支持的最高编码版本
+
+// 消息体压缩算法，登录时由客户端请求、服务端确认，对双向超过阈值的消息体生效
+enum class Compression : std::uint8_t
+{
+  NONE = 0,  // 不压缩
+  LZ4 = 1,   // LZ4 frame，速度优先
+  ZSTD = 2,  // zstd，可配合训练好的字典压缩小消息
+};
 
 }  // namespace utils
 
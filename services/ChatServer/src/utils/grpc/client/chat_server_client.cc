@@ -1,22 +1,511 @@
 #include "chat_server_client.hpp"
 
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <global/MpscQueue.hpp>
+#include <mutex>
+#include <stop_token>
+#include <thread>
+#include <tools/Logger.hpp>
+#include <unordered_map>
+#include <utils/pool/channel/channel_pool.hpp>
+
 namespace utils
 {
 
+namespace
+{
+
+struct alignas(64) RelayCounters
+{
+  std::atomic<std::uint64_t> _frames_sent{0};
+  std::atomic<std::uint64_t> _batches_sent{0};
+  std::atomic<std::uint64_t> _frames_acked{0};
+  std::atomic<std::uint64_t> _frames_dropped{0};
+};
+
+class RelayStream;
+
+// 一个对端：发送队列、当前转发流，以及负责建流与重连的线程
+class Peer
+{
+public:
+  Peer(std::string address, std::size_t max_batch_frames, RelayCounters& counters);
+  ~Peer();
+
+  // 入队后只在空闲到忙碌的跳变时取得发送权并开始写入
+  bool Push(RelayFrame frame);
+
+  // 持有发送权的一方调用，写入一批或在队列为空时交还发送权；没有可用的流时保留发送权，由新流接手
+  void WriteNext();
+
+  // 从队列取出一批帧，返回取出的帧数，只由持有发送权的一方调用
+  std::size_t Fill(RelayBatch& batch);
+
+  // 收到对端的初始元数据，流已建立，此后才向它写入，避免对端不可达时把帧写进注定失败的流
+  void Attach(RelayStream& stream);
+
+  // 流已断开，不再向它写入，之后由建流线程重连
+  void Detach(RelayStream& stream);
+
+  void OnStreamDone();
+
+  [[nodiscard]] RelayCounters& Counters()
+  {
+    return _counters;
+  }
+
+  Peer(const Peer&) = delete;
+  Peer& operator=(const Peer&) = delete;
+  Peer(Peer&&) = delete;
+  Peer& operator=(Peer&&) = delete;
+
+private:
+  // 与 RelayStream::AcquireWriter 配对，流已断开且是最后一个写入方时释放 hold
+  void release_writer(RelayStream& stream);
+
+  void connect_loop(const std::stop_token& token);
+
+  std::string _address;
+  std::size_t _max_batch_frames;
+  RelayCounters& _counters;
+  ChannelPool _channels;
+  std::unique_ptr<ChatService::Stub> _stub;
+
+  // 发送队列，_write_armed 为 true 表示已有一方负责清空队列
+  global::MpscQueue<RelayFrame> _queue;
+  std::atomic<bool> _write_armed{false};
+  std::uint64_t _next_seq{0};
+
+  // 以下成员由 _mutex 保护；_connecting 为正在建立的流，_parked 表示发送权的持有方在等待新流
+  std::mutex _mutex;
+  std::condition_variable_any _cv;
+  RelayStream* _connecting{nullptr};
+  RelayStream* _stream{nullptr};
+  bool _parked{false};
+  std::size_t _live_streams{0};
+
+  std::jthread _connector;
+};
+
+// 一次 Relay 调用，流结束后由 Peer 重新建立；构造时持有一个 hold，
+// 保证流断开之前其他线程可以随时对它发起写入，Detach 且没有正在发起写入的线程时才释放
+class RelayStream final : public grpc::ClientBidiReactor<RelayBatch, RelayAck>
+{
+public:
+  RelayStream(Peer& peer, ChatService::Stub& stub) : _peer(peer)
+  {
+    stub.async()->Relay(&_context, this);
+    AddHold();
+    StartRead(&_ack);
+  }
+
+  void Start()
+  {
+    StartCall();
+  }
+
+  void Cancel()
+  {
+    _context.TryCancel();
+  }
+
+  // 由 Peer 在 _mutex 下调用，登记一个即将发起写入的线程
+  void AcquireWriter()
+  {
+    ++_writers;
+  }
+
+  // 由 Peer 在 _mutex 下调用，返回 true 时调用方需在锁外 RemoveHold
+  [[nodiscard]] bool ReleaseWriter()
+  {
+    --_writers;
+    return _detached && _writers == 0;
+  }
+
+  [[nodiscard]] bool MarkDetached()
+  {
+    if (std::exchange(_detached, true))
+    {
+      return false;
+    }
+    return _writers == 0;
+  }
+
+  // 取出一批写入，队列为空时返回 false
+  bool WriteBatch()
+  {
+    _batch.Clear();
+    _batch_frames = _peer.Fill(_batch);
+    if (_batch_frames == 0)
+    {
+      return false;
+    }
+
+    StartWrite(&_batch);
+    return true;
+  }
+
+  void OnReadInitialMetadataDone(bool ok) override
+  {
+    if (ok)
+    {
+      _peer.Attach(*this);
+    }
+  }
+
+  void OnWriteDone(bool ok) override
+  {
+    auto& counters = _peer.Counters();
+    if (ok)
+    {
+      counters._frames_sent.fetch_add(_batch_frames, std::memory_order_relaxed);
+      counters._batches_sent.fetch_add(1, std::memory_order_relaxed);
+    }
+    else
+    {
+      counters._frames_dropped.fetch_add(_batch_frames, std::memory_order_relaxed);
+      _peer.Detach(*this);
+    }
+
+    // 仍然持有发送权，继续写下一批；流已断开时由新流接手
+    _peer.WriteNext();
+  }
+
+  void OnReadDone(bool ok) override
+  {
+    if (!ok)
+    {
+      _peer.Detach(*this);
+      return;
+    }
+
+    _peer.Counters()._frames_acked.fetch_add(_ack.frames(), std::memory_order_relaxed);
+    StartRead(&_ack);
+  }
+
+  void OnDone(const grpc::Status& status) override
+  {
+    if (!status.ok() && status.error_code() != grpc::StatusCode::CANCELLED)
+    {
+      tools::Logger::getInstance().warning("Relay stream closed: {} ({})", status.error_message(),
+                                           static_cast<int>(status.error_code()));
+    }
+
+    _peer.OnStreamDone();
+    delete this;
+  }
+
+private:
+  Peer& _peer;
+  grpc::ClientContext _context;
+  RelayBatch _batch;
+  std::size_t _batch_frames{0};
+  RelayAck _ack;
+
+  // 由 Peer::_mutex 保护
+  std::size_t _writers{0};
+  bool _detached{false};
+};
+
+Peer::Peer(std::string address, std::size_t max_batch_frames, RelayCounters& counters)
+    : _address(std::move(address)),
+      _max_batch_frames(max_batch_frames == 0 ? 1 : max_batch_frames),
+      _counters(counters),
+      _channels(_address, 1),
+      _stub(ChatService::NewStub(_channels.GetChannel())),
+      _connector([this](const std::stop_token& token) { connect_loop(token); })
+{
+}
+
+// 先停止建流线程，再取消当前流并等待所有流结束，之后 reactor 不再访问 Peer
+Peer::~Peer()
+{
+  _connector.request_stop();
+  _connector.join();
+
+  // 取消可能在本线程上直接触发读完成回调，与 WriteNext 一样登记后在锁外发起
+  RelayStream* stream = nullptr;
+  {
+    std::lock_guard lock{_mutex};
+    stream = _stream != nullptr ? _stream : _connecting;
+    if (stream != nullptr)
+    {
+      stream->AcquireWriter();
+    }
+  }
+  if (stream != nullptr)
+  {
+    stream->Cancel();
+    release_writer(*stream);
+  }
+
+  std::unique_lock lock{_mutex};
+  _cv.wait(lock, [this] { return _live_streams == 0; });
+
+  std::size_t dropped = 0;
+  RelayFrame frame;
+  while (_queue.pop(frame))
+  {
+    ++dropped;
+  }
+  _counters._frames_dropped.fetch_add(dropped, std::memory_order_relaxed);
+}
+
+bool Peer::Push(RelayFrame frame)
+{
+  if (_queue.size() >= global::server::RELAY_MAX_PENDING_FRAMES)
+  {
+    _counters._frames_dropped.fetch_add(1, std::memory_order_relaxed);
+    return false;
+  }
+
+  _queue.emplace(std::move(frame));
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+
+  if (!_write_armed.exchange(true, std::memory_order_acq_rel))
+  {
+    WriteNext();
+  }
+  return true;
+}
+
+void Peer::WriteNext()
+{
+  while (true)
+  {
+    RelayStream* stream = nullptr;
+    {
+      std::lock_guard lock{_mutex};
+      if (_stream == nullptr)
+      {
+        _parked = true;
+        return;
+      }
+      stream = _stream;
+      stream->AcquireWriter();
+    }
+
+    // StartWrite 的完成回调可能在本线程上直接执行，不能持锁发起
+    bool wrote = stream->WriteBatch();
+    release_writer(*stream);
+
+    if (wrote)
+    {
+      return;
+    }
+
+    // 与 Session 的写协程相同：先交还发送权再复查队列，与 Push 中的 fence 配对
+    _write_armed.store(false, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+
+    if (_queue.empty() || _write_armed.exchange(true, std::memory_order_acq_rel))
+    {
+      return;
+    }
+  }
+}
+
+std::size_t Peer::Fill(RelayBatch& batch)
+{
+  std::size_t frames = 0;
+  std::size_t bytes = 0;
+  RelayFrame frame;
+
+  while (frames < _max_batch_frames && _queue.pop(frame))
+  {
+    bytes += frame.body().size() + frame.to_uid().size();
+    batch.mutable_frames()->Add(std::move(frame));
+    ++frames;
+
+    if (bytes >= global::server::RELAY_BATCH_MAX_BYTES)
+    {
+      break;
+    }
+  }
+
+  if (frames != 0)
+  {
+    batch.set_seq(++_next_seq);
+  }
+  return frames;
+}
+
+void Peer::Attach(RelayStream& stream)
+{
+  bool resume = false;
+  {
+    std::lock_guard lock{_mutex};
+    if (_connecting != &stream)
+    {
+      return;
+    }
+    _connecting = nullptr;
+    _stream = &stream;
+    resume = std::exchange(_parked, false);
+  }
+  tools::Logger::getInstance().info("Relay stream to {} established", _address);
+
+  if (resume)
+  {
+    WriteNext();
+  }
+}
+
+void Peer::Detach(RelayStream& stream)
+{
+  bool release = false;
+  {
+    std::lock_guard lock{_mutex};
+    if (_stream == &stream)
+    {
+      _stream = nullptr;
+    }
+    if (_connecting == &stream)
+    {
+      _connecting = nullptr;
+    }
+    release = stream.MarkDetached();
+  }
+  _cv.notify_all();
+
+  if (release)
+  {
+    stream.RemoveHold();
+  }
+}
+
+void Peer::release_writer(RelayStream& stream)
+{
+  bool release = false;
+  {
+    std::lock_guard lock{_mutex};
+    release = stream.ReleaseWriter();
+  }
+  if (release)
+  {
+    stream.RemoveHold();
+  }
+}
+
+void Peer::OnStreamDone()
+{
+  {
+    std::lock_guard lock{_mutex};
+    --_live_streams;
+  }
+  _cv.notify_all();
+}
+
+// 当前流断开后等待重连间隔再建立新流，第一次立即建立
+void Peer::connect_loop(const std::stop_token& token)
+{
+  bool first = true;
+  std::unique_lock lock{_mutex};
+
+  while (true)
+  {
+    _cv.wait(lock, token, [this] { return _stream == nullptr && _connecting == nullptr; });
+    if (!first)
+    {
+      _cv.wait_for(lock, token, std::chrono::milliseconds(global::server::RELAY_RECONNECT_MS), [] { return false; });
+    }
+    if (token.stop_requested())
+    {
+      return;
+    }
+    first = false;
+
+    auto* stream = new RelayStream(*this, *_stub);
+    _connecting = stream;
+    ++_live_streams;
+    lock.unlock();
+
+    stream->Start();
+    lock.lock();
+  }
+}
+
+}  // namespace
+
+struct ChatServerClient::_impl
+{
+  RelayCounters _counters;
+  std::unordered_map<std::string, std::unique_ptr<Peer>> _peers;
+};
+
+ChatServerClient::ChatServerClient() : _pimpl(std::make_unique<_impl>())
+{
+}
+
+ChatServerClient::~ChatServerClient() = default;
+
 ChatServerClient& ChatServerClient::GetInstance()
 {
   static ChatServerClient instance;
   return instance;
 }
 
-void ChatServerClient::Init(const std::string& server_address, std::size_t pool_size)
+void ChatServerClient::Init(const std::vector<std::string>& peers, std::size_t max_batch_frames)
+{
+  Shutdown();
+
+  for (const auto& address : peers)
+  {
+    _pimpl->_peers.try_emplace(address, std::make_unique<Peer>(address, max_batch_frames, _pimpl->_counters));
+  }
+}
+
+bool ChatServerClient::Relay(const std::string& peer, const std::string& to_uid, short msg_id, WireProtocol protocol,
+                             std::string body)
+{
+  auto iter = _pimpl->_peers.find(peer);
+  if (iter == _pimpl->_peers.end() || body.size() > global::server::RELAY_BATCH_MAX_BYTES)
+  {
+    _pimpl->_counters._frames_dropped.fetch_add(1, std::memory_order_relaxed);
+    return false;
+  }
+
+  RelayFrame frame;
+  frame.set_to_uid(to_uid);
+  frame.set_msg_id(msg_id);
+  frame.set_protocol(static_cast<std::uint32_t>(protocol));
+  frame.set_body(std::move(body));
+  return iter->second->Push(std::move(frame));
+}
+
+std::size_t ChatServerClient::Broadcast(const std::string& to_uid, short msg_id, WireProtocol protocol,
+                                       const std::string& body)
+{
+  std::size_t queued = 0;
+  for (const auto& [address, peer] : _pimpl->_peers)
+  {
+    if (Relay(address, to_uid, msg_id, protocol, body))
+    {
+      ++queued;
+    }
+  }
+  return queued;
+}
+
+std::size_t ChatServerClient::GetPeerCount() const
+{
+  return _pimpl->_peers.size();
+}
+
+RelayStats ChatServerClient::GetStats() const
 {
-  _pool = std::make_unique<ChannelPool>(server_address, pool_size);
+  const auto& counters = _pimpl->_counters;
+  return {.frames_sent = counters._frames_sent.load(std::memory_order_relaxed),
+          .batches_sent = counters._batches_sent.load(std::memory_order_relaxed),
+          .frames_acked = counters._frames_acked.load(std::memory_order_relaxed),
+          .frames_dropped = counters._frames_dropped.load(std::memory_order_relaxed)};
 }
 
-std::unique_ptr<ChatService::Stub> ChatServerClient::create_stub()
+void ChatServerClient::Shutdown()
 {
-  return ChatService::NewStub(_pool->GetChannel());
+  _pimpl->_peers.clear();
 }
 
-}  // namespace utils
\ No newline at end of file
+}  // namespace utils
@@ -5,7 +5,8 @@
  *
  * @author     KBchulan
  * @date       2026/03/02
- * @history
+ * @history    2026/10/18 每个对端维持一条双向流，转发的帧在流上批量发送
+ *             2026/10/18 新增向全部对端转发，尚无用户所在服务器的索引时由各对端投递给本地在线的会话
  ******************************************************************************/
 
 #ifndef CHAT_SERVER_CLIENT_HPP
@@ -17,20 +18,53 @@
 #include <utils/grpc/chat_server/chat_server.pb.h>
 #pragma GCC diagnostic pop
 
+#include <cstdint>
+#include <global/Global.hpp>
 #include <memory>
+#include <string>
 #include <utils/UtilsExport.hpp>
-#include <utils/pool/channel/channel_pool.hpp>
+#include <utils/common/code.hpp>
+#include <vector>
 
 namespace utils
 {
 
 using namespace KBchulan::ChatRoom::ChatServer;
 
+// 所有对端累计的转发统计
+struct UTILS_EXPORT RelayStats
+{
+  std::uint64_t frames_sent;     // 已写入转发流的帧数
+  std::uint64_t batches_sent;    // 写入次数，frames_sent / batches_sent 即平均每批帧数
+  std::uint64_t frames_acked;    // 对端确认已处理的帧数
+  std::uint64_t frames_dropped;  // 队列已满、帧过大或流断开时丢弃的帧数
+};
+
+// 发送端与 Session 的写协程一致：队列由空变为非空的那次调用取得发送权，
+// 上一批写完之前到达的帧在下一次写入时合并，空闲时单帧立即发出，繁忙时每批最多 max_batch_frames 帧
 class UTILS_EXPORT ChatServerClient
 {
 public:
   static ChatServerClient& GetInstance();
-  void Init(const std::string& server_address, std::size_t pool_size);
+
+  // peers 为其他聊天服务器的转发地址 host:port，每个对端建立一条双向流，断开后自动重连
+  // 重复调用时先关闭已有的转发流，未发送的帧丢弃；Init 与 Shutdown 不能与 Relay 并发调用
+  void Init(const std::vector<std::string>& peers,
+            std::size_t max_batch_frames = global::server::RELAY_BATCH_MAX_FRAMES);
+
+  // 非阻塞，帧进入对端的发送队列后立即返回；对端未配置、队列已满或帧过大时返回 false
+  bool Relay(const std::string& peer, const std::string& to_uid, short msg_id, WireProtocol protocol,
+             std::string body);
+
+  // 同一帧转发给全部对端，返回进入发送队列的对端数；尚无用户所在服务器的索引，由各对端投递给本地在线的会话
+  std::size_t Broadcast(const std::string& to_uid, short msg_id, WireProtocol protocol, const std::string& body);
+
+  [[nodiscard]] std::size_t GetPeerCount() const;
+
+  [[nodiscard]] RelayStats GetStats() const;
+
+  // 取消全部转发流并等待其结束
+  void Shutdown();
 
   ChatServerClient(const ChatServerClient&) = delete;
   ChatServerClient& operator=(const ChatServerClient&) = delete;
@@ -38,14 +72,13 @@ public:
   ChatServerClient& operator=(ChatServerClient&&) = delete;
 
 private:
-  ChatServerClient() = default;
-  ~ChatServerClient() = default;
-
-  [[nodiscard]] std::unique_ptr<ChatService::Stub> create_stub();
+  ChatServerClient();
+  ~ChatServerClient();
 
-  std::unique_ptr<ChannelPool> _pool;
+  struct _impl;
+  std::unique_ptr<_impl> _pimpl;
 };
 
 }  // namespace utils
 
-#endif  // CHAT_SERVER_CLIENT_HPP
\ No newline at end of file
+#endif  // CHAT_SERVER_CLIENT_HPP
@@ -1,5 +1,8 @@
 #include "status_server_client.hpp"
 
+#include <chrono>
+#include <global/Global.hpp>
+
 namespace utils
 {
 
@@ -34,6 +37,43 @@ LoginVerifyResult StatusServerClinet::VerifyLoginInfo(const std::string& uuid, c
   return std::unexpected{GrpcError{.code = status.error_code(), .message = status.error_message()}};
 }
 
+void StatusServerClinet::AsyncVerifyLoginInfo(const std::string& uuid, const std::string& token,
+                                              LoginVerifyCallback callback)
+{
+  // context、请求和响应在调用完成前必须保持存活，统一放到堆上，由完成回调持有
+  struct AsyncCall
+  {
+    std::unique_ptr<StatusService::Stub> stub;
+    grpc::ClientContext context;
+    LoginVerifyRequest request;
+    LoginVerifyResponse response;
+    LoginVerifyCallback callback;
+  };
+
+  auto call = std::make_shared<AsyncCall>();
+  call->stub = create_stub();
+  call->request.set_uuid(uuid);
+  call->request.set_token(token);
+  call->callback = std::move(callback);
+
+  // 等待校验期间会话的后续消息被暂存，StatusServer 无响应时需要在有限时间内结束
+  call->context.set_deadline(std::chrono::system_clock::now() +
+                             std::chrono::milliseconds(global::server::STATUS_RPC_TIMEOUT_MS));
+
+  call->stub->async()->LoginVerify(&call->context, &call->request, &call->response,
+                                   [call](const grpc::Status& status)
+                                   {
+                                     if (status.ok())
+                                     {
+                                       call->callback(std::move(call->response));
+                                       return;
+                                     }
+
+                                     call->callback(std::unexpected{
+                                         GrpcError{.code = status.error_code(), .message = status.error_message()}});
+                                   });
+}
+
 std::unique_ptr<StatusService::Stub> StatusServerClinet::create_stub()
 {
   return StatusService::NewStub(_pool->GetChannel());
@@ -18,6 +18,7 @@
 #pragma GCC diagnostic pop
 
 #include <expected>
+#include <functional>
 #include <utils/UtilsExport.hpp>
 #include <utils/grpc/client/grpc_error.hpp>
 #include <utils/pool/channel/channel_pool.hpp>
@@ -28,6 +29,7 @@ namespace utils
 using namespace KBchulan::ChatRoom::StatusServer;
 
 using LoginVerifyResult = std::expected<LoginVerifyResponse, GrpcError>;
+using LoginVerifyCallback = std::function<void(LoginVerifyResult)>;
 
 class UTILS_EXPORT StatusServerClinet
 {
@@ -38,6 +40,9 @@ public:
 
   [[nodiscard]] LoginVerifyResult VerifyLoginInfo(const std::string& uuid, const std::string& token);
 
+  // 异步校验，立即返回，RPC 完成后在 gRPC 内部线程上执行回调，调用方需自行切回业务线程
+  void AsyncVerifyLoginInfo(const std::string& uuid, const std::string& token, LoginVerifyCallback callback);
+
   StatusServerClinet(const StatusServerClinet&) = delete;
   StatusServerClinet& operator=(const StatusServerClinet&) = delete;
   StatusServerClinet(StatusServerClinet&&) = delete;
@@ -1,6 +1,129 @@
 #include "chat_service.hpp"
 
+#include <cstdint>
+#include <mutex>
+#include <utility>
+
 namespace utils
 {
 
-}  // namespace utils
\ No newline at end of file
+namespace
+{
+
+class RelayReactor final : public grpc::ServerBidiReactor<RelayBatch, RelayAck>
+{
+public:
+  // 立即发送初始元数据，发送端据此确认流已建立后才开始写入
+  explicit RelayReactor(const RelayHandler& handler) : _handler(handler)
+  {
+    StartSendInitialMetadata();
+    StartRead(&_batch);
+  }
+
+  void OnReadDone(bool ok) override
+  {
+    if (!ok)
+    {
+      // 对端关闭写方向或连接断开，等待中的确认写完后结束
+      bool finish = false;
+      {
+        std::lock_guard lock{_mutex};
+        _reading_done = true;
+        finish = !_writing;
+      }
+      if (finish)
+      {
+        Finish(grpc::Status::OK);
+      }
+      return;
+    }
+
+    std::uint32_t delivered = 0;
+    for (const auto& frame : _batch.frames())
+    {
+      if (_handler && _handler(frame))
+      {
+        ++delivered;
+      }
+    }
+
+    bool write = false;
+    {
+      std::lock_guard lock{_mutex};
+      _pending.set_seq(_batch.seq());
+      _pending.set_frames(_pending.frames() + static_cast<std::uint32_t>(_batch.frames_size()));
+      _pending.set_delivered(_pending.delivered() + delivered);
+      write = !std::exchange(_writing, true);
+      if (write)
+      {
+        _ack.Swap(&_pending);
+        _pending.Clear();
+      }
+    }
+
+    // 写完成回调可能在本线程上直接执行，不能持锁发起
+    if (write)
+    {
+      StartWrite(&_ack);
+    }
+    StartRead(&_batch);
+  }
+
+  void OnWriteDone(bool ok) override
+  {
+    bool write = false;
+    bool finish = false;
+    {
+      std::lock_guard lock{_mutex};
+      if (ok && _pending.frames() != 0)
+      {
+        _ack.Swap(&_pending);
+        _pending.Clear();
+        write = true;
+      }
+      else
+      {
+        _writing = false;
+        finish = _reading_done;
+      }
+    }
+
+    if (write)
+    {
+      StartWrite(&_ack);
+    }
+    else if (finish)
+    {
+      Finish(grpc::Status::OK);
+    }
+  }
+
+  void OnDone() override
+  {
+    delete this;
+  }
+
+private:
+  const RelayHandler& _handler;
+  RelayBatch _batch;
+  RelayAck _ack;
+
+  // 读写回调可能在不同线程上并发执行，以下成员由 _mutex 保护
+  std::mutex _mutex;
+  RelayAck _pending;
+  bool _writing{false};
+  bool _reading_done{false};
+};
+
+}  // namespace
+
+ChatServiceImpl::ChatServiceImpl(RelayHandler handler) : _handler(std::move(handler))
+{
+}
+
+grpc::ServerBidiReactor<RelayBatch, RelayAck>* ChatServiceImpl::Relay(grpc::CallbackServerContext* /*context*/)
+{
+  return new RelayReactor(_handler);
+}
+
+}  // namespace utils
@@ -5,7 +5,7 @@
  *
  * @author     KBchulan
  * @date       2026/03/02
- * @history
+ * @history    2026/10/18 实现跨服转发的双向流，收到的帧交给注册的处理函数投递
  ******************************************************************************/
 
 #ifndef CHAT_SERVICE_HPP
@@ -17,6 +17,7 @@
 #include <utils/grpc/chat_server/chat_server.pb.h>
 #pragma GCC diagnostic pop
 
+#include <functional>
 #include <utils/UtilsExport.hpp>
 
 namespace utils
@@ -24,13 +25,22 @@ namespace utils
 
 using namespace KBchulan::ChatRoom::ChatServer;
 
-class UTILS_EXPORT ChatServiceImpl final : public ChatService::Service
+// 在 gRPC 内部线程上调用，返回目标用户是否在本服务器在线并已投递
+using RelayHandler = std::function<bool(const RelayFrame& frame)>;
+
+// 基于回调 API，每条转发流一个 reactor，不占用独立线程；批次处理完后回复确认，写确认期间到达的批次合并确认
+class UTILS_EXPORT ChatServiceImpl final : public ChatService::CallbackService
 {
 public:
-  ChatServiceImpl() = default;
+  explicit ChatServiceImpl(RelayHandler handler);
   ~ChatServiceImpl() override = default;
+
+  grpc::ServerBidiReactor<RelayBatch, RelayAck>* Relay(grpc::CallbackServerContext* context) override;
+
+private:
+  RelayHandler _handler;
 };
 
 }  // namespace utils
 
-#endif  // CHAT_SERVICE_HPP
\ No newline at end of file
+#endif  // CHAT_SERVICE_HPP
@@ -0,0 +1,457 @@
+#include "async_db_pool.hpp"
+
+#include <algorithm>
+#include <boost/asio/associated_executor.hpp>
+#include <boost/asio/async_result.hpp>
+#include <boost/asio/posix/stream_descriptor.hpp>
+#include <boost/asio/post.hpp>
+#include <boost/asio/redirect_error.hpp>
+#include <boost/asio/steady_timer.hpp>
+#include <boost/asio/this_coro.hpp>
+#include <boost/asio/use_awaitable.hpp>
+#include <cstring>
+#include <tools/Logger.hpp>
+
+namespace utils
+{
+
+AsyncPooledConnection::AsyncPooledConnection(AsyncDBPool* pool, std::size_t slot) : _pool(pool), _slot(slot)
+{
+}
+
+AsyncPooledConnection::~AsyncPooledConnection()
+{
+  if (_pool != nullptr)
+  {
+    _pool->_slots[_slot]._last_used = std::chrono::steady_clock::now();
+    _pool->ReleaseConnection(_slot);
+  }
+}
+
+AsyncPooledConnection::AsyncPooledConnection(AsyncPooledConnection&& other) noexcept
+    : _pool(other._pool), _slot(other._slot)
+{
+  other._pool = nullptr;
+}
+
+MYSQL* AsyncPooledConnection::GetConnection() const
+{
+  return _pool->_slots[_slot]._conn;
+}
+
+boost::asio::awaitable<bool> AsyncPooledConnection::Execute(const char* sql, const std::vector<ParamHolder>& params)
+{
+  MYSQL_STMT* stmt = co_await prepare_and_execute(sql, params);
+  if (stmt == nullptr)
+  {
+    co_return false;
+  }
+
+  co_await close_stmt(stmt);
+  co_return true;
+}
+
+boost::asio::awaitable<bool> AsyncPooledConnection::QueryOne(const char* sql, const std::vector<ParamHolder>& params,
+                                                             const std::vector<ResultHolder>& results)
+{
+  MYSQL_STMT* stmt = co_await prepare_and_execute(sql, params);
+  if (stmt == nullptr)
+  {
+    co_return false;
+  }
+
+  if (!bind_results(stmt, results))
+  {
+    co_await close_stmt(stmt);
+    co_return false;
+  }
+
+  bool success = (co_await fetch(stmt) == 0);
+  co_await close_stmt(stmt);
+  co_return success;
+}
+
+boost::asio::awaitable<bool> AsyncPooledConnection::Ping()
+{
+  MYSQL* conn = GetConnection();
+  int ret = 0;
+  co_await run([&] { return mysql_ping_start(&ret, conn); },
+               [&](int ready) { return mysql_ping_cont(&ret, conn, ready); });
+  co_return ret == 0;
+}
+
+boost::asio::awaitable<bool> AsyncPooledConnection::Reconnect()
+{
+  auto& slot = _pool->_slots[_slot];
+  const auto& config = _pool->_config;
+
+  if (slot._conn != nullptr)
+  {
+    mysql_close(slot._conn);
+  }
+  slot._conn = AsyncDBPool::create_handle();
+
+  MYSQL* conn = slot._conn;
+  MYSQL* ret = nullptr;
+  co_await run(
+      [&]
+      {
+        return mysql_real_connect_start(&ret, conn, config.host.c_str(), config.user.c_str(), config.password.c_str(),
+                                        config.database.c_str(), config.port, nullptr, 0);
+      },
+      [&](int ready) { return mysql_real_connect_cont(&ret, conn, ready); });
+
+  if (ret == nullptr)
+  {
+    tools::Logger::getInstance().error("mariadb reconnect failed: {}", mysql_error(conn));
+    co_return false;
+  }
+
+  co_return true;
+}
+
+boost::asio::awaitable<int> AsyncPooledConnection::wait_for(int status)
+{
+  auto executor = co_await boost::asio::this_coro::executor;
+  MYSQL* conn = GetConnection();
+
+  // 只剩超时事件时用定时器等待，否则等 socket 就绪
+  if ((status & (MYSQL_WAIT_READ | MYSQL_WAIT_WRITE)) == 0)
+  {
+    boost::asio::steady_timer timer(executor, std::chrono::milliseconds(mysql_get_timeout_value_ms(conn)));
+    co_await timer.async_wait(boost::asio::use_awaitable);
+    co_return MYSQL_WAIT_TIMEOUT;
+  }
+
+  // 连接 socket 归 MariaDB 所有，这里只借用 fd 注册到当前线程的 reactor，析构时交还而不是关闭
+  struct BorrowedSocket
+  {
+    boost::asio::posix::stream_descriptor _descriptor;
+
+    ~BorrowedSocket()
+    {
+      _descriptor.release();
+    }
+  } socket{boost::asio::posix::stream_descriptor(executor, mysql_get_socket(conn))};
+
+  // 读、写、超时三者并发等待，先完成的一个取消其余，全部回调结束后再返回，局部对象才能安全析构
+  // io_context 每个只由一个线程驱动，回调与本协程串行执行，无需加锁
+  boost::asio::steady_timer timeout(executor);
+  boost::asio::steady_timer done(executor, boost::asio::steady_timer::time_point::max());
+  int ready = 0;
+  int pending = 0;
+  bool fired = false;
+
+  auto on_complete = [&](int event)
+  {
+    return [&, event](const boost::system::error_code& errc)
+    {
+      if (!errc)
+      {
+        ready |= event;
+      }
+      else if (errc != boost::asio::error::operation_aborted)
+      {
+        // 交给 MariaDB 读写 socket，由它报告具体的错误
+        tools::Logger::getInstance().error("mariadb socket wait failed: {}", errc.message());
+        ready |= MYSQL_WAIT_EXCEPT;
+      }
+
+      if (!fired)
+      {
+        fired = true;
+        socket._descriptor.cancel();
+        timeout.cancel();
+      }
+      if (--pending == 0)
+      {
+        done.cancel();
+      }
+    };
+  };
+
+  if ((status & MYSQL_WAIT_READ) != 0)
+  {
+    ++pending;
+    socket._descriptor.async_wait(boost::asio::posix::descriptor_base::wait_read, on_complete(MYSQL_WAIT_READ));
+  }
+  if ((status & MYSQL_WAIT_WRITE) != 0)
+  {
+    ++pending;
+    socket._descriptor.async_wait(boost::asio::posix::descriptor_base::wait_write, on_complete(MYSQL_WAIT_WRITE));
+  }
+  if ((status & MYSQL_WAIT_TIMEOUT) != 0)
+  {
+    ++pending;
+    timeout.expires_after(std::chrono::milliseconds(mysql_get_timeout_value_ms(conn)));
+    timeout.async_wait(on_complete(MYSQL_WAIT_TIMEOUT));
+  }
+
+  boost::system::error_code ignored;
+  co_await done.async_wait(boost::asio::redirect_error(boost::asio::use_awaitable, ignored));
+
+  // 定时器到期与 socket 就绪落在同一轮时以 socket 为准，避免 MariaDB 把一次正常的读写当成超时
+  if ((ready & (MYSQL_WAIT_READ | MYSQL_WAIT_WRITE)) != 0)
+  {
+    ready &= ~MYSQL_WAIT_TIMEOUT;
+  }
+  co_return ready;
+}
+
+boost::asio::awaitable<MYSQL_STMT*> AsyncPooledConnection::prepare_and_execute(const char* sql,
+                                                                              const std::vector<ParamHolder>& params)
+{
+  MYSQL* conn = GetConnection();
+  MYSQL_STMT* stmt = mysql_stmt_init(conn);
+  if (stmt == nullptr)
+  {
+    tools::Logger::getInstance().error("mysql_stmt_init failed: {}", mysql_error(conn));
+    co_return nullptr;
+  }
+
+  int ret = 0;
+  auto len = std::strlen(sql);
+  co_await run([&] { return mysql_stmt_prepare_start(&ret, stmt, sql, len); },
+               [&](int ready) { return mysql_stmt_prepare_cont(&ret, stmt, ready); });
+  if (ret != 0)
+  {
+    tools::Logger::getInstance().error("mysql_stmt_prepare failed: {}", mysql_stmt_error(stmt));
+    co_await close_stmt(stmt);
+    co_return nullptr;
+  }
+
+  // 提取 MYSQL_BIND 数组
+  if (!params.empty())
+  {
+    std::vector<MYSQL_BIND> binds(params.size());
+    std::ranges::transform(params, binds.begin(), [](const ParamHolder& holder) { return holder.bind; });
+
+    if (mysql_stmt_bind_param(stmt, binds.data()) != 0)
+    {
+      tools::Logger::getInstance().error("mysql_stmt_bind_param failed: {}", mysql_stmt_error(stmt));
+      co_await close_stmt(stmt);
+      co_return nullptr;
+    }
+  }
+
+  co_await run([&] { return mysql_stmt_execute_start(&ret, stmt); },
+               [&](int ready) { return mysql_stmt_execute_cont(&ret, stmt, ready); });
+  if (ret != 0)
+  {
+    tools::Logger::getInstance().error("mysql_stmt_execute failed: {}", mysql_stmt_error(stmt));
+    co_await close_stmt(stmt);
+    co_return nullptr;
+  }
+
+  co_return stmt;
+}
+
+bool AsyncPooledConnection::bind_results(MYSQL_STMT* stmt, const std::vector<ResultHolder>& results)
+{
+  if (results.empty())
+  {
+    return true;
+  }
+
+  std::vector<MYSQL_BIND> binds(results.size());
+  std::ranges::transform(results, binds.begin(), [](const ResultHolder& holder) { return holder.bind; });
+
+  if (mysql_stmt_bind_result(stmt, binds.data()) != 0)
+  {
+    tools::Logger::getInstance().error("mysql_stmt_bind_result failed: {}", mysql_stmt_error(stmt));
+    return false;
+  }
+  return true;
+}
+
+boost::asio::awaitable<int> AsyncPooledConnection::fetch(MYSQL_STMT* stmt)
+{
+  int ret = 0;
+  co_await run([&] { return mysql_stmt_fetch_start(&ret, stmt); },
+               [&](int ready) { return mysql_stmt_fetch_cont(&ret, stmt, ready); });
+  co_return ret;
+}
+
+bool AsyncPooledConnection::complete_row(MYSQL_STMT* stmt, int status, const std::vector<ResultHolder>& results)
+{
+  if (status == 0)
+  {
+    return true;
+  }
+  if (status != MYSQL_DATA_TRUNCATED)
+  {
+    tools::Logger::getInstance().error("mysql_stmt_fetch failed: {}", mysql_stmt_error(stmt));
+    return false;
+  }
+
+  // 截断时 length 中是列的实际长度，整行已在客户端缓冲中，重新读取不经过网络
+  for (unsigned int column = 0; column < results.size(); ++column)
+  {
+    const auto& holder = results[column];
+    if (holder.bind.length == nullptr || *holder.bind.length <= holder.bind.buffer_length)
+    {
+      continue;
+    }
+    if (holder.overflow == nullptr)
+    {
+      tools::Logger::getInstance().error("Column {} truncated to {} of {} bytes", column, holder.bind.buffer_length,
+                                         *holder.bind.length);
+      return false;
+    }
+
+    unsigned long length = 0;
+    my_bool error = 0;
+    holder.overflow->resize(*holder.bind.length);
+
+    MYSQL_BIND full{};
+    full.buffer_type = holder.bind.buffer_type;
+    full.buffer = holder.overflow->data();
+    full.buffer_length = *holder.bind.length;
+    full.length = &length;
+    full.error = &error;
+    if (mysql_stmt_fetch_column(stmt, &full, column, 0) != 0)
+    {
+      tools::Logger::getInstance().error("mysql_stmt_fetch_column failed for column {}: {}", column,
+                                         mysql_stmt_error(stmt));
+      return false;
+    }
+  }
+  return true;
+}
+
+boost::asio::awaitable<void> AsyncPooledConnection::close_stmt(MYSQL_STMT* stmt)
+{
+  if (stmt == nullptr)
+  {
+    co_return;
+  }
+
+  my_bool ret = 0;
+  co_await run([&] { return mysql_stmt_close_start(&ret, stmt); },
+               [&](int ready) { return mysql_stmt_close_cont(&ret, stmt, ready); });
+}
+
+AsyncDBPool& AsyncDBPool::GetInstance()
+{
+  static AsyncDBPool instance;
+  return instance;
+}
+
+void AsyncDBPool::Init(const DBConfig& config)
+{
+  _config = config;
+  _slots.resize(config.pool_size);
+  _free.reserve(config.pool_size);
+
+  for (std::size_t i = 0; i < config.pool_size; ++i)
+  {
+    // 开启非阻塞选项后仍可以使用阻塞 API，启动阶段直接同步连接
+    MYSQL* conn = create_handle();
+    if (mysql_real_connect(conn, _config.host.c_str(), _config.user.c_str(), _config.password.c_str(),
+                           _config.database.c_str(), _config.port, nullptr, 0) == nullptr)
+    {
+      std::string err_msg = mysql_error(conn);
+      mysql_close(conn);
+      throw std::runtime_error("Failed to connect to MySQL: " + err_msg);
+    }
+
+    _slots[i]._conn = conn;
+    _slots[i]._last_used = std::chrono::steady_clock::now();
+    _free.push_back(i);
+  }
+
+  tools::Logger::getInstance().info("async mariadb pool init successful");
+}
+
+boost::asio::awaitable<AsyncPooledConnection> AsyncDBPool::GetConnection()
+{
+  auto slot = co_await acquire_slot();
+  AsyncPooledConnection conn{this, slot};
+
+  // 长时间空闲的连接可能已被服务端断开，先探活，失败则重连
+  auto idle = std::chrono::steady_clock::now() - _slots[slot]._last_used;
+  if (idle > std::chrono::seconds(global::server::DB_ASYNC_IDLE_PING_S) && !co_await conn.Ping())
+  {
+    co_await conn.Reconnect();
+  }
+
+  co_return conn;
+}
+
+void AsyncDBPool::ReleaseConnection(std::size_t slot)
+{
+  std::unique_lock lock(_mutex);
+  if (_waiters.empty())
+  {
+    _free.push_back(slot);
+    return;
+  }
+
+  auto waiter = std::move(_waiters.front());
+  _waiters.pop_front();
+  lock.unlock();
+
+  waiter(slot);
+}
+
+boost::asio::awaitable<std::size_t> AsyncDBPool::acquire_slot()
+{
+  return boost::asio::async_initiate<const boost::asio::use_awaitable_t<>&, void(std::size_t)>(
+      [this](auto handler)
+      {
+        // 恢复协程的动作总是 post 到它自己的 executor 上，不在释放连接的线程里直接执行
+        auto resume = [handler = std::move(handler)](std::size_t slot) mutable
+        {
+          auto executor = boost::asio::get_associated_executor(handler);
+          boost::asio::post(executor, [handler = std::move(handler), slot]() mutable { std::move(handler)(slot); });
+        };
+
+        std::unique_lock lock(_mutex);
+        if (_free.empty())
+        {
+          _waiters.emplace_back(std::move(resume));
+          return;
+        }
+
+        auto slot = _free.back();
+        _free.pop_back();
+        lock.unlock();
+
+        resume(slot);
+      },
+      boost::asio::use_awaitable);
+}
+
+AsyncDBPool::AsyncDBPool() = default;
+
+AsyncDBPool::~AsyncDBPool()
+{
+  for (auto& slot : _slots)
+  {
+    if (slot._conn != nullptr)
+    {
+      mysql_close(slot._conn);
+    }
+  }
+
+  tools::Logger::getInstance().info("async mariadb pool closed");
+}
+
+MYSQL* AsyncDBPool::create_handle()
+{
+  MYSQL* conn = mysql_init(nullptr);
+  if (conn == nullptr)
+  {
+    throw std::runtime_error("Failed to initialize MySQL connection");
+  }
+
+  unsigned int timeout = 5;
+  mysql_options(conn, MYSQL_OPT_CONNECT_TIMEOUT, &timeout);
+  mysql_options(conn, MYSQL_OPT_NONBLOCK, nullptr);
+
+  // 字符集在握手时协商，连接建立后再调 mysql_set_character_set 会在 io 线程上阻塞一次往返
+  mysql_options(conn, MYSQL_SET_CHARSET_NAME, "utf8mb4");
+  return conn;
+}
+
+}  // namespace utils
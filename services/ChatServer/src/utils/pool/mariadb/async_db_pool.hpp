@@ -0,0 +1,168 @@
+/******************************************************************************
+ *
+ * @file       async_db_pool.hpp
+ * @brief      基于 MariaDB 非阻塞 API 的协程连接池
+ *
+ * @author     KBchulan
+ * @date       2026/10/18
+ * @history    mysql_*_start / mysql_*_cont 由 io_context 驱动，查询等待期间不占用线程
+ *             2026/10/18 QueryMany 按实际长度重新读取截断的列，查询或取行失败时返回 std::nullopt
+ ******************************************************************************/
+
+#ifndef ASYNC_DB_POOL_HPP
+#define ASYNC_DB_POOL_HPP
+
+#include <boost/asio/awaitable.hpp>
+#include <chrono>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <utils/pool/mariadb/db_params.hpp>
+#include <utils/pool/mariadb/db_pool.hpp>
+#include <vector>
+
+namespace utils
+{
+
+class AsyncDBPool;
+
+// 协程版本的连接，接口与 PooledConnection 一致，只能在 io_context 线程上 co_await
+class UTILS_EXPORT AsyncPooledConnection
+{
+public:
+  AsyncPooledConnection(AsyncDBPool* pool, std::size_t slot);
+
+  ~AsyncPooledConnection();
+
+  [[nodiscard]] MYSQL* GetConnection() const;
+
+  // 执行 SQL 语句 (INSERT/UPDATE/DELETE)
+  boost::asio::awaitable<bool> Execute(const char* sql, const std::vector<ParamHolder>& params);
+
+  // 查询单行 (SELECT ... LIMIT 1)，成功返回 true
+  boost::asio::awaitable<bool> QueryOne(const char* sql, const std::vector<ParamHolder>& params,
+                                        const std::vector<ResultHolder>& results);
+
+  // 查询多行，每取到一行调用一次 callback，返回行数；查询失败、取行出错或截断的列无法重新读取时返回 std::nullopt，
+  // 此前已经取到的行仍会交给 callback
+  template <typename Callback>
+  boost::asio::awaitable<std::optional<std::size_t>> QueryMany(const char* sql, const std::vector<ParamHolder>& params,
+                                                               const std::vector<ResultHolder>& results,
+                                                               Callback callback)
+  {
+    MYSQL_STMT* stmt = co_await prepare_and_execute(sql, params);
+    if (stmt == nullptr || !bind_results(stmt, results))
+    {
+      co_await close_stmt(stmt);
+      co_return std::nullopt;
+    }
+
+    std::optional<std::size_t> count{0};
+    int status = 0;
+    while ((status = co_await fetch(stmt)) != MYSQL_NO_DATA)
+    {
+      if (!complete_row(stmt, status, results))
+      {
+        count.reset();
+        break;
+      }
+      callback();
+      ++*count;
+    }
+
+    co_await close_stmt(stmt);
+    co_return count;
+  }
+
+  // 检测连接是否可用
+  boost::asio::awaitable<bool> Ping();
+
+  // 关闭旧连接并重新建立
+  boost::asio::awaitable<bool> Reconnect();
+
+  AsyncPooledConnection(const AsyncPooledConnection&) = delete;
+  AsyncPooledConnection& operator=(const AsyncPooledConnection&) = delete;
+  AsyncPooledConnection(AsyncPooledConnection&& other) noexcept;
+  AsyncPooledConnection& operator=(AsyncPooledConnection&&) noexcept = delete;
+
+private:
+  // 驱动一次非阻塞调用：start 返回需要等待的事件，事件就绪后交给 cont 继续，直到返回 0
+  template <typename Start, typename Cont>
+  boost::asio::awaitable<void> run(Start start, Cont cont)
+  {
+    int status = start();
+    while (status != 0)
+    {
+      status = cont(co_await wait_for(status));
+    }
+  }
+
+  // 等待 status 中要求的 socket 事件或超时，返回实际发生的事件
+  boost::asio::awaitable<int> wait_for(int status);
+
+  // prepare + bind_param + execute，任意一步失败都会关闭 stmt 并返回 nullptr
+  boost::asio::awaitable<MYSQL_STMT*> prepare_and_execute(const char* sql, const std::vector<ParamHolder>& params);
+
+  static bool bind_results(MYSQL_STMT* stmt, const std::vector<ResultHolder>& results);
+
+  boost::asio::awaitable<int> fetch(MYSQL_STMT* stmt);
+
+  // 取行结果为 MYSQL_DATA_TRUNCATED 时，把超出 buffer 的列按实际长度重新读取到 overflow，返回该行是否可用
+  static bool complete_row(MYSQL_STMT* stmt, int status, const std::vector<ResultHolder>& results);
+
+  boost::asio::awaitable<void> close_stmt(MYSQL_STMT* stmt);
+
+  AsyncDBPool* _pool;
+  std::size_t _slot;
+};
+
+class UTILS_EXPORT AsyncDBPool
+{
+  struct Slot
+  {
+    MYSQL* _conn = nullptr;
+    std::chrono::steady_clock::time_point _last_used;
+  };
+
+  using Waiter = std::move_only_function<void(std::size_t)>;
+
+public:
+  static AsyncDBPool& GetInstance();
+
+  // 同步建立全部连接，与 DBPool::Init 一致，在启动阶段调用
+  void Init(const DBConfig& config);
+
+  // 没有空闲连接时挂起当前协程，不阻塞线程
+  [[nodiscard]] boost::asio::awaitable<AsyncPooledConnection> GetConnection();
+
+  void ReleaseConnection(std::size_t slot);
+
+  AsyncDBPool(const AsyncDBPool&) = delete;
+  AsyncDBPool& operator=(const AsyncDBPool&) = delete;
+  AsyncDBPool(AsyncDBPool&&) = delete;
+  AsyncDBPool& operator=(AsyncDBPool&&) = delete;
+
+private:
+  friend class AsyncPooledConnection;
+
+  AsyncDBPool();
+  ~AsyncDBPool();
+
+  [[nodiscard]] boost::asio::awaitable<std::size_t> acquire_slot();
+
+  // 创建开启 MYSQL_OPT_NONBLOCK、指定 utf8mb4 字符集的句柄，尚未连接
+  [[nodiscard]] static MYSQL* create_handle();
+
+  DBConfig _config{};
+  std::vector<Slot> _slots;
+
+  std::mutex _mutex;
+  std::vector<std::size_t> _free;  // 空闲槽位
+  std::deque<Waiter> _waiters;     // 等待连接的协程，释放时直接把槽位交给队首
+};
+
+}  // namespace utils
+
+#endif  // ASYNC_DB_POOL_HPP
@@ -79,9 +79,25 @@ struct UTILS_EXPORT StringBuffer
   }
 };
 
+// 长度不定的字符串，常见长度放进 N 字节的 buffer；超出时取行报告截断，
+// 由 AsyncPooledConnection::QueryMany 按实际长度把整列重新读取到 overflow
+template <std::size_t N>
+struct UTILS_EXPORT VarStringBuffer
+{
+  std::array<char, N> data{};
+  unsigned long length{0};
+  std::string overflow;
+
+  [[nodiscard]] std::string str() const
+  {
+    return length <= N ? std::string(data.data(), length) : overflow;
+  }
+};
+
 struct UTILS_EXPORT ResultHolder
 {
   MYSQL_BIND bind{};
+  std::string* overflow{nullptr};  // 非空时该列截断后重新读取到这里
 };
 
 // 字符串 buffer
@@ -96,6 +112,18 @@ ResultHolder MakeResultBind(StringBuffer<N>& buf)
   return holder;
 }
 
+template <std::size_t N>
+ResultHolder MakeResultBind(VarStringBuffer<N>& buf)
+{
+  ResultHolder holder;
+  holder.bind.buffer_type = MYSQL_TYPE_STRING;
+  holder.bind.buffer = buf.data.data();
+  holder.bind.buffer_length = N;
+  holder.bind.length = &buf.length;
+  holder.overflow = &buf.overflow;
+  return holder;
+}
+
 // 有符号整数类型
 ResultHolder MakeResultBind(std::int8_t& value);
 ResultHolder MakeResultBind(std::int16_t& value);
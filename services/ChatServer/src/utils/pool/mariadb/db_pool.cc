@@ -25,15 +25,18 @@ MYSQL* PooledConnection::GetConnection() const
 
 bool PooledConnection::Execute(const char* sql, const std::vector<ParamHolder>& params)
 {
+  _last_errno = 0;
   MYSQL_STMT* stmt = mysql_stmt_init(_conn);
   if (stmt == nullptr)
   {
+    _last_errno = mysql_errno(_conn);
     tools::Logger::getInstance().error("mysql_stmt_init failed: {}", mysql_error(_conn));
     return false;
   }
 
   if (mysql_stmt_prepare(stmt, sql, std::strlen(sql)) != 0)
   {
+    _last_errno = mysql_stmt_errno(stmt);
     tools::Logger::getInstance().error("mysql_stmt_prepare failed: {}", mysql_stmt_error(stmt));
     mysql_stmt_close(stmt);
     return false;
@@ -47,6 +50,7 @@ bool PooledConnection::Execute(const char* sql, const std::vector<ParamHolder>&
 
     if (mysql_stmt_bind_param(stmt, binds.data()) != 0)
     {
+      _last_errno = mysql_stmt_errno(stmt);
       tools::Logger::getInstance().error("mysql_stmt_bind_param failed: {}", mysql_stmt_error(stmt));
       mysql_stmt_close(stmt);
       return false;
@@ -56,12 +60,18 @@ bool PooledConnection::Execute(const char* sql, const std::vector<ParamHolder>&
   int result = mysql_stmt_execute(stmt);
   if (result != 0)
   {
+    _last_errno = mysql_stmt_errno(stmt);
     tools::Logger::getInstance().error("mysql_stmt_execute failed: {}", mysql_stmt_error(stmt));
   }
   mysql_stmt_close(stmt);
   return result == 0;
 }
 
+unsigned int PooledConnection::GetLastErrno() const
+{
+  return _last_errno;
+}
+
 bool PooledConnection::QueryOne(const char* sql, const std::vector<ParamHolder>& params,
                                 const std::vector<ResultHolder>& results)
 {
@@ -184,7 +194,7 @@ std::size_t PooledConnection::QueryMany(const char* sql, const std::vector<Param
 }
 
 PooledConnection::PooledConnection(PooledConnection&& other) noexcept
-    : _conn(other._conn), _pool(other._pool), _slot(other._slot)
+    : _conn(other._conn), _pool(other._pool), _slot(other._slot), _last_errno(other._last_errno)
 {
   other._conn = nullptr;
 }
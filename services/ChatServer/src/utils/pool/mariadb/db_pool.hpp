@@ -42,6 +42,9 @@ public:
   // 执行 SQL 语句 (INSERT/UPDATE/DELETE)
   bool Execute(const char* sql, const std::vector<ParamHolder>& params);
 
+  // 最近一次 Execute 失败时的错误码，成功时为 0，用于区分主键冲突等不应重试的失败
+  [[nodiscard]] unsigned int GetLastErrno() const;
+
   // 查询单行 (SELECT ... LIMIT 1)，成功返回 true
   bool QueryOne(const char* sql, const std::vector<ParamHolder>& params, const std::vector<ResultHolder>& results);
 
@@ -59,6 +62,7 @@ private:
   MYSQL* _conn;
   DBPool* _pool;
   std::size_t _slot;
+  unsigned int _last_errno{0};
 };
 
 class UTILS_EXPORT DBPool
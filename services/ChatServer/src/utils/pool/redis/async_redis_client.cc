@@ -0,0 +1,773 @@
+#include "async_redis_client.hpp"
+
+#include <array>
+#include <boost/asio/associated_executor.hpp>
+#include <boost/asio/async_result.hpp>
+#include <boost/asio/co_spawn.hpp>
+#include <boost/asio/connect.hpp>
+#include <boost/asio/detached.hpp>
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/asio/post.hpp>
+#include <boost/asio/steady_timer.hpp>
+#include <boost/asio/strand.hpp>
+#include <boost/asio/use_awaitable.hpp>
+#include <boost/asio/write.hpp>
+#include <chrono>
+#include <cstdarg>
+#include <deque>
+#include <functional>
+#include <initializer_list>
+#include <string_view>
+#include <tools/Logger.hpp>
+
+namespace utils
+{
+
+namespace
+{
+
+constexpr std::size_t READ_BUFFER_SIZE = 16384;  // 单次从 socket 读取的最大字节数
+
+std::string vformat_command(const char* format, va_list args)
+{
+  char* command = nullptr;
+  int len = redisvFormatCommand(&command, format, args);
+  if (len < 0)
+  {
+    return {};
+  }
+
+  std::string result(command, static_cast<std::size_t>(len));
+  redisFreeCommand(command);
+  return result;
+}
+
+std::string format_command(const char* format, ...)
+{
+  va_list app;
+  va_start(app, format);
+  auto command = vformat_command(format, app);
+  va_end(app);
+  return command;
+}
+
+// head 与 args 依次拼接为参数列表，用于参数个数不定的命令
+std::string format_argv(std::initializer_list<std::string_view> head, const std::vector<std::string>& args)
+{
+  std::vector<const char*> argv;
+  std::vector<std::size_t> argvlen;
+  argv.reserve(head.size() + args.size());
+  argvlen.reserve(head.size() + args.size());
+
+  for (const auto& arg : head)
+  {
+    argv.push_back(arg.data());
+    argvlen.push_back(arg.size());
+  }
+  for (const auto& arg : args)
+  {
+    argv.push_back(arg.data());
+    argvlen.push_back(arg.size());
+  }
+
+  char* command = nullptr;
+  auto len = redisFormatCommandArgv(&command, static_cast<int>(argv.size()), argv.data(), argvlen.data());
+  if (len < 0)
+  {
+    return {};
+  }
+
+  std::string result(command, static_cast<std::size_t>(len));
+  redisFreeCommand(command);
+  return result;
+}
+
+std::vector<RedisReply> failed_replies(std::size_t count)
+{
+  std::vector<RedisReply> replies;
+  replies.reserve(count);
+  for (std::size_t i = 0; i < count; ++i)
+  {
+    replies.emplace_back(nullptr);
+  }
+  return replies;
+}
+
+}  // namespace
+
+// ============================================================================
+// Connection 实现
+// ============================================================================
+
+// 单条连接，所有成员只在 _strand 上访问；命令追加到 _outbox 由一个写协程批量写出，
+// 回复由读协程按 FIFO 顺序交给 _pending 队首，RESP 协议保证回复顺序与命令顺序一致
+struct AsyncRedisClient::Connection : std::enable_shared_from_this<Connection>
+{
+  using Handler = std::move_only_function<void(std::vector<RedisReply>)>;
+
+  struct Pending
+  {
+    std::size_t _count;
+    std::vector<RedisReply> _replies;
+    Handler _handler;
+  };
+
+  boost::asio::strand<boost::asio::any_io_executor> _strand;
+  boost::asio::ip::tcp::socket _socket;
+  RedisConfig _config;
+  redisReader* _reader = nullptr;
+  std::array<char, READ_BUFFER_SIZE> _read_buffer{};
+
+  std::string _outbox;   // 等待写出的命令
+  std::string _writing;  // 正在写出的命令
+  bool _flushing = false;
+  std::deque<Pending> _pending;
+
+  std::atomic<bool> _connected{false};
+
+  // 订阅连接只接收推送，不承载命令，也不放入 _connections
+  std::string _channel;
+  MessageHandler _on_message;
+  std::function<void()> _on_subscribed;
+
+  Connection(const boost::asio::any_io_executor& executor, RedisConfig config)
+      : _strand(boost::asio::make_strand(executor)), _socket(_strand), _config(std::move(config))
+  {
+  }
+
+  ~Connection()
+  {
+    if (_reader != nullptr)
+    {
+      redisReaderFree(_reader);
+    }
+  }
+
+  Connection(const Connection&) = delete;
+  Connection& operator=(const Connection&) = delete;
+  Connection(Connection&&) = delete;
+  Connection& operator=(Connection&&) = delete;
+
+  void submit(std::string commands, std::size_t count, Handler handler)
+  {
+    if (!_connected.load(std::memory_order_relaxed))
+    {
+      handler(failed_replies(count));
+      return;
+    }
+
+    _outbox.append(commands);
+    auto& pending = _pending.emplace_back(Pending{._count = count, ._replies = {}, ._handler = std::move(handler)});
+    pending._replies.reserve(count);
+
+    // 写协程运行期间到达的命令会在它的下一轮中一起写出
+    if (!_flushing)
+    {
+      _flushing = true;
+      boost::asio::co_spawn(_strand, flush(shared_from_this()), boost::asio::detached);
+    }
+  }
+
+  static boost::asio::awaitable<void> flush(std::shared_ptr<Connection> self)
+  {
+    while (!self->_outbox.empty())
+    {
+      std::swap(self->_writing, self->_outbox);
+      try
+      {
+        co_await boost::asio::async_write(self->_socket, boost::asio::buffer(self->_writing),
+                                          boost::asio::use_awaitable);
+      }
+      catch (const boost::system::system_error& errc)
+      {
+        // 关闭 socket 让读协程退出，由它统一处理在途命令
+        tools::Logger::getInstance().error("redis write failed: {}", errc.what());
+        self->_writing.clear();
+        self->_outbox.clear();
+        boost::system::error_code ignored;
+        self->_socket.close(ignored);
+        break;
+      }
+      self->_writing.clear();
+    }
+    self->_flushing = false;
+  }
+
+  // 连接的整个生命周期：建连、读回复，断开后清理并定时重连
+  static boost::asio::awaitable<void> run(std::shared_ptr<Connection> self)
+  {
+    boost::asio::steady_timer timer(self->_strand);
+    while (true)
+    {
+      if (co_await self->connect())
+      {
+        self->_connected.store(true, std::memory_order_release);
+        tools::Logger::getInstance().info("async redis connected to {}:{}", self->_config.host, self->_config.port);
+
+        if (self->_on_message)
+        {
+          co_await self->subscribe_loop();
+        }
+        else
+        {
+          co_await self->read_loop();
+        }
+
+        self->_connected.store(false, std::memory_order_release);
+        self->fail_all();
+      }
+
+      timer.expires_after(std::chrono::milliseconds(global::server::REDIS_ASYNC_RECONNECT_MS));
+      co_await timer.async_wait(boost::asio::use_awaitable);
+    }
+  }
+
+  boost::asio::awaitable<bool> connect()
+  {
+    try
+    {
+      boost::asio::ip::tcp::resolver resolver(_strand);
+      auto endpoints = co_await resolver.async_resolve(_config.host, std::to_string(_config.port),
+                                                       boost::asio::use_awaitable);
+      co_await boost::asio::async_connect(_socket, endpoints, boost::asio::use_awaitable);
+      _socket.set_option(boost::asio::ip::tcp::no_delay(true));
+    }
+    catch (const boost::system::system_error& errc)
+    {
+      tools::Logger::getInstance().error("async redis connect failed: {}", errc.what());
+      boost::system::error_code ignored;
+      _socket.close(ignored);
+      co_return false;
+    }
+
+    // 丢弃上一条连接残留的半个回复
+    if (_reader != nullptr)
+    {
+      redisReaderFree(_reader);
+    }
+    _reader = redisReaderCreate();
+
+    if (!_config.password.empty() && !co_await handshake(format_command("AUTH %s", _config.password.c_str())))
+    {
+      tools::Logger::getInstance().error("async redis authenticate failed");
+      co_return false;
+    }
+
+    if (_config.db_index != 0 &&
+        !co_await handshake(format_command("SELECT %lld", static_cast<long long>(_config.db_index))))
+    {
+      tools::Logger::getInstance().error("async redis select database failed");
+      co_return false;
+    }
+
+    co_return true;
+  }
+
+  // 建连阶段还没有其他命令在途，直接写出并读取一条回复
+  boost::asio::awaitable<bool> handshake(std::string command)
+  {
+    try
+    {
+      co_await boost::asio::async_write(_socket, boost::asio::buffer(command), boost::asio::use_awaitable);
+    }
+    catch (const boost::system::system_error& errc)
+    {
+      tools::Logger::getInstance().error("redis write failed: {}", errc.what());
+      boost::system::error_code ignored;
+      _socket.close(ignored);
+      co_return false;
+    }
+
+    RedisReply reply(co_await read_reply());
+    if (!reply.IsValid() || reply.IsError())
+    {
+      boost::system::error_code ignored;
+      _socket.close(ignored);
+      co_return false;
+    }
+    co_return true;
+  }
+
+  // 读取下一条完整回复，连接出错或协议错误时返回 nullptr
+  boost::asio::awaitable<redisReply*> read_reply()
+  {
+    while (true)
+    {
+      void* reply = nullptr;
+      if (redisReaderGetReply(_reader, &reply) != REDIS_OK)
+      {
+        tools::Logger::getInstance().error("redis protocol error");
+        co_return nullptr;
+      }
+      if (reply != nullptr)
+      {
+        co_return static_cast<redisReply*>(reply);
+      }
+
+      std::size_t bytes = 0;
+      try
+      {
+        bytes = co_await _socket.async_read_some(boost::asio::buffer(_read_buffer), boost::asio::use_awaitable);
+      }
+      catch (const boost::system::system_error& errc)
+      {
+        tools::Logger::getInstance().error("redis read failed: {}", errc.what());
+        co_return nullptr;
+      }
+      redisReaderFeed(_reader, _read_buffer.data(), bytes);
+    }
+  }
+
+  boost::asio::awaitable<void> read_loop()
+  {
+    while (true)
+    {
+      auto* reply = co_await read_reply();
+      if (reply == nullptr)
+      {
+        co_return;
+      }
+
+      if (_pending.empty())
+      {
+        tools::Logger::getInstance().error("unexpected redis reply without pending command");
+        freeReplyObject(reply);
+        co_return;
+      }
+
+      auto& front = _pending.front();
+      front._replies.emplace_back(reply);
+      if (front._replies.size() == front._count)
+      {
+        auto done = std::move(front);
+        _pending.pop_front();
+        done._handler(std::move(done._replies));
+      }
+    }
+  }
+
+  // 订阅确认同样是一条普通回复，之后只会收到 ["message", channel, payload] 形式的推送
+  boost::asio::awaitable<void> subscribe_loop()
+  {
+    if (!co_await handshake(format_command("SUBSCRIBE %b", _channel.data(), _channel.size())))
+    {
+      tools::Logger::getInstance().error("async redis subscribe {} failed", _channel);
+      co_return;
+    }
+    tools::Logger::getInstance().info("async redis subscribed to {}", _channel);
+    _on_subscribed();
+
+    while (true)
+    {
+      RedisReply reply(co_await read_reply());
+      if (!reply.IsValid())
+      {
+        co_return;
+      }
+
+      const auto* raw = reply.GetReply();
+      if (raw->type == REDIS_REPLY_ARRAY && raw->elements == 3 && raw->element[2]->type == REDIS_REPLY_STRING &&
+          std::string_view{raw->element[0]->str, raw->element[0]->len} == "message")
+      {
+        _on_message(std::string_view{raw->element[2]->str, raw->element[2]->len});
+      }
+    }
+  }
+
+  // 断开后所有在途命令以无效回复完成，已经收到的回复照常返回
+  void fail_all()
+  {
+    boost::system::error_code ignored;
+    _socket.close(ignored);
+    _outbox.clear();
+
+    auto pending = std::move(_pending);
+    _pending.clear();
+    for (auto& entry : pending)
+    {
+      while (entry._replies.size() < entry._count)
+      {
+        entry._replies.emplace_back(nullptr);
+      }
+      entry._handler(std::move(entry._replies));
+    }
+
+    if (!pending.empty())
+    {
+      tools::Logger::getInstance().error("async redis disconnected, {} pending commands failed", pending.size());
+    }
+  }
+};
+
+// ============================================================================
+// AsyncPipeLine 实现
+// ============================================================================
+
+AsyncPipeLine::AsyncPipeLine(AsyncRedisClient* client) : _client(client), _command_count(0), _format_failed(false)
+{
+}
+
+AsyncPipeLine& AsyncPipeLine::Append(const char* format, ...)
+{
+  va_list app;
+  va_start(app, format);
+  auto command = vformat_command(format, app);
+  va_end(app);
+
+  // 序列化失败的命令不会写出，若仍计数，连接会多等一条回复并取走下一个调用方的回复
+  if (command.empty())
+  {
+    tools::Logger::getInstance().error("Failed to format redis command: {}", format);
+    _format_failed = true;
+  }
+  _commands.append(command);
+  ++_command_count;
+  return *this;
+}
+
+boost::asio::awaitable<std::vector<RedisReply>> AsyncPipeLine::Execute()
+{
+  auto count = std::exchange(_command_count, 0);
+  auto commands = std::exchange(_commands, {});
+
+  // 有命令序列化失败时整条流水线都不写出，每条命令都以无效回复返回
+  if (std::exchange(_format_failed, false))
+  {
+    commands.clear();
+  }
+  return _client->execute(std::move(commands), count);
+}
+
+// ============================================================================
+// AsyncRedisClient 实现
+// ============================================================================
+
+AsyncRedisClient& AsyncRedisClient::GetInstance()
+{
+  static AsyncRedisClient instance;
+  return instance;
+}
+
+void AsyncRedisClient::Init(const RedisConfig& config, const std::vector<boost::asio::any_io_executor>& executors)
+{
+  _config = config;
+  _connections.reserve(config.pool_size);
+
+  for (std::size_t i = 0; i < config.pool_size; ++i)
+  {
+    auto conn = std::make_shared<Connection>(executors[i % executors.size()], config);
+    _connections.push_back(conn);
+    boost::asio::co_spawn(conn->_strand, Connection::run(conn), boost::asio::detached);
+  }
+
+  tools::Logger::getInstance().info("async redis client init successful");
+}
+
+boost::asio::awaitable<RedisReply> AsyncRedisClient::Set(const std::string& key, const std::string& value)
+{
+  return execute_one(format_command("SET %b %b", key.data(), key.size(), value.data(), value.size()));
+}
+
+boost::asio::awaitable<RedisReply> AsyncRedisClient::SetEX(const std::string& key, const std::string& value,
+                                                           std::size_t seconds)
+{
+  return execute_one(format_command("SETEX %b %lld %b", key.data(), key.size(), static_cast<long long>(seconds),
+                                    value.data(), value.size()));
+}
+
+boost::asio::awaitable<RedisReply> AsyncRedisClient::SetNX(const std::string& key, const std::string& value)
+{
+  return execute_one(format_command("SETNX %b %b", key.data(), key.size(), value.data(), value.size()));
+}
+
+boost::asio::awaitable<RedisReply> AsyncRedisClient::Get(const std::string& key)
+{
+  return execute_one(format_command("GET %b", key.data(), key.size()));
+}
+
+boost::asio::awaitable<RedisReply> AsyncRedisClient::Del(const std::string& key)
+{
+  return execute_one(format_command("DEL %b", key.data(), key.size()));
+}
+
+boost::asio::awaitable<RedisReply> AsyncRedisClient::Del(const std::vector<std::string>& keys)
+{
+  // 空命令直接以无效回复返回
+  return execute_one(keys.empty() ? std::string{} : format_argv({"DEL"}, keys));
+}
+
+boost::asio::awaitable<RedisReply> AsyncRedisClient::Exists(const std::string& key)
+{
+  return execute_one(format_command("EXISTS %b", key.data(), key.size()));
+}
+
+boost::asio::awaitable<RedisReply> AsyncRedisClient::Expire(const std::string& key, std::size_t seconds)
+{
+  return execute_one(format_command("EXPIRE %b %lld", key.data(), key.size(), static_cast<long long>(seconds)));
+}
+
+boost::asio::awaitable<RedisReply> AsyncRedisClient::TTL(const std::string& key)
+{
+  return execute_one(format_command("TTL %b", key.data(), key.size()));
+}
+
+boost::asio::awaitable<RedisReply> AsyncRedisClient::Incr(const std::string& key)
+{
+  return execute_one(format_command("INCR %b", key.data(), key.size()));
+}
+
+boost::asio::awaitable<RedisReply> AsyncRedisClient::Decr(const std::string& key)
+{
+  return execute_one(format_command("DECR %b", key.data(), key.size()));
+}
+
+boost::asio::awaitable<RedisReply> AsyncRedisClient::IncrBy(const std::string& key, std::int64_t increment)
+{
+  return execute_one(format_command("INCRBY %b %lld", key.data(), key.size(), static_cast<long long>(increment)));
+}
+
+boost::asio::awaitable<RedisReply> AsyncRedisClient::DecrBy(const std::string& key, std::int64_t decrement)
+{
+  return execute_one(format_command("DECRBY %b %lld", key.data(), key.size(), static_cast<long long>(decrement)));
+}
+
+boost::asio::awaitable<RedisReply> AsyncRedisClient::HSet(const std::string& key, const std::string& field,
+                                                          const std::string& value)
+{
+  return execute_one(format_command("HSET %b %b %b", key.data(), key.size(), field.data(), field.size(), value.data(),
+                                    value.size()));
+}
+
+boost::asio::awaitable<RedisReply> AsyncRedisClient::HGet(const std::string& key, const std::string& field)
+{
+  return execute_one(format_command("HGET %b %b", key.data(), key.size(), field.data(), field.size()));
+}
+
+boost::asio::awaitable<RedisReply> AsyncRedisClient::HGetAll(const std::string& key)
+{
+  return execute_one(format_command("HGETALL %b", key.data(), key.size()));
+}
+
+boost::asio::awaitable<RedisReply> AsyncRedisClient::HDel(const std::string& key, const std::string& field)
+{
+  return execute_one(format_command("HDEL %b %b", key.data(), key.size(), field.data(), field.size()));
+}
+
+boost::asio::awaitable<RedisReply> AsyncRedisClient::HExists(const std::string& key, const std::string& field)
+{
+  return execute_one(format_command("HEXISTS %b %b", key.data(), key.size(), field.data(), field.size()));
+}
+
+boost::asio::awaitable<RedisReply> AsyncRedisClient::HIncrBy(const std::string& key, const std::string& field,
+                                                             std::int64_t increment)
+{
+  return execute_one(format_command("HINCRBY %b %b %lld", key.data(), key.size(), field.data(), field.size(),
+                                    static_cast<long long>(increment)));
+}
+
+boost::asio::awaitable<RedisReply> AsyncRedisClient::LPush(const std::string& key, const std::string& value)
+{
+  return execute_one(format_command("LPUSH %b %b", key.data(), key.size(), value.data(), value.size()));
+}
+
+boost::asio::awaitable<RedisReply> AsyncRedisClient::RPush(const std::string& key, const std::string& value)
+{
+  return execute_one(format_command("RPUSH %b %b", key.data(), key.size(), value.data(), value.size()));
+}
+
+boost::asio::awaitable<RedisReply> AsyncRedisClient::LPop(const std::string& key)
+{
+  return execute_one(format_command("LPOP %b", key.data(), key.size()));
+}
+
+boost::asio::awaitable<RedisReply> AsyncRedisClient::RPop(const std::string& key)
+{
+  return execute_one(format_command("RPOP %b", key.data(), key.size()));
+}
+
+boost::asio::awaitable<RedisReply> AsyncRedisClient::LRange(const std::string& key, std::int64_t start,
+                                                            std::int64_t stop)
+{
+  return execute_one(format_command("LRANGE %b %lld %lld", key.data(), key.size(), static_cast<long long>(start),
+                                    static_cast<long long>(stop)));
+}
+
+boost::asio::awaitable<RedisReply> AsyncRedisClient::LLen(const std::string& key)
+{
+  return execute_one(format_command("LLEN %b", key.data(), key.size()));
+}
+
+boost::asio::awaitable<RedisReply> AsyncRedisClient::LTrim(const std::string& key, std::int64_t start,
+                                                           std::int64_t stop)
+{
+  return execute_one(format_command("LTRIM %b %lld %lld", key.data(), key.size(), static_cast<long long>(start),
+                                    static_cast<long long>(stop)));
+}
+
+boost::asio::awaitable<RedisReply> AsyncRedisClient::SAdd(const std::string& key, const std::string& member)
+{
+  return execute_one(format_command("SADD %b %b", key.data(), key.size(), member.data(), member.size()));
+}
+
+boost::asio::awaitable<RedisReply> AsyncRedisClient::SAdd(const std::string& key,
+                                                          const std::vector<std::string>& members)
+{
+  return execute_one(members.empty() ? std::string{} : format_argv({"SADD", key}, members));
+}
+
+boost::asio::awaitable<RedisReply> AsyncRedisClient::SRem(const std::string& key, const std::string& member)
+{
+  return execute_one(format_command("SREM %b %b", key.data(), key.size(), member.data(), member.size()));
+}
+
+boost::asio::awaitable<RedisReply> AsyncRedisClient::SMembers(const std::string& key)
+{
+  return execute_one(format_command("SMEMBERS %b", key.data(), key.size()));
+}
+
+boost::asio::awaitable<RedisReply> AsyncRedisClient::SIsMember(const std::string& key, const std::string& member)
+{
+  return execute_one(format_command("SISMEMBER %b %b", key.data(), key.size(), member.data(), member.size()));
+}
+
+boost::asio::awaitable<RedisReply> AsyncRedisClient::SCard(const std::string& key)
+{
+  return execute_one(format_command("SCARD %b", key.data(), key.size()));
+}
+
+boost::asio::awaitable<RedisReply> AsyncRedisClient::ZAdd(const std::string& key, double score,
+                                                          const std::string& member)
+{
+  auto score_str = std::to_string(score);
+  return execute_one(
+      format_command("ZADD %b %s %b", key.data(), key.size(), score_str.c_str(), member.data(), member.size()));
+}
+
+boost::asio::awaitable<RedisReply> AsyncRedisClient::ZRem(const std::string& key, const std::string& member)
+{
+  return execute_one(format_command("ZREM %b %b", key.data(), key.size(), member.data(), member.size()));
+}
+
+boost::asio::awaitable<RedisReply> AsyncRedisClient::ZRange(const std::string& key, std::int64_t start,
+                                                            std::int64_t stop)
+{
+  return execute_one(format_command("ZRANGE %b %lld %lld", key.data(), key.size(), static_cast<long long>(start),
+                                    static_cast<long long>(stop)));
+}
+
+boost::asio::awaitable<RedisReply> AsyncRedisClient::ZRevRange(const std::string& key, std::int64_t start,
+                                                               std::int64_t stop)
+{
+  return execute_one(format_command("ZREVRANGE %b %lld %lld", key.data(), key.size(), static_cast<long long>(start),
+                                    static_cast<long long>(stop)));
+}
+
+boost::asio::awaitable<RedisReply> AsyncRedisClient::ZRangeByScore(const std::string& key, double min, double max)
+{
+  auto min_str = std::to_string(min);
+  auto max_str = std::to_string(max);
+  return execute_one(
+      format_command("ZRANGEBYSCORE %b %s %s", key.data(), key.size(), min_str.c_str(), max_str.c_str()));
+}
+
+boost::asio::awaitable<RedisReply> AsyncRedisClient::ZScore(const std::string& key, const std::string& member)
+{
+  return execute_one(format_command("ZSCORE %b %b", key.data(), key.size(), member.data(), member.size()));
+}
+
+boost::asio::awaitable<RedisReply> AsyncRedisClient::ZCard(const std::string& key)
+{
+  return execute_one(format_command("ZCARD %b", key.data(), key.size()));
+}
+
+boost::asio::awaitable<RedisReply> AsyncRedisClient::Publish(const std::string& channel, const std::string& message)
+{
+  return execute_one(
+      format_command("PUBLISH %b %b", channel.data(), channel.size(), message.data(), message.size()));
+}
+
+void AsyncRedisClient::Subscribe(const boost::asio::any_io_executor& executor, std::string channel,
+                                 MessageHandler on_message, std::function<void()> on_subscribed)
+{
+  auto conn = std::make_shared<Connection>(executor, _config);
+  conn->_channel = std::move(channel);
+  conn->_on_message = std::move(on_message);
+  conn->_on_subscribed = on_subscribed ? std::move(on_subscribed) : [] {};
+  boost::asio::co_spawn(conn->_strand, Connection::run(conn), boost::asio::detached);
+}
+
+AsyncPipeLine AsyncRedisClient::NewPipeLine()
+{
+  return AsyncPipeLine{this};
+}
+
+boost::asio::awaitable<RedisReply> AsyncRedisClient::Ping()
+{
+  return execute_one(format_command("PING"));
+}
+
+boost::asio::awaitable<RedisReply> AsyncRedisClient::Command(const char* format, ...)
+{
+  va_list app;
+  va_start(app, format);
+  auto command = vformat_command(format, app);
+  va_end(app);
+  return execute_one(std::move(command));
+}
+
+AsyncRedisClient::AsyncRedisClient() = default;
+
+AsyncRedisClient::~AsyncRedisClient()
+{
+  tools::Logger::getInstance().info("async redis client closed");
+}
+
+boost::asio::awaitable<std::vector<RedisReply>> AsyncRedisClient::execute(std::string commands, std::size_t count)
+{
+  auto conn = commands.empty() ? nullptr : pick_connection();
+  if (conn == nullptr)
+  {
+    co_return failed_replies(count);
+  }
+
+  co_return co_await boost::asio::async_initiate<const boost::asio::use_awaitable_t<>&, void(std::vector<RedisReply>)>(
+      [&commands, count, &conn](auto handler)
+      {
+        // 回复在连接的 strand 上到达，恢复协程的动作 post 回它自己的 executor
+        Connection::Handler complete = [handler = std::move(handler)](std::vector<RedisReply> replies) mutable
+        {
+          auto executor = boost::asio::get_associated_executor(handler);
+          boost::asio::post(executor, [handler = std::move(handler), replies = std::move(replies)]() mutable
+                            { std::move(handler)(std::move(replies)); });
+        };
+
+        auto& strand = conn->_strand;
+        boost::asio::post(strand,
+                          [conn = std::move(conn), commands = std::move(commands), count,
+                           complete = std::move(complete)]() mutable
+                          { conn->submit(std::move(commands), count, std::move(complete)); });
+      },
+      boost::asio::use_awaitable);
+}
+
+boost::asio::awaitable<RedisReply> AsyncRedisClient::execute_one(std::string command)
+{
+  auto replies = co_await execute(std::move(command), 1);
+  co_return std::move(replies.front());
+}
+
+std::shared_ptr<AsyncRedisClient::Connection> AsyncRedisClient::pick_connection()
+{
+  auto size = _connections.size();
+  for (std::size_t i = 0; i < size; ++i)
+  {
+    auto idx = _next_idx.fetch_add(1, std::memory_order_relaxed) % size;
+    if (auto conn = _connections[idx].lock(); conn != nullptr && conn->_connected.load(std::memory_order_acquire))
+    {
+      return conn;
+    }
+  }
+  return nullptr;
+}
+
+}  // namespace utils
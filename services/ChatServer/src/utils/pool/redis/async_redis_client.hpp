@@ -0,0 +1,159 @@
+/******************************************************************************
+ *
+ * @file       async_redis_client.hpp
+ * @brief      运行在 io_context 上的协程 Redis 客户端
+ *
+ * @author     KBchulan
+ * @date       2026/10/18
+ * @history    少量长连接上流水线复用，在途命令数不受连接数限制
+ *             2026/10/18 新增 Publish 与独占一条连接的 Subscribe
+ *             2026/10/18 流水线中有命令序列化失败时不再写出，避免回复与调用方错位
+ ******************************************************************************/
+
+#ifndef ASYNC_REDIS_CLIENT_HPP
+#define ASYNC_REDIS_CLIENT_HPP
+
+#include <atomic>
+#include <boost/asio/any_io_executor.hpp>
+#include <boost/asio/awaitable.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <utils/UtilsExport.hpp>
+#include <utils/pool/redis/redis_pool.hpp>
+#include <vector>
+
+namespace utils
+{
+
+class AsyncRedisClient;
+
+// 协程版本的流水线，Execute 时所有命令作为一次写出，回复按顺序返回；有命令序列化失败时全部以无效回复返回
+class UTILS_EXPORT AsyncPipeLine
+{
+public:
+  explicit AsyncPipeLine(AsyncRedisClient* client);
+  AsyncPipeLine& Append(const char* format, ...);
+  boost::asio::awaitable<std::vector<RedisReply>> Execute();
+
+private:
+  AsyncRedisClient* _client;
+  std::string _commands;
+  std::size_t _command_count;
+  bool _format_failed;
+};
+
+// 命令在调用时即完成序列化，参数不需要在 co_await 期间保持有效
+// 连接断开时返回 IsValid() 为 false 的回复，与 PooledRedisConnection 一致
+class UTILS_EXPORT AsyncRedisClient
+{
+public:
+  // 订阅频道收到的消息，在订阅连接的 strand 上调用
+  using MessageHandler = std::function<void(std::string_view message)>;
+
+  static AsyncRedisClient& GetInstance();
+
+  // 按 config.pool_size 建立连接，依次绑定到 executors 上，连接与重连都在后台协程中完成
+  void Init(const RedisConfig& config, const std::vector<boost::asio::any_io_executor>& executors);
+
+  // 基础 Key 操作
+  boost::asio::awaitable<RedisReply> Set(const std::string& key, const std::string& value);
+  boost::asio::awaitable<RedisReply> SetEX(const std::string& key, const std::string& value, std::size_t seconds);
+  boost::asio::awaitable<RedisReply> SetNX(const std::string& key, const std::string& value);
+  boost::asio::awaitable<RedisReply> Get(const std::string& key);
+  boost::asio::awaitable<RedisReply> Del(const std::string& key);
+  boost::asio::awaitable<RedisReply> Del(const std::vector<std::string>& keys);
+  boost::asio::awaitable<RedisReply> Exists(const std::string& key);
+  boost::asio::awaitable<RedisReply> Expire(const std::string& key, std::size_t seconds);
+  boost::asio::awaitable<RedisReply> TTL(const std::string& key);
+
+  // String 操作
+  boost::asio::awaitable<RedisReply> Incr(const std::string& key);
+  boost::asio::awaitable<RedisReply> Decr(const std::string& key);
+  boost::asio::awaitable<RedisReply> IncrBy(const std::string& key, std::int64_t increment);
+  boost::asio::awaitable<RedisReply> DecrBy(const std::string& key, std::int64_t decrement);
+
+  // Hash 操作
+  boost::asio::awaitable<RedisReply> HSet(const std::string& key, const std::string& field, const std::string& value);
+  boost::asio::awaitable<RedisReply> HGet(const std::string& key, const std::string& field);
+  boost::asio::awaitable<RedisReply> HGetAll(const std::string& key);
+  boost::asio::awaitable<RedisReply> HDel(const std::string& key, const std::string& field);
+  boost::asio::awaitable<RedisReply> HExists(const std::string& key, const std::string& field);
+  boost::asio::awaitable<RedisReply> HIncrBy(const std::string& key, const std::string& field, std::int64_t increment);
+
+  // List 操作
+  boost::asio::awaitable<RedisReply> LPush(const std::string& key, const std::string& value);
+  boost::asio::awaitable<RedisReply> RPush(const std::string& key, const std::string& value);
+  boost::asio::awaitable<RedisReply> LPop(const std::string& key);
+  boost::asio::awaitable<RedisReply> RPop(const std::string& key);
+  boost::asio::awaitable<RedisReply> LRange(const std::string& key, std::int64_t start, std::int64_t stop);
+  boost::asio::awaitable<RedisReply> LLen(const std::string& key);
+  boost::asio::awaitable<RedisReply> LTrim(const std::string& key, std::int64_t start, std::int64_t stop);
+
+  // Set 操作
+  boost::asio::awaitable<RedisReply> SAdd(const std::string& key, const std::string& member);
+  boost::asio::awaitable<RedisReply> SAdd(const std::string& key, const std::vector<std::string>& members);
+  boost::asio::awaitable<RedisReply> SRem(const std::string& key, const std::string& member);
+  boost::asio::awaitable<RedisReply> SMembers(const std::string& key);
+  boost::asio::awaitable<RedisReply> SIsMember(const std::string& key, const std::string& member);
+  boost::asio::awaitable<RedisReply> SCard(const std::string& key);
+
+  // Sorted Set 操作
+  boost::asio::awaitable<RedisReply> ZAdd(const std::string& key, double score, const std::string& member);
+  boost::asio::awaitable<RedisReply> ZRem(const std::string& key, const std::string& member);
+  boost::asio::awaitable<RedisReply> ZRange(const std::string& key, std::int64_t start, std::int64_t stop);
+  boost::asio::awaitable<RedisReply> ZRevRange(const std::string& key, std::int64_t start, std::int64_t stop);
+  boost::asio::awaitable<RedisReply> ZRangeByScore(const std::string& key, double min, double max);
+  boost::asio::awaitable<RedisReply> ZScore(const std::string& key, const std::string& member);
+  boost::asio::awaitable<RedisReply> ZCard(const std::string& key);
+
+  // 发布订阅
+  boost::asio::awaitable<RedisReply> Publish(const std::string& channel, const std::string& message);
+
+  // 在 executor 上另建一条连接订阅 channel，需在 Init 之后调用；断线后按同样的间隔重连并重新订阅，
+  // 每次订阅成功都会调用 on_subscribed，断线期间发布的消息已经丢失，调用方应在其中丢弃依赖这些消息的状态
+  void Subscribe(const boost::asio::any_io_executor& executor, std::string channel, MessageHandler on_message,
+                 std::function<void()> on_subscribed);
+
+  // 工具方法
+  AsyncPipeLine NewPipeLine();
+  boost::asio::awaitable<RedisReply> Ping();
+
+  // 自定义命令
+  boost::asio::awaitable<RedisReply> Command(const char* format, ...);
+
+  AsyncRedisClient(const AsyncRedisClient&) = delete;
+  AsyncRedisClient& operator=(const AsyncRedisClient&) = delete;
+  AsyncRedisClient(AsyncRedisClient&&) = delete;
+  AsyncRedisClient& operator=(AsyncRedisClient&&) = delete;
+
+private:
+  friend class AsyncPipeLine;
+
+  struct Connection;
+
+  AsyncRedisClient();
+  ~AsyncRedisClient();
+
+  // 将已序列化的 count 条命令交给一条连接，全部回复到达后恢复协程
+  boost::asio::awaitable<std::vector<RedisReply>> execute(std::string commands, std::size_t count);
+
+  boost::asio::awaitable<RedisReply> execute_one(std::string command);
+
+  // 轮询挑选一条已连接的连接，全部断开时返回空
+  [[nodiscard]] std::shared_ptr<Connection> pick_connection();
+
+  // 连接由自身的读协程持有，这里只保留弱引用，析构顺序与 io_context 无关
+  std::vector<std::weak_ptr<Connection>> _connections;
+  std::atomic<std::size_t> _next_idx{0};
+
+  // Subscribe 沿用 Init 时的配置
+  RedisConfig _config;
+};
+
+}  // namespace utils
+
+#endif  // ASYNC_REDIS_CLIENT_HPP
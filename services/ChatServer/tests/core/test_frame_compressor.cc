@@ -0,0 +1,316 @@
+/******************************************************************************
+ *
+ * @file       test_frame_compressor.cc
+ * @brief      消息体压缩单元测试
+ *
+ * @author     KBchulan
+ * @date       2026/10/18
+ * @history    LZ4 与 zstd 往返、分块输入、非法解压长度与字典协商的测试套件
+ ******************************************************************************/
+
+#include <gtest/gtest.h>
+#include <zdict.h>
+
+#include <boost/asio/detail/socket_ops.hpp>
+#include <core/msg-node/frame-compressor.hpp>
+#include <core/msg-node/msg-node.hpp>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <global/Global.hpp>
+#include <memory>
+#include <random>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace
+{
+
+using namespace global::server;
+
+constexpr short TEST_MSG_ID = 1017;  // 测试使用的消息 id，不含压缩标记
+constexpr core::CompressionMode LZ4_MODE{.algorithm = utils::Compression::LZ4, .use_dict = false};
+constexpr core::CompressionMode ZSTD_MODE{.algorithm = utils::Compression::ZSTD, .use_dict = false};
+constexpr core::CompressionMode ZSTD_DICT_MODE{.algorithm = utils::Compression::ZSTD, .use_dict = true};
+
+// 与线上单聊消息结构相近的 JSON，可压缩
+std::string chat_message(std::mt19937& rng, std::uint64_t msg_id)
+{
+  std::uniform_int_distribution<std::uint32_t> uid(100000, 999999);
+  return R"({"msg_id":)" + std::to_string(msg_id) + R"(,"from_uid":)" + std::to_string(uid(rng)) + R"(,"to_uid":)" +
+         std::to_string(uid(rng)) + R"(,"type":"text","content":"晚上一起吃饭吗 see you later","timestamp":)" +
+         std::to_string(1760745600000ULL + msg_id * 1375) + "}";
+}
+
+// 四个字母随机组成的消息体，压缩后仍超过 RECV_BUFFER_SIZE，压缩帧因此分块存放
+std::string random_letters(std::size_t len)
+{
+  std::mt19937 rng(42);
+  std::uniform_int_distribution<int> letter(0, 3);
+  std::string body(len, 'a');
+  for (auto& ch : body)
+  {
+    ch = static_cast<char>('a' + letter(rng));
+  }
+  return body;
+}
+
+std::vector<char> wire_body(const core::SendNode& node)
+{
+  if (!node.IsChunked())
+  {
+    auto data = node.GetData().subspan(MSG_HEAD_TOTAL_LEN);
+    return {data.begin(), data.end()};
+  }
+
+  std::vector<char> body;
+  for (auto chunk : node.GetChunks())
+  {
+    body.insert(body.end(), chunk.begin(), chunk.end());
+  }
+  return body;
+}
+
+// 按接收端的方式把消息体放入 RecvNode，超过 RECV_BUFFER_SIZE 时分块存放
+std::shared_ptr<core::RecvNode> make_recv_node(std::span<const char> body)
+{
+  if (body.size() <= RECV_BUFFER_SIZE)
+  {
+    return core::RecvNode::Create(TEST_MSG_ID, body);
+  }
+
+  auto node = core::RecvNode::CreateChunked(TEST_MSG_ID, body.size());
+  for (auto chunk : node->GetChunks())
+  {
+    std::memcpy(chunk.data(), body.data(), chunk.size());
+    body = body.subspan(chunk.size());
+  }
+  return node;
+}
+
+std::string flatten(const std::shared_ptr<core::RecvNode>& node)
+{
+  if (!node->IsChunked())
+  {
+    return {node->GetData().data(), node->GetData().size()};
+  }
+
+  std::string body;
+  for (auto chunk : node->GetChunks())
+  {
+    body.append(chunk.data(), chunk.size());
+  }
+  return body;
+}
+
+bool is_compressed(const core::SendNode& node)
+{
+  return (static_cast<std::uint16_t>(node.GetMsgId()) & MSG_COMPRESSED_FLAG) != 0;
+}
+
+// 压缩后再按接收端方式解压
+std::shared_ptr<core::RecvNode> round_trip(const std::string& body, core::CompressionMode mode)
+{
+  auto& compressor = core::FrameCompressor::GetInstance();
+  auto send_node = compressor.MakeSendNode(TEST_MSG_ID, body, mode);
+  if (!is_compressed(*send_node))
+  {
+    return nullptr;
+  }
+  return compressor.Decompress(*make_recv_node(wire_body(*send_node)), mode);
+}
+
+// 改写压缩消息体开头的解压后长度
+std::vector<char> with_raw_len(std::vector<char> body, std::uint32_t raw_len)
+{
+  auto net_len = boost::asio::detail::socket_ops::host_to_network_long(raw_len);
+  std::memcpy(body.data(), &net_len, MSG_RAW_LEN_LENGTH);
+  return body;
+}
+
+}  // namespace
+
+class FrameCompressorTest : public ::testing::Test
+{
+protected:
+  // 字典是进程级状态，训练一次后各用例共用
+  static void SetUpTestSuite()
+  {
+    std::mt19937 rng(7);
+    std::string samples;
+    std::vector<std::size_t> sizes;
+    for (std::size_t i = 0; i < 2000; ++i)
+    {
+      auto sample = chat_message(rng, i);
+      samples += sample;
+      sizes.push_back(sample.size());
+    }
+
+    std::vector<char> dict(16 * 1024);
+    auto size = ZDICT_trainFromBuffer(dict.data(), dict.size(), samples.data(), sizes.data(),
+                                      static_cast<unsigned>(sizes.size()));
+    ASSERT_EQ(ZDICT_isError(size), 0U);
+
+    auto path = std::filesystem::temp_directory_path() / "test_frame_compressor.zdict";
+    std::ofstream(path, std::ios::binary).write(dict.data(), static_cast<std::streamsize>(size));
+    ASSERT_TRUE(core::FrameCompressor::GetInstance().LoadDictionary(path.string()));
+    std::filesystem::remove(path);
+  }
+
+  void SetUp() override
+  {
+  }
+
+  void TearDown() override
+  {
+  }
+};
+
+// 测试1: LZ4 与 zstd 压缩后解压得到原文，消息 id 去掉压缩标记
+TEST_F(FrameCompressorTest, RoundTrip)
+{
+  std::mt19937 rng(1);
+  std::string body;
+  for (std::uint64_t i = 0; i < 20; ++i)
+  {
+    body += chat_message(rng, i);
+  }
+
+  for (auto mode : {LZ4_MODE, ZSTD_MODE})
+  {
+    auto node = round_trip(body, mode);
+    ASSERT_NE(node, nullptr);
+    EXPECT_EQ(node->GetMsgId(), TEST_MSG_ID);
+    EXPECT_EQ(flatten(node), body);
+  }
+}
+
+// 测试2: 未达到阈值或不压缩时按原文组帧，不带压缩标记
+TEST_F(FrameCompressorTest, BelowThresholdNotFlagged)
+{
+  auto& compressor = core::FrameCompressor::GetInstance();
+  std::string small(COMPRESS_MIN_SIZE - 1, 'a');
+  std::string large(COMPRESS_MIN_SIZE * 4, 'a');
+
+  EXPECT_FALSE(is_compressed(*compressor.MakeSendNode(TEST_MSG_ID, small, LZ4_MODE)));
+  EXPECT_FALSE(is_compressed(*compressor.MakeSendNode(TEST_MSG_ID, small, ZSTD_MODE)));
+  EXPECT_FALSE(is_compressed(*compressor.MakeSendNode(TEST_MSG_ID, large, core::CompressionMode{})));
+  EXPECT_TRUE(is_compressed(*compressor.MakeSendNode(TEST_MSG_ID, large, ZSTD_MODE)));
+
+  auto plain = compressor.MakeSendNode(TEST_MSG_ID, small, LZ4_MODE);
+  auto body = wire_body(*plain);
+  EXPECT_EQ(std::string(body.begin(), body.end()), small);
+}
+
+// 测试3: 压缩帧本身分块存放时，跨分块流式解压得到原文
+TEST_F(FrameCompressorTest, ChunkedCompressedInput)
+{
+  auto body = random_letters(1 << 20);
+  auto& compressor = core::FrameCompressor::GetInstance();
+
+  for (auto mode : {LZ4_MODE, ZSTD_MODE})
+  {
+    auto send_node = compressor.MakeSendNode(TEST_MSG_ID, body, mode);
+    ASSERT_TRUE(is_compressed(*send_node));
+    ASSERT_TRUE(send_node->IsChunked());
+
+    auto recv_node = make_recv_node(wire_body(*send_node));
+    ASSERT_TRUE(recv_node->IsChunked());
+
+    auto node = compressor.Decompress(*recv_node, mode);
+    ASSERT_NE(node, nullptr);
+    EXPECT_TRUE(node->IsChunked());
+    EXPECT_EQ(flatten(node), body);
+  }
+}
+
+// 测试4: 声明的解压长度超过大帧上限或为 0 时直接拒绝
+TEST_F(FrameCompressorTest, OversizedRawLenRejected)
+{
+  std::string body(COMPRESS_MIN_SIZE * 4, 'a');
+  auto& compressor = core::FrameCompressor::GetInstance();
+
+  for (auto mode : {LZ4_MODE, ZSTD_MODE})
+  {
+    auto wire = wire_body(*compressor.MakeSendNode(TEST_MSG_ID, body, mode));
+    auto oversized = with_raw_len(wire, static_cast<std::uint32_t>(MAX_LARGE_FRAME_SIZE + 1));
+    auto zero = with_raw_len(wire, 0);
+    EXPECT_EQ(compressor.Decompress(*make_recv_node(oversized), mode), nullptr);
+    EXPECT_EQ(compressor.Decompress(*make_recv_node(zero), mode), nullptr);
+  }
+}
+
+// 测试5: 声明的解压长度与实际不符时拒绝，不会写越界或交付截断的消息体
+TEST_F(FrameCompressorTest, MismatchedRawLenRejected)
+{
+  std::string body(COMPRESS_MIN_SIZE * 4, 'a');
+  auto& compressor = core::FrameCompressor::GetInstance();
+
+  for (auto mode : {LZ4_MODE, ZSTD_MODE})
+  {
+    auto wire = wire_body(*compressor.MakeSendNode(TEST_MSG_ID, body, mode));
+    auto longer = with_raw_len(wire, static_cast<std::uint32_t>(body.size() + 1));
+    auto shorter = with_raw_len(wire, static_cast<std::uint32_t>(body.size() - 1));
+    EXPECT_EQ(compressor.Decompress(*make_recv_node(longer), mode), nullptr);
+    EXPECT_EQ(compressor.Decompress(*make_recv_node(shorter), mode), nullptr);
+  }
+}
+
+// 测试6: 截断的压缩数据解压失败
+TEST_F(FrameCompressorTest, TruncatedInputRejected)
+{
+  std::string body(COMPRESS_MIN_SIZE * 4, 'a');
+  auto& compressor = core::FrameCompressor::GetInstance();
+
+  for (auto mode : {LZ4_MODE, ZSTD_MODE})
+  {
+    auto wire = wire_body(*compressor.MakeSendNode(TEST_MSG_ID, body, mode));
+    wire.pop_back();
+    EXPECT_EQ(compressor.Decompress(*make_recv_node(wire), mode), nullptr);
+  }
+}
+
+// 测试7: 只有 zstd 且字典 id 与服务端一致时才启用字典
+TEST_F(FrameCompressorTest, NegotiateDictionary)
+{
+  auto& compressor = core::FrameCompressor::GetInstance();
+  auto dict_id = compressor.GetDictId();
+  ASSERT_NE(dict_id, 0U);
+
+  auto zstd = static_cast<std::uint32_t>(utils::Compression::ZSTD);
+  auto lz4 = static_cast<std::uint32_t>(utils::Compression::LZ4);
+
+  auto matched = compressor.Negotiate(zstd, dict_id);
+  EXPECT_EQ(matched.algorithm, utils::Compression::ZSTD);
+  EXPECT_TRUE(matched.use_dict);
+
+  auto mismatched = compressor.Negotiate(zstd, dict_id + 1);
+  EXPECT_EQ(mismatched.algorithm, utils::Compression::ZSTD);
+  EXPECT_FALSE(mismatched.use_dict);
+
+  EXPECT_FALSE(compressor.Negotiate(zstd, 0).use_dict);
+  EXPECT_FALSE(compressor.Negotiate(lz4, dict_id).use_dict);
+  EXPECT_EQ(compressor.Negotiate(99, dict_id).algorithm, utils::Compression::NONE);
+}
+
+// 测试8: 字典压缩的小消息往返一致，未协商字典的一端无法解压
+TEST_F(FrameCompressorTest, DictionaryMismatchFails)
+{
+  std::mt19937 rng(99);
+  auto body = chat_message(rng, 12345);
+  ASSERT_GE(body.size(), COMPRESS_DICT_MIN_SIZE);
+  ASSERT_LT(body.size(), COMPRESS_MIN_SIZE);
+
+  auto& compressor = core::FrameCompressor::GetInstance();
+  auto send_node = compressor.MakeSendNode(TEST_MSG_ID, body, ZSTD_DICT_MODE);
+  ASSERT_TRUE(is_compressed(*send_node));
+
+  auto recv_node = make_recv_node(wire_body(*send_node));
+  auto node = compressor.Decompress(*recv_node, ZSTD_DICT_MODE);
+  ASSERT_NE(node, nullptr);
+  EXPECT_EQ(flatten(node), body);
+
+  EXPECT_EQ(compressor.Decompress(*recv_node, ZSTD_MODE), nullptr);
+}
@@ -0,0 +1,110 @@
+/******************************************************************************
+ *
+ * @file       test_history_cache.cc
+ * @brief      历史消息缓存单元测试
+ *
+ * @author     KBchulan
+ * @date       2026/10/18
+ * @history    缓存页完整性判断的测试套件：seq 断档、before_seq 相接、整页与到达第一条消息
+ ******************************************************************************/
+
+#include <gtest/gtest.h>
+
+#include <core/model/message_do.hpp>
+#include <core/repository/history_cache.hpp>
+#include <cstdint>
+#include <vector>
+
+namespace
+{
+
+// 从 newest 开始按 seq 降序的 count 条消息，与 RangeAsync 的返回顺序一致
+std::vector<core::MessageDO> page(std::uint64_t newest, std::uint64_t count)
+{
+  std::vector<core::MessageDO> messages;
+  for (std::uint64_t seq = newest; seq > newest - count; --seq)
+  {
+    messages.push_back(core::MessageDO{
+        .conversation_id = "p_1_2", .seq = seq, .sender_uuid = "u1", .msg_type = 0, .content = "hi", .created_at = 0});
+  }
+  return messages;
+}
+
+}  // namespace
+
+class HistoryCacheTest : public ::testing::Test
+{
+protected:
+  void SetUp() override
+  {
+  }
+
+  void TearDown() override
+  {
+  }
+};
+
+// 测试1: 空结果不完整，需要回源
+TEST_F(HistoryCacheTest, EmptyIsIncomplete)
+{
+  EXPECT_FALSE(core::HistoryCache::IsComplete({}, 0, 20));
+  EXPECT_FALSE(core::HistoryCache::IsComplete({}, 10, 20));
+}
+
+// 测试2: 从最新一条开始的连续整页是完整的
+TEST_F(HistoryCacheTest, FullPageFromLatest)
+{
+  EXPECT_TRUE(core::HistoryCache::IsComplete(page(100, 20), 0, 20));
+}
+
+// 测试3: 条数不足一页且没有到达第一条消息时不完整，缓存之外还有更早的消息
+TEST_F(HistoryCacheTest, ShortPageIsIncomplete)
+{
+  EXPECT_FALSE(core::HistoryCache::IsComplete(page(100, 19), 0, 20));
+  EXPECT_FALSE(core::HistoryCache::IsComplete(page(100, 1), 0, 20));
+}
+
+// 测试4: 条数不足一页但已到达会话的第一条消息时完整
+TEST_F(HistoryCacheTest, ShortPageReachingFirstMessage)
+{
+  EXPECT_TRUE(core::HistoryCache::IsComplete(page(5, 5), 0, 20));
+  EXPECT_TRUE(core::HistoryCache::IsComplete(page(1, 1), 0, 20));
+  EXPECT_TRUE(core::HistoryCache::IsComplete(page(10, 10), 11, 20));
+}
+
+// 测试5: 中间、开头或末尾任意位置断档都不完整
+TEST_F(HistoryCacheTest, GapIsIncomplete)
+{
+  auto middle = page(100, 21);
+  middle.erase(middle.begin() + 10);
+  EXPECT_FALSE(core::HistoryCache::IsComplete(middle, 0, 20));
+
+  auto head = page(100, 21);
+  head.erase(head.begin() + 1);
+  EXPECT_FALSE(core::HistoryCache::IsComplete(head, 0, 20));
+
+  auto tail = page(20, 20);
+  tail.back().seq = 0;
+  EXPECT_FALSE(core::HistoryCache::IsComplete(tail, 0, 20));
+
+  // 到达第一条消息也不能掩盖断档
+  auto reaching_first = page(5, 5);
+  reaching_first.erase(reaching_first.begin() + 2);
+  EXPECT_FALSE(core::HistoryCache::IsComplete(reaching_first, 0, 20));
+}
+
+// 测试6: 翻页时第一条必须紧接在 before_seq 之前，否则缓存与请求的位置之间有缺失
+TEST_F(HistoryCacheTest, AnchoredToBeforeSeq)
+{
+  EXPECT_TRUE(core::HistoryCache::IsComplete(page(49, 20), 50, 20));
+  EXPECT_FALSE(core::HistoryCache::IsComplete(page(48, 20), 50, 20));
+  EXPECT_FALSE(core::HistoryCache::IsComplete(page(50, 20), 50, 20));
+}
+
+// 测试7: 重复的 seq 同样视为不连续
+TEST_F(HistoryCacheTest, DuplicateSeqIsIncomplete)
+{
+  auto messages = page(100, 20);
+  messages[5].seq = messages[4].seq;
+  EXPECT_FALSE(core::HistoryCache::IsComplete(messages, 0, 20));
+}
@@ -0,0 +1,317 @@
+/******************************************************************************
+ *
+ * @file       test_large_frame.cc
+ * @brief      大帧分块收发单元测试
+ *
+ * @author     KBchulan
+ * @date       2026/10/18
+ * @history    SendNode 分块编码、RecvNode 分块分配与真实 Session 上行拼接、下行写出的测试套件
+ ******************************************************************************/
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <boost/asio/buffer.hpp>
+#include <boost/asio/detail/socket_ops.hpp>
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/asio/read.hpp>
+#include <boost/asio/write.hpp>
+#include <chrono>
+#include <condition_variable>
+#include <core/io/io.hpp>
+#include <core/logic/logic.hpp>
+#include <core/msg-node/msg-node.hpp>
+#include <core/session/session.hpp>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <global/Global.hpp>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <vector>
+
+namespace
+{
+
+using namespace global::server;
+
+constexpr short CHUNKED_MSG_ID = 30001;   // 注册分块处理函数的测试 id
+constexpr short FLAT_MSG_ID = 30002;      // 只注册普通处理函数的测试 id，大帧拼接后交付
+constexpr short DOWNLOAD_MSG_ID = 30003;  // 下行测试 id
+
+// 逻辑线程交付的消息体与分块数，测试线程按到达顺序取出
+struct Delivery
+{
+  std::vector<char> body;
+  std::size_t chunk_count{0};
+};
+
+struct Received
+{
+  std::mutex mtx;
+  std::condition_variable cv;
+  std::deque<Delivery> deliveries;
+
+  void Put(std::vector<char> body, std::size_t chunk_count)
+  {
+    {
+      std::lock_guard lock(mtx);
+      deliveries.push_back({.body = std::move(body), .chunk_count = chunk_count});
+    }
+    cv.notify_one();
+  }
+
+  std::optional<Delivery> Take()
+  {
+    std::unique_lock lock(mtx);
+    if (!cv.wait_for(lock, std::chrono::seconds(5), [this] { return !deliveries.empty(); }))
+    {
+      return std::nullopt;
+    }
+    auto result = std::move(deliveries.front());
+    deliveries.pop_front();
+    return result;
+  }
+};
+
+Received g_received;
+
+// 处理函数在任何消息投递之前注册一次，之后各用例共用
+void register_handlers()
+{
+  static const bool registered = []
+  {
+    auto& logic = core::Logic::GetInstance();
+    logic.RegisterChunkedHandler(CHUNKED_MSG_ID,
+                                 [](const std::shared_ptr<core::Session>&, std::span<const std::span<char>> chunks)
+                                 {
+                                   std::vector<char> body;
+                                   for (auto chunk : chunks)
+                                   {
+                                     body.insert(body.end(), chunk.begin(), chunk.end());
+                                   }
+                                   g_received.Put(std::move(body), chunks.size());
+                                 });
+    logic.RegisterHandler(FLAT_MSG_ID, [](const std::shared_ptr<core::Session>&, std::span<const char> body)
+                          { g_received.Put({body.begin(), body.end()}, 1); });
+    return true;
+  }();
+  (void)registered;
+}
+
+// 在 IO 池上建立一个真实 Session，客户端 socket 以阻塞模式留在测试线程
+struct LoopbackSession
+{
+  boost::asio::io_context _client_ioc;
+  boost::asio::ip::tcp::socket _client{_client_ioc};
+  core::Session::Ptr _session;
+
+  LoopbackSession()
+  {
+    boost::asio::ip::tcp::acceptor acceptor(
+        _client_ioc, boost::asio::ip::tcp::endpoint(boost::asio::ip::make_address("127.0.0.1"), 0));
+    _client.connect(acceptor.local_endpoint());
+
+    auto socket = acceptor.accept(core::IO::GetInstance().GetIOContext());
+    _session = core::Session::Create(std::move(socket), std::weak_ptr<core::Server>{});
+    _session->Start();
+  }
+
+  ~LoopbackSession()
+  {
+    boost::system::error_code errc;
+    _client.close(errc);
+  }
+
+  LoopbackSession(const LoopbackSession&) = delete;
+  LoopbackSession& operator=(const LoopbackSession&) = delete;
+  LoopbackSession(LoopbackSession&&) = delete;
+  LoopbackSession& operator=(LoopbackSession&&) = delete;
+};
+
+// 按下标生成可区分各分块位置的消息体
+std::vector<char> make_body(std::size_t len)
+{
+  std::vector<char> body(len);
+  for (std::size_t i = 0; i < len; ++i)
+  {
+    body[i] = static_cast<char>((i * 31 + i / LARGE_FRAME_CHUNK_SIZE) & 0xFF);
+  }
+  return body;
+}
+
+// 客户端侧的大帧：2 字节 id + 长度标记 + 4 字节长度 + 消息体
+std::vector<char> make_large_frame(short msg_id, std::span<const char> body)
+{
+  std::vector<char> frame(MSG_HEAD_TOTAL_LEN + MSG_EXT_LEN_LENGTH);
+  auto net_id = boost::asio::detail::socket_ops::host_to_network_short(static_cast<std::uint16_t>(msg_id));
+  auto net_marker = boost::asio::detail::socket_ops::host_to_network_short(MSG_EXT_LEN_MARKER);
+  auto net_len = boost::asio::detail::socket_ops::host_to_network_long(static_cast<std::uint32_t>(body.size()));
+  std::memcpy(frame.data(), &net_id, MSG_TYPE_LENGTH);
+  std::memcpy(frame.data() + MSG_TYPE_LENGTH, &net_marker, MSG_LEN_LENGTH);
+  std::memcpy(frame.data() + MSG_HEAD_TOTAL_LEN, &net_len, MSG_EXT_LEN_LENGTH);
+  frame.insert(frame.end(), body.begin(), body.end());
+  return frame;
+}
+
+// 以很小的片段写出，让 Session 在任意位置遇到半包
+void write_fragmented(boost::asio::ip::tcp::socket& socket, std::span<const char> frame, std::size_t piece)
+{
+  for (std::size_t offset = 0; offset < frame.size(); offset += piece)
+  {
+    auto len = std::min(piece, frame.size() - offset);
+    boost::asio::write(socket, boost::asio::buffer(frame.data() + offset, len));
+  }
+}
+
+std::vector<char> join_chunks(std::span<const std::span<char>> chunks)
+{
+  std::vector<char> body;
+  for (auto chunk : chunks)
+  {
+    body.insert(body.end(), chunk.begin(), chunk.end());
+  }
+  return body;
+}
+
+}  // namespace
+
+class LargeFrameTest : public ::testing::Test
+{
+protected:
+  void SetUp() override
+  {
+    register_handlers();
+  }
+
+  void TearDown() override
+  {
+  }
+};
+
+// 测试1: 不超过 RECV_BUFFER_SIZE 的消息体保持普通帧
+TEST_F(LargeFrameTest, SmallBodyStaysFlat)
+{
+  auto body = make_body(RECV_BUFFER_SIZE);
+  auto node = core::SendNode::Create(DOWNLOAD_MSG_ID, body);
+
+  EXPECT_FALSE(node->IsChunked());
+  EXPECT_TRUE(node->GetChunks().empty());
+  ASSERT_EQ(node->GetData().size(), MSG_HEAD_TOTAL_LEN + body.size());
+  EXPECT_EQ(std::memcmp(node->GetData().data() + MSG_HEAD_TOTAL_LEN, body.data(), body.size()), 0);
+}
+
+// 测试2: 超过 RECV_BUFFER_SIZE 的消息体编码为 8 字节头加分块
+TEST_F(LargeFrameTest, SendNodeSplitsLargeBody)
+{
+  constexpr std::size_t BODY_LEN = (3 * LARGE_FRAME_CHUNK_SIZE) + 123;
+  auto body = make_body(BODY_LEN);
+  auto node = core::SendNode::Create(DOWNLOAD_MSG_ID, body);
+
+  ASSERT_TRUE(node->IsChunked());
+  ASSERT_EQ(node->GetData().size(), MSG_HEAD_TOTAL_LEN + MSG_EXT_LEN_LENGTH);
+
+  std::uint16_t net_id = 0;
+  std::uint16_t net_marker = 0;
+  std::uint32_t net_len = 0;
+  std::memcpy(&net_id, node->GetData().data(), MSG_TYPE_LENGTH);
+  std::memcpy(&net_marker, node->GetData().data() + MSG_TYPE_LENGTH, MSG_LEN_LENGTH);
+  std::memcpy(&net_len, node->GetData().data() + MSG_HEAD_TOTAL_LEN, MSG_EXT_LEN_LENGTH);
+  EXPECT_EQ(boost::asio::detail::socket_ops::network_to_host_short(net_id), DOWNLOAD_MSG_ID);
+  EXPECT_EQ(boost::asio::detail::socket_ops::network_to_host_short(net_marker), MSG_EXT_LEN_MARKER);
+  EXPECT_EQ(boost::asio::detail::socket_ops::network_to_host_long(net_len), BODY_LEN);
+
+  auto chunks = node->GetChunks();
+  ASSERT_EQ(chunks.size(), 4);
+  for (std::size_t i = 0; i + 1 < chunks.size(); ++i)
+  {
+    EXPECT_EQ(chunks[i].size(), LARGE_FRAME_CHUNK_SIZE);
+  }
+  EXPECT_EQ(chunks.back().size(), 123);
+  EXPECT_EQ(join_chunks(chunks), body);
+}
+
+// 测试3: 接收节点按 LARGE_FRAME_CHUNK_SIZE 分块，总长等于消息体长度
+TEST_F(LargeFrameTest, RecvNodeChunkSizes)
+{
+  constexpr std::size_t BODY_LEN = (2 * LARGE_FRAME_CHUNK_SIZE) + 1;
+  auto node = core::RecvNode::CreateChunked(CHUNKED_MSG_ID, BODY_LEN);
+
+  ASSERT_TRUE(node->IsChunked());
+  EXPECT_EQ(node->GetMsgId(), CHUNKED_MSG_ID);
+  EXPECT_EQ(node->GetBodySize(), BODY_LEN);
+
+  auto chunks = node->GetChunks();
+  ASSERT_EQ(chunks.size(), 3);
+  EXPECT_EQ(chunks[0].size(), LARGE_FRAME_CHUNK_SIZE);
+  EXPECT_EQ(chunks[1].size(), LARGE_FRAME_CHUNK_SIZE);
+  EXPECT_EQ(chunks[2].size(), 1);
+}
+
+// 测试4: 碎片化写入的上行大帧在分块处理函数中按原样重组
+TEST_F(LargeFrameTest, UploadReassemblesChunked)
+{
+  constexpr std::size_t BODY_LEN = (4 * LARGE_FRAME_CHUNK_SIZE) + 777;
+  LoopbackSession loopback;
+  auto body = make_body(BODY_LEN);
+  auto frame = make_large_frame(CHUNKED_MSG_ID, body);
+
+  write_fragmented(loopback._client, frame, 1000);
+
+  auto received = g_received.Take();
+  ASSERT_TRUE(received.has_value());
+  EXPECT_EQ(received->body, body);
+  EXPECT_EQ(received->chunk_count, 5);
+}
+
+// 测试5: 只注册普通处理函数时，大帧拼接成连续内存后交付
+TEST_F(LargeFrameTest, UploadFlattensForPlainHandler)
+{
+  constexpr std::size_t BODY_LEN = (2 * LARGE_FRAME_CHUNK_SIZE) + 5;
+  LoopbackSession loopback;
+  auto body = make_body(BODY_LEN);
+  auto frame = make_large_frame(FLAT_MSG_ID, body);
+
+  write_fragmented(loopback._client, frame, 4093);
+
+  auto received = g_received.Take();
+  ASSERT_TRUE(received.has_value());
+  EXPECT_EQ(received->body, body);
+}
+
+// 测试6: 同一连接上连续两个大帧互不串扰
+TEST_F(LargeFrameTest, UploadBackToBack)
+{
+  LoopbackSession loopback;
+  auto first = make_body(LARGE_FRAME_CHUNK_SIZE + 1);
+  auto second = make_body((3 * LARGE_FRAME_CHUNK_SIZE) - 1);
+  auto frame = make_large_frame(CHUNKED_MSG_ID, first);
+  auto next = make_large_frame(CHUNKED_MSG_ID, second);
+  frame.insert(frame.end(), next.begin(), next.end());
+
+  write_fragmented(loopback._client, frame, 7);
+
+  auto received = g_received.Take();
+  ASSERT_TRUE(received.has_value());
+  EXPECT_EQ(received->body, first);
+  received = g_received.Take();
+  ASSERT_TRUE(received.has_value());
+  EXPECT_EQ(received->body, second);
+}
+
+// 测试7: 下行大帧在客户端读到的内容与消息体一致
+TEST_F(LargeFrameTest, DownloadMatchesBody)
+{
+  constexpr std::size_t BODY_LEN = (5 * LARGE_FRAME_CHUNK_SIZE) + 9;
+  LoopbackSession loopback;
+  auto body = make_body(BODY_LEN);
+
+  loopback._session->Send(core::SendNode::Create(DOWNLOAD_MSG_ID, body));
+
+  std::vector<char> sink(MSG_HEAD_TOTAL_LEN + MSG_EXT_LEN_LENGTH + BODY_LEN);
+  boost::asio::read(loopback._client, boost::asio::buffer(sink));
+  EXPECT_EQ(sink, make_large_frame(DOWNLOAD_MSG_ID, body));
+}
@@ -0,0 +1,127 @@
+/******************************************************************************
+ *
+ * @file       test_message_writer.cc
+ * @brief      聊天消息异步落库单元测试
+ *
+ * @author     KBchulan
+ * @date       2026/10/18
+ * @history    排队中最大 seq 的登记与清除测试套件，seq 计数器丢失后据此起算
+ ******************************************************************************/
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <core/model/message_do.hpp>
+#include <core/repository/message_writer.hpp>
+#include <cstdint>
+#include <mutex>
+#include <span>
+#include <string>
+#include <thread>
+
+namespace
+{
+
+core::MessageDO make_message(const std::string& conversation_id, std::uint64_t seq)
+{
+  return core::MessageDO{.conversation_id = conversation_id,
+                         .seq = seq,
+                         .sender_uuid = "u1",
+                         .msg_type = 0,
+                         .content = "hi",
+                         .created_at = 0};
+}
+
+// 打开之前写线程阻塞在 sink 中，消息停留在排队与写入中
+class Gate
+{
+public:
+  void Open()
+  {
+    {
+      std::lock_guard lock(_mutex);
+      _open = true;
+    }
+    _cv.notify_all();
+  }
+
+  void Wait()
+  {
+    std::unique_lock lock(_mutex);
+    _cv.wait(lock, [this] { return _open; });
+  }
+
+private:
+  std::mutex _mutex;
+  std::condition_variable _cv;
+  bool _open{false};
+};
+
+}  // namespace
+
+class MessageWriterTest : public ::testing::Test
+{
+protected:
+  void SetUp() override
+  {
+    core::MessageWriter::GetInstance().Start(
+        [this](std::span<const core::MessageDO>)
+        {
+          gate.Wait();
+          return true;
+        });
+  }
+
+  void TearDown() override
+  {
+    gate.Open();
+    core::MessageWriter::GetInstance().Stop();
+  }
+
+  Gate gate;
+};
+
+// 测试1: 排队中的消息按会话登记最大 seq，乱序入队也取最大值
+TEST_F(MessageWriterTest, TracksPendingMaxSeq)
+{
+  auto& writer = core::MessageWriter::GetInstance();
+  EXPECT_EQ(writer.GetPendingMaxSeq("conv_a"), 0);
+
+  ASSERT_TRUE(writer.Submit(make_message("conv_a", 7)));
+  ASSERT_TRUE(writer.Submit(make_message("conv_a", 9)));
+  ASSERT_TRUE(writer.Submit(make_message("conv_a", 8)));
+  ASSERT_TRUE(writer.Submit(make_message("conv_b", 3)));
+
+  EXPECT_EQ(writer.GetPendingMaxSeq("conv_a"), 9);
+  EXPECT_EQ(writer.GetPendingMaxSeq("conv_b"), 3);
+  EXPECT_EQ(writer.GetPendingMaxSeq("conv_c"), 0);
+}
+
+// 测试2: 会话最新的一条写完后不再登记
+TEST_F(MessageWriterTest, ClearsAfterWritten)
+{
+  auto& writer = core::MessageWriter::GetInstance();
+  ASSERT_TRUE(writer.Submit(make_message("conv_a", 41)));
+  ASSERT_TRUE(writer.Submit(make_message("conv_a", 42)));
+  EXPECT_EQ(writer.GetPendingMaxSeq("conv_a"), 42);
+
+  gate.Open();
+  for (int i = 0; i < 500 && writer.GetStats().pending != 0; ++i)
+  {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  ASSERT_EQ(writer.GetStats().pending, 0);
+  EXPECT_EQ(writer.GetPendingMaxSeq("conv_a"), 0);
+}
+
+// 测试3: 被拒绝的消息不登记
+TEST_F(MessageWriterTest, RejectedNotTracked)
+{
+  auto& writer = core::MessageWriter::GetInstance();
+  gate.Open();
+  writer.Stop();
+
+  EXPECT_FALSE(writer.Submit(make_message("conv_a", 100)));
+  EXPECT_EQ(writer.GetPendingMaxSeq("conv_a"), 0);
+}
@@ -0,0 +1,165 @@
+/******************************************************************************
+ *
+ * @file       test_resume_token.cc
+ * @brief      断线恢复令牌单元测试
+ *
+ * @author     KBchulan
+ * @date       2026/10/18
+ * @history    签发与校验、密钥轮换、过期、篡改与密钥环格式校验的测试套件
+ ******************************************************************************/
+
+#include <gtest/gtest.h>
+
+#include <core/session/resume_token.hpp>
+#include <cstdint>
+#include <global/Global.hpp>
+#include <stdexcept>
+#include <string>
+
+namespace
+{
+
+using global::server::RESUME_TOKEN_TTL_S;
+
+constexpr std::int64_t NOW = 1760745600;  // 固定的签发时刻，过期判断不依赖真实时间
+constexpr const char* UUID = "9f1c2d3e-4b5a-6c7d-8e9f-0a1b2c3d4e5f";
+
+constexpr const char* KEY_K1 = "k1:test-resume-key-fedcba9876543210";
+constexpr const char* KEY_K2 = "k2:test-resume-key-0123456789abcdef";
+constexpr const char* KEY_K1_OTHER_SECRET = "k1:test-resume-key-another-secret-000";
+
+std::string ring(const char* first, const char* second)
+{
+  return std::string{first} + "," + second;
+}
+
+// 把令牌中第 index 个以 '.' 分隔的字段替换为 value
+std::string replace_field(const std::string& token, std::size_t index, const std::string& value)
+{
+  std::size_t begin = 0;
+  for (std::size_t i = 0; i < index; ++i)
+  {
+    begin = token.find('.', begin) + 1;
+  }
+  auto end = token.find('.', begin);
+  return token.substr(0, begin) + value + (end == std::string::npos ? "" : token.substr(end));
+}
+
+}  // namespace
+
+// 密钥环是进程级状态，每个用例先加载自己需要的密钥环
+class ResumeTokenTest : public ::testing::Test
+{
+protected:
+  void SetUp() override
+  {
+    core::ResumeToken::LoadKeys(KEY_K1);
+  }
+
+  void TearDown() override
+  {
+  }
+};
+
+// 测试1: 签发的令牌校验通过，声明中的 uuid 与过期时刻正确
+TEST_F(ResumeTokenTest, IssueAndVerify)
+{
+  auto token = core::ResumeToken::Issue(UUID, NOW);
+  ASSERT_FALSE(token.empty());
+  EXPECT_EQ(token.rfind("2.k1.", 0), 0U);
+
+  auto claims = core::ResumeToken::Verify(token, NOW);
+  ASSERT_TRUE(claims.has_value());
+  EXPECT_EQ(claims->uuid, UUID);
+  EXPECT_EQ(claims->expires_at, NOW + RESUME_TOKEN_TTL_S);
+}
+
+// 测试2: 到达过期时刻即失效，过期前一秒仍有效
+TEST_F(ResumeTokenTest, Expiry)
+{
+  auto token = core::ResumeToken::Issue(UUID, NOW);
+
+  EXPECT_TRUE(core::ResumeToken::Verify(token, NOW + RESUME_TOKEN_TTL_S - 1).has_value());
+  EXPECT_FALSE(core::ResumeToken::Verify(token, NOW + RESUME_TOKEN_TTL_S).has_value());
+  EXPECT_FALSE(core::ResumeToken::Verify(token, NOW + RESUME_TOKEN_TTL_S + 3600).has_value());
+}
+
+// 测试3: 轮换时新密钥签发、旧密钥仍可校验，旧密钥撤下后轮换前的令牌失效
+TEST_F(ResumeTokenTest, KeyRotation)
+{
+  auto old_token = core::ResumeToken::Issue(UUID, NOW);
+
+  core::ResumeToken::LoadKeys(ring(KEY_K2, KEY_K1));
+  auto new_token = core::ResumeToken::Issue(UUID, NOW);
+  EXPECT_EQ(new_token.rfind("2.k2.", 0), 0U);
+  EXPECT_TRUE(core::ResumeToken::Verify(old_token, NOW).has_value());
+  EXPECT_TRUE(core::ResumeToken::Verify(new_token, NOW).has_value());
+
+  core::ResumeToken::LoadKeys(KEY_K2);
+  EXPECT_FALSE(core::ResumeToken::Verify(old_token, NOW).has_value());
+  EXPECT_TRUE(core::ResumeToken::Verify(new_token, NOW).has_value());
+}
+
+// 测试4: 密钥环中没有的密钥 id 直接拒绝
+TEST_F(ResumeTokenTest, UnknownKeyId)
+{
+  auto token = core::ResumeToken::Issue(UUID, NOW);
+  EXPECT_FALSE(core::ResumeToken::Verify(replace_field(token, 1, "k9"), NOW).has_value());
+
+  core::ResumeToken::LoadKeys(KEY_K2);
+  EXPECT_FALSE(core::ResumeToken::Verify(token, NOW).has_value());
+}
+
+// 测试5: 同一密钥 id 换了密钥后签名不符
+TEST_F(ResumeTokenTest, SameKeyIdDifferentSecret)
+{
+  auto token = core::ResumeToken::Issue(UUID, NOW);
+
+  core::ResumeToken::LoadKeys(KEY_K1_OTHER_SECRET);
+  EXPECT_FALSE(core::ResumeToken::Verify(token, NOW).has_value());
+}
+
+// 测试6: 篡改签名、uuid、过期时刻或版本号后校验失败
+TEST_F(ResumeTokenTest, TamperedToken)
+{
+  auto token = core::ResumeToken::Issue(UUID, NOW);
+
+  auto flipped = token;
+  flipped.back() = flipped.back() == '0' ? '1' : '0';
+  EXPECT_FALSE(core::ResumeToken::Verify(flipped, NOW).has_value());
+
+  EXPECT_FALSE(core::ResumeToken::Verify(replace_field(token, 2, "attacker"), NOW).has_value());
+  EXPECT_FALSE(
+      core::ResumeToken::Verify(replace_field(token, 3, std::to_string(NOW + (100 * RESUME_TOKEN_TTL_S))), NOW)
+          .has_value());
+  EXPECT_FALSE(core::ResumeToken::Verify(replace_field(token, 0, "1"), NOW).has_value());
+}
+
+// 测试7: 格式错误的令牌返回空而不是抛出
+TEST_F(ResumeTokenTest, MalformedToken)
+{
+  auto token = core::ResumeToken::Issue(UUID, NOW);
+
+  EXPECT_FALSE(core::ResumeToken::Verify("", NOW).has_value());
+  EXPECT_FALSE(core::ResumeToken::Verify("no-dots-at-all", NOW).has_value());
+  EXPECT_FALSE(core::ResumeToken::Verify(token.substr(0, token.size() - 1), NOW).has_value());
+  EXPECT_FALSE(core::ResumeToken::Verify(replace_field(token, 4, "zz"), NOW).has_value());
+  EXPECT_FALSE(core::ResumeToken::Verify(replace_field(token, 3, "12ab"), NOW).has_value());
+  EXPECT_FALSE(core::ResumeToken::Verify(replace_field(token, 2, ""), NOW).has_value());
+  EXPECT_FALSE(core::ResumeToken::Verify(replace_field(token, 2, std::string(65, 'u')), NOW).has_value());
+}
+
+// 测试8: 密钥环格式错误、密钥过短或密钥 id 重复时拒绝加载，原有密钥环保持不变
+TEST_F(ResumeTokenTest, LoadKeysRejectsInvalidSpec)
+{
+  EXPECT_THROW(core::ResumeToken::LoadKeys(""), std::invalid_argument);
+  EXPECT_THROW(core::ResumeToken::LoadKeys("k1"), std::invalid_argument);
+  EXPECT_THROW(core::ResumeToken::LoadKeys("k1:too-short"), std::invalid_argument);
+  EXPECT_THROW(core::ResumeToken::LoadKeys(":test-resume-key-fedcba9876543210"), std::invalid_argument);
+  EXPECT_THROW(core::ResumeToken::LoadKeys("k.1:test-resume-key-fedcba9876543210"), std::invalid_argument);
+  EXPECT_THROW(core::ResumeToken::LoadKeys(ring(KEY_K1, KEY_K1_OTHER_SECRET)), std::invalid_argument);
+
+  auto token = core::ResumeToken::Issue(UUID, NOW);
+  EXPECT_EQ(token.rfind("2.k1.", 0), 0U);
+  EXPECT_TRUE(core::ResumeToken::Verify(token, NOW).has_value());
+}
@@ -0,0 +1,227 @@
+/******************************************************************************
+ *
+ * @file       test_timing_wheel.cc
+ * @brief      哈希时间轮单元测试
+ *
+ * @author     KBchulan
+ * @date       2026/10/18
+ * @history    到期刻度、Touch 推迟与重新挂链、跨圈超时、移除与重新加入的测试套件
+ ******************************************************************************/
+
+#include <gtest/gtest.h>
+
+#include <boost/asio/io_context.hpp>
+#include <chrono>
+#include <core/timer/timing-wheel.hpp>
+#include <cstddef>
+#include <memory>
+
+namespace
+{
+
+// 刻度取 1 秒，用例中的超时时长都是整数个刻度，实际刻度数为超时时长加 1
+constexpr auto TICK = std::chrono::milliseconds(1000);
+constexpr std::size_t SLOTS = 8;
+
+class CountingNode final : public core::TimingWheel::Node
+{
+public:
+  std::size_t expired = 0;
+
+protected:
+  void OnExpire() override
+  {
+    ++expired;
+  }
+};
+
+}  // namespace
+
+// 内部定时器所在的 io_context 不运行，刻度全部由用例通过 Advance 手动推进
+class TimingWheelTest : public ::testing::Test
+{
+protected:
+  void SetUp() override
+  {
+    wheel = std::make_shared<core::TimingWheel>(io_context, TICK, SLOTS);
+  }
+
+  void TearDown() override
+  {
+  }
+
+  // 推进 ticks 个刻度，返回期间超时的节点总数
+  std::size_t advance(std::size_t ticks)
+  {
+    std::size_t expired = 0;
+    for (std::size_t i = 0; i < ticks; ++i)
+    {
+      expired += wheel->Advance();
+    }
+    return expired;
+  }
+
+  boost::asio::io_context io_context;
+  std::shared_ptr<core::TimingWheel> wheel;
+};
+
+// 测试1: 超时时长向上取整后再加一个刻度，到期前不回调，到期时摘除并回调一次
+TEST_F(TimingWheelTest, ExpiresAfterTimeout)
+{
+  CountingNode node;
+  wheel->Add(node, std::chrono::seconds(3));
+  EXPECT_TRUE(node.IsLinked());
+  EXPECT_EQ(wheel->Size(), 1);
+
+  EXPECT_EQ(advance(3), 0);
+  EXPECT_EQ(node.expired, 0);
+
+  EXPECT_EQ(wheel->Advance(), 1);
+  EXPECT_EQ(node.expired, 1);
+  EXPECT_FALSE(node.IsLinked());
+  EXPECT_EQ(wheel->Size(), 0);
+
+  EXPECT_EQ(advance(2 * SLOTS), 0);
+  EXPECT_EQ(node.expired, 1);
+}
+
+// 测试2: 不足一个刻度的超时向上取整
+TEST_F(TimingWheelTest, RoundsUpPartialTick)
+{
+  CountingNode node;
+  wheel->Add(node, std::chrono::milliseconds(1500));
+
+  EXPECT_EQ(advance(2), 0);
+  EXPECT_EQ(wheel->Advance(), 1);
+}
+
+// 测试3: Touch 从当前刻度重新计时，槽位到期时节点挂到新的槽位而不是超时
+TEST_F(TimingWheelTest, TouchPostponesAndRelinks)
+{
+  CountingNode node;
+  wheel->Add(node, std::chrono::seconds(3));
+
+  EXPECT_EQ(advance(2), 0);
+  wheel->Touch(node);
+
+  // 原到期刻度 4 处理到该节点时只是挂回，新的到期刻度为 2 + 4 = 6
+  EXPECT_EQ(advance(2), 0);
+  EXPECT_TRUE(node.IsLinked());
+  EXPECT_EQ(wheel->Size(), 1);
+
+  EXPECT_EQ(wheel->Advance(), 0);
+  EXPECT_EQ(wheel->Advance(), 1);
+  EXPECT_EQ(node.expired, 1);
+}
+
+// 测试4: 持续 Touch 的节点不会超时
+TEST_F(TimingWheelTest, KeepsTouchedNodeAlive)
+{
+  CountingNode node;
+  wheel->Add(node, std::chrono::seconds(3));
+
+  for (std::size_t i = 0; i < 10 * SLOTS; ++i)
+  {
+    wheel->Touch(node);
+    EXPECT_EQ(wheel->Advance(), 0);
+  }
+  EXPECT_EQ(node.expired, 0);
+  EXPECT_EQ(advance(4), 1);
+}
+
+// 测试5: 超时时长超过一圈时，节点在同一槽位上转过整圈后才到期
+TEST_F(TimingWheelTest, WrapsAroundWheel)
+{
+  auto small = std::make_shared<core::TimingWheel>(io_context, TICK, 4);
+  CountingNode node;
+  small->Add(node, std::chrono::seconds(10));
+
+  // 到期刻度 11，槽位 3 在刻度 3 与 7 被处理时节点尚未到期
+  for (std::size_t tick = 1; tick < 11; ++tick)
+  {
+    EXPECT_EQ(small->Advance(), 0) << "tick " << tick;
+    EXPECT_TRUE(node.IsLinked());
+  }
+  EXPECT_EQ(small->Advance(), 1);
+  EXPECT_EQ(small->Size(), 0);
+}
+
+// 测试6: Touch 到跨圈的刻度后，节点换到另一个槽位并在新的刻度到期
+TEST_F(TimingWheelTest, TouchAcrossWrap)
+{
+  auto small = std::make_shared<core::TimingWheel>(io_context, TICK, 4);
+  CountingNode node;
+  small->Add(node, std::chrono::seconds(5));
+
+  EXPECT_EQ(small->Advance(), 0);
+  small->Touch(node);
+
+  // 到期刻度由 6 变为 7，刻度 2 处理槽位 2 时挂到槽位 3，之后每圈挂回同一槽位
+  for (std::size_t tick = 2; tick < 7; ++tick)
+  {
+    EXPECT_EQ(small->Advance(), 0) << "tick " << tick;
+  }
+  EXPECT_EQ(small->Advance(), 1);
+}
+
+// 测试7: 移除后不再回调，重复移除与移除未加入的节点都是空操作
+TEST_F(TimingWheelTest, RemoveStopsExpiry)
+{
+  CountingNode node;
+  CountingNode never_added;
+  wheel->Add(node, std::chrono::seconds(2));
+
+  wheel->Remove(node);
+  EXPECT_FALSE(node.IsLinked());
+  EXPECT_EQ(wheel->Size(), 0);
+
+  wheel->Remove(node);
+  wheel->Remove(never_added);
+  EXPECT_EQ(wheel->Size(), 0);
+
+  EXPECT_EQ(advance(2 * SLOTS), 0);
+  EXPECT_EQ(node.expired, 0);
+}
+
+// 测试8: 同一槽位链表中间的节点移除后，前后节点仍按时到期
+TEST_F(TimingWheelTest, RemoveFromMiddleOfSlot)
+{
+  CountingNode first;
+  CountingNode middle;
+  CountingNode last;
+  wheel->Add(first, std::chrono::seconds(2));
+  wheel->Add(middle, std::chrono::seconds(2));
+  wheel->Add(last, std::chrono::seconds(2));
+
+  wheel->Remove(middle);
+  EXPECT_EQ(wheel->Size(), 2);
+
+  EXPECT_EQ(advance(3), 2);
+  EXPECT_EQ(first.expired, 1);
+  EXPECT_EQ(middle.expired, 0);
+  EXPECT_EQ(last.expired, 1);
+}
+
+// 测试9: 已加入的节点再次 Add 时按新的超时时长从当前刻度重新计时，不重复计数
+TEST_F(TimingWheelTest, ReAddResetsTimeout)
+{
+  CountingNode shorter;
+  CountingNode longer;
+  wheel->Add(shorter, std::chrono::seconds(5));
+  wheel->Add(longer, std::chrono::seconds(1));
+
+  EXPECT_EQ(wheel->Advance(), 0);
+  wheel->Add(shorter, std::chrono::seconds(1));
+  wheel->Add(longer, std::chrono::seconds(5));
+  EXPECT_EQ(wheel->Size(), 2);
+
+  // shorter 的到期刻度 1 + 2 = 3，longer 为 1 + 6 = 7
+  EXPECT_EQ(wheel->Advance(), 0);
+  EXPECT_EQ(wheel->Advance(), 1);
+  EXPECT_EQ(shorter.expired, 1);
+
+  EXPECT_EQ(advance(3), 0);
+  EXPECT_EQ(wheel->Advance(), 1);
+  EXPECT_EQ(longer.expired, 1);
+  EXPECT_EQ(wheel->Size(), 0);
+}
@@ -0,0 +1,200 @@
+/******************************************************************************
+ *
+ * @file       test_mpscqueue.cc
+ * @brief      MpscQueue无锁队列单元测试
+ *
+ * @author     KBchulan
+ * @date       2026/10/17
+ * @history    MpscQueue顺序、析构和多生产者测试套件
+ ******************************************************************************/
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <global/MpscQueue.hpp>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+struct TestMessage
+{
+  int id{0};
+  std::string content;
+
+  TestMessage() = default;
+  TestMessage(int _id, std::string _content) : id(_id), content(std::move(_content))
+  {
+  }
+};
+
+class MpscQueueTest : public ::testing::Test
+{
+protected:
+  void SetUp() override
+  {
+  }
+
+  void TearDown() override
+  {
+  }
+};
+
+// 测试1: 基本入队出队
+TEST_F(MpscQueueTest, BasicEnqueueDequeue)
+{
+  global::MpscQueue<int> queue;
+
+  EXPECT_TRUE(queue.empty());
+  EXPECT_EQ(queue.size(), 0);
+
+  queue.emplace(42);
+  EXPECT_FALSE(queue.empty());
+  EXPECT_EQ(queue.size(), 1);
+
+  int value = 0;
+  EXPECT_TRUE(queue.pop(value));
+  EXPECT_EQ(value, 42);
+  EXPECT_TRUE(queue.empty());
+  EXPECT_EQ(queue.size(), 0);
+}
+
+// 测试2: 队列空测试，出队后再次入队需要复用新的哨兵节点
+TEST_F(MpscQueueTest, QueueEmpty)
+{
+  global::MpscQueue<int> queue;
+
+  int value = 0;
+  EXPECT_FALSE(queue.pop(value)) << "队列为空,出队应该返回false";
+
+  for (int round = 0; round < 3; ++round)
+  {
+    queue.emplace(round);
+    EXPECT_TRUE(queue.pop(value));
+    EXPECT_EQ(value, round);
+    EXPECT_FALSE(queue.pop(value));
+    EXPECT_TRUE(queue.empty());
+  }
+}
+
+// 测试3: 无容量上限，超过原 SuperQueue 发送队列容量也能入队
+TEST_F(MpscQueueTest, Unbounded)
+{
+  global::MpscQueue<int> queue;
+
+  for (int i = 0; i < 5000; ++i)
+  {
+    queue.emplace(i);
+  }
+  EXPECT_EQ(queue.size(), 5000);
+
+  for (int i = 0; i < 5000; ++i)
+  {
+    int value = 0;
+    EXPECT_TRUE(queue.pop(value));
+    EXPECT_EQ(value, i) << "FIFO顺序错误 at " << i;
+  }
+  EXPECT_TRUE(queue.empty());
+}
+
+// 测试4: 复杂类型测试
+TEST_F(MpscQueueTest, ComplexType)
+{
+  global::MpscQueue<TestMessage> queue;
+
+  queue.emplace(1, "Hello");
+  queue.emplace(2, "World");
+
+  EXPECT_EQ(queue.size(), 2);
+
+  TestMessage msg;
+  EXPECT_TRUE(queue.pop(msg));
+  EXPECT_EQ(msg.id, 1);
+  EXPECT_EQ(msg.content, "Hello");
+
+  EXPECT_TRUE(queue.pop(msg));
+  EXPECT_EQ(msg.id, 2);
+  EXPECT_EQ(msg.content, "World");
+
+  EXPECT_TRUE(queue.empty());
+}
+
+// 测试5: 析构函数释放剩余元素
+TEST_F(MpscQueueTest, DestructorWithElements)
+{
+  auto tracker = std::make_shared<int>(0);
+
+  {
+    global::MpscQueue<std::shared_ptr<int>> queue;
+
+    for (int i = 0; i < 10; ++i)
+    {
+      queue.emplace(tracker);
+    }
+
+    std::shared_ptr<int> value;
+    for (int i = 0; i < 5; ++i)
+    {
+      EXPECT_TRUE(queue.pop(value));
+    }
+    value.reset();
+
+    EXPECT_EQ(tracker.use_count(), 6);
+  }
+
+  EXPECT_EQ(tracker.use_count(), 1);
+}
+
+// 测试6: 多生产者单消费者，每个生产者内部保持 FIFO
+TEST_F(MpscQueueTest, MultiProducerSingleConsumer)
+{
+  global::MpscQueue<int> queue;
+  const int num_producers = 8;
+  const int items_per_producer = 10000;
+  const int total = num_producers * items_per_producer;
+
+  std::vector<std::thread> producers;
+  producers.reserve(num_producers);
+  for (int i = 0; i < num_producers; ++i)
+  {
+    producers.emplace_back(
+        [&queue, i]()
+        {
+          for (int j = 0; j < items_per_producer; ++j)
+          {
+            queue.emplace((i * items_per_producer) + j);
+          }
+        });
+  }
+
+  std::vector<int> last_seen(num_producers, -1);
+  int consumed = 0;
+  while (consumed < total)
+  {
+    int value = 0;
+    if (!queue.pop(value))
+    {
+      std::this_thread::yield();
+      continue;
+    }
+
+    int producer = value / items_per_producer;
+    EXPECT_GT(value, last_seen[static_cast<std::size_t>(producer)]) << "生产者内部顺序错误";
+    last_seen[static_cast<std::size_t>(producer)] = value;
+    ++consumed;
+  }
+
+  for (auto& producer : producers)
+  {
+    producer.join();
+  }
+
+  EXPECT_EQ(consumed, total);
+  EXPECT_TRUE(queue.empty());
+}
+
+// 测试7: 空闲队列占用的内存应当足够小
+TEST_F(MpscQueueTest, IdleFootprint)
+{
+  EXPECT_LE(sizeof(global::MpscQueue<std::shared_ptr<int>>), 64);
+}
@@ -77,6 +77,9 @@ constexpr std::int8_t IO_CONTEXT_POOL_SIZE = 8;        // io_context 池子大
 constexpr std::int8_t BUSINESS_POOL_SIZE = 8;          // 业务池子大小
 constexpr std::uint16_t MAX_FLATBUFFER_SIZE = 8192;    // 最大扁平化缓冲区大小 8KB
 
+constexpr bool IO_PIN_CPUS = false;             // io 线程按 NUMA 节点顺序各绑一个核，独占机器部署时开启
+constexpr bool REUSEPORT_CPU_STEERING = false;  // 绑核时按收包 CPU 选择 acceptor，需网卡 RSS 或 RPS 把连接分散到各核
+
 constexpr std::int32_t RPC_MAX_SEND_RECV_SIZE = 4 * 1024 * 1024;  // RPC 最大发送和接收消息大小 4MB
 
 constexpr const char* EMAIL_RPC_SERVER_HOST = "127.0.0.1";  // 邮箱 RPC 服务器地址
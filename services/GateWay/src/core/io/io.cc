@@ -3,6 +3,7 @@
 #include <algorithm>
 #include <atomic>
 #include <boost/asio/executor_work_guard.hpp>
+#include <core/io/cpu_affinity.hpp>
 #include <cstddef>
 #include <global/Global.hpp>
 #include <iterator>
@@ -18,6 +19,7 @@ struct IO::_impl
   std::size_t _pool_size;
   std::vector<std::unique_ptr<boost::asio::io_context>> _io_contexts;
   std::vector<std::jthread> _io_threads;
+  std::vector<int> _cpus;
   std::vector<boost::asio::executor_work_guard<boost::asio::io_context::executor_type>> _work_guards;
   std::atomic<std::size_t> _next_idx;
 
@@ -33,11 +35,45 @@ struct IO::_impl
     std::ranges::transform(_io_contexts, std::back_inserter(_work_guards),
                            [](const auto& ioc) { return boost::asio::make_work_guard(*ioc); });
 
+    assign_cpus();
+
     _io_threads.reserve(_pool_size);
-    std::ranges::transform(_io_contexts, std::back_inserter(_io_threads),
-                           [](const auto& ioc) { return std::jthread([&ioc]() { (*ioc).run(); }); });
+    for (std::size_t i = 0; i < _pool_size; ++i)
+    {
+      _io_threads.emplace_back(
+          [ioc = _io_contexts[i].get(), cpu = _cpus[i]]()
+          {
+            // 在线程内绑定，run 之前完成，之后该线程的内存首次分配都落在绑定核所在的节点上
+            if (cpu >= 0 && !CpuAffinity::PinCurrentThread(cpu))
+            {
+              tools::Logger::getInstance().warning("Failed to pin io thread to cpu {}", cpu);
+            }
+            ioc->run();
+          });
+    }
 
-    tools::Logger::getInstance().info("io pool initialized successful");
+    tools::Logger::getInstance().info("io pool initialized successful on {}", IO::GetBackendName());
+  }
+
+  // 线程数超过可用核数时从头复用，多个 io 线程共享一个核
+  void assign_cpus()
+  {
+    _cpus.assign(_pool_size, -1);
+    if (!global::server::IO_PIN_CPUS)
+    {
+      return;
+    }
+
+    auto cpus = CpuAffinity::AvailableCpus();
+    if (cpus.empty())
+    {
+      tools::Logger::getInstance().warning("No cpu available for pinning, io threads stay unpinned");
+      return;
+    }
+    for (std::size_t i = 0; i < _pool_size; ++i)
+    {
+      _cpus[i] = cpus[i % cpus.size()];
+    }
   }
 
   ~_impl()
@@ -76,4 +112,18 @@ boost::asio::io_context& IO::GetIOContextAt(std::size_t idx)
   return *_pimpl->_io_contexts[idx % _pimpl->_pool_size];
 }
 
+int IO::GetCpuAt(std::size_t idx) const
+{
+  return _pimpl->_cpus[idx % _pimpl->_pool_size];
+}
+
+const char* IO::GetBackendName() noexcept
+{
+#if defined(BOOST_ASIO_HAS_IO_URING_AS_DEFAULT)
+  return "io_uring";
+#else
+  return "epoll";
+#endif
+}
+
 }  // namespace core
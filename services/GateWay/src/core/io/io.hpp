@@ -5,7 +5,8 @@
  *
  * @author     KBchulan
  * @date       2025/12/07
- * @history
+ * @history    2026/10/18 可选按 NUMA 节点顺序把 io 线程绑定到各个核上
+ *             2026/10/18 可选以 io_uring 为后端构建
  ******************************************************************************/
 
 #ifndef IO_HPP
@@ -33,6 +34,12 @@ public:
   // 根据索引获取 io_context
   [[nodiscard]] boost::asio::io_context& GetIOContextAt(std::size_t idx);
 
+  // 根据索引获取 io 线程绑定的核，未绑核时返回 -1
+  [[nodiscard]] int GetCpuAt(std::size_t idx) const;
+
+  // 构建时选定的后端，"io_uring" 或 "epoll"
+  [[nodiscard]] static const char* GetBackendName() noexcept;
+
   IO(const IO&) = delete;
   IO& operator=(const IO&) = delete;
   IO(IO&&) = delete;
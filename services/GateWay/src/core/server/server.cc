@@ -2,22 +2,27 @@
 
 #include <sys/socket.h>
 
+#include <algorithm>
 #include <boost/asio/ip/address_v4.hpp>
 #include <boost/asio/ip/tcp.hpp>
 #include <boost/asio/socket_base.hpp>
 #include <boost/system/detail/error_code.hpp>
 #include <core/connection/connection.hpp>
+#include <core/io/cpu_affinity.hpp>
 #include <core/io/io.hpp>
+#include <global/Global.hpp>
 #include <tools/Logger.hpp>
+#include <vector>
 
 namespace core
 {
 
-// 单个 Acceptor 工作单元，每个 io_context 对应一个
+// 单个 Acceptor 工作单元，每个 io_context 对应一个，绑核时按收包 CPU 分发连接
 class AcceptorWorker
 {
 public:
-  AcceptorWorker(boost::asio::io_context& ioc, unsigned short port) : _io_context(ioc), _acceptor(ioc), _socket(ioc)
+  AcceptorWorker(boost::asio::io_context& ioc, int cpu, unsigned short port)
+      : _io_context(ioc), _acceptor(ioc), _socket(ioc)
   {
     boost::asio::ip::tcp::endpoint endpoint(boost::asio::ip::address_v4::any(), port);
 
@@ -28,6 +33,11 @@ public:
     int reuse_port = 1;
     setsockopt(_acceptor.native_handle(), SOL_SOCKET, SO_REUSEPORT, &reuse_port, sizeof(reuse_port));
 
+    if (global::server::REUSEPORT_CPU_STEERING && cpu >= 0)
+    {
+      CpuAffinity::SetIncomingCpu(_acceptor.native_handle(), cpu);
+    }
+
     _acceptor.bind(endpoint);
     _acceptor.listen(boost::asio::socket_base::max_listen_connections);
 
@@ -40,6 +50,11 @@ public:
     _acceptor.close(errc);
   }
 
+  [[nodiscard]] int NativeHandle()
+  {
+    return _acceptor.native_handle();
+  }
+
 private:
   void start_accept()
   {
@@ -87,12 +102,39 @@ struct Server::_impl
     // 每个 io_context 创建一个 acceptor
     for (std::size_t i = 0; i < pool_size; ++i)
     {
-      _workers.emplace_back(std::make_unique<AcceptorWorker>(io_pool.GetIOContextAt(i), _port));
+      _workers.emplace_back(std::make_unique<AcceptorWorker>(io_pool.GetIOContextAt(i), io_pool.GetCpuAt(i), _port));
+    }
+
+    if (global::server::REUSEPORT_CPU_STEERING)
+    {
+      attach_steering(io_pool);
     }
 
     tools::Logger::getInstance().info("Gateway started on port {} with {} acceptors", _port, pool_size);
   }
 
+  // 组内 socket 的下标即 listen 的先后顺序，与 io_context 的索引一致，挂到任一 socket 上对整组生效
+  void attach_steering(IO& io_pool)
+  {
+    std::vector<int> cpus(_workers.size());
+    for (std::size_t i = 0; i < cpus.size(); ++i)
+    {
+      cpus[i] = io_pool.GetCpuAt(i);
+    }
+
+    if (std::ranges::find(cpus, -1) != cpus.end())
+    {
+      tools::Logger::getInstance().warning("Reuseport steering needs pinned io threads, keep hashing");
+      return;
+    }
+    if (!CpuAffinity::AttachReuseportSteering(_workers.front()->NativeHandle(), cpus))
+    {
+      tools::Logger::getInstance().warning("Failed to attach reuseport steering program, keep hashing");
+      return;
+    }
+    tools::Logger::getInstance().info("Reuseport steering attached for {} acceptors", cpus.size());
+  }
+
   ~_impl()
   {
     tools::Logger::getInstance().info("Gateway stopped");